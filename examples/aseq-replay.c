@@ -0,0 +1,81 @@
+/* This file is part of the LAIK parallel container library.
+ * Copyright (c) 2018 Josef Weidendorfer
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Replay of recorded action sequences.
+ *
+ * Action sequences prepared by a LAIK application run with environment
+ * variable LAIK_ASEQ_SAVE=<prefix> are written to files
+ * "<prefix>-<seq id>-<rank>.aseq". This loads such a sequence for each
+ * process (same number of processes required), lets the backend prepare
+ * it and measures execution time with dummy data. Use the configuration
+ * of the backend (e.g. LAIK_MPI_SORT, LAIK_MPI_COMBINE) to compare
+ * transformation passes on recorded schedules.
+ */
+
+#include <laik.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+    int myid = laik_myid(world);
+
+    int iter = 10;
+    int arg = 1;
+    if ((argc > arg + 1) && (strcmp(argv[arg], "-n") == 0)) {
+        iter = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if ((argc <= arg) || (iter < 1)) {
+        if (myid == 0)
+            printf("Usage: %s [-n <iterations>] <prefix>-<seq id>\n"
+                   "  Replay action sequence from files "
+                   "'<prefix>-<seq id>-<rank>.aseq'\n", argv[0]);
+        laik_finalize(inst);
+        return 1;
+    }
+
+    char fname[256];
+    snprintf(fname, sizeof(fname), "%s-%d.aseq", argv[arg], myid);
+
+    Laik_ActionSeq* as = laik_aseq_load(inst, fname);
+    if (!as) {
+        printf("Task %d: cannot load action sequence from '%s'\n", myid, fname);
+        exit(1);
+    }
+
+    double t1 = laik_wtime();
+    laik_aseq_prepare(as);
+    double t2 = laik_wtime();
+    for(int i = 0; i < iter; i++)
+        laik_aseq_replay(as);
+    double t3 = laik_wtime();
+
+    if (myid == 0)
+        printf("Replayed '%s' %d times: prepare %.3f ms, exec %.3f ms each "
+               "(%d bytes buffers)\n",
+               argv[arg], iter, 1000.0 * (t2 - t1),
+               1000.0 * (t3 - t2) / iter, laik_aseq_bufsize(as));
+
+    laik_aseq_free(as);
+    laik_finalize(inst);
+    return 0;
+}
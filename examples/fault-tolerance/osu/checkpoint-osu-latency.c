@@ -128,6 +128,8 @@ int main (int argc, char *argv[])
         Laik_Partitioning* newT2Partitioning = laik_new_partitioning(laik_Master, world, laik_data_get_space(data), NULL);
 
         //Modify second partitioning, such that it resides on task 1 instead of task 0
+        //(its slices are shared with the identical first one, so modify a copy)
+        newT2Partitioning->saList->slices = laik_slicearray_unshare(newT2Partitioning->saList->slices);
         newT2Partitioning->saList->slices->tslice[0].task++;
 
         assert(newT1Partitioning->saList->slices->tslice[0].task == 0);
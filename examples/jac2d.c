@@ -67,11 +67,29 @@ void setBoundary(int size, Laik_Partitioning *pWrite, Laik_Data* dWrite)
 }
 
 // to deliberately change block partitioning (if arg 3 provided)
+// userData: phase (number of repartitionings, only parity used)
+//           and number of tasks
 double getTW(int rank, const void* userData)
 {
-    int v = * ((int*) userData);
-    // switch non-equal weigthing on and off
-    return 1.0 + (rank * (v & 1));
+    const int* ud = (const int*) userData;
+    int v = ud[0], tasks = ud[1];
+    // switch non-equal weighting on and off: ranks 4k+1 give half of
+    // their rows to ranks 4k+2, others keep their rows
+    if ((v & 1) == 0) return 1.0;
+    if (((rank % 4) == 1) && (rank + 1 < tasks)) return 0.5;
+    if ((rank % 4) == 2) return 1.5;
+    return 1.0;
+}
+
+// with distributed partitionings, each task only stores own slices
+// and slices of neighbors needed for halo exchange
+Laik_Partitioning* newPartitioning(bool distributed, Laik_Partitioner* pr,
+                                   Laik_Group* g, Laik_Space* space,
+                                   Laik_Partitioning* other)
+{
+    if (distributed)
+        return laik_new_distributed_partitioning(pr, g, space, other);
+    return laik_new_partitioning(pr, g, space, other);
 }
 
 int main(int argc, char* argv[])
@@ -83,20 +101,29 @@ int main(int argc, char* argv[])
     int maxiter = 0;
     int repart = 0; // enforce repartitioning after <repart> iterations
     bool use_cornerhalo = true; // use halo partitioner including corners?
+    bool use_stencil = false; // use stencil partitioner for halo without corners?
     bool do_profiling = false;
     bool do_sum = false;
+    bool do_distpart = false; // use distributed partitionings?
+    bool do_wbisection = false; // surface-minimizing bisection?
 
     int arg = 1;
     while ((argc > arg) && (argv[arg][0] == '-')) {
         if (argv[arg][1] == 'n') use_cornerhalo = false;
+        if (argv[arg][1] == 't') use_cornerhalo = false, use_stencil = true;
         if (argv[arg][1] == 'p') do_profiling = true;
         if (argv[arg][1] == 's') do_sum = true;
+        if (argv[arg][1] == 'd') do_distpart = true;
+        if (argv[arg][1] == 'b') do_wbisection = true;
         if (argv[arg][1] == 'h') {
             printf("Usage: %s [options] <side width> <maxiter> <repart>\n\n"
                    "Options:\n"
                    " -n : use partitioner which does not include corners\n"
+                   " -t : as -n, but using stencil partitioner (allows repartitioning)\n"
                    " -p : write profiling data to 'jac2d_profiling.txt'\n"
                    " -s : print value sum at end (warning: sum done at master)\n"
+                   " -d : use distributed partitionings (only own/needed slices)\n"
+                   " -b : use bisection minimizing halo surface\n"
                    " -h : print this help text and exit\n",
                    argv[0]);
             exit(1);
@@ -107,6 +134,15 @@ int main(int argc, char* argv[])
     if (argc > arg + 1) maxiter = atoi(argv[arg + 1]);
     if (argc > arg + 2) repart = atoi(argv[arg + 2]);
 
+    if ((repart > 0) && !use_cornerhalo && !use_stencil) {
+        // halo partitioner without corners requires tagged slices, which
+        // the block partitioner used for repartitioning does not provide
+        if (laik_myid(world) == 0)
+            printf("Repartitioning requires halo with corners (no '-n', try '-t')\n");
+        laik_finalize(inst);
+        exit(1);
+    }
+
     if (size == 0) size = 2500; // 6.25 mio entries
     if (maxiter == 0) maxiter = 50;
 
@@ -139,15 +175,38 @@ int main(int argc, char* argv[])
     // - prWrite: cells to update (disjunctive partitioning)
     // - prRead : extends partitionings by haloes, to read neighbor values
     Laik_Partitioner *prWrite, *prRead;
-    prWrite = laik_new_bisection_partitioner();
-    prRead = use_cornerhalo ? laik_new_cornerhalo_partitioner(1) :
-                              laik_new_halo_partitioner(1);
+    // with repartitioning, use row stripes to be able to move borders.
+    // Weights only depend on phase parity: use a partitioner for each,
+    // as partitioners may be run again later (distributed partitionings)
+    static int userData[2][2];
+    Laik_Partitioner* prBlock[2] = { 0, 0 };
+    if (repart > 0) {
+        for(int i = 0; i < 2; i++) {
+            userData[i][0] = i;
+            userData[i][1] = laik_size(world);
+            prBlock[i] = laik_new_block_partitioner(1, 1, 0, getTW, userData[i]);
+        }
+        prWrite = prBlock[0];
+    }
+    else if (do_wbisection)
+        prWrite = laik_new_weighted_bisection_partitioner(0, 0, 0);
+    else
+        prWrite = laik_new_bisection_partitioner();
+    if (use_cornerhalo)
+        prRead = laik_new_cornerhalo_partitioner(1);
+    else if (use_stencil) {
+        // face-only halos of depth 1 (5-point stencil)
+        int depth[2] = { 1, 1 };
+        prRead = laik_new_stencil_partitioner(2, depth, 0, false);
+    }
+    else
+        prRead = laik_new_halo_partitioner(1);
 
     // run partitioners to get partitionings over 2d space and <world> group
     // data1/2 are then alternately accessed using pRead/pWrite
     Laik_Partitioning *pWrite, *pRead;
-    pWrite = laik_new_partitioning(prWrite, world, space, 0);
-    pRead  = laik_new_partitioning(prRead, world, space, pWrite);
+    pWrite = newPartitioning(do_distpart, prWrite, world, space, 0);
+    pRead  = newPartitioning(do_distpart, prRead, world, space, pWrite);
     laik_partitioning_set_name(pWrite, "pWrite");
     laik_partitioning_set_name(pRead, "pRead");
 
@@ -278,7 +337,24 @@ int main(int argc, char* argv[])
             }
         }
 
-        // TODO: allow repartitioning
+        // optionally, change partitioning slightly as test
+        if ((repart > 0) && (iter > 0) && ((iter % repart) == 0)) {
+            prWrite = prBlock[(iter / repart) & 1];
+
+            // calculate new partitionings, switch to them, free old
+            // only need to preserve data written into dWrite
+            Laik_Partitioning *pWriteNew, *pReadNew;
+            pWriteNew = newPartitioning(do_distpart, prWrite, world, space, 0);
+            pReadNew  = newPartitioning(do_distpart, prRead, world, space, pWriteNew);
+            laik_switchto_partitioning(dWrite, pWriteNew,
+                                       LAIK_DF_Preserve, LAIK_RO_None);
+            laik_switchto_partitioning(dRead, pReadNew,
+                                       LAIK_DF_None, LAIK_RO_None);
+            laik_free_partitioning(pWrite);
+            laik_free_partitioning(pRead);
+            pWrite = pWriteNew;
+            pRead = pReadNew;
+        }
     }
 
     // statistics for all iterations and reductions
@@ -84,6 +84,53 @@ void setBoundary(int size, Laik_Partitioning *pWrite, Laik_Data* dWrite)
     }
 }
 
+// update cells in given range from neighbors (no residuum calculation)
+void update(double* baseR, uint64_t zstrideR, uint64_t ystrideR,
+            double* baseW, uint64_t zstrideW, uint64_t ystrideW,
+            int64_t z1, int64_t z2, int64_t y1, int64_t y2,
+            int64_t x1, int64_t x2)
+{
+    double vSum, coeff = 1.0 / 6.0;
+    for(int64_t z = z1; z < z2; z++) {
+        for(int64_t y = y1; y < y2; y++) {
+            for(int64_t x = x1; x < x2; x++) {
+                vSum = baseR[ (z-1) * zstrideR + y * ystrideR + x ] +
+                       baseR[ (z+1) * zstrideR + y * ystrideR + x ] +
+                       baseR[ z * zstrideR + (y-1) * ystrideR + x ] +
+                       baseR[ z * zstrideR + (y+1) * ystrideR + x ] +
+                       baseR[ z * zstrideR + y * ystrideR + (x-1) ] +
+                       baseR[ z * zstrideR + y * ystrideR + (x+1) ];
+                baseW[z * zstrideW + y * ystrideW + x] = coeff * vSum;
+            }
+        }
+    }
+}
+
+// one action sequence for switching container <d1> with <t1> and <d2> with <t2>
+Laik_ActionSeq* calcMultiActions(Laik_Data* d1, Laik_Transition* t1, Laik_Reservation* r1,
+                                 Laik_Data* d2, Laik_Transition* t2, Laik_Reservation* r2)
+{
+    Laik_Data* d[2] = { d1, d2 };
+    Laik_Transition* t[2] = { t1, t2 };
+    Laik_Reservation* r[2] = { r1, r2 };
+    return laik_calc_actions_multi(2, d, t, r, r);
+}
+
+// calculate transitions to halo and back to exclusive partitioning at once
+void calcTransitions(Laik_Space* space,
+                     Laik_Partitioning* pWrite, Laik_Partitioning* pRead,
+                     Laik_Transition** toHalo, Laik_Transition** toExcl)
+{
+    Laik_Space* s[2] = { space, space };
+    Laik_Partitioning* fromP[2] = { pWrite, pRead };
+    Laik_Partitioning* toP[2] = { pRead, pWrite };
+    Laik_DataFlow flow[2] = { LAIK_DF_Preserve, LAIK_DF_None };
+    Laik_ReductionOperation redOp[2] = { LAIK_RO_None, LAIK_RO_None };
+    Laik_Transition* t[2];
+    laik_calc_transitions(2, s, fromP, toP, flow, redOp, t);
+    *toHalo = t[0];
+    *toExcl = t[1];
+}
 
 int main(int argc, char* argv[])
 {
@@ -93,24 +140,35 @@ int main(int argc, char* argv[])
     int size = 0;
     int maxiter = 0;
     bool use_cornerhalo = true; // use halo partitioner including corners?
+    bool use_stencil = false; // use stencil partitioner for halo without corners?
     bool do_profiling = false;
     bool do_sum = false;
     bool do_reservation = false;
     bool do_exec = false;
     bool do_actions = false;
+    bool do_multi = false;
+    bool do_overlap = false;
     bool do_grid = false;
+    bool do_wbisection = false; // surface-minimizing bisection?
     int xblocks = 0, yblocks = 0, zblocks = 0; // for grid partitioner
     int iter_shrink = 0; // number iterations between shrinks (0: disable)
+    int alloc_flags = LAIK_AF_None; // for built-in allocator
 
     int arg = 1;
     while ((argc > arg) && (argv[arg][0] == '-')) {
         if (argv[arg][1] == 'n') use_cornerhalo = false;
+        if (argv[arg][1] == 't') use_cornerhalo = false, use_stencil = true;
         if (argv[arg][1] == 'p') do_profiling = true;
         if (argv[arg][1] == 's') do_sum = true;
         if (argv[arg][1] == 'r') do_reservation = true;
         if (argv[arg][1] == 'e') do_exec = true;
         if (argv[arg][1] == 'a') do_actions = true;
+        if (argv[arg][1] == 'm') do_multi = do_actions = true;
+        if (argv[arg][1] == 'o') do_overlap = true;
         if (argv[arg][1] == 'g') do_grid = true;
+        if (argv[arg][1] == 'b') do_wbisection = true;
+        if (argv[arg][1] == 'H') alloc_flags |= LAIK_AF_HugePages | LAIK_AF_FirstTouch;
+        if (argv[arg][1] == 'N') alloc_flags |= LAIK_AF_NumaInterleave;
         if (argv[arg][1] == 'x' && argc > arg+1) {
             xblocks = atoi(argv[++arg]);
             do_grid = true;
@@ -120,14 +178,20 @@ int main(int argc, char* argv[])
             printf("Usage: %s [options] <side width> <maxiter>\n\n"
                    "Options:\n"
                    " -n        : use partitioner which does not include corners\n"
+                   " -t        : as -n, but using stencil partitioner\n"
                    " -g        : use grid partitioning with automatic block size\n"
                    " -x <xgrid>: use grid partitioning with given x block length\n"
+                   " -b        : use bisection minimizing halo surface\n"
                    " -p        : write profiling data to 'jac3d_profiling.txt'\n"
                    " -s        : print value sum at end (warning: sum done at master)\n"
                    " -r        : do space reservation before iteration loop\n"
                    " -e        : pre-calculate transitions to exec in iteration loop\n"
                    " -a        : pre-calculate action sequence to exec (includes -e)\n"
+                   " -m        : as -a, but one sequence for both containers\n"
+                   " -o        : overlap halo exchange with update of inner cells\n"
                    " -i <iter> : remove master every <iter> iterations (0: disable)\n"
+                   " -H        : use huge pages for containers, with parallel first touch\n"
+                   " -N        : interleave container memory over NUMA nodes\n"
                    " -h        : print this help text and exit\n",
                    argv[0]);
             exit(1);
@@ -189,15 +253,33 @@ int main(int argc, char* argv[])
     Laik_Space* space = laik_new_space_3d(inst, size, size, size);
     Laik_Data* data1 = laik_new_data(space, laik_Double);
     Laik_Data* data2 = laik_new_data(space, laik_Double);
+    if (alloc_flags != LAIK_AF_None) {
+        Laik_Allocator* alloc = laik_new_allocator_preset(alloc_flags, 0);
+        // reuse memory of freed mappings instead of new mmap on each switch
+        alloc->policy = LAIK_MP_UsePool;
+        laik_set_allocator(data1, alloc);
+        laik_set_allocator(data2, alloc);
+    }
 
     // we use two types of partitioners algorithms:
     // - prWrite: cells to update (disjunctive partitioning)
     // - prRead : extends partitionings by haloes, to read neighbor values
     Laik_Partitioner *prWrite, *prRead;
-    prWrite = do_grid ? laik_new_grid_partitioner(xblocks, yblocks, zblocks) :
-                        laik_new_bisection_partitioner();
-    prRead = use_cornerhalo ? laik_new_cornerhalo_partitioner(1) :
-                              laik_new_halo_partitioner(1);
+    if (do_grid)
+        prWrite = laik_new_grid_partitioner(xblocks, yblocks, zblocks);
+    else if (do_wbisection)
+        prWrite = laik_new_weighted_bisection_partitioner(0, 0, 0);
+    else
+        prWrite = laik_new_bisection_partitioner();
+    if (use_cornerhalo)
+        prRead = laik_new_cornerhalo_partitioner(1);
+    else if (use_stencil) {
+        // face-only halos of depth 1 (7-point stencil)
+        int depth[3] = { 1, 1, 1 };
+        prRead = laik_new_stencil_partitioner(3, depth, 0, false);
+    }
+    else
+        prRead = laik_new_halo_partitioner(1);
 
     // run partitioners to get partitionings over 3d space and <world> group
     // data1/2 are then alternately accessed using pRead/pWrite
@@ -237,11 +319,16 @@ int main(int argc, char* argv[])
     Laik_ActionSeq* data2_toHaloActions = 0;
     Laik_ActionSeq* data2_toExclActions = 0;
     if (do_exec || do_actions) {
-        toHaloTransition = laik_calc_transition(space, pWrite, pRead,
-                                                LAIK_DF_Preserve, LAIK_RO_None);
-        toExclTransition = laik_calc_transition(space, pRead, pWrite,
-                                                LAIK_DF_None, LAIK_RO_None);
-        if (do_actions) {
+        calcTransitions(space, pWrite, pRead,
+                        &toHaloTransition, &toExclTransition);
+        if (do_multi) {
+            // combined sequences: one container to halo, other to exclusive
+            data1_toHaloActions = calcMultiActions(data1, toHaloTransition, r1,
+                                                   data2, toExclTransition, r2);
+            data2_toHaloActions = calcMultiActions(data2, toHaloTransition, r2,
+                                                   data1, toExclTransition, r1);
+        }
+        else if (do_actions) {
             data1_toHaloActions = laik_calc_actions(data1, toHaloTransition, r1, r1);
             data1_toExclActions = laik_calc_actions(data1, toExclTransition, r1, r1);
             data2_toHaloActions = laik_calc_actions(data2, toHaloTransition, r2, r2);
@@ -308,18 +395,38 @@ int main(int argc, char* argv[])
         // (3) with pre-calculated action sequence for transitions: execute it
         // with (3), it is especially beneficial to use a reservation, as
         // the actions usually directly refer to e.g. MPI calls
-
-        if (do_actions) {
+        // with -m, switches of both containers are done in one sequence,
+        // allowing the backend to combine messages to the same process
+        // with -o, the switch of dRead to halo partitioning only gets
+        // started, and completed after updating inner cells (not for (2)).
+        // Iterations with residuum calculation are done without overlap
+
+        bool overlap = do_overlap && ((iter % 10) != 0);
+        if (do_multi) {
+            Laik_ActionSeq* as;
+            as = (dRead == data1) ? data1_toHaloActions : data2_toHaloActions;
+            if (overlap)
+                laik_exec_actions_start(as);
+            else
+                laik_exec_actions(as);
+        }
+        else if (do_actions) {
             // case (3): pre-calculated action sequences
+            Laik_ActionSeq *toHalo, *toExcl;
             if (dRead == data1) {
                 // switch data 1 to halo partitioning
-                laik_exec_actions(data1_toHaloActions);
-                laik_exec_actions(data2_toExclActions);
+                toHalo = data1_toHaloActions;
+                toExcl = data2_toExclActions;
             }
             else {
-                laik_exec_actions(data2_toHaloActions);
-                laik_exec_actions(data1_toExclActions);
+                toHalo = data2_toHaloActions;
+                toExcl = data1_toExclActions;
             }
+            if (overlap)
+                laik_exec_actions_start(toHalo);
+            else
+                laik_exec_actions(toHalo);
+            laik_exec_actions(toExcl);
         }
         else if (do_exec) {
             // case (2): pre-calculated transitions
@@ -328,7 +435,10 @@ int main(int argc, char* argv[])
         }
         else {
             // case (1): no pre-calculation: switch to partitionings
-            laik_switchto_partitioning(dRead,  pRead,  LAIK_DF_Preserve, LAIK_RO_None);
+            if (overlap)
+                laik_switchto_partitioning_start(dRead, pRead, LAIK_DF_Preserve, LAIK_RO_None);
+            else
+                laik_switchto_partitioning(dRead,  pRead,  LAIK_DF_Preserve, LAIK_RO_None);
             laik_switchto_partitioning(dWrite, pWrite, LAIK_DF_None, LAIK_RO_None);
         }
 
@@ -429,6 +539,32 @@ int main(int argc, char* argv[])
 
             if (res < .001) break;
         }
+        else if (overlap) {
+            // inner cells: all neighbors are own cells, no halo needed
+            int64_t zi1 = (z1 > 0) ? z1 : 1, zi2 = (z2 < (int64_t) zsizeW) ? z2 : z2 - 1;
+            int64_t yi1 = (y1 > 0) ? y1 : 1, yi2 = (y2 < (int64_t) ysizeW) ? y2 : y2 - 1;
+            int64_t xi1 = (x1 > 0) ? x1 : 1, xi2 = (x2 < (int64_t) xsizeW) ? x2 : x2 - 1;
+            update(baseR, zstrideR, ystrideR, baseW, zstrideW, ystrideW,
+                   zi1, zi2, yi1, yi2, xi1, xi2);
+
+            // complete halo exchange, then update remaining cells
+            laik_switchto_wait(dRead);
+            if (zi1 >= zi2) zi1 = zi2 = z2;
+            update(baseR, zstrideR, ystrideR, baseW, zstrideW, ystrideW,
+                   z1, zi1, y1, y2, x1, x2);
+            update(baseR, zstrideR, ystrideR, baseW, zstrideW, ystrideW,
+                   zi2, z2, y1, y2, x1, x2);
+            if (yi1 >= yi2) yi1 = yi2 = y2;
+            update(baseR, zstrideR, ystrideR, baseW, zstrideW, ystrideW,
+                   zi1, zi2, y1, yi1, x1, x2);
+            update(baseR, zstrideR, ystrideR, baseW, zstrideW, ystrideW,
+                   zi1, zi2, yi2, y2, x1, x2);
+            if (xi1 >= xi2) xi1 = xi2 = x2;
+            update(baseR, zstrideR, ystrideR, baseW, zstrideW, ystrideW,
+                   zi1, zi2, yi1, yi2, x1, xi1);
+            update(baseR, zstrideR, ystrideR, baseW, zstrideW, ystrideW,
+                   zi1, zi2, yi1, yi2, xi2, x2);
+        }
         else {
             double vNew, vSum, coeff;
             coeff = 1.0 / 6.0;
@@ -498,11 +634,15 @@ int main(int argc, char* argv[])
                 laik_free_transition(toHaloTransition);
                 laik_free_transition(toExclTransition);
 
-                toHaloTransition = laik_calc_transition(space, newpWrite, newpRead,
-                                                        LAIK_DF_Preserve, LAIK_RO_None);
-                toExclTransition = laik_calc_transition(space, newpRead, newpWrite,
-                                                        LAIK_DF_None, LAIK_RO_None);
-                if (do_actions) {
+                calcTransitions(space, newpWrite, newpRead,
+                                &toHaloTransition, &toExclTransition);
+                if (do_multi) {
+                    data1_toHaloActions = calcMultiActions(data1, toHaloTransition, newr1,
+                                                           data2, toExclTransition, newr2);
+                    data2_toHaloActions = calcMultiActions(data2, toHaloTransition, newr2,
+                                                           data1, toExclTransition, newr1);
+                }
+                else if (do_actions) {
                     data1_toHaloActions = laik_calc_actions(data1, toHaloTransition, newr1, newr1);
                     data1_toExclActions = laik_calc_actions(data1, toExclTransition, newr1, newr1);
                     data2_toHaloActions = laik_calc_actions(data2, toHaloTransition, newr2, newr2);
@@ -115,7 +115,8 @@ void run_markovPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
 
 
 // Iteratively calculate probability distribution, return last written data.
-// This version expects one (sparse) mapping of data1/data2 each
+// This version expects one (sparse) mapping of data1/data2 each, with
+// states of pRead possibly in multiple slices (e.g. graph partitioning)
 Laik_Data* runSparse(MGraph* mg, int miter,
                      Laik_Data* data1, Laik_Data* data2,
                      Laik_Partitioning* pWrite, Laik_Partitioning* pRead)
@@ -130,7 +131,7 @@ Laik_Data* runSparse(MGraph* mg, int miter,
     Laik_Data *dRead = data1, *dWrite = data2;
     double *src, *dst;
     uint64_t srcCount, dstCount;
-    int64_t srcFrom, srcTo, dstFrom;
+    int64_t srcFrom, dstFrom, from, to;
 
     int iter = 0;
     while(1) {
@@ -139,9 +140,7 @@ Laik_Data* runSparse(MGraph* mg, int miter,
         // switch dRead to pRead, dWrite to pWrite
         laik_switchto_partitioning(dRead,  pRead, LAIK_DF_Preserve, LAIK_RO_Sum);
         laik_get_map_1d(dRead, 0, (void**) &src, &srcCount);
-        laik_my_slice_1d(pRead, 0, &srcFrom, &srcTo);
-        assert(srcFrom <= srcTo);
-        assert(srcCount == (uint64_t) (srcTo - srcFrom));
+        srcFrom = (srcCount > 0) ? laik_local2global_1d(dRead, 0) : 0;
 
         laik_switchto_partitioning(dWrite, pWrite, LAIK_DF_Init, LAIK_RO_Sum);
         laik_get_map_1d(dWrite, 0, (void**) &dst, &dstCount);
@@ -150,13 +149,15 @@ Laik_Data* runSparse(MGraph* mg, int miter,
         if (doPrint) {
             laik_log_begin(2);
             laik_log_append("Src values before iter %d:\n", iter);
-            for(int i = srcFrom; i < srcTo; i++)
-                laik_log_append("  %d: %f", i, src[i - srcFrom]);
+            for(int sNo = 0; laik_my_slice_1d(pRead, sNo, &from, &to); sNo++)
+                for(int i = from; i < to; i++)
+                    laik_log_append("  %d: %f", i, src[i - srcFrom]);
             laik_log_flush("\n");
         }
 
         // spread values according to probability distribution
-        for(int i = srcFrom; i < srcTo; i++) {
+        for(int sNo = 0; laik_my_slice_1d(pRead, sNo, &from, &to); sNo++)
+        for(int i = from; i < to; i++) {
             int off = i * (out + 1);
             for(int j = 0; j <= out; j++) {
                 if (doPrint)
@@ -173,8 +174,9 @@ Laik_Data* runSparse(MGraph* mg, int miter,
         if (doPrint) {
             laik_log_begin(2);
             laik_log_append("Src values after after %d:\n", iter);
-            for(int64_t i = srcFrom; i < srcTo; i++)
-                laik_log_append("  %d: %f", i, dst[i - dstFrom]);
+            for(int sNo = 0; laik_my_slice_1d(pRead, sNo, &from, &to); sNo++)
+                for(int64_t i = from; i < to; i++)
+                    laik_log_append("  %d: %f", i, dst[i - dstFrom]);
             laik_log_flush("\n");
         }
 
@@ -267,6 +269,7 @@ int main(int argc, char* argv[])
     int useSingleIndex = 0;
     int fineGrained = 0;
     int doProfiling = 0;
+    int useGraph = 0;
     doPrint = 0;
 
     int arg = 1;
@@ -278,6 +281,7 @@ int main(int argc, char* argv[])
         case 'f': fineGrained = 1; break;
         case 'v': doPrint = 1; break;
         case 'p': doProfiling = 1; break;
+        case 'g': useGraph = 1; break;
         case 'h':
         default:
             printf("markov [options] [<states> [<fan-out> [<iterations> [<istate>]]]]\n"
@@ -294,6 +298,7 @@ int main(int argc, char* argv[])
                    " -f: use pseudo-random connectivity (much more slices)\n"
                    " -v: be verbose using laik_log(), level 2\n"
                    " -p: write profiling measurements to 'markov2_profiling.txt'\n"
+                   " -g: use graph partitioner for distributing states\n"
                    " -h: this help text\n", n, out);
             exit(1);
         }
@@ -308,6 +313,12 @@ int main(int argc, char* argv[])
     if (out == 0) out = 10;
     if (doCompact) doIndirection = 1;
     if (onestate >= n) onestate = -1;
+    if (useGraph && doIndirection) {
+        if (laik_myid(world) == 0)
+            printf("Graph partitioner (-g) not supported with -i/-c\n");
+        laik_finalize(inst);
+        exit(1);
+    }
 
     if (n < 6) {
         if (laik_myid(world) == 0)
@@ -323,8 +334,9 @@ int main(int argc, char* argv[])
 
     if (laik_myid(world) == 0) {
         printf("Init Markov chain with %d states, max fan-out %d.\n", n, out);
-        printf("Running %d iterations.%s%s%s\n", miter,
+        printf("Running %d iterations.%s%s%s%s\n", miter,
                useSingleIndex ? " Partitioner using single indexes.":"",
+               useGraph ? " Using graph partitioner.":"",
                doCompact ? " Using compact mapping.":"",
                doIndirection ? " Using indirection.":"");
         if (onestate >= 0)
@@ -359,12 +371,25 @@ int main(int argc, char* argv[])
     // exchanged after every iteration
     Laik_Partitioning *pRead, *pWrite, *pMaster;
     Laik_Partitioner* pr;
-    pRead = laik_new_partitioning(laik_new_block_partitioner1(),
-                                  world, space, 0);
-    pr = laik_new_partitioner("markov-out", run_markovPartitioner, &mg,
-                              LAIK_PF_Merge |
-                              (useSingleIndex ? LAIK_PF_SingleIndex : 0) |
-                              (doCompact ? LAIK_PF_Compact : 0));
+    int* xadj = 0;
+    if (useGraph) {
+        // incoming states of state i (including i) are stored in
+        // mg.cm[i*(out+1) .. (i+1)*(out+1)-1], which is a CSR adjacency
+        xadj = malloc((n + 1) * sizeof(int));
+        for(int i = 0; i <= n; i++)
+            xadj[i] = i * (out + 1);
+        pRead = laik_new_partitioning(laik_new_graph_partitioner(n, xadj, mg.cm, 0),
+                                      world, space, 0);
+        pr = laik_new_graph_halo_partitioner(n, xadj, mg.cm);
+    }
+    else {
+        pRead = laik_new_partitioning(laik_new_block_partitioner1(),
+                                      world, space, 0);
+        pr = laik_new_partitioner("markov-out", run_markovPartitioner, &mg,
+                                  LAIK_PF_Merge |
+                                  (useSingleIndex ? LAIK_PF_SingleIndex : 0) |
+                                  (doCompact ? LAIK_PF_Compact : 0));
+    }
     pWrite = laik_new_partitioning(pr, world, space, pRead);
     pMaster = laik_new_partitioning(laik_Master, world, space, 0);
 
@@ -411,7 +436,7 @@ int main(int argc, char* argv[])
         // set state <phase> to probability 1
         if (laik_global2local_1d(data1, onestate, &off)) {
             // if global index 0 is local, it must be at local index 0
-            assert(off == (uint64_t) onestate);
+            assert(useGraph || (off == (uint64_t) onestate));
             v[off] = 1.0;
         }
     }
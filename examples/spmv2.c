@@ -88,6 +88,15 @@ double getEW(Laik_Index* i, const void* d)
     return (double) (m->row[ii + 1] - m->row[ii]);
 }
 
+// same as getEW, but for a range of rows at once
+void getEWs(int64_t from, int64_t to, double* w, const void* d)
+{
+    SpM* m = (SpM*) d;
+
+    for(int64_t ii = from; ii < to; ii++)
+        w[ii - from] = (double) (m->row[ii + 1] - m->row[ii]);
+}
+
 
 //----------------------------------------------------------------------
 // main
@@ -199,8 +208,9 @@ int main(int argc, char* argv[])
     laik_switchto_new_partitioning(sumD, world, laik_All, LAIK_DF_None, LAIK_RO_None);
 
     // block partitioning according to number of non-zero elems in matrix rows
-    Laik_Partitioner* pr = laik_new_block_partitioner(0, 1, getEW, 0, m);
-    laik_set_index_weight(pr, getEW, m);
+    // (weights requested in bulk, cached for repartitioning with less tasks)
+    Laik_Partitioner* pr = laik_new_block_partitioner1();
+    laik_set_index_weights(pr, getEWs, m);
     Laik_Partitioning* p = laik_new_partitioning(pr, world, s, 0);
     // nothing to preserve between iterations (assume at least one iter)
     laik_switchto_partitioning(resD, p, LAIK_DF_None, LAIK_RO_None);
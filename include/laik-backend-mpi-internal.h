@@ -12,7 +12,11 @@
 static void laik_mpi_finalize(Laik_Instance*);
 static void laik_mpi_prepare(Laik_ActionSeq*);
 static void laik_mpi_cleanup(Laik_ActionSeq*);
+static void laik_mpi_rebase(Laik_ActionSeq*, char**);
 static void laik_mpi_exec(Laik_ActionSeq* as);
+static void laik_mpi_exec_start(Laik_ActionSeq* as);
+static bool laik_mpi_exec_test(Laik_ActionSeq* as);
+static void laik_mpi_exec_wait(Laik_ActionSeq* as);
 static void laik_mpi_updateGroup(Laik_Group*);
 static bool laik_mpi_log_action(Laik_Action* a);
 static void laik_mpi_sync(Laik_KVStore* kvs);
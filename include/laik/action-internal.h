@@ -50,6 +50,9 @@ struct _Laik_Action {
 // for iterating action sequences
 #define nextAction(a) ((Laik_Action*) (((char*)a) + a->len))
 
+// transition context of an action in sequence <as>
+#define actionContext(as,a) ((Laik_TransitionContext*) (as)->context[(a)->tid])
+
 
 // helper struct for CopyFromBuf / CopyToBuf actions
 typedef struct _Laik_CopyEntry {
@@ -61,6 +64,9 @@ typedef struct _Laik_CopyEntry {
 // backend-independent action structs:
 // only requried if further parameters need to be stored, ie. not for
 //   Nop, Halt, TExec, ...
+// Each action type has its own struct with only the parameters it needs,
+// to keep sequences small. For a given action type, the struct to use is
+// given in the comment before the struct definition.
 
 // action structs are packed
 #pragma pack(push,1)
@@ -93,6 +99,15 @@ typedef struct {
     char* buf;
 } Laik_A_BufSend;
 
+// MapSend action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    int to_rank;
+    int fromMapNo;
+    unsigned int offset;
+} Laik_A_MapSend;
+
 // MapPackAndSend action
 typedef struct {
     Laik_Action h;
@@ -102,6 +117,15 @@ typedef struct {
     unsigned int count;
 } Laik_A_MapPackAndSend;
 
+// PackAndSend action
+typedef struct {
+    Laik_Action h;
+    int to_rank;
+    Laik_Mapping* map;
+    Laik_Slice* slc;
+    unsigned int count;
+} Laik_A_PackAndSend;
+
 
 // receive actions
 
@@ -122,6 +146,15 @@ typedef struct {
     char* buf;
 } Laik_A_BufRecv;
 
+// MapRecv action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    int from_rank;
+    int toMapNo;
+    unsigned int offset;
+} Laik_A_MapRecv;
+
 // MapRecvAndUnpack action
 typedef struct {
     Laik_Action h;
@@ -131,34 +164,221 @@ typedef struct {
     unsigned int count;
 } Laik_A_MapRecvAndUnpack;
 
+// RecvAndUnpack action
+typedef struct {
+    Laik_Action h;
+    int from_rank;
+    Laik_Mapping* map;
+    Laik_Slice* slc;
+    unsigned int count;
+} Laik_A_RecvAndUnpack;
+
+
+// pack/unpack actions
 
-// TODO: split off into different action types with minimal space requirements
-typedef struct _Laik_BackendAction {
-    // header
+// PackToBuf action
+typedef struct {
     Laik_Action h;
+    unsigned int count;
+    Laik_Mapping* map;
+    Laik_Slice* slc;
+    char* toBuf;
+} Laik_A_PackToBuf;
 
-    unsigned int count;  // for Send, Recv, Copy, Reduce
-    unsigned int offset; // for MapSend, MapRecv, RBufSend, RBufRecv
-    int bufID;           // for BufReserve, RBufSend, RBufRecv
-    Laik_Type* dtype;    // for RBufReduce, BufInit
+// PackToRBuf action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_Mapping* map;
+    Laik_Slice* slc;
+    int bufID;
+    unsigned int offset;
+} Laik_A_PackToRBuf;
 
-    Laik_Mapping* map; // for Pack, Unpack, PackAndSend, RecvAndUnpack
-    int fromMapNo;     // for MapSend, MapGroupReduce
-    int toMapNo;       // for MapRecv, MapGroupReduce
+// MapPackToBuf action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    int fromMapNo;
+    Laik_Slice* slc;
+    char* toBuf;
+} Laik_A_MapPackToBuf;
 
-    char* fromBuf;     // for SendBuf, Pack, Copy, Reduce
-    char* toBuf;       // for RecvBuf, Unpack, Copy, Reduce
-    int rank;          // for Send, Recv, PackAndSend, RecvAndUnpack, Reduce
-    Laik_CopyEntry* ce; // for CopyFromBuf, CopyToBuf
+// MapPackToRBuf action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    int fromMapNo;
+    Laik_Slice* slc;
+    int bufID;
+    unsigned int offset;
+} Laik_A_MapPackToRBuf;
 
-    // points to slice given in operation of transition
-    Laik_Slice* slc;   // for Pack, Unpack, PackAndSend, RecvAndUnpack
+// UnpackFromBuf action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_Mapping* map;
+    Laik_Slice* slc;
+    char* fromBuf;
+} Laik_A_UnpackFromBuf;
 
-    // subgroup IDs defined in transition
-    int inputGroup, outputGroup;   // for GroupReduce
-    Laik_ReductionOperation redOp; // for GroupReduce, Reduce
+// UnpackFromRBuf action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_Mapping* map;
+    Laik_Slice* slc;
+    int bufID;
+    unsigned int offset;
+} Laik_A_UnpackFromRBuf;
 
-} Laik_BackendAction;
+// MapUnpackFromBuf action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    int toMapNo;
+    Laik_Slice* slc;
+    char* fromBuf;
+} Laik_A_MapUnpackFromBuf;
+
+// MapUnpackFromRBuf action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    int toMapNo;
+    Laik_Slice* slc;
+    int bufID;
+    unsigned int offset;
+} Laik_A_MapUnpackFromRBuf;
+
+
+// copy actions
+
+// CopyToBuf action: <count> ranges in <ce> gathered into <toBuf>
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_CopyEntry* ce;
+    char* toBuf;
+} Laik_A_CopyToBuf;
+
+// CopyFromBuf action: <count> ranges in <ce> scattered from <fromBuf>
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_CopyEntry* ce;
+    char* fromBuf;
+} Laik_A_CopyFromBuf;
+
+// CopyToRBuf action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_CopyEntry* ce;
+    int bufID;
+    unsigned int offset;
+} Laik_A_CopyToRBuf;
+
+// CopyFromRBuf action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_CopyEntry* ce;
+    int bufID;
+    unsigned int offset;
+} Laik_A_CopyFromRBuf;
+
+// BufCopy action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    char* fromBuf;
+    char* toBuf;
+} Laik_A_BufCopy;
+
+// RBufCopy action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    int bufID;
+    unsigned int offset;
+    char* toBuf;
+} Laik_A_RBufCopy;
+
+
+// reduction actions
+
+// BufInit action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_ReductionOperation redOp;
+    Laik_Type* dtype;
+    char* toBuf;
+} Laik_A_BufInit;
+
+// RBufLocalReduce action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_ReductionOperation redOp;
+    Laik_Type* dtype;
+    int bufID;
+    unsigned int offset;
+    char* toBuf;
+} Laik_A_RBufLocalReduce;
+
+// Reduce action (rootTask -1: all tasks get result)
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_ReductionOperation redOp;
+    int rootTask;
+    char* fromBuf;
+    char* toBuf;
+} Laik_A_Reduce;
+
+// RBufReduce action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_ReductionOperation redOp;
+    int rootTask;
+    int bufID;
+    unsigned int offset;
+} Laik_A_RBufReduce;
+
+// MapGroupReduce action
+// subgroup IDs defined in transition
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_ReductionOperation redOp;
+    int inputGroup, outputGroup;
+    int fromMapNo, toMapNo;
+    Laik_Slice* slc;
+} Laik_A_MapGroupReduce;
+
+// GroupReduce action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_ReductionOperation redOp;
+    int inputGroup, outputGroup;
+    char* fromBuf;
+    char* toBuf;
+} Laik_A_GroupReduce;
+
+// RBufGroupReduce action
+typedef struct {
+    Laik_Action h;
+    unsigned int count;
+    Laik_ReductionOperation redOp;
+    int inputGroup, outputGroup;
+    int bufID;
+    unsigned int offset;
+} Laik_A_RBufGroupReduce;
 
 #pragma pack(pop)
 
@@ -209,23 +429,41 @@ struct _Laik_ActionSeq {
     // if non-null, only this backend can execute the sequence, and
     // the backend gets called for clean-up when the sequence is destroyed
     Laik_Backend* backend;
+    // can be set by backend, to be freed in its clean-up
+    void* backend_data;
 
-    // actions can refer to different transition contexts
-#define ASEQ_CONTEXTS_MAX 1
+    // prepared for repeated executions (cached or kept by LAIK user):
+    // backends may spend more effort on optimizing the sequence
+    bool reused;
+
+    // actions can refer to different transition contexts.
+    // all transitions in a sequence must be within the same process group
+#define ASEQ_CONTEXTS_MAX 32
     void* context[ASEQ_CONTEXTS_MAX];
     int contextCount;
-
-    // each call to laik_aseq_allocBuffer() allocates another buffer
-#define ASEQ_BUFFER_MAX 5
-    char* buf[ASEQ_BUFFER_MAX];
-    size_t bufSize[ASEQ_BUFFER_MAX];
-    int bufferCount;
+    // context ID given to actions appended by the laik_aseq_add* helpers
+    // (set by transformations to the ID of the action being replaced)
+    int currentTID;
+
+    // created by laik_aseq_load: transitions and mappings of contexts
+    // are owned by the sequence and freed with it
+    bool loaded;
+
+    // each call to laik_aseq_allocBuffer() allocates another buffer,
+    // taken from the buffer pool of the instance. Buffer IDs from
+    // ASEQ_RBUF_FIRSTID on are used for not-yet allocated reservations.
+    // After preparation, buffers are given back to the pool and borrowed
+    // again for each execution; <buf> keeps the addresses actions refer to
+#define ASEQ_RBUF_FIRSTID 100000
+    char** buf;
+    size_t* bufSize;
+    int bufferCount, bufferCapacity;
     unsigned int bufReserveCount; // current number of BufReserve actions
+    bool bufReturned; // buffers given back to the pool
 
     // for copy actions
-#define ASEQ_COPYENTRY_MAX 5
-    Laik_CopyEntry* ce[ASEQ_COPYENTRY_MAX];
-    int ceCount;
+    Laik_CopyEntry** ce;
+    int ceCount, ceCapacity;
     int ceRanges;
 
     // action sequence to trigger on execution
@@ -235,12 +473,26 @@ struct _Laik_ActionSeq {
     // how many rounds
     int roundCount;
 
+    // runs of local data movement actions to execute with the thread pool
+    // (see laik_aseq_prepareLocalMoves): number of actions in the run
+    // starting at each action (0 if none), and space for the pieces of the
+    // largest run
+    unsigned int* localRun;
+    void* localPiece;
+    int localPieceCount;
+
+    // state for split-phase execution (see laik_exec_actions_start):
+    // backends remember the next action to execute between calls
+    bool execPending;        // started, but not yet completed
+    unsigned int execPos;    // index of next action to execute
+    Laik_Action* execAction; // next action to execute
+
     // temporary action sequence storage used during generation by
     // laik_aseq_addAction(). Call laik_aseq_finish to make it active
     // (ie. set <action> array to this temporary seq)
     unsigned int newActionCount;
     size_t newBytesUsed, newBytesAlloc;
-    Laik_BackendAction* newAction;
+    Laik_Action* newAction;
     int newRoundCount;
 
     // aggreated actions of one execution, for updating statistics
@@ -253,6 +505,34 @@ struct _Laik_ActionSeq {
 };
 
 
+// Pool for temporary buffers of action sequences, one per LAIK instance.
+// Sequences borrow their buffers only for the time of an execution (see
+// laik_aseq_borrowBuffers), thus memory in use is bounded by the peak
+// demand of concurrently executing sequences. Buffers are handed out in
+// size classes of 4 steps per power of two, wasting less than 20%. A buffer
+// given back is kept in the free list of its class for reuse, as long as
+// cached buffers do not exceed a byte limit (LAIK_BUFPOOL_MAX, in MB).
+#define BUFPOOL_MINCLASS 12  // smallest buffer: 4 KB
+#define BUFPOOL_CLASSES  160
+#define BUFPOOL_MAXCACHED 64 // default limit for cached buffers in MB
+struct _Laik_BufPool {
+    bool enabled; // if false, buffers are directly malloc'ed/freed
+    void* freeList[BUFPOOL_CLASSES]; // next pointer stored in buffer
+    uint64_t usedBytes, cachedBytes, peakBytes;
+    uint64_t maxCachedBytes;
+    unsigned int hits, misses, trimmed;
+};
+
+// create pool for instance (LAIK_BUFPOOL=0 disables pooling)
+Laik_BufPool* laik_bufpool_new(void);
+// get a buffer of at least <size> bytes from the pool of instance <inst>
+char* laik_bufpool_get(Laik_Instance* inst, size_t size);
+// give back a buffer got via laik_bufpool_get with same <size>
+void laik_bufpool_put(Laik_Instance* inst, char* buf, size_t size);
+// free all cached buffers, called by laik_finalize
+void laik_bufpool_release(Laik_Instance* inst);
+
+
 
 // helpers for building new action sequences. New actions are first
 // stored in temporary space, and only becoming active when calling
@@ -276,8 +556,9 @@ void laik_aseq_activateNewActions(Laik_ActionSeq* as);
 // free temporary space used for building a new sequence
 void laik_aseq_freeTempSpace(Laik_ActionSeq* as);
 
-// append an invalid backend action
-Laik_BackendAction* laik_aseq_addBAction(Laik_ActionSeq* as, int round);
+// reset a prepared sequence to one TExec action per context, releasing
+// buffers, to prepare it again (backend resources must be released before)
+void laik_aseq_reset(Laik_ActionSeq* as);
 
 
 // returns the transaction ID
@@ -460,9 +741,19 @@ void laik_aseq_addSends(Laik_ActionSeq* as, int round,
                         Laik_Data* data, Laik_Transition* t);
 
 // collect buffer reservation actions and update actions referencing them
-// works in-place, only call once
+// works in-place, each call allocates a new buffer from the instance pool
 bool laik_aseq_allocBuffer(Laik_ActionSeq* as);
 
+// give buffers of <as> back to the pool, after preparation or execution
+void laik_aseq_returnBuffers(Laik_ActionSeq* as);
+// borrow buffers of <as> from the pool again for an execution. If a buffer
+// gets another address, pointers into it are updated in all actions, and
+// the backend is asked to update its own actions and resources
+void laik_aseq_borrowBuffers(Laik_ActionSeq* as);
+// address of <p> after moving buffers of <as> to <newBuf> (as done by
+// laik_aseq_borrowBuffers). Pointers not into a buffer are kept
+char* laik_aseq_rebasePtr(Laik_ActionSeq* as, char** newBuf, char* p);
+
 
 //
 // generic transformation passes for action sequences
@@ -488,8 +779,15 @@ bool laik_aseq_sort_rounds(Laik_ActionSeq* as);
 // transform MapPackAndSend/MapRecvAndUnpack into simple Send/Recv actions
 bool laik_aseq_flattenPacking(Laik_ActionSeq* as);
 
+// how laik_aseq_splitReduce splits group reduce actions
+typedef enum _Laik_ReduceSplit {
+    LAIK_RS_Auto = 0, // choose by input/output group sizes
+    LAIK_RS_2Rounds,  // inputs sent to all output tasks, reduced there
+    LAIK_RS_3Rounds   // reduce at one task, result sent to output tasks
+} Laik_ReduceSplit;
+
 // transformation for split reduce actions into basic multiple actions
-bool laik_aseq_splitReduce(Laik_ActionSeq* as);
+bool laik_aseq_splitReduce(Laik_ActionSeq* as, Laik_ReduceSplit mode);
 
 // replace group reduction actions with all-reduction actions if possible
 bool laik_aseq_replaceWithAllReduce(Laik_ActionSeq* as);
@@ -497,16 +795,74 @@ bool laik_aseq_replaceWithAllReduce(Laik_ActionSeq* as);
 // replace transition exec actions with equivalent reduce/send/recv actions
 bool laik_aseq_splitTransitionExecs(Laik_ActionSeq* as);
 
+// communication of the tasks on own node, as needed for forwarding
+// messages via node leaders. Leaders know the element counts of all
+// tasks on their node, other tasks only their own
+typedef struct _Laik_NodeComm {
+    int size;      // size of group
+    int* leader;   // for each task: leader of its node (lowest task ID)
+    int* index;    // for each task: row in <sent>/<received>, or -1
+    int rows;      // number of tasks with known element counts
+
+    // per context: communicating task pairs from own node to the node
+    // with leader L (at [L]), and from that node to own node
+    int* pairsTo[ASEQ_CONTEXTS_MAX];
+    int* pairsFrom[ASEQ_CONTEXTS_MAX];
+    // per context: elements sent from task A to B (at [index[A] * size + B])
+    // and received by task B from A (at [index[B] * size + A])
+    unsigned int* sent[ASEQ_CONTEXTS_MAX];
+    unsigned int* received[ASEQ_CONTEXTS_MAX];
+} Laik_NodeComm;
+
+// forward messages among tasks on different nodes via node leaders,
+// aggregating all messages from one node to another into one.
+// <nc> must describe the communication of this task (and of all tasks on
+// own node for leaders), with node pair counts matching on all nodes.
+// To be called directly after laik_aseq_splitTransitionExecs
+bool laik_aseq_aggregateByNode(Laik_ActionSeq* as, const Laik_NodeComm* nc);
+
 // calculate stats of one run of the action sequence
 int laik_aseq_calc_stats(Laik_ActionSeq* as);
 
+// does <as> need execution by the backend? True if there is communication
+// in its transitions or backend transformations added messages for the
+// calling task (e.g. to forward messages of other tasks).
+// Statistics must have been calculated
+bool laik_aseq_needsExec(Laik_ActionSeq* as);
+
+// does action <a> need to wait for data from other processes?
+bool laik_action_waitsForRemote(Laik_Action* a);
+
+// is <a> a backend-independent send / receive action?
+bool laik_action_isSend(Laik_Action* a);
+bool laik_action_isRecv(Laik_Action* a);
+
+// size of struct for backend-independent action type (0 if unknown)
+unsigned int laik_action_size(int type);
+// element count of a backend-independent action (0 if none)
+unsigned int laik_action_count(Laik_Action* a);
+
+// check consistency of all actions in a sequence, panics on error.
+// only active in debug builds (without NDEBUG), no-op otherwise
+void laik_aseq_validate(Laik_ActionSeq* as);
+
 
 // Exec implementations for actions not specific to a backend
 
-// exec action LAIK_AT_PackToBuf
-void laik_exec_pack(Laik_BackendAction* a, Laik_Mapping* map);
-// exec action LAIK_AT_UnpackFromBuf
-void laik_exec_unpack(Laik_BackendAction* a, Laik_Mapping* map);
+// exec action LAIK_AT_(Map)PackToBuf with given mapping
+void laik_exec_pack(Laik_Mapping* map, Laik_Slice* slc,
+                    char* toBuf, unsigned int count);
+// exec action LAIK_AT_(Map)UnpackFromBuf with given mapping
+void laik_exec_unpack(Laik_Mapping* map, Laik_Slice* slc,
+                      char* fromBuf, unsigned int count);
+// determine runs of independent pack/unpack/copy actions for execution
+// with the thread pool of the instance. Called at the end of preparation
+void laik_aseq_prepareLocalMoves(Laik_ActionSeq* as);
+// exec run of independent pack/unpack/copy actions starting at <a> (at
+// position <pos> in the sequence) with the thread pool of the instance.
+// Returns number of actions executed, 0 if the caller has to execute <a>
+unsigned int laik_aseq_execLocalMoves(Laik_ActionSeq* as, Laik_Action* a,
+                                      unsigned int pos);
 
 
 #endif // LAIK_ACTION_INTERNAL_H
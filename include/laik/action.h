@@ -18,6 +18,7 @@
 #ifndef LAIK_ACTIONS_H
 #define LAIK_ACTIONS_H
 
+#include <stdbool.h> // for bool
 #include <stdint.h>  // for uint64_t
 
 #include "core.h" // for Laik_Instance
@@ -136,5 +137,16 @@ void laik_aseq_free(Laik_ActionSeq* as);
 // get sum of sizes of all allocated temporary buffers
 int laik_aseq_bufsize(Laik_ActionSeq* as);
 
+// save the transitions of an action sequence together with slices of
+// mappings into a file, to be loaded again for replay
+bool laik_aseq_save(Laik_ActionSeq* as, const char* fname);
+// load a sequence saved with laik_aseq_save, using new containers with
+// dummy data. Requires same number of processes and same rank as saving
+Laik_ActionSeq* laik_aseq_load(Laik_Instance* inst, const char* fname);
+// let the backend prepare a loaded sequence for execution
+void laik_aseq_prepare(Laik_ActionSeq* as);
+// execute a loaded sequence
+void laik_aseq_replay(Laik_ActionSeq* as);
+
 
 #endif // LAIK_ACTIONS_H
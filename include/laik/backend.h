@@ -54,9 +54,23 @@ struct _Laik_Backend {
     // free resources allocated for an action sequence
     void (*cleanup)(Laik_ActionSeq *);
 
+    // buffers of a prepared sequence are moved to <newBuf> before an
+    // execution (see laik_aseq_borrowBuffers): update addresses in
+    // backend-specific actions and resources bound to buffers. Optional
+    void (*rebase)(Laik_ActionSeq *, char **newBuf);
+
     // execute a action sequence
     void (*exec)(Laik_ActionSeq *);
 
+    // split-phase execution of an action sequence (optional, all or none).
+    // exec_start triggers all actions not needing to wait for remote data,
+    // exec_test makes progress without blocking and returns true if
+    // execution is finished, exec_wait blocks until finished.
+    // If not provided, LAIK uses <exec> at start of split-phase execution
+    void (*exec_start)(Laik_ActionSeq *);
+    bool (*exec_test)(Laik_ActionSeq *);
+    void (*exec_wait)(Laik_ActionSeq *);
+
     // update backend specific data for group if needed
     void (*updateGroup)(Laik_Group *);
 
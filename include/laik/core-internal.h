@@ -26,6 +26,24 @@
 // dynamically generated revision/opt flags information, in info.c
 void laik_log_append_info(void);
 
+// pool for temporary buffers of action sequences, see action-internal.h
+typedef struct _Laik_BufPool Laik_BufPool;
+
+// thread pool for local data movement (pack/unpack/copy) and transition
+// calculation, see threadpool.c
+typedef struct _Laik_ThreadPool Laik_ThreadPool;
+
+// create pool using <threads> threads (including the calling thread).
+// returns 0 for less than 2 threads
+Laik_ThreadPool* laik_threadpool_new(int threads);
+// stop worker threads and free pool
+void laik_threadpool_free(Laik_ThreadPool* p);
+// number of threads used by pool <p> (1 if no pool)
+int laik_threadpool_size(Laik_ThreadPool* p);
+// call <func>(<ctx>, i) for all i in [0;<items>[ using all threads of <p>
+void laik_threadpool_run(Laik_ThreadPool* p, int items,
+                         void (*func)(void* ctx, int item), void* ctx);
+
 struct _Laik_Task {
     int rank;
 };
@@ -85,6 +103,17 @@ struct _Laik_Instance {
     // External Control Related
     Laik_RepartitionControl* repart_ctrl;
 
+    // pool for temporary buffers of action sequences
+    Laik_BufPool* bufPool;
+
+    // threads for local data movement and transition calculation
+    // (LAIK_THREADS), 0 if single-threaded
+    Laik_ThreadPool* threadPool;
+
+    // hash table of frozen slice arrays shared among partitionings
+    Laik_SliceArray** saTable;
+    unsigned int saTableSize, saTableCount;
+
     // LAIK backend error handler. Gives backends the chance to pass errors back to the user instead of aborting the
     // application
     Laik_Backend_Error_Handler* errorHandler;
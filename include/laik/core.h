@@ -49,6 +49,15 @@ void laik_finalize(Laik_Instance* inst);
 //! return a backend-dependant string for the location of the calling task
 char* laik_mylocation(Laik_Instance*);
 
+//! set number of threads used for local data movement (pack/unpack/copy)
+// and calculation of multiple transitions (see laik_calc_transitions)
+// in this instance. Communication is still done by the calling thread.
+// Default is given by environment variable LAIK_THREADS (1 if not set)
+void laik_set_threads(Laik_Instance* inst, int threads);
+
+//! return number of threads used for local data movement
+int laik_get_threads(Laik_Instance* inst);
+
 //! create a group to be used in this LAIK instance
 Laik_Group* laik_create_group(Laik_Instance*, int maxsize);
 
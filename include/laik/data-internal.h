@@ -63,6 +63,9 @@ struct _Laik_SwitchStat
     uint64_t elemSendCount, elemRecvCount, elemReduceCount;
     uint64_t byteSendCount, byteRecvCount, byteReduceCount;
     uint64_t initOpCount, reduceOpCount, byteBufCopyCount;
+    // mapping allocations with LAIK_MP_UsePool: taken from pool (hits,
+    // not counted as malloc) or newly allocated (misses)
+    int poolHits, poolMisses;
 
 };
 
@@ -92,7 +95,50 @@ struct _Laik_Reservation {
     Laik_Mapping* mapping; // array of mappings for reservations
 };
 
+// number of entries in the per-container transition cache
+#define TRANSCACHE_SIZE 8
+
+// cache entry: remembers the transition for switching between
+// two partitionings with given flow/reduction operation, and an
+// action sequence prepared by the backend for given mappings.
+// A prepared sequence is only kept for stable mappings (from
+// reservations), as the backend may embed addresses into actions.
+// If one of the partitionings gets freed, the transition may be kept
+// as "retired" entry to calculate new transitions incrementally from.
+// A retired transition does not refer to partitionings or their group
+// any longer; the ID of the group is kept to match it with new ones
+typedef struct _Laik_TransCacheEntry {
+    Laik_Partitioning *fromP, *toP;
+    bool retired; // partitionings freed, only usable as update base
+    int gid; // ID of process group of transition
+    Laik_Partitioner *fromPr, *toPr; // partitioners used for fromP/toP
+    Laik_DataFlow flow;
+    Laik_ReductionOperation redOp;
+    Laik_Transition* t;
+
+    Laik_MappingList *fromList, *toList; // mappings <as> was prepared for
+    Laik_ActionSeq* as;
+
+    unsigned int lastUse; // for LRU replacement
+} Laik_TransCacheEntry;
+
 // a data container
+// Pool for memory of mappings of a container (policy LAIK_MP_UsePool).
+// Sizes are rounded up to size classes, with MAPPOOL_STEPS classes per
+// power of two (i.e. at most 25% waste). Memory of a freed mapping is kept
+// in the free list of its class and reused for later mappings of the same
+// class. This avoids allocation and first-touch of the whole container
+// on each repartitioning. The allocator gives an upper limit for cached
+// bytes; when exceeded, cached memory of largest classes is released.
+#define MAPPOOL_MINCLASS 6  // smallest class: 64 bytes
+#define MAPPOOL_STEPS    4
+#define MAPPOOL_CLASSES  (MAPPOOL_STEPS * (64 - MAPPOOL_MINCLASS))
+typedef struct _Laik_MapPool {
+    void* freeList[MAPPOOL_CLASSES]; // next pointer stored in memory
+    uint64_t cachedBytes;
+    Laik_Allocator* allocator; // allocator used for cached memory
+} Laik_MapPool;
+
 struct _Laik_Data {
     char* name;
     int id;
@@ -111,12 +157,23 @@ struct _Laik_Data {
     Laik_Reservation* activeReservation;
 
     Laik_Allocator* allocator;
+    Laik_MapPool* pool; // created on first use with LAIK_MP_UsePool
 
     // can be set by backend
     void* backend_data;
 
     // statistics
     Laik_SwitchStat* stat;
+
+    // action sequence of a switch started but not yet completed
+    // (split-phase), and whether it has to be freed on completion
+    Laik_ActionSeq* pendingASeq;
+    bool pendingASeqOwned;
+
+    // cache for switches done via laik_switchto_partitioning
+    int transCacheCount;
+    unsigned int transCacheUse;
+    Laik_TransCacheEntry transCache[TRANSCACHE_SIZE];
 };
 
 struct _Laik_Layout {
@@ -157,6 +214,8 @@ struct _Laik_Mapping {
     char* start; // start address of mapping
     char* base; // address matching requiredSlice.from (usually same as start)
     uint64_t capacity; // number of bytes allocated
+    bool fromPool; // memory from mapping pool of container, see Laik_MapPool
+    Laik_Allocator* allocator; // allocator used for memory (0: malloc)
     int reusedFor; // -1: not reused, otherwise map number used for
 
     Laik_Mapping* baseMapping; // mapping this one is embedded in
@@ -175,7 +234,16 @@ void laik_data_init(void);
 void laik_type_init(void);
 
 
+// drop cached transitions/action sequences referencing partitioning <p>
+// from all containers of instance <inst>. Called on changes to <p>
+void laik_data_transcache_invalidate(Laik_Instance* inst, Laik_Partitioning* p);
+
 // ensure that the mapping is backed by memory (called by backends)
 void laik_allocateMap(Laik_Mapping* m, Laik_SwitchStat *ss);
 
+// create a list of <n> mappings for <d> covering given slices, backed by
+// zeroed memory and not bound to a partitioning (for loaded sequences)
+Laik_MappingList* laik_mappinglist_new(Laik_Data* d, int n, Laik_Slice* slc);
+void laik_mappinglist_free(Laik_MappingList* ml);
+
 #endif // LAIK_DATA_INTERNAL_H
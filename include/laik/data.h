@@ -125,17 +125,69 @@ Laik_ActionSeq* laik_calc_actions(Laik_Data* d, Laik_Transition* t,
                                   Laik_Reservation* fromRes,
                                   Laik_Reservation* toRes);
 
-// execute a previously calculated transition on a data container
+// record steps for transitions on <n> different containers into one
+// action sequence, allowing the backend to combine messages across
+// containers. All transitions must be within the same process group.
+// <fromRes>/<toRes> may be 0, as well as single entries
+Laik_ActionSeq* laik_calc_actions_multi(int n, Laik_Data** d,
+                                        Laik_Transition** t,
+                                        Laik_Reservation** fromRes,
+                                        Laik_Reservation** toRes);
+
+// execute a previously calculated action sequence
+// (for one or multiple data containers)
 void laik_exec_actions(Laik_ActionSeq* as);
 
+// split-phase execution of an action sequence: start triggers all
+// communication not needing to wait for remote data, allowing to overlap
+// communication with computation. Until completion, only data not received
+// from other processes is valid, and the containers must not be switched.
+// laik_exec_actions_test returns true if completed (without blocking)
+void laik_exec_actions_start(Laik_ActionSeq* as);
+bool laik_exec_actions_test(Laik_ActionSeq* as);
+void laik_exec_actions_wait(Laik_ActionSeq* as);
+
 // switch to new partitioning (new flow is derived from previous flow)
 void laik_switchto_partitioning(Laik_Data* d,
                                 Laik_Partitioning* toP,
                                 Laik_DataFlow flow, Laik_ReductionOperation redOp);
 
+// split-phase variant of laik_switchto_partitioning, see
+// laik_exec_actions_start. Complete with laik_switchto_wait (or
+// laik_switchto_test returning true). These also complete a pending
+// action sequence started on <d> via laik_exec_actions_start
+void laik_switchto_partitioning_start(Laik_Data* d,
+                                      Laik_Partitioning* toP,
+                                      Laik_DataFlow flow, Laik_ReductionOperation redOp);
+bool laik_switchto_test(Laik_Data* d);
+void laik_switchto_wait(Laik_Data* d);
+
 // switch to use another data flow, keep access phase/partitioning
 void laik_switchto_flow(Laik_Data* d, Laik_DataFlow flow, Laik_ReductionOperation redOp);
 
+// predicted cost of switching a container to another partitioning
+// (from the view of this process, before backend optimizations)
+typedef struct _Laik_SwitchCost {
+    unsigned int msgSendCount, msgRecvCount, msgReduceCount;
+    uint64_t byteSendCount, byteRecvCount, byteReduceCount;
+    uint64_t byteCopyCount; // copied between own mappings (upper bound)
+    uint64_t byteInitCount; // initialized for reductions
+
+    // per peer (rank in process group of transition)
+    int peers;
+    unsigned int *peerMsgSend, *peerMsgRecv;
+    uint64_t *peerByteSend, *peerByteRecv;
+} Laik_SwitchCost;
+
+// predict cost of switching <d> to <toP> without executing the switch
+// (no communication, no allocation). Returns 0 if not involved.
+// The transition is kept in the transition cache for a following switch
+Laik_SwitchCost* laik_data_predict_switch(Laik_Data* d,
+                                          Laik_Partitioning* toP,
+                                          Laik_DataFlow flow,
+                                          Laik_ReductionOperation redOp);
+void laik_free_switchcost(Laik_SwitchCost* c);
+
 // get slice number <n> in own partition of data container <d>
 // returns 0 if partitioning is not set or slice number <n> is invalid
 Laik_TaskSlice* laik_data_slice(Laik_Data* d, int n);
@@ -278,6 +330,34 @@ typedef enum _Laik_MemoryPolicy {
     LAIK_MP_UsePool,        // no allocate if possible via spare pool resource
 } Laik_MemoryPolicy;
 
+// flags for built-in allocators (see laik_new_allocator_preset)
+typedef enum _Laik_AllocatorFlag {
+    LAIK_AF_None = 0,
+
+    // back large mappings by transparent huge pages (madvise)
+    LAIK_AF_HugePages = 1,
+
+    // use explicitly reserved huge pages of 2MB/1GB (MAP_HUGETLB), falling
+    // back to transparent huge pages if none are available. 1GB pages are
+    // only used for mappings of at least 1GB, smaller ones use 2MB pages
+    // (if also requested) or transparent huge pages
+    LAIK_AF_HugeTLB2M = 2,
+    LAIK_AF_HugeTLB1G = 4,
+
+    // interleave pages of large mappings over NUMA nodes of <numaNodes>
+    LAIK_AF_NumaInterleave = 8,
+
+    // bind pages of large mappings to NUMA nodes of <numaNodes>
+    // (if 0: to the node the allocating task runs on)
+    LAIK_AF_NumaBind = 16,
+
+    // after allocation, initialize memory of large mappings in parallel
+    // (first touch), via <touch> callback of the allocator if set, or by
+    // the LAIK threads used for local data movement (LAIK_THREADS)
+    LAIK_AF_FirstTouch = 32
+
+} Laik_AllocatorFlag;
+
 // allocator interface
 typedef struct _Laik_Allocator Laik_Allocator;
 struct _Laik_Allocator {
@@ -294,10 +374,30 @@ struct _Laik_Allocator {
     // transfered by the communication backend and should be made consistent
     // (used with LAIK_MP_NotifyOnChange)
     void (*unmap)(Laik_Data* d, void* ptr, size_t length);
+
+    // with LAIK_MP_UsePool: maximum number of bytes of freed mapping memory
+    // kept per container for reuse (0: no limit)
+    uint64_t poolMaxBytes;
+
+    // for built-in allocators: Laik_AllocatorFlag values, NUMA node mask
+    int flags;
+    uint64_t numaNodes;
+
+    // with LAIK_AF_FirstTouch: called to initialize new memory from the
+    // threads which will work on it (e.g. an OpenMP parallel loop)
+    void (*touch)(Laik_Data* d, void* ptr, size_t size);
 };
 
 // returns an allocator with default policy LAIK_MP_NewAllocOnRepartition
 Laik_Allocator* laik_new_allocator(void);
+// returns an allocator with policy LAIK_MP_UsePool, keeping at most
+// <maxBytes> of freed mapping memory per container for reuse (0: no limit)
+Laik_Allocator* laik_new_pool_allocator(uint64_t maxBytes);
+// returns a built-in allocator using mmap for large mappings, with huge
+// page, NUMA placement and first touch options given by <flags>
+// (Laik_AllocatorFlag values). <numaNodes> is a bit mask of NUMA nodes
+// to use (0: all nodes allowed for interleaving, local node for binding)
+Laik_Allocator* laik_new_allocator_preset(int flags, uint64_t numaNodes);
 void laik_set_allocator(Laik_Data* d, Laik_Allocator* alloc);
 Laik_Allocator* laik_get_allocator(Laik_Data* d);
 
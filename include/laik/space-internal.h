@@ -58,6 +58,10 @@ struct _Laik_SliceReceiver {
     Laik_SliceArray* array;
     Laik_SliceFilter* filter;
     Laik_PartitionerParams* params;
+
+    // slices of base partitioning calculated for this run,
+    // see laik_slicereceiver_otherslices
+    Laik_SliceArray* otherSA;
 };
 
 
@@ -77,9 +81,11 @@ typedef struct _Laik_TaskSlice_Gen {
     int mapNo;
 } Laik_TaskSlice_Gen;
 
-// for single-index slices in 1d
+// for single-index slices in 1d, collected as runs [idx;idx+len[ of
+// consecutively appended indexes for same task
 typedef struct _Laik_TaskSlice_Single1d {
     int task;
+    unsigned int len;
     int64_t idx;
 } Laik_TaskSlice_Single1d;
 
@@ -90,6 +96,20 @@ struct _Laik_TaskSlice {
 };
 
 
+// node of a spatial index over the slices of a slice array
+typedef struct _Laik_SliceIndexNode {
+    Laik_Index from, to;        // bounding box of slices below this node
+    unsigned int first, count;  // range of slices in <order> of the index
+    unsigned int child;         // first of two children, 0 for leaves
+} Laik_SliceIndexNode;
+
+// spatial index (bounding volume hierarchy) for intersection queries
+typedef struct _Laik_SliceIndex {
+    unsigned int nodeCount;
+    Laik_SliceIndexNode* node;  // node 0 is root
+    unsigned int* order;        // offsets of slices, grouped by node
+} Laik_SliceIndex;
+
 // a slice array is an sequence of slices assigned to task ids, ordered
 // by task id, then mapping id, then an index ordering
 struct _Laik_SliceArray {
@@ -109,8 +129,36 @@ struct _Laik_SliceArray {
     int map_tid;  // typically used for "own" task id
     unsigned int map_count; // number of mappings needed for slices of <maptask>
     unsigned int* map_off;  // offsets into own slices for same mapping
+
+    // built lazily on first intersection query for large arrays
+    Laik_SliceIndex* index;
+
+    // frozen slice arrays can be shared among partitionings (see
+    // laik_slicearray_intern): number of users, 0 if not shared
+    int refcount;
+    uint64_t hash; // over task ids and slice borders, valid if shared
+    int shareTid; // own task id of users, part of sharing key
+    Laik_SliceArray* nextShared; // chain in hash table of instance
 };
 
+// share frozen <sa> with other partitionings of the instance using the
+// same space and own task id <tid>. If an identical slice array already
+// is shared, <sa> is freed and the existing one returned.
+// Shared slice arrays are immutable and must be freed via release
+Laik_SliceArray* laik_slicearray_intern(Laik_SliceArray* sa, int tid);
+// drop a reference to <sa>, freeing it if not used anymore
+void laik_slicearray_release(Laik_SliceArray* sa);
+// get a slice array with contents of <sa> which may be modified
+// (copy-on-write): drops a reference to <sa> if shared
+Laik_SliceArray* laik_slicearray_unshare(Laik_SliceArray* sa);
+
+// get offsets of slices in frozen <sa> intersecting with <s>, ascending.
+// offsets are written into <*res>, enlarged if needed; returns count
+unsigned int laik_slicearray_intersecting(Laik_SliceArray* sa,
+                                          const Laik_Slice* s,
+                                          unsigned int** res,
+                                          unsigned int* resSize);
+
 
 // if a slice filter is installed for a new created partitioning, for
 // each slice added by the partitioner, the filter is called to check
@@ -120,9 +168,10 @@ typedef bool
 
 // for intersection partitioning filter
 typedef struct {
-    int64_t from, to;
+    Laik_Slice bb; // bounding box of slices
     Laik_TaskSlice_Gen* ts;
     unsigned int len;
+    bool sorted; // 1d only: slices ordered and disjoint, allows binary search
 } PFilterPar;
 
 // parameters for filtering slices on a partitioner run
@@ -138,8 +187,18 @@ struct _Laik_SliceFilter {
     // are stored. max of 2 partitionings can be given
     // (used in laik_calc_transition for reduced memory consumption)
     PFilterPar *pfilter1, *pfilter2;
+
+    // for intersection filter: also keep slices within this distance
+    // (used for base partitionings of derived partitionings)
+    int64_t reach;
 };
 
+// may a slice for tasks in [fromTask;toTask[ within <s> pass the filter?
+bool laik_slicefilter_wants(Laik_SliceFilter* sf,
+                            int fromTask, int toTask, const Laik_Slice* s);
+// new filter with same settings as <sf>, with reach enlarged by <reach>
+Laik_SliceFilter* laik_slicefilter_extend(Laik_SliceFilter* sf, int64_t reach);
+
 // meta info about slices arrays stored with partitionings (AI = array info)
 // this gets set when running partitioner with specific filter
 typedef enum _ArrayInfo {
@@ -155,6 +214,7 @@ typedef struct _SliceArray_Entry {
     ArrayInfo info;
     int filter_tid; // for AI_SINGLETASK
     Laik_Partitioning* other; // for AI_INTERSECT
+    int otherId; // id of <other>, to detect reuse of freed partitioning
 
     Laik_SliceArray* slices;
     struct _SliceArray_Entry* next;
@@ -277,13 +337,38 @@ struct _Laik_Transition {
     // sub-groups of task group referenced by reduction operations
     int subgroupCount;
     TaskGroup *subgroup;
+
+    // slices the operations depend on: own slices and intersecting ones
+    // of other tasks (sorted by task), 0 if not recorded.
+    // Used for incremental recalculation, see laik_calc_transition_update
+    int fromDepCount, toDepCount;
+    Laik_TaskSlice_Gen *fromDep, *toDep;
 };
 
+// allocate a transition with space for given number of operations,
+// copying the sub-groups (to be filled by caller)
+Laik_Transition* laik_transition_new(int localCount, int initCount,
+                                     int sendCount, int recvCount,
+                                     int redCount,
+                                     int subgroupCount, TaskGroup* subgroup);
+
 // same as laik_calc_transition without logging
 Laik_Transition* do_calc_transition(Laik_Space* space,
                                     Laik_Partitioning* fromP, Laik_Partitioning* toP,
                                     Laik_DataFlow flow, Laik_ReductionOperation redOp);
 
+// calculate transition, reusing operations of transition <base> calculated
+// before for other partitionings. Only operations with tasks whose slices
+// relevant for this process changed are recalculated. If <base> does not
+// refer to a group any longer (retired in a transition cache), the caller
+// must make sure that it was calculated for the group of <fromP>/<toP>
+Laik_Transition* laik_calc_transition_update(Laik_Transition* base,
+                                             Laik_Space* space,
+                                             Laik_Partitioning* fromP,
+                                             Laik_Partitioning* toP,
+                                             Laik_DataFlow flow,
+                                             Laik_ReductionOperation redOp);
+
 // return size of task group with ID <subgroup> in transition <t>
 int laik_trans_groupCount(Laik_Transition* t, int subgroup);
 
@@ -175,7 +175,8 @@ void laik_slice_init_3d(Laik_Slice* slc, Laik_Space* space,
 // is the given slice empty?
 bool laik_slice_isEmpty(Laik_Slice* slc);
 
-// get the intersection of 2 slices; return 0 if intersection is empty
+// get the intersection of 2 slices; return 0 if intersection is empty.
+// returned slice is valid until next call from same thread
 Laik_Slice* laik_slice_intersect(const Laik_Slice* s1, const Laik_Slice* s2);
 
 // expand slice <dst> such that it contains <src>
@@ -264,6 +265,9 @@ int laik_slicearray_isSingle(Laik_SliceArray* sa);
 bool laik_slicearray_isEqual(Laik_SliceArray* sa1, Laik_SliceArray* sa2);
 // do the slices of this partitioning cover the full space?
 bool laik_slicearray_coversSpace(Laik_SliceArray* sa);
+// same, and if <overlap> is given, set overlap[0/1] to offsets of two
+// overlapping slices, or -1 if slices do not overlap
+bool laik_slicearray_checkCoverage(Laik_SliceArray* sa, int* overlap);
 // get number of slices
 int laik_slicearray_slicecount(Laik_SliceArray* sa);
 int laik_slicearray_tidslicecount(Laik_SliceArray* sa, int tid);
@@ -367,6 +371,14 @@ void laik_append_slice(Laik_SliceReceiver* r, int task, const Laik_Slice* s,
                        int tag, void* data);
 // append 1d single-index slice
 void laik_append_index_1d(Laik_SliceReceiver* r, int task, int64_t idx);
+// may a slice for tasks in [fromTask;toTask[ within <s> be stored?
+// allows to skip enumeration of regions not relevant for filtered runs
+bool laik_slicereceiver_wants(Laik_SliceReceiver* r,
+                              int fromTask, int toTask, const Laik_Slice* s);
+// slices of base partitioning needed for this run, for partitioners
+// extending base slices by at most <reach> indexes (e.g. halos)
+Laik_SliceArray* laik_slicereceiver_otherslices(Laik_SliceReceiver* r,
+                                                int64_t reach);
 
 
 /**
@@ -403,6 +415,13 @@ Laik_Partitioning* laik_new_partitioning(Laik_Partitioner* pr,
                                          Laik_Group* g, Laik_Space* space,
                                          Laik_Partitioning* otherP);
 
+// create a new partitioning storing only own slices. Slices of other tasks
+// are calculated on demand, only as far as needed for transitions
+Laik_Partitioning* laik_new_distributed_partitioning(Laik_Partitioner* pr,
+                                                     Laik_Group* g,
+                                                     Laik_Space* space,
+                                                     Laik_Partitioning* otherP);
+
 // new partitioning taking slices from another, migrating to new group
 Laik_Partitioning* laik_new_migrated_partitioning(Laik_Partitioning* other,
                                                   Laik_Group* newg);
@@ -479,6 +498,8 @@ void* laik_partitioner_data(Laik_Partitioner* partitioner);
 bool laik_partitioning_isAll(Laik_Partitioning* p);
 int  laik_partitioning_isSingle(Laik_Partitioning* p);
 bool laik_partitioning_coversSpace(Laik_Partitioning* p);
+// does the partitioning cover the full space without overlapping slices?
+bool laik_partitioning_isExclusive(Laik_Partitioning* p);
 bool laik_partitioning_isEqual(Laik_Partitioning* p1, Laik_Partitioning* p2);
 
 
@@ -496,6 +517,11 @@ Laik_Partitioner* laik_new_single_partitioner(int);
 Laik_Partitioner* laik_new_copy_partitioner(int fromDim, int toDim);
 Laik_Partitioner* laik_new_cornerhalo_partitioner(int depth);
 Laik_Partitioner* laik_new_halo_partitioner(int depth);
+// stencil halo partitioner: extend slices of another partitioning by
+// halos of depth lo[d] / hi[d] towards lower / higher indexes in dimension
+// d (hi = 0: same as lo), with <corners> also to diagonal neighbors
+Laik_Partitioner* laik_new_stencil_partitioner(int dims, const int* lo,
+                                               const int* hi, bool corners);
 Laik_Partitioner* laik_new_bisection_partitioner(void);
 Laik_Partitioner* laik_new_grid_partitioner(int xblocks, int yblocks,
                                             int zblocks);
@@ -523,6 +549,15 @@ Laik_Partitioner* laik_new_block_partitioner_tw1(Laik_GetTaskWeight_t f,
 void laik_set_index_weight(Laik_Partitioner* p, Laik_GetIdxWeight_t f,
                            const void* userData);
 
+// bulk variant of index-wise weight getter: write weights of indexes
+// [from;to[ of the partitioned dimension into <w>. Weights are expected
+// to not change: they are cached for further runs of the partitioner
+// (e.g. with other task weights), until a weight getter is set again
+typedef void (*Laik_GetIdxWeights_t)(int64_t from, int64_t to, double* w,
+                                     const void* userData);
+void laik_set_index_weights(Laik_Partitioner* p, Laik_GetIdxWeights_t f,
+                            const void* userData);
+
 // set task-wise weight getter, used when calculating BLOCK partitioning.
 // as getter is called in every LAIK task, weights have to be known globally
 // (useful if relative performance per task is known)
@@ -533,6 +568,41 @@ void laik_set_task_weight(Laik_Partitioner* pr, Laik_GetTaskWeight_t f,
 // to distribute chunks to tasks. Default is 1.
 void laik_set_cycle_count(Laik_Partitioner* p, int cycles);
 
+// space-filling-curve partitioner for 1d/2d/3d spaces: cuts a Morton
+// or Hilbert curve over the space into chunks of similar index weight
+// (weight 1 per index if <ifunc> is 0), one per task. A task gets a few
+// rectangular slices, grouped into one mapping
+typedef enum _Laik_SFCType {
+    LAIK_SFC_Morton = 1,
+    LAIK_SFC_Hilbert
+} Laik_SFCType;
+
+Laik_Partitioner* laik_new_sfc_partitioner(Laik_SFCType type,
+                                           Laik_GetIdxWeight_t ifunc,
+                                           const void* userData);
+
+// recursive bisection with index-wise and task-wise weighting (both
+// optional), choosing cuts to minimize the total halo surface
+Laik_Partitioner*
+laik_new_weighted_bisection_partitioner(Laik_GetIdxWeight_t ifunc,
+                                        Laik_GetTaskWeight_t tfunc,
+                                        const void* userData);
+
+// multilevel graph partitioner for 1d space of <n> indexes being vertices
+// of a graph in CSR format: neighbors of vertex i are in <adjncy> at
+// offsets <xadj>[i] .. <xadj>[i+1]-1. Edges are taken as undirected,
+// <vwgt> are optional vertex weights. Minimizes the number of edges cut
+// between tasks while balancing vertex weights. Arrays are not copied and
+// must stay unchanged while the partitioner is in use
+Laik_Partitioner* laik_new_graph_partitioner(int n, const int* xadj,
+                                             const int* adjncy,
+                                             const double* vwgt);
+
+// graph halo partitioner: indexes of base partitioning plus neighbors
+// in the graph given in CSR format (as for the graph partitioner)
+Laik_Partitioner* laik_new_graph_halo_partitioner(int n, const int* xadj,
+                                                  const int* adjncy);
+
 // Reassign: incremental partitioner
 // redistribute indexes from tasks to be removed
 // this partitioner can make use of application-specified index weights
@@ -553,6 +623,14 @@ laik_calc_transition(Laik_Space* space,
                      Laik_Partitioning* fromP, Laik_Partitioning* toP,
                      Laik_DataFlow flow, Laik_ReductionOperation redOp);
 
+// Calculate <n> transitions at once (e.g. for multiple containers), in
+// parallel using the threads of the instance (see laik_set_threads).
+// Transition i is from <fromP>[i] to <toP>[i] with <flow>[i]/<redOp>[i]
+void laik_calc_transitions(int n, Laik_Space** space,
+                           Laik_Partitioning** fromP, Laik_Partitioning** toP,
+                           Laik_DataFlow* flow, Laik_ReductionOperation* redOp,
+                           Laik_Transition** t);
+
 // free a transition
 void laik_free_transition(Laik_Transition* t);
 
@@ -0,0 +1,567 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2018 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <laik-internal.h>
+
+// for string.h to declare strdup
+#define __STDC_WANT_LIB_EXT2__ 1
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+//
+// Saving/loading action sequences
+//
+// Actions embed addresses (mappings, buffers, backend requests), so
+// instead of the actions, we store what is needed to regenerate them:
+// for each transition context the container type, the index space,
+// the transition with all its slices and the slices of from/to mappings.
+// Properties of the sequence as prepared when saving (buffer sizes,
+// number of actions and rounds) are stored for reference.
+// A loaded sequence is unprepared (one TExec action per context), using
+// new containers with zeroed dummy mappings. This allows to run different
+// transformation passes on recorded schedules.
+// The format is binary in host byte order, and not meant for exchange
+// between different machines.
+
+#define ASEQ_FILE_MAGIC   "LAIKASEQ"
+#define ASEQ_FILE_VERSION 1
+
+// sanity limit for counts read from file
+#define ASEQ_FILE_MAXCOUNT 100000000
+
+// file with error state: after an error, further accesses are ignored
+typedef struct {
+    FILE* f;
+    bool ok;
+} ASeqFile;
+
+static void put(ASeqFile* af, const void* p, size_t size)
+{
+    if (af->ok && (fwrite(p, size, 1, af->f) != 1))
+        af->ok = false;
+}
+
+static void putInt(ASeqFile* af, int v)
+{
+    int32_t v32 = v;
+    put(af, &v32, sizeof(int32_t));
+}
+
+static void putU64(ASeqFile* af, uint64_t v)
+{
+    put(af, &v, sizeof(uint64_t));
+}
+
+static void putString(ASeqFile* af, const char* s)
+{
+    int len = s ? (int) strlen(s) : 0;
+    putInt(af, len);
+    if (len > 0) put(af, s, len);
+}
+
+// the space pointer of a slice is not stored
+static void putSlice(ASeqFile* af, Laik_Slice* s)
+{
+    for(int i = 0; i < 3; i++) putU64(af, (uint64_t) s->from.i[i]);
+    for(int i = 0; i < 3; i++) putU64(af, (uint64_t) s->to.i[i]);
+}
+
+static void putMList(ASeqFile* af, Laik_MappingList* ml)
+{
+    if (ml == 0) {
+        putInt(af, -1);
+        return;
+    }
+    putInt(af, ml->count);
+    for(int i = 0; i < ml->count; i++)
+        putSlice(af, &(ml->map[i].requiredSlice));
+}
+
+static void putTransition(ASeqFile* af, Laik_Transition* t)
+{
+    putInt(af, t->flags);
+    putInt(af, t->flow);
+    putInt(af, t->redOp);
+    putInt(af, t->dims);
+
+    putInt(af, t->localCount);
+    putInt(af, t->initCount);
+    putInt(af, t->sendCount);
+    putInt(af, t->recvCount);
+    putInt(af, t->redCount);
+    putInt(af, t->subgroupCount);
+
+    for(int i = 0; i < t->subgroupCount; i++) {
+        putInt(af, t->subgroup[i].count);
+        for(int j = 0; j < t->subgroup[i].count; j++)
+            putInt(af, t->subgroup[i].task[j]);
+    }
+
+    for(int i = 0; i < t->localCount; i++) {
+        struct localTOp* op = &(t->local[i]);
+        putSlice(af, &(op->slc));
+        putInt(af, op->fromSliceNo);
+        putInt(af, op->toSliceNo);
+        putInt(af, op->fromMapNo);
+        putInt(af, op->toMapNo);
+    }
+    for(int i = 0; i < t->initCount; i++) {
+        struct initTOp* op = &(t->init[i]);
+        putSlice(af, &(op->slc));
+        putInt(af, op->sliceNo);
+        putInt(af, op->mapNo);
+        putInt(af, op->redOp);
+    }
+    for(int i = 0; i < t->sendCount; i++) {
+        struct sendTOp* op = &(t->send[i]);
+        putSlice(af, &(op->slc));
+        putInt(af, op->sliceNo);
+        putInt(af, op->mapNo);
+        putInt(af, op->toTask);
+    }
+    for(int i = 0; i < t->recvCount; i++) {
+        struct recvTOp* op = &(t->recv[i]);
+        putSlice(af, &(op->slc));
+        putInt(af, op->sliceNo);
+        putInt(af, op->mapNo);
+        putInt(af, op->fromTask);
+    }
+    for(int i = 0; i < t->redCount; i++) {
+        struct redTOp* op = &(t->red[i]);
+        putSlice(af, &(op->slc));
+        putInt(af, op->redOp);
+        putInt(af, op->inputGroup);
+        putInt(af, op->outputGroup);
+        putInt(af, op->myInputSliceNo);
+        putInt(af, op->myOutputSliceNo);
+        putInt(af, op->myInputMapNo);
+        putInt(af, op->myOutputMapNo);
+    }
+}
+
+// save transitions of action sequence <as> into file <fname>
+bool laik_aseq_save(Laik_ActionSeq* as, const char* fname)
+{
+    assert(as->contextCount > 0);
+    Laik_TransitionContext* tc0 = as->context[0];
+    Laik_Group* g = tc0->transition->group;
+
+    ASeqFile af;
+    af.f = fopen(fname, "wb");
+    if (!af.f) {
+        laik_log(LAIK_LL_Warning, "Cannot open '%s' to save action seq '%s'",
+                 fname, as->name);
+        return false;
+    }
+    af.ok = true;
+
+    put(&af, ASEQ_FILE_MAGIC, 8);
+    putInt(&af, ASEQ_FILE_VERSION);
+    putInt(&af, g->size);
+    putInt(&af, laik_myid(g));
+    putInt(&af, as->contextCount);
+
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_TransitionContext* tc = as->context[i];
+        Laik_Data* d = tc->data;
+        Laik_Space* s = d->space;
+
+        putString(&af, d->name);
+        putString(&af, d->type->name);
+        putInt(&af, (int) d->elemsize);
+
+        putInt(&af, s->dims);
+        putSlice(&af, &(s->s));
+
+        putTransition(&af, tc->transition);
+        putMList(&af, tc->fromList);
+        putMList(&af, tc->toList);
+    }
+
+    // properties of sequence as prepared, for reference
+    putInt(&af, as->bufferCount);
+    for(int i = 0; i < as->bufferCount; i++)
+        putU64(&af, as->bufSize[i]);
+    putInt(&af, (int) as->actionCount);
+    putU64(&af, as->bytesUsed);
+    putInt(&af, as->roundCount);
+
+    if (fclose(af.f) != 0) af.ok = false;
+    if (!af.ok) {
+        laik_log(LAIK_LL_Warning, "Error writing action seq '%s' to '%s'",
+                 as->name, fname);
+        return false;
+    }
+
+    laik_log(1, "saved action seq '%s' (%d contexts) to '%s'",
+             as->name, as->contextCount, fname);
+    return true;
+}
+
+
+static void get(ASeqFile* af, void* p, size_t size)
+{
+    if (af->ok && (fread(p, size, 1, af->f) != 1)) {
+        af->ok = false;
+        memset(p, 0, size);
+    }
+    else if (!af->ok)
+        memset(p, 0, size);
+}
+
+static int getInt(ASeqFile* af)
+{
+    int32_t v32;
+    get(af, &v32, sizeof(int32_t));
+    return v32;
+}
+
+static uint64_t getU64(ASeqFile* af)
+{
+    uint64_t v;
+    get(af, &v, sizeof(uint64_t));
+    return v;
+}
+
+// count in valid range? Otherwise set error state
+static int getCount(ASeqFile* af, int min)
+{
+    int v = getInt(af);
+    if ((v < min) || (v > ASEQ_FILE_MAXCOUNT)) {
+        af->ok = false;
+        return 0;
+    }
+    return v;
+}
+
+static char* getString(ASeqFile* af)
+{
+    int len = getCount(af, 0);
+    char* s = malloc(len + 1);
+    if (!s) {
+        laik_panic("Out of memory reading string from action seq file");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    if (len > 0) get(af, s, len);
+    s[len] = 0;
+    return s;
+}
+
+static void getSlice(ASeqFile* af, Laik_Slice* s, Laik_Space* space)
+{
+    s->space = space;
+    for(int i = 0; i < 3; i++) s->from.i[i] = (int64_t) getU64(af);
+    for(int i = 0; i < 3; i++) s->to.i[i] = (int64_t) getU64(af);
+}
+
+static Laik_MappingList* getMList(ASeqFile* af, Laik_Data* d)
+{
+    int n = getCount(af, -1);
+    if (n < 0) return 0;
+
+    Laik_Slice* slc = malloc((n + 1) * sizeof(Laik_Slice));
+    if (!slc) {
+        laik_panic("Out of memory reading mappings from action seq file");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(int i = 0; i < n; i++) {
+        getSlice(af, &(slc[i]), d->space);
+        if (!laik_slice_within_space(&(slc[i]), d->space))
+            af->ok = false;
+    }
+    if (!af->ok) {
+        free(slc);
+        return 0;
+    }
+
+    Laik_MappingList* ml = laik_mappinglist_new(d, n, slc);
+    free(slc);
+    return ml;
+}
+
+// check map/slice numbers of transition operations read from file
+static bool validMapNo(int mapNo, Laik_MappingList* ml)
+{
+    return (ml != 0) && (mapNo >= 0) && (mapNo < ml->count);
+}
+
+static bool validGroup(int g, Laik_Transition* t)
+{
+    return (g >= -1) && (g < t->subgroupCount);
+}
+
+static bool validTask(int task, Laik_Group* group)
+{
+    return (task >= 0) && (task < group->size);
+}
+
+static Laik_Transition* getTransition(ASeqFile* af, Laik_Data* d,
+                                      Laik_Group* group)
+{
+    int flags = getInt(af);
+    int flow = getInt(af);
+    int redOp = getInt(af);
+    int dims = getInt(af);
+
+    int localCount = getCount(af, 0);
+    int initCount = getCount(af, 0);
+    int sendCount = getCount(af, 0);
+    int recvCount = getCount(af, 0);
+    int redCount = getCount(af, 0);
+    int subgroupCount = getCount(af, 0);
+    if (!af->ok) return 0;
+
+    TaskGroup* subgroup = malloc((subgroupCount + 1) * sizeof(TaskGroup));
+    if (!subgroup) {
+        laik_panic("Out of memory reading transition from action seq file");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    int sgRead = 0;
+    for(; sgRead < subgroupCount; sgRead++) {
+        TaskGroup* tg = &(subgroup[sgRead]);
+        tg->count = getCount(af, 0);
+        if (tg->count > group->size) af->ok = false;
+        if (!af->ok) break;
+        tg->task = malloc((tg->count + 1) * sizeof(int));
+        if (!tg->task) {
+            laik_panic("Out of memory reading transition from action seq file");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        for(int j = 0; j < tg->count; j++) {
+            tg->task[j] = getInt(af);
+            if (!validTask(tg->task[j], group)) af->ok = false;
+        }
+    }
+
+    Laik_Transition* t = 0;
+    if (af->ok)
+        t = laik_transition_new(localCount, initCount, sendCount,
+                                recvCount, redCount,
+                                subgroupCount, subgroup);
+    for(int i = 0; i < sgRead; i++)
+        free(subgroup[i].task);
+    free(subgroup);
+    if (!t) return 0;
+
+    t->flags = flags;
+    t->space = d->space;
+    t->group = group;
+    t->fromPartitioning = 0;
+    t->toPartitioning = 0;
+    t->flow = (Laik_DataFlow) flow;
+    t->redOp = (Laik_ReductionOperation) redOp;
+    t->dims = dims;
+
+    for(int i = 0; i < localCount; i++) {
+        struct localTOp* op = &(t->local[i]);
+        getSlice(af, &(op->slc), d->space);
+        op->fromSliceNo = getInt(af);
+        op->toSliceNo = getInt(af);
+        op->fromMapNo = getInt(af);
+        op->toMapNo = getInt(af);
+    }
+    for(int i = 0; i < initCount; i++) {
+        struct initTOp* op = &(t->init[i]);
+        getSlice(af, &(op->slc), d->space);
+        op->sliceNo = getInt(af);
+        op->mapNo = getInt(af);
+        op->redOp = (Laik_ReductionOperation) getInt(af);
+    }
+    for(int i = 0; i < sendCount; i++) {
+        struct sendTOp* op = &(t->send[i]);
+        getSlice(af, &(op->slc), d->space);
+        op->sliceNo = getInt(af);
+        op->mapNo = getInt(af);
+        op->toTask = getInt(af);
+        if (!validTask(op->toTask, group)) af->ok = false;
+    }
+    for(int i = 0; i < recvCount; i++) {
+        struct recvTOp* op = &(t->recv[i]);
+        getSlice(af, &(op->slc), d->space);
+        op->sliceNo = getInt(af);
+        op->mapNo = getInt(af);
+        op->fromTask = getInt(af);
+        if (!validTask(op->fromTask, group)) af->ok = false;
+    }
+    for(int i = 0; i < redCount; i++) {
+        struct redTOp* op = &(t->red[i]);
+        getSlice(af, &(op->slc), d->space);
+        op->redOp = (Laik_ReductionOperation) getInt(af);
+        op->inputGroup = getInt(af);
+        op->outputGroup = getInt(af);
+        op->myInputSliceNo = getInt(af);
+        op->myOutputSliceNo = getInt(af);
+        op->myInputMapNo = getInt(af);
+        op->myOutputMapNo = getInt(af);
+        if (!validGroup(op->inputGroup, t) || !validGroup(op->outputGroup, t))
+            af->ok = false;
+    }
+
+    if (!af->ok) {
+        laik_free_transition(t);
+        return 0;
+    }
+    return t;
+}
+
+// check that all map numbers used in <t> are valid for given lists
+static bool validMapNos(Laik_Transition* t,
+                        Laik_MappingList* fromList, Laik_MappingList* toList)
+{
+    for(int i = 0; i < t->localCount; i++)
+        if (!validMapNo(t->local[i].fromMapNo, fromList) ||
+            !validMapNo(t->local[i].toMapNo, toList)) return false;
+    for(int i = 0; i < t->initCount; i++)
+        if (!validMapNo(t->init[i].mapNo, toList)) return false;
+    for(int i = 0; i < t->sendCount; i++)
+        if (!validMapNo(t->send[i].mapNo, fromList)) return false;
+    for(int i = 0; i < t->recvCount; i++)
+        if (!validMapNo(t->recv[i].mapNo, toList)) return false;
+    for(int i = 0; i < t->redCount; i++) {
+        struct redTOp* op = &(t->red[i]);
+        if ((op->myInputMapNo >= 0) && !validMapNo(op->myInputMapNo, fromList))
+            return false;
+        if ((op->myOutputMapNo >= 0) && !validMapNo(op->myOutputMapNo, toList))
+            return false;
+    }
+    return true;
+}
+
+// type for a container loaded from file: a predefined one if matching
+static Laik_Type* findType(char* name, int elemsize)
+{
+    Laik_Type* types[] = { laik_Char, laik_Int32, laik_Int64,
+                           laik_UChar, laik_UInt32, laik_UInt64,
+                           laik_Float, laik_Double, 0 };
+    for(int i = 0; types[i]; i++)
+        if ((strcmp(types[i]->name, name) == 0) && (types[i]->size == elemsize))
+            return types[i];
+
+    // no reduction support for custom types
+    laik_log(LAIK_LL_Warning, "Unknown type '%s' in action seq file, "
+             "using type without reduction support", name);
+    return laik_type_register(strdup(name), elemsize);
+}
+
+// load an action sequence from file <fname> saved with laik_aseq_save.
+// Requires same number of processes and same rank as when saved.
+// Returns 0 on error
+Laik_ActionSeq* laik_aseq_load(Laik_Instance* inst, const char* fname)
+{
+    ASeqFile af;
+    af.f = fopen(fname, "rb");
+    if (!af.f) {
+        laik_log(LAIK_LL_Warning, "Cannot open action seq file '%s'", fname);
+        return 0;
+    }
+    af.ok = true;
+
+    char magic[8];
+    get(&af, magic, 8);
+    if (!af.ok || (memcmp(magic, ASEQ_FILE_MAGIC, 8) != 0) ||
+        (getInt(&af) != ASEQ_FILE_VERSION)) {
+        laik_log(LAIK_LL_Warning, "'%s' is not an action seq file", fname);
+        fclose(af.f);
+        return 0;
+    }
+
+    Laik_Group* world = laik_world(inst);
+    int size = getInt(&af);
+    int myid = getInt(&af);
+    if (!af.ok || (size != world->size) || (myid != laik_myid(world))) {
+        laik_log(LAIK_LL_Warning,
+                 "Action seq file '%s' saved by task %d/%d, we are %d/%d",
+                 fname, myid, size, laik_myid(world), world->size);
+        fclose(af.f);
+        return 0;
+    }
+
+    int contextCount = getCount(&af, 1);
+    if (contextCount > ASEQ_CONTEXTS_MAX) af.ok = false;
+
+    Laik_ActionSeq* as = laik_aseq_new(inst);
+    as->loaded = true;
+    as->reused = true;
+    for(int i = 0; af.ok && (i < contextCount); i++) {
+        char* dname = getString(&af);
+        char* tname = getString(&af);
+        int elemsize = getInt(&af);
+        int dims = getInt(&af);
+        if (!af.ok || (elemsize <= 0) || (dims < 1) || (dims > 3)) {
+            free(dname);
+            free(tname);
+            af.ok = false;
+            break;
+        }
+
+        Laik_Space* s = laik_new_space(inst);
+        s->dims = dims;
+        getSlice(&af, &(s->s), s);
+
+        Laik_Data* d = laik_new_data(s, findType(tname, elemsize));
+        laik_data_set_name(d, dname);
+        free(tname);
+
+        Laik_Transition* t = getTransition(&af, d, world);
+        if (!t) {
+            af.ok = false;
+            break;
+        }
+        Laik_MappingList* fromList = getMList(&af, d);
+        Laik_MappingList* toList = getMList(&af, d);
+        if (!af.ok || !validMapNos(t, fromList, toList)) {
+            laik_mappinglist_free(fromList);
+            laik_mappinglist_free(toList);
+            laik_free_transition(t);
+            af.ok = false;
+            break;
+        }
+
+        int tid = laik_aseq_addTContext(as, d, t, fromList, toList);
+        laik_aseq_addTExec(as, tid);
+    }
+    laik_aseq_activateNewActions(as);
+
+    // properties of sequence when saved
+    int bufCount = getCount(&af, 0);
+    uint64_t bufSize = 0;
+    for(int i = 0; i < bufCount; i++)
+        bufSize += getU64(&af);
+    int actionCount = getInt(&af);
+    uint64_t bytesUsed = getU64(&af);
+    int roundCount = getInt(&af);
+    fclose(af.f);
+
+    if (!af.ok) {
+        laik_log(LAIK_LL_Warning, "Error reading action seq file '%s'", fname);
+        laik_aseq_free(as);
+        return 0;
+    }
+
+    laik_log(2, "loaded '%s' as action seq '%s' (%d contexts)\n"
+                "  when saved: %d actions (%llu bytes), %d rounds, "
+                "%d buffers (%llu bytes)",
+             fname, as->name, as->contextCount,
+             actionCount, (unsigned long long) bytesUsed, roundCount,
+             bufCount, (unsigned long long) bufSize);
+
+    return as;
+}
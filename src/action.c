@@ -27,6 +27,145 @@
 
 static int aseq_id = 0;
 
+//
+// Pool for temporary buffers of action sequences
+//
+
+// size class to use for a buffer of <size> bytes, with its size in <csize>.
+// Between 2^k and 2^(k+1), there are classes in steps of 2^(k-2)
+static int bufpool_class(size_t size, size_t* csize)
+{
+    int k = BUFPOOL_MINCLASS;
+    if (size <= ((size_t)1 << k)) {
+        *csize = (size_t)1 << k;
+        return 0;
+    }
+    while(((size_t)1 << (k + 1)) < size) k++;
+    size_t step = (size_t)1 << (k - 2);
+    size_t j = (size - ((size_t)1 << k) + step - 1) / step;
+    *csize = ((size_t)1 << k) + j * step;
+    int c = 4 * (k - BUFPOOL_MINCLASS) + (int) j;
+    assert(c < BUFPOOL_CLASSES);
+    return c;
+}
+
+// create pool for instance (LAIK_BUFPOOL=0 disables pooling)
+Laik_BufPool* laik_bufpool_new()
+{
+    Laik_BufPool* p = malloc(sizeof(Laik_BufPool));
+    if (!p) {
+        laik_panic("Out of memory allocating Laik_BufPool object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    p->enabled = true;
+    char* str = getenv("LAIK_BUFPOOL");
+    if (str) p->enabled = (atoi(str) != 0);
+    p->maxCachedBytes = (uint64_t) BUFPOOL_MAXCACHED << 20;
+    str = getenv("LAIK_BUFPOOL_MAX");
+    if (str) p->maxCachedBytes = (uint64_t) atoi(str) << 20;
+
+    for(int i = 0; i < BUFPOOL_CLASSES; i++)
+        p->freeList[i] = 0;
+    p->usedBytes = 0;
+    p->cachedBytes = 0;
+    p->peakBytes = 0;
+    p->hits = 0;
+    p->misses = 0;
+    p->trimmed = 0;
+
+    return p;
+}
+
+// get a buffer of at least <size> bytes from the pool of instance <inst>
+char* laik_bufpool_get(Laik_Instance* inst, size_t size)
+{
+    Laik_BufPool* p = inst->bufPool;
+    if (!p->enabled) {
+        char* buf = malloc(size);
+        if (!buf) {
+            laik_panic("Out of memory allocating action sequence buffer");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        return buf;
+    }
+
+    size_t csize;
+    int c = bufpool_class(size, &csize);
+    char* buf = p->freeList[c];
+    if (buf) {
+        p->freeList[c] = *((void**) buf);
+        p->cachedBytes -= csize;
+        p->hits++;
+    }
+    else {
+        buf = malloc(csize);
+        if (!buf) {
+            laik_panic("Out of memory allocating action sequence buffer");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        p->misses++;
+    }
+
+    p->usedBytes += csize;
+    if (p->usedBytes > p->peakBytes)
+        p->peakBytes = p->usedBytes;
+
+    return buf;
+}
+
+// give back a buffer got via laik_bufpool_get with same <size>.
+// If cached buffers would exceed the limit, the buffer is freed
+void laik_bufpool_put(Laik_Instance* inst, char* buf, size_t size)
+{
+    Laik_BufPool* p = inst->bufPool;
+    if (!p->enabled) {
+        free(buf);
+        return;
+    }
+
+    size_t csize;
+    int c = bufpool_class(size, &csize);
+    assert(p->usedBytes >= csize);
+    p->usedBytes -= csize;
+
+    if (p->cachedBytes + csize > p->maxCachedBytes) {
+        free(buf);
+        p->trimmed++;
+        return;
+    }
+
+    p->cachedBytes += csize;
+    *((void**) buf) = p->freeList[c];
+    p->freeList[c] = buf;
+}
+
+// free all cached buffers, called by laik_finalize
+// buffers given back afterwards are freed directly
+void laik_bufpool_release(Laik_Instance* inst)
+{
+    Laik_BufPool* p = inst->bufPool;
+    if (!p->enabled) return;
+
+    laik_log(1, "buffer pool: %u hits, %u misses, %u trimmed, peak %llu "
+             "bytes, releasing %llu bytes",
+             p->hits, p->misses, p->trimmed, (unsigned long long) p->peakBytes,
+             (unsigned long long) p->cachedBytes);
+
+    for(int c = 0; c < BUFPOOL_CLASSES; c++) {
+        void* buf = p->freeList[c];
+        while(buf) {
+            void* next = *((void**) buf);
+            free(buf);
+            buf = next;
+        }
+        p->freeList[c] = 0;
+    }
+    p->cachedBytes = 0;
+    p->enabled = false;
+}
+
+
 // create a new action sequence object, usable for the given LAIK instance
 Laik_ActionSeq* laik_aseq_new(Laik_Instance *inst)
 {
@@ -41,28 +180,41 @@ Laik_ActionSeq* laik_aseq_new(Laik_Instance *inst)
 
     as->inst = inst;
     as->backend = 0;
+    as->backend_data = 0;
+    as->reused = false;
 
     for(int i = 0; i < ASEQ_CONTEXTS_MAX; i++)
         as->context[i] = 0;
     as->contextCount = 0;
 
-    for(int i = 0; i < ASEQ_BUFFER_MAX; i++) {
-        as->buf[i] = 0;
-        as->bufSize[i] = 0;
-    }
+    as->buf = 0;
+    as->bufSize = 0;
     as->bufferCount = 0;
+    as->bufferCapacity = 0;
     as->bufReserveCount = 0;
+    as->bufReturned = false;
 
-    for(int i = 0; i < ASEQ_COPYENTRY_MAX; i++)
-        as->ce[i] = 0;
+    as->ce = 0;
     as->ceCount = 0;
+    as->ceCapacity = 0;
     as->ceRanges = 0;
 
+    as->currentTID = 0;
+    as->loaded = false;
+
     as->actionCount = 0;
     as->bytesUsed = 0;
     as->action = 0;
     as->roundCount = 0;
 
+    as->localRun = 0;
+    as->localPiece = 0;
+    as->localPieceCount = 0;
+
+    as->execPending = false;
+    as->execPos = 0;
+    as->execAction = 0;
+
     as->newAction = 0;
     as->newActionCount = 0;
     as->newBytesUsed = 0;
@@ -77,6 +229,26 @@ Laik_ActionSeq* laik_aseq_new(Laik_Instance *inst)
     return as;
 }
 
+// give back temporary buffers and copy entries of a sequence
+static void freeBuffers(Laik_ActionSeq* as)
+{
+    Laik_TransitionContext* tc = as->context[0];
+
+    for(int i = 0; i < as->bufferCount; i++) {
+        if (as->bufSize[i] == 0) continue;
+
+        laik_log(1, "    free buffer %d: %zu bytes\n", i, as->bufSize[i]);
+        if (!as->bufReturned)
+            laik_bufpool_put(as->inst, as->buf[i], as->bufSize[i]);
+
+        // update allocation statistics
+        laik_switchstat_free(tc->data->stat, as->bufSize[i]);
+    }
+
+    for(int i = 0; i < as->ceCount; i++)
+        free(as->ce[i]);
+}
+
 // free all resources allocated for an action sequence
 // this may include backend-specific resources
 void laik_aseq_free(Laik_ActionSeq* as)
@@ -91,30 +263,57 @@ void laik_aseq_free(Laik_ActionSeq* as)
         (as->backend->cleanup)(as);
     }
 
-    Laik_TransitionContext* tc = as->context[0];
-
-    for(int i = 0; i < as->bufferCount; i++) {
-        if (as->bufSize[i] == 0) continue;
-
-        laik_log(1, "    free buffer %d: %zu bytes\n", i, as->bufSize[i]);
-        free(as->buf[i]);
-
-        // update allocation statistics
-        laik_switchstat_free(tc->data->stat, as->bufSize[i]);
-    }
+    freeBuffers(as);
 
-    for(int i = 0; i < as->contextCount; i++)
+    for(int i = 0; i < as->contextCount; i++) {
+        if (as->loaded) {
+            Laik_TransitionContext* ltc = as->context[i];
+            laik_mappinglist_free(ltc->fromList);
+            laik_mappinglist_free(ltc->toList);
+            laik_free_transition(ltc->transition);
+        }
         free(as->context[i]);
+    }
 
-    for(int i = 0; i < as->ceCount; i++)
-        free(as->ce[i]);
-
+    free(as->buf);
+    free(as->bufSize);
+    free(as->ce);
     free(as->action);
     free(as->newAction);
+    free(as->localRun);
+    free(as->localPiece);
 
     free(as);
 }
 
+// reset a prepared sequence to the state before preparation: one TExec
+// action per transition context, no buffers. Allows to prepare the
+// sequence again, e.g. with different transformations. The backend must
+// have released its resources for the sequence before
+void laik_aseq_reset(Laik_ActionSeq* as)
+{
+    assert(as->execPending == false);
+    laik_log(1, "reset action seq '%s' (%d actions, %d buffers)",
+             as->name, as->actionCount, as->bufferCount);
+
+    freeBuffers(as);
+    as->bufferCount = 0;
+    as->bufReserveCount = 0;
+    as->bufReturned = false;
+    as->ceCount = 0;
+    as->ceRanges = 0;
+    as->backend = 0;
+    as->backend_data = 0;
+
+    laik_aseq_discardNewActions(as);
+    for(int tid = 0; tid < as->contextCount; tid++)
+        laik_aseq_addTExec(as, tid);
+    laik_aseq_activateNewActions(as);
+
+    // mark that stats are not yet calculated
+    as->transitionCount = 0;
+}
+
 
 // get sum of sizes of all allocated temporary buffers
 int laik_aseq_bufsize(Laik_ActionSeq* as)
@@ -168,13 +367,16 @@ void laik_aseq_discardNewActions(Laik_ActionSeq* as)
     as->newBytesUsed = 0;
     as->newActionCount = 0;
     as->newRoundCount = 0;
+    as->currentTID = 0;
 }
 
 // finish building an action sequence, activate the new built sequence
 void laik_aseq_activateNewActions(Laik_ActionSeq* as)
 {
-    // free old sequence
+    // free old sequence, runs of local moves found in it get invalid
     free(as->action);
+    free(as->localRun);
+    as->localRun = 0;
 
     // copy into new space with size as needed
     as->action = malloc(as->newBytesUsed);
@@ -198,15 +400,6 @@ void laik_aseq_freeTempSpace(Laik_ActionSeq* as)
 }
 
 
-Laik_BackendAction* laik_aseq_addBAction(Laik_ActionSeq* as, int round)
-{
-    Laik_BackendAction* ba;
-    ba = (Laik_BackendAction*) laik_aseq_addAction(as,
-                                                   sizeof(Laik_BackendAction),
-                                                   LAIK_AT_Invalid, round, 0);
-    return ba;
-}
-
 int laik_aseq_addTContext(Laik_ActionSeq* as,
                           Laik_Data* data, Laik_Transition* transition,
                           Laik_MappingList* fromList,
@@ -215,7 +408,20 @@ int laik_aseq_addTContext(Laik_ActionSeq* as,
     // the transition must be valid
     assert(transition != 0);
 
+    // ranks used in actions refer to one group for all transitions
+    if (as->contextCount > 0) {
+        Laik_TransitionContext* tc0 = as->context[0];
+        if (tc0->transition->group != transition->group) {
+            laik_panic("Transitions in one action sequence must use same group");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+    }
+
     Laik_TransitionContext* tc = malloc(sizeof(Laik_TransitionContext));
+    if (!tc) {
+        laik_panic("Out of memory allocating Laik_TransitionContext object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
     tc->data = data;
     tc->transition = transition;
     tc->fromList = fromList;
@@ -253,10 +459,11 @@ void laik_aseq_addTExec(Laik_ActionSeq* as, int tid)
 
 
 // append action to reserve buffer space
-// if <bufID> is negative, a new ID is generated (always > 100)
+// if <bufID> is negative, a new ID is generated (>= ASEQ_RBUF_FIRSTID)
 // returns bufID.
 //
-// bufID < 100 are reserved for buffers already allocated (buf[bufID]).
+// bufID < ASEQ_RBUF_FIRSTID are reserved for buffers already allocated
+// (buf[bufID]).
 // in a final pass, all buffer reservations must be collected, the buffer
 // allocated (with ID 0), and the references to this buffer replaced
 // by references into buffer 0. These actions can be removed afterwards.
@@ -264,12 +471,12 @@ int laik_aseq_addBufReserve(Laik_ActionSeq* as, unsigned int size, int bufID)
 {
     if (bufID < 0) {
         // generate new buf ID
-        // only return IDs > 100. ID <100 are reserved for actual buffers
-        bufID = (int)(as->bufReserveCount + 100);
+        // lower IDs are reserved for actual buffers
+        bufID = (int)(as->bufReserveCount + ASEQ_RBUF_FIRSTID);
         as->bufReserveCount++;
     }
     else
-        assert(bufID <= (int)(as->bufReserveCount + 99));
+        assert(bufID < (int)(as->bufReserveCount + ASEQ_RBUF_FIRSTID));
 
     // BufReserve in round 0: allocation is done before exec
     Laik_A_BufReserve* a;
@@ -289,7 +496,8 @@ void laik_aseq_addRBufSend(Laik_ActionSeq* as, int round,
 {
     Laik_A_RBufSend* a;
     a = (Laik_A_RBufSend*) laik_aseq_addAction(as, sizeof(*a),
-                                               LAIK_AT_RBufSend, round, 0);
+                                               LAIK_AT_RBufSend, round,
+                                               as->currentTID);
     a->bufID = bufID;
     a->offset = byteOffset;
     a->count = count;
@@ -303,7 +511,8 @@ void laik_aseq_addRBufRecv(Laik_ActionSeq* as, int round,
 {
     Laik_A_RBufRecv* a;
     a = (Laik_A_RBufRecv*) laik_aseq_addAction(as, sizeof(*a),
-                                               LAIK_AT_RBufRecv, round, 0);
+                                               LAIK_AT_RBufRecv, round,
+                                               as->currentTID);
     a->bufID = bufID;
     a->offset = byteOffset;
     a->count = count;
@@ -318,9 +527,10 @@ void laik_aseq_addRBufLocalReduce(Laik_ActionSeq* as, int round,
                                   int fromBufID, unsigned int fromByteOffset,
                                   char* toBuf, unsigned int count)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_RBufLocalReduce;
+    Laik_A_RBufLocalReduce* a;
+    a = (Laik_A_RBufLocalReduce*) laik_aseq_addAction(as, sizeof(*a),
+                                                      LAIK_AT_RBufLocalReduce, round,
+                                                      as->currentTID);
     a->dtype = dtype;
     a->redOp = redOp;
     a->toBuf = toBuf;
@@ -335,9 +545,10 @@ void laik_aseq_addBufInit(Laik_ActionSeq* as, int round,
                           Laik_ReductionOperation redOp,
                           char* toBuf, unsigned int count)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_BufInit;
+    Laik_A_BufInit* a;
+    a = (Laik_A_BufInit*) laik_aseq_addAction(as, sizeof(*a),
+                                              LAIK_AT_BufInit, round,
+                                              as->currentTID);
     a->dtype = dtype;
     a->redOp = redOp;
     a->toBuf = toBuf;
@@ -350,9 +561,10 @@ void laik_aseq_addRBufCopy(Laik_ActionSeq* as, int round,
                            int fromBufID, unsigned int fromByteOffset,
                            char* toBuf, unsigned int count)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_RBufCopy;
+    Laik_A_RBufCopy* a;
+    a = (Laik_A_RBufCopy*) laik_aseq_addAction(as, sizeof(*a),
+                                               LAIK_AT_RBufCopy, round,
+                                               as->currentTID);
     a->bufID = fromBufID;
     a->offset = fromByteOffset;
     a->toBuf = toBuf;
@@ -365,9 +577,10 @@ void laik_aseq_addBufCopy(Laik_ActionSeq* as, int round,
 {
     assert(fromBuf != toBuf);
 
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_BufCopy;
+    Laik_A_BufCopy* a;
+    a = (Laik_A_BufCopy*) laik_aseq_addAction(as, sizeof(*a),
+                                              LAIK_AT_BufCopy, round,
+                                              as->currentTID);
     a->fromBuf = fromBuf;
     a->toBuf = toBuf;
     a->count = count;
@@ -379,13 +592,14 @@ void laik_aseq_addMapSend(Laik_ActionSeq* as, int round,
                           int fromMapNo, unsigned int off,
                           unsigned int count, int to)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_MapSend;
+    Laik_A_MapSend* a;
+    a = (Laik_A_MapSend*) laik_aseq_addAction(as, sizeof(*a),
+                                              LAIK_AT_MapSend, round,
+                                              as->currentTID);
     a->fromMapNo = fromMapNo;
     a->offset = off;
     a->count = count;
-    a->rank = to;
+    a->to_rank = to;
 }
 
 // append send action from a buffer
@@ -394,7 +608,8 @@ void laik_aseq_addBufSend(Laik_ActionSeq* as, int round,
 {
     Laik_A_BufSend* a;
     a = (Laik_A_BufSend*) laik_aseq_addAction(as, sizeof(*a),
-                                              LAIK_AT_BufSend, round, 0);
+                                              LAIK_AT_BufSend, round,
+                                              as->currentTID);
     a->buf = fromBuf;
     a->count = count;
     a->to_rank = to;
@@ -405,13 +620,14 @@ void laik_aseq_addMapRecv(Laik_ActionSeq* as, int round,
                           int toMapNo, unsigned int off,
                           unsigned int count, int from)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_MapRecv;
+    Laik_A_MapRecv* a;
+    a = (Laik_A_MapRecv*) laik_aseq_addAction(as, sizeof(*a),
+                                              LAIK_AT_MapRecv, round,
+                                              as->currentTID);
     a->toMapNo = toMapNo;
     a->offset = off;
     a->count = count;
-    a->rank = from;
+    a->from_rank = from;
 }
 
 // append recv action into a buffer
@@ -420,7 +636,8 @@ void laik_aseq_addBufRecv(Laik_ActionSeq* as, int round,
 {
     Laik_A_BufRecv* a;
     a = (Laik_A_BufRecv*) laik_aseq_addAction(as, sizeof(*a),
-                                              LAIK_AT_BufRecv, round, 0);
+                                              LAIK_AT_BufRecv, round,
+                                              as->currentTID);
     a->buf = toBuf;
     a->count = count;
     a->from_rank = from;
@@ -429,14 +646,16 @@ void laik_aseq_addBufRecv(Laik_ActionSeq* as, int round,
 void laik_aseq_addPackAndSend(Laik_ActionSeq* as, int round,
                               Laik_Mapping* fromMap, Laik_Slice* slc, int to)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_PackAndSend* a;
+    a = (Laik_A_PackAndSend*) laik_aseq_addAction(as, sizeof(*a),
+                                                  LAIK_AT_PackAndSend, round,
+                                                  as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_PackAndSend;
     a->map = fromMap;
     a->slc = slc;
-    a->rank = to;
+    a->to_rank = to;
     assert(count < (UINT64_C(1) <<32));
     a->count = (unsigned int) count;
 }
@@ -445,11 +664,13 @@ void laik_aseq_addPackToRBuf(Laik_ActionSeq* as, int round,
                              Laik_Mapping* fromMap, Laik_Slice* slc,
                              int toBufID, unsigned int toByteOffset)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_PackToRBuf* a;
+    a = (Laik_A_PackToRBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                 LAIK_AT_PackToRBuf, round,
+                                                 as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_PackToRBuf;
     a->map = fromMap;
     a->slc = slc;
     a->bufID = toBufID;
@@ -461,11 +682,13 @@ void laik_aseq_addPackToRBuf(Laik_ActionSeq* as, int round,
 void laik_aseq_addPackToBuf(Laik_ActionSeq* as, int round,
                             Laik_Mapping* fromMap, Laik_Slice* slc, char* toBuf)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_PackToBuf* a;
+    a = (Laik_A_PackToBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                LAIK_AT_PackToBuf, round,
+                                                as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_PackToBuf;
     a->map = fromMap;
     a->slc = slc;
     a->toBuf = toBuf;
@@ -479,7 +702,7 @@ void laik_aseq_addMapPackAndSend(Laik_ActionSeq* as, int round,
     Laik_A_MapPackAndSend* a;
     a = (Laik_A_MapPackAndSend*) laik_aseq_addAction(as, sizeof(*a),
                                                      LAIK_AT_MapPackAndSend,
-                                                     round, 0);
+                                                     round, as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
@@ -494,11 +717,13 @@ void laik_aseq_addMapPackToRBuf(Laik_ActionSeq* as, int round,
                                 int fromMapNo, Laik_Slice* slc,
                                 int toBufID, unsigned int toByteOffset)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_MapPackToRBuf* a;
+    a = (Laik_A_MapPackToRBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                    LAIK_AT_MapPackToRBuf, round,
+                                                    as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_MapPackToRBuf;
     a->fromMapNo = fromMapNo;
     a->slc = slc;
     a->bufID = toBufID;
@@ -510,11 +735,13 @@ void laik_aseq_addMapPackToRBuf(Laik_ActionSeq* as, int round,
 void laik_aseq_addMapPackToBuf(Laik_ActionSeq* as, int round,
                                int fromMapNo, Laik_Slice* slc, char* toBuf)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_MapPackToBuf* a;
+    a = (Laik_A_MapPackToBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                   LAIK_AT_MapPackToBuf, round,
+                                                   as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_MapPackToBuf;
     a->fromMapNo = fromMapNo;
     a->slc = slc;
     a->toBuf = toBuf;
@@ -525,14 +752,16 @@ void laik_aseq_addMapPackToBuf(Laik_ActionSeq* as, int round,
 void laik_aseq_addRecvAndUnpack(Laik_ActionSeq* as, int round,
                                 Laik_Mapping* toMap, Laik_Slice* slc, int from)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_RecvAndUnpack* a;
+    a = (Laik_A_RecvAndUnpack*) laik_aseq_addAction(as, sizeof(*a),
+                                                    LAIK_AT_RecvAndUnpack, round,
+                                                    as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_RecvAndUnpack;
     a->map = toMap;
     a->slc = slc;
-    a->rank = from;
+    a->from_rank = from;
     assert(count < (UINT64_C(1)<<32));
     a->count = (unsigned int) count;
 }
@@ -541,11 +770,13 @@ void laik_aseq_addUnpackFromRBuf(Laik_ActionSeq* as, int round,
                                  int fromBufID, unsigned int fromByteOffset,
                                  Laik_Mapping* toMap, Laik_Slice* slc)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_UnpackFromRBuf* a;
+    a = (Laik_A_UnpackFromRBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                     LAIK_AT_UnpackFromRBuf, round,
+                                                     as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_UnpackFromRBuf;
     a->bufID = fromBufID;
     a->offset = fromByteOffset;
     a->map = toMap;
@@ -557,11 +788,13 @@ void laik_aseq_addUnpackFromRBuf(Laik_ActionSeq* as, int round,
 void laik_aseq_addUnpackFromBuf(Laik_ActionSeq* as, int round,
                                 char* fromBuf, Laik_Mapping* toMap, Laik_Slice* slc)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_UnpackFromBuf* a;
+    a = (Laik_A_UnpackFromBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                    LAIK_AT_UnpackFromBuf, round,
+                                                    as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_UnpackFromBuf;
     a->fromBuf = fromBuf;
     a->map = toMap;
     a->slc = slc;
@@ -575,7 +808,7 @@ void laik_aseq_addMapRecvAndUnpack(Laik_ActionSeq* as, int round,
     Laik_A_MapRecvAndUnpack* a;
     a = (Laik_A_MapRecvAndUnpack*) laik_aseq_addAction(as, sizeof(*a),
                                                        LAIK_AT_MapRecvAndUnpack,
-                                                       round, 0);
+                                                       round, as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
@@ -590,11 +823,13 @@ void laik_aseq_addMapUnpackFromRBuf(Laik_ActionSeq* as, int round,
                                     int fromBufID, unsigned int fromByteOffset,
                                     int toMapNo, Laik_Slice* slc)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_MapUnpackFromRBuf* a;
+    a = (Laik_A_MapUnpackFromRBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                        LAIK_AT_MapUnpackFromRBuf, round,
+                                                        as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_MapUnpackFromRBuf;
     a->bufID = fromBufID;
     a->offset = fromByteOffset;
     a->toMapNo = toMapNo;
@@ -606,11 +841,13 @@ void laik_aseq_addMapUnpackFromRBuf(Laik_ActionSeq* as, int round,
 void laik_aseq_addMapUnpackFromBuf(Laik_ActionSeq* as, int round,
                                    char* fromBuf, int toMapNo, Laik_Slice* slc)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_MapUnpackFromBuf* a;
+    a = (Laik_A_MapUnpackFromBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                       LAIK_AT_MapUnpackFromBuf, round,
+                                                       as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_MapUnpackFromBuf;
     a->fromBuf = fromBuf;
     a->toMapNo = toMapNo;
     a->slc = slc;
@@ -623,14 +860,16 @@ void laik_aseq_addReduce(Laik_ActionSeq* as, int round,
                          char* fromBuf, char* toBuf, unsigned int count,
                          int rootTask, Laik_ReductionOperation redOp)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_Reduce* a;
+    a = (Laik_A_Reduce*) laik_aseq_addAction(as, sizeof(*a),
+                                             LAIK_AT_Reduce, round,
+                                             as->currentTID);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_Reduce;
     a->fromBuf = fromBuf;
     a->toBuf = toBuf;
     a->count = count;
-    a->rank = rootTask;
+    a->rootTask = rootTask;
     a->redOp = redOp;
 }
 
@@ -638,14 +877,16 @@ void laik_aseq_addRBufReduce(Laik_ActionSeq* as, int round,
                              int bufID, unsigned int byteOffset, unsigned int count,
                              int rootTask, Laik_ReductionOperation redOp)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_RBufReduce* a;
+    a = (Laik_A_RBufReduce*) laik_aseq_addAction(as, sizeof(*a),
+                                                 LAIK_AT_RBufReduce, round,
+                                                 as->currentTID);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_RBufReduce;
     a->bufID = bufID;
     a->offset = byteOffset;
     a->count = count;
-    a->rank = rootTask;
+    a->rootTask = rootTask;
     a->redOp = redOp;
 }
 
@@ -655,11 +896,13 @@ void laik_aseq_addMapGroupReduce(Laik_ActionSeq* as, int round,
                                  int myInputMapNo, int myOutputMapNo,
                                  Laik_Slice* slc, Laik_ReductionOperation redOp)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_MapGroupReduce* a;
+    a = (Laik_A_MapGroupReduce*) laik_aseq_addAction(as, sizeof(*a),
+                                                     LAIK_AT_MapGroupReduce, round,
+                                                     as->currentTID);
     uint64_t count = laik_slice_size(slc);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_MapGroupReduce;
     a->inputGroup = inputGroup;
     a->outputGroup = outputGroup;
     a->fromMapNo = myInputMapNo;
@@ -676,10 +919,12 @@ void laik_aseq_addGroupReduce(Laik_ActionSeq* as, int round,
                               char* fromBuf, char* toBuf, unsigned int count,
                               Laik_ReductionOperation redOp)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_GroupReduce* a;
+    a = (Laik_A_GroupReduce*) laik_aseq_addAction(as, sizeof(*a),
+                                                  LAIK_AT_GroupReduce, round,
+                                                  as->currentTID);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_GroupReduce;
     a->inputGroup = inputGroup;
     a->outputGroup = outputGroup;
     a->fromBuf = fromBuf;
@@ -695,10 +940,12 @@ void laik_aseq_addRBufGroupReduce(Laik_ActionSeq* as, int round,
                                   unsigned int count,
                                   Laik_ReductionOperation redOp)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
+    Laik_A_RBufGroupReduce* a;
+    a = (Laik_A_RBufGroupReduce*) laik_aseq_addAction(as, sizeof(*a),
+                                                      LAIK_AT_RBufGroupReduce, round,
+                                                      as->currentTID);
     assert(count > 0);
 
-    a->h.type = LAIK_AT_RBufGroupReduce;
     a->inputGroup = inputGroup;
     a->outputGroup = outputGroup;
     a->bufID = bufID;
@@ -712,9 +959,10 @@ void laik_aseq_addRBufGroupReduce(Laik_ActionSeq* as, int round,
 void laik_aseq_addCopyToBuf(Laik_ActionSeq* as, int round,
                             Laik_CopyEntry* ce, char* toBuf, unsigned int count)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_CopyToBuf;
+    Laik_A_CopyToBuf* a;
+    a = (Laik_A_CopyToBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                LAIK_AT_CopyToBuf, round,
+                                                as->currentTID);
     a->ce = ce;
     a->toBuf = toBuf;
     a->count = count;
@@ -723,9 +971,10 @@ void laik_aseq_addCopyToBuf(Laik_ActionSeq* as, int round,
 void laik_aseq_addCopyFromBuf(Laik_ActionSeq* as, int round,
                               Laik_CopyEntry* ce, char* fromBuf, unsigned int count)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_CopyFromBuf;
+    Laik_A_CopyFromBuf* a;
+    a = (Laik_A_CopyFromBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                  LAIK_AT_CopyFromBuf, round,
+                                                  as->currentTID);
     a->ce = ce;
     a->fromBuf = fromBuf;
     a->count = count;
@@ -736,14 +985,14 @@ void laik_aseq_addCopyToRBuf(Laik_ActionSeq* as, int round,
                              int toBufID, unsigned int toByteOffset,
                              unsigned int count)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_CopyToRBuf;
+    Laik_A_CopyToRBuf* a;
+    a = (Laik_A_CopyToRBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                 LAIK_AT_CopyToRBuf, round,
+                                                 as->currentTID);
     a->ce = ce;
     a->bufID = toBufID;
     a->offset = toByteOffset;
     a->count = count;
-
 }
 
 void laik_aseq_addCopyFromRBuf(Laik_ActionSeq* as, int round,
@@ -751,9 +1000,10 @@ void laik_aseq_addCopyFromRBuf(Laik_ActionSeq* as, int round,
                                int fromBufID, unsigned int fromByteOffset,
                                unsigned int count)
 {
-    Laik_BackendAction* a = laik_aseq_addBAction(as, round);
-
-    a->h.type = LAIK_AT_CopyFromRBuf;
+    Laik_A_CopyFromRBuf* a;
+    a = (Laik_A_CopyFromRBuf*) laik_aseq_addAction(as, sizeof(*a),
+                                                   LAIK_AT_CopyFromRBuf, round,
+                                                   as->currentTID);
     a->ce = ce;
     a->bufID = fromBufID;
     a->offset = fromByteOffset;
@@ -786,12 +1036,100 @@ bool laik_action_isRecv(Laik_Action* a)
     return false;
 }
 
+// size of the struct used for backend-independent action type <type>
+// returns 0 for unknown (ie. backend-specific) types
+unsigned int laik_action_size(int type)
+{
+    switch(type) {
+    case LAIK_At_Halt:
+    case LAIK_AT_Nop:
+    case LAIK_AT_TExec:              return sizeof(Laik_Action);
+    case LAIK_AT_BufReserve:         return sizeof(Laik_A_BufReserve);
+    case LAIK_AT_MapSend:            return sizeof(Laik_A_MapSend);
+    case LAIK_AT_BufSend:            return sizeof(Laik_A_BufSend);
+    case LAIK_AT_RBufSend:           return sizeof(Laik_A_RBufSend);
+    case LAIK_AT_MapRecv:            return sizeof(Laik_A_MapRecv);
+    case LAIK_AT_BufRecv:            return sizeof(Laik_A_BufRecv);
+    case LAIK_AT_RBufRecv:           return sizeof(Laik_A_RBufRecv);
+    case LAIK_AT_RBufLocalReduce:    return sizeof(Laik_A_RBufLocalReduce);
+    case LAIK_AT_BufInit:            return sizeof(Laik_A_BufInit);
+    case LAIK_AT_CopyFromBuf:        return sizeof(Laik_A_CopyFromBuf);
+    case LAIK_AT_CopyToBuf:          return sizeof(Laik_A_CopyToBuf);
+    case LAIK_AT_CopyFromRBuf:       return sizeof(Laik_A_CopyFromRBuf);
+    case LAIK_AT_CopyToRBuf:         return sizeof(Laik_A_CopyToRBuf);
+    case LAIK_AT_MapPackAndSend:     return sizeof(Laik_A_MapPackAndSend);
+    case LAIK_AT_PackAndSend:        return sizeof(Laik_A_PackAndSend);
+    case LAIK_AT_MapPackToRBuf:      return sizeof(Laik_A_MapPackToRBuf);
+    case LAIK_AT_PackToRBuf:         return sizeof(Laik_A_PackToRBuf);
+    case LAIK_AT_MapPackToBuf:       return sizeof(Laik_A_MapPackToBuf);
+    case LAIK_AT_PackToBuf:          return sizeof(Laik_A_PackToBuf);
+    case LAIK_AT_MapRecvAndUnpack:   return sizeof(Laik_A_MapRecvAndUnpack);
+    case LAIK_AT_RecvAndUnpack:      return sizeof(Laik_A_RecvAndUnpack);
+    case LAIK_AT_MapUnpackFromRBuf:  return sizeof(Laik_A_MapUnpackFromRBuf);
+    case LAIK_AT_UnpackFromRBuf:     return sizeof(Laik_A_UnpackFromRBuf);
+    case LAIK_AT_MapUnpackFromBuf:   return sizeof(Laik_A_MapUnpackFromBuf);
+    case LAIK_AT_UnpackFromBuf:      return sizeof(Laik_A_UnpackFromBuf);
+    case LAIK_AT_Reduce:             return sizeof(Laik_A_Reduce);
+    case LAIK_AT_RBufReduce:         return sizeof(Laik_A_RBufReduce);
+    case LAIK_AT_MapGroupReduce:     return sizeof(Laik_A_MapGroupReduce);
+    case LAIK_AT_GroupReduce:        return sizeof(Laik_A_GroupReduce);
+    case LAIK_AT_RBufGroupReduce:    return sizeof(Laik_A_RBufGroupReduce);
+    case LAIK_AT_BufCopy:            return sizeof(Laik_A_BufCopy);
+    case LAIK_AT_RBufCopy:           return sizeof(Laik_A_RBufCopy);
+    default: break;
+    }
+    return 0;
+}
+
+// element count of a backend-independent action (number of copy
+// ranges for CopyTo/From actions), 0 if action has no count
+unsigned int laik_action_count(Laik_Action* a)
+{
+    switch(a->type) {
+#define ACOUNT(T) return ((T*) a)->count
+    case LAIK_AT_MapSend:            ACOUNT(Laik_A_MapSend);
+    case LAIK_AT_BufSend:            ACOUNT(Laik_A_BufSend);
+    case LAIK_AT_RBufSend:           ACOUNT(Laik_A_RBufSend);
+    case LAIK_AT_MapRecv:            ACOUNT(Laik_A_MapRecv);
+    case LAIK_AT_BufRecv:            ACOUNT(Laik_A_BufRecv);
+    case LAIK_AT_RBufRecv:           ACOUNT(Laik_A_RBufRecv);
+    case LAIK_AT_RBufLocalReduce:    ACOUNT(Laik_A_RBufLocalReduce);
+    case LAIK_AT_BufInit:            ACOUNT(Laik_A_BufInit);
+    case LAIK_AT_CopyFromBuf:        ACOUNT(Laik_A_CopyFromBuf);
+    case LAIK_AT_CopyToBuf:          ACOUNT(Laik_A_CopyToBuf);
+    case LAIK_AT_CopyFromRBuf:       ACOUNT(Laik_A_CopyFromRBuf);
+    case LAIK_AT_CopyToRBuf:         ACOUNT(Laik_A_CopyToRBuf);
+    case LAIK_AT_MapPackAndSend:     ACOUNT(Laik_A_MapPackAndSend);
+    case LAIK_AT_PackAndSend:        ACOUNT(Laik_A_PackAndSend);
+    case LAIK_AT_MapPackToRBuf:      ACOUNT(Laik_A_MapPackToRBuf);
+    case LAIK_AT_PackToRBuf:         ACOUNT(Laik_A_PackToRBuf);
+    case LAIK_AT_MapPackToBuf:       ACOUNT(Laik_A_MapPackToBuf);
+    case LAIK_AT_PackToBuf:          ACOUNT(Laik_A_PackToBuf);
+    case LAIK_AT_MapRecvAndUnpack:   ACOUNT(Laik_A_MapRecvAndUnpack);
+    case LAIK_AT_RecvAndUnpack:      ACOUNT(Laik_A_RecvAndUnpack);
+    case LAIK_AT_MapUnpackFromRBuf:  ACOUNT(Laik_A_MapUnpackFromRBuf);
+    case LAIK_AT_UnpackFromRBuf:     ACOUNT(Laik_A_UnpackFromRBuf);
+    case LAIK_AT_MapUnpackFromBuf:   ACOUNT(Laik_A_MapUnpackFromBuf);
+    case LAIK_AT_UnpackFromBuf:      ACOUNT(Laik_A_UnpackFromBuf);
+    case LAIK_AT_Reduce:             ACOUNT(Laik_A_Reduce);
+    case LAIK_AT_RBufReduce:         ACOUNT(Laik_A_RBufReduce);
+    case LAIK_AT_MapGroupReduce:     ACOUNT(Laik_A_MapGroupReduce);
+    case LAIK_AT_GroupReduce:        ACOUNT(Laik_A_GroupReduce);
+    case LAIK_AT_RBufGroupReduce:    ACOUNT(Laik_A_RBufGroupReduce);
+    case LAIK_AT_BufCopy:            ACOUNT(Laik_A_BufCopy);
+    case LAIK_AT_RBufCopy:           ACOUNT(Laik_A_RBufCopy);
+#undef ACOUNT
+    default: break;
+    }
+    return 0;
+}
+
 
 // add all reduce ops from a transition to an ActionSeq.
 void laik_aseq_addReds(Laik_ActionSeq* as, int round,
                        Laik_Data* data, Laik_Transition* t)
 {
-    Laik_TransitionContext* tc = as->context[0];
+    Laik_TransitionContext* tc = as->context[as->currentTID];
     assert(tc->data == data);
     assert(tc->transition == t);
     assert(t->group->myid >= 0);
@@ -810,7 +1148,7 @@ void laik_aseq_addReds(Laik_ActionSeq* as, int round,
 void laik_aseq_addRecvs(Laik_ActionSeq* as, int round,
                         Laik_Data* data, Laik_Transition* t)
 {
-    Laik_TransitionContext* tc = as->context[0];
+    Laik_TransitionContext* tc = as->context[as->currentTID];
     assert(tc->data == data);
     assert(tc->transition == t);
     assert(t->group->myid >= 0);
@@ -827,7 +1165,7 @@ void laik_aseq_addRecvs(Laik_ActionSeq* as, int round,
 void laik_aseq_addSends(Laik_ActionSeq* as, int round,
                         Laik_Data* data, Laik_Transition* t)
 {
-    Laik_TransitionContext* tc = as->context[0];
+    Laik_TransitionContext* tc = as->context[as->currentTID];
     assert(tc->data == data);
     assert(tc->transition == t);
     assert(t->group->myid >= 0);
@@ -841,36 +1179,32 @@ void laik_aseq_addSends(Laik_ActionSeq* as, int round,
 
 // collect buffer reservation actions and update actions referencing them
 // works in-place; BufReserve actions are marked as NOP but not removed
-// can be called ASEQ_BUFFER_MAX times, allocating a new buffer on each call
+// can be called multiple times, allocating a new buffer on each call
 bool laik_aseq_allocBuffer(Laik_ActionSeq* as)
 {
     unsigned int rCount = 0, rActions = 0;
-    assert(as->bufferCount < ASEQ_BUFFER_MAX);
-    assert(as->buf[as->bufferCount] == 0); // nothing allocated yet
+    assert(as->bufferCount < ASEQ_RBUF_FIRSTID);
+    assert(!as->bufReturned);
 
     Laik_TransitionContext* tc = as->context[0];
-    unsigned int elemsize = tc->data->elemsize;
 
     Laik_A_BufReserve** resAction;
     resAction = malloc(as->bufReserveCount * sizeof(Laik_A_BufReserve*));
     for(unsigned int i = 0; i < as->bufReserveCount; i++)
-        resAction[i] = 0; // reservation not seen yet for ID (i-100)
+        resAction[i] = 0; // reservation not seen yet for ID (i+FIRSTID)
 
     unsigned int bufSize = 0;
     Laik_Action* a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
-        Laik_BackendAction* ba = (Laik_BackendAction*) a;
-
         switch(a->type) {
         case LAIK_AT_BufReserve: {
             Laik_A_BufReserve* aa = (Laik_A_BufReserve*) a;
             // reservation already processed and allocated
-            if (aa->bufID < ASEQ_BUFFER_MAX) break;
+            if (aa->bufID < ASEQ_RBUF_FIRSTID) break;
 
             aa->offset = bufSize;
-            assert(aa->bufID >= 100);
-            assert(aa->bufID < (int)(100 + as->bufReserveCount));
-            resAction[aa->bufID - 100] = aa;
+            assert(aa->bufID < (int)(ASEQ_RBUF_FIRSTID + as->bufReserveCount));
+            resAction[aa->bufID - ASEQ_RBUF_FIRSTID] = aa;
             aa->bufID = as->bufferCount; // mark as processed
             bufSize += aa->size;
             rCount++;
@@ -894,41 +1228,35 @@ bool laik_aseq_allocBuffer(Laik_ActionSeq* as)
             unsigned int* pOffset = 0;
             unsigned int count = 0;
             switch(a->type) {
-            case LAIK_AT_RBufSend:
-                pBufID  = &( ((Laik_A_RBufSend*) a)->bufID );
-                pOffset = &( ((Laik_A_RBufSend*) a)->offset);
-                count   =    ((Laik_A_RBufSend*) a)->count;
-                break;
-            case LAIK_AT_RBufRecv:
-                pBufID  = &( ((Laik_A_RBufRecv*) a)->bufID );
-                pOffset = &( ((Laik_A_RBufRecv*) a)->offset);
-                count   =    ((Laik_A_RBufRecv*) a)->count;
-                break;
-            case LAIK_AT_RBufCopy:
-            case LAIK_AT_RBufLocalReduce:
-            case LAIK_AT_RBufReduce:
-            case LAIK_AT_PackToRBuf:
-            case LAIK_AT_UnpackFromRBuf:
-            case LAIK_AT_MapPackToRBuf:
-            case LAIK_AT_MapUnpackFromRBuf:
-            case LAIK_AT_CopyFromRBuf:
-            case LAIK_AT_CopyToRBuf:
-            case LAIK_AT_RBufGroupReduce:
-                pBufID  = &( ba->bufID );
-                pOffset = &( ba->offset);
-                count   =    ba->count;
-                break;
+#define RBUF_REF(T) \
+                pBufID  = &( ((T*) a)->bufID ); \
+                pOffset = &( ((T*) a)->offset); \
+                count   =    ((T*) a)->count; \
+                break
+            case LAIK_AT_RBufSend:           RBUF_REF(Laik_A_RBufSend);
+            case LAIK_AT_RBufRecv:           RBUF_REF(Laik_A_RBufRecv);
+            case LAIK_AT_RBufCopy:           RBUF_REF(Laik_A_RBufCopy);
+            case LAIK_AT_RBufLocalReduce:    RBUF_REF(Laik_A_RBufLocalReduce);
+            case LAIK_AT_RBufReduce:         RBUF_REF(Laik_A_RBufReduce);
+            case LAIK_AT_PackToRBuf:         RBUF_REF(Laik_A_PackToRBuf);
+            case LAIK_AT_UnpackFromRBuf:     RBUF_REF(Laik_A_UnpackFromRBuf);
+            case LAIK_AT_MapPackToRBuf:      RBUF_REF(Laik_A_MapPackToRBuf);
+            case LAIK_AT_MapUnpackFromRBuf:  RBUF_REF(Laik_A_MapUnpackFromRBuf);
+            case LAIK_AT_CopyFromRBuf:       RBUF_REF(Laik_A_CopyFromRBuf);
+            case LAIK_AT_CopyToRBuf:         RBUF_REF(Laik_A_CopyToRBuf);
+            case LAIK_AT_RBufGroupReduce:    RBUF_REF(Laik_A_RBufGroupReduce);
+#undef RBUF_REF
             default: assert(0);
             }
 
             // action with allocated reservation
-            if (*pBufID < ASEQ_BUFFER_MAX) break;
+            if (*pBufID < ASEQ_RBUF_FIRSTID) break;
 
-            assert(*pBufID >= 100);
-            assert(*pBufID < (int)(100 + as->bufReserveCount));
-            Laik_A_BufReserve* ra = resAction[*pBufID - 100];
+            assert(*pBufID < (int)(ASEQ_RBUF_FIRSTID + as->bufReserveCount));
+            Laik_A_BufReserve* ra = resAction[*pBufID - ASEQ_RBUF_FIRSTID];
             assert(ra != 0);
             assert(count > 0);
+            unsigned int elemsize = actionContext(as, a)->data->elemsize;
             assert(*pOffset + (uint64_t)(count * elemsize) <= (uint64_t) ra->size);
 
             *pOffset += ra->offset;
@@ -948,8 +1276,17 @@ bool laik_aseq_allocBuffer(Laik_ActionSeq* as)
         return false;
     }
 
-    char* buf = malloc(bufSize);
-    assert(buf != 0);
+    if (as->bufferCount == as->bufferCapacity) {
+        as->bufferCapacity = (as->bufferCapacity + 2) * 2;
+        as->buf = realloc(as->buf, as->bufferCapacity * sizeof(char*));
+        as->bufSize = realloc(as->bufSize,
+                              as->bufferCapacity * sizeof(size_t));
+        if (!as->buf || !as->bufSize) {
+            laik_panic("Out of memory allocating buffer list of action seq");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+    }
+    char* buf = laik_bufpool_get(as->inst, bufSize);
 
     // update allocation statistics
     laik_switchstat_malloc(tc->data->stat, bufSize);
@@ -957,7 +1294,7 @@ bool laik_aseq_allocBuffer(Laik_ActionSeq* as)
     // substitute RBuf actions, now that buffer allocation is known
     a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
-        Laik_BackendAction* ba = (Laik_BackendAction*) a;
+        as->currentTID = a->tid;
         switch(a->type) {
         case LAIK_AT_BufReserve:
             // BufReserve actions processed, can be removed
@@ -976,49 +1313,65 @@ bool laik_aseq_allocBuffer(Laik_ActionSeq* as)
                                  buf + aa->offset, aa->count, aa->from_rank);
             break;
         }
-        case LAIK_AT_PackToRBuf:
+        case LAIK_AT_PackToRBuf: {
             // replace PackToRBuf with PackToBuf action
+            Laik_A_PackToRBuf* aa = (Laik_A_PackToRBuf*) a;
             laik_aseq_addPackToBuf(as, a->round,
-                                   ba->map, ba->slc, buf + ba->offset);
+                                   aa->map, aa->slc, buf + aa->offset);
             break;
-        case LAIK_AT_UnpackFromRBuf:
+        }
+        case LAIK_AT_UnpackFromRBuf: {
             // replace UnpackFromRBuf to UnpackFromBuf
+            Laik_A_UnpackFromRBuf* aa = (Laik_A_UnpackFromRBuf*) a;
             laik_aseq_addUnpackFromBuf(as, a->round,
-                                       buf + ba->offset, ba->map, ba->slc);
+                                       buf + aa->offset, aa->map, aa->slc);
             break;
-        case LAIK_AT_MapPackToRBuf:
+        }
+        case LAIK_AT_MapPackToRBuf: {
             // replace MapPackToRBuf with MapPackToBuf action
+            Laik_A_MapPackToRBuf* aa = (Laik_A_MapPackToRBuf*) a;
             laik_aseq_addMapPackToBuf(as, a->round,
-                                      ba->fromMapNo, ba->slc, buf + ba->offset);
+                                      aa->fromMapNo, aa->slc, buf + aa->offset);
             break;
-        case LAIK_AT_MapUnpackFromRBuf:
+        }
+        case LAIK_AT_MapUnpackFromRBuf: {
             // replace MapUnpackFromRBuf to MapUnpackFromBuf
+            Laik_A_MapUnpackFromRBuf* aa = (Laik_A_MapUnpackFromRBuf*) a;
             laik_aseq_addMapUnpackFromBuf(as, a->round,
-                                          buf + ba->offset, ba->toMapNo, ba->slc);
+                                          buf + aa->offset, aa->toMapNo, aa->slc);
             break;
-        case LAIK_AT_CopyFromRBuf:
+        }
+        case LAIK_AT_CopyFromRBuf: {
             // replace CopyFromRBuf with CopyFromBuf
+            Laik_A_CopyFromRBuf* aa = (Laik_A_CopyFromRBuf*) a;
             laik_aseq_addCopyFromBuf(as, a->round,
-                                     ba->ce, buf + ba->offset, ba->count);
+                                     aa->ce, buf + aa->offset, aa->count);
             break;
-        case LAIK_AT_CopyToRBuf:
+        }
+        case LAIK_AT_CopyToRBuf: {
             // replace CopyToRBuf with CopyToBuf
+            Laik_A_CopyToRBuf* aa = (Laik_A_CopyToRBuf*) a;
             laik_aseq_addCopyToBuf(as, a->round,
-                                   ba->ce, buf + ba->offset, ba->count);
+                                   aa->ce, buf + aa->offset, aa->count);
             break;
-        case LAIK_AT_RBufReduce:
+        }
+        case LAIK_AT_RBufReduce: {
             // replace RBufReduce with Reduce
+            Laik_A_RBufReduce* aa = (Laik_A_RBufReduce*) a;
             laik_aseq_addReduce(as, a->round,
-                                buf + ba->offset, buf + ba->offset,
-                                ba->count, ba->rank, ba->redOp);
+                                buf + aa->offset, buf + aa->offset,
+                                aa->count, aa->rootTask, aa->redOp);
             break;
-        case LAIK_AT_RBufGroupReduce:
+        }
+        case LAIK_AT_RBufGroupReduce: {
             // replace RBufGroupReduce with GroupReduce
+            Laik_A_RBufGroupReduce* aa = (Laik_A_RBufGroupReduce*) a;
             laik_aseq_addGroupReduce(as, a->round,
-                                     ba->inputGroup, ba->outputGroup,
-                                     buf + ba->offset, buf + ba->offset,
-                                     ba->count, ba->redOp);
+                                     aa->inputGroup, aa->outputGroup,
+                                     buf + aa->offset, buf + aa->offset,
+                                     aa->count, aa->redOp);
             break;
+        }
         default:
             // pass through
             laik_aseq_add(a, as, -1);
@@ -1037,7 +1390,7 @@ bool laik_aseq_allocBuffer(Laik_ActionSeq* as)
         for(unsigned int i = 0; i < as->bufReserveCount; i++) {
             if (resAction[i] == 0) continue;
             laik_log_append("\n    RBuf %d (len %d) ==> off %d at %p",
-                            i + 100, resAction[i]->size,
+                            i + ASEQ_RBUF_FIRSTID, resAction[i]->size,
                             resAction[i]->offset,
                             (void*) (buf + resAction[i]->offset));
         }
@@ -1048,7 +1401,7 @@ bool laik_aseq_allocBuffer(Laik_ActionSeq* as)
     free(resAction);
     laik_aseq_activateNewActions(as);
 
-    // start again with bufID 100 for next reservations
+    // start again with bufID ASEQ_RBUF_FIRSTID for next reservations
     as->bufReserveCount = 0;
     as->bufferCount++;
 
@@ -1056,6 +1409,128 @@ bool laik_aseq_allocBuffer(Laik_ActionSeq* as)
 }
 
 
+// give buffers of <as> back to the pool. Actions still refer to them:
+// they are borrowed again before the next execution.
+// Buffers the pool would free are kept: their memory may be reused e.g.
+// for mappings, and pointers into it would be wrongly updated on borrowing
+void laik_aseq_returnBuffers(Laik_ActionSeq* as)
+{
+    if (as->bufReturned || (as->bufferCount == 0)) return;
+
+    Laik_BufPool* p = as->inst->bufPool;
+    if (!p->enabled) return;
+    uint64_t bytes = 0;
+    for(int i = 0; i < as->bufferCount; i++) {
+        size_t csize;
+        if (as->bufSize[i] == 0) continue;
+        bufpool_class(as->bufSize[i], &csize);
+        bytes += csize;
+    }
+    if (p->cachedBytes + bytes > p->maxCachedBytes) {
+        laik_log(1, "action seq '%s': keeping buffers (%llu bytes, pool full)",
+                 as->name, (unsigned long long) bytes);
+        return;
+    }
+
+    for(int i = 0; i < as->bufferCount; i++)
+        if (as->bufSize[i] > 0)
+            laik_bufpool_put(as->inst, as->buf[i], as->bufSize[i]);
+    as->bufReturned = true;
+}
+
+char* laik_aseq_rebasePtr(Laik_ActionSeq* as, char** newBuf, char* p)
+{
+    uintptr_t a = (uintptr_t) p;
+    for(int i = 0; i < as->bufferCount; i++) {
+        uintptr_t b = (uintptr_t) as->buf[i];
+        if ((a >= b) && (a < b + as->bufSize[i]))
+            return newBuf[i] + (a - b);
+    }
+    return p;
+}
+
+// update pointers into buffers of <as> in generic actions
+static
+void rebaseActions(Laik_ActionSeq* as, char** newBuf)
+{
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        switch(a->type) {
+#define REBASE(T, F) \
+            ((T*) a)->F = laik_aseq_rebasePtr(as, newBuf, ((T*) a)->F)
+        case LAIK_AT_BufSend:          REBASE(Laik_A_BufSend, buf); break;
+        case LAIK_AT_BufRecv:          REBASE(Laik_A_BufRecv, buf); break;
+        case LAIK_AT_PackToBuf:        REBASE(Laik_A_PackToBuf, toBuf); break;
+        case LAIK_AT_MapPackToBuf:     REBASE(Laik_A_MapPackToBuf, toBuf); break;
+        case LAIK_AT_UnpackFromBuf:    REBASE(Laik_A_UnpackFromBuf, fromBuf); break;
+        case LAIK_AT_MapUnpackFromBuf: REBASE(Laik_A_MapUnpackFromBuf, fromBuf); break;
+        case LAIK_AT_CopyToBuf: {
+            Laik_A_CopyToBuf* aa = (Laik_A_CopyToBuf*) a;
+            REBASE(Laik_A_CopyToBuf, toBuf);
+            for(unsigned int j = 0; j < aa->count; j++)
+                aa->ce[j].ptr = laik_aseq_rebasePtr(as, newBuf, aa->ce[j].ptr);
+            break;
+        }
+        case LAIK_AT_CopyFromBuf: {
+            Laik_A_CopyFromBuf* aa = (Laik_A_CopyFromBuf*) a;
+            REBASE(Laik_A_CopyFromBuf, fromBuf);
+            for(unsigned int j = 0; j < aa->count; j++)
+                aa->ce[j].ptr = laik_aseq_rebasePtr(as, newBuf, aa->ce[j].ptr);
+            break;
+        }
+        case LAIK_AT_RBufCopy:         REBASE(Laik_A_RBufCopy, toBuf); break;
+        case LAIK_AT_BufInit:          REBASE(Laik_A_BufInit, toBuf); break;
+        case LAIK_AT_RBufLocalReduce:  REBASE(Laik_A_RBufLocalReduce, toBuf); break;
+        case LAIK_AT_BufCopy:
+            REBASE(Laik_A_BufCopy, fromBuf);
+            REBASE(Laik_A_BufCopy, toBuf);
+            break;
+        case LAIK_AT_Reduce:
+            REBASE(Laik_A_Reduce, fromBuf);
+            REBASE(Laik_A_Reduce, toBuf);
+            break;
+        case LAIK_AT_GroupReduce:
+            REBASE(Laik_A_GroupReduce, fromBuf);
+            REBASE(Laik_A_GroupReduce, toBuf);
+            break;
+#undef REBASE
+        default:
+            break;
+        }
+    }
+}
+
+void laik_aseq_borrowBuffers(Laik_ActionSeq* as)
+{
+    if (!as->bufReturned) return;
+
+    char** newBuf = malloc(as->bufferCount * sizeof(char*));
+    if (!newBuf) {
+        laik_panic("Out of memory borrowing buffers of action seq");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    bool moved = false;
+    for(int i = 0; i < as->bufferCount; i++) {
+        newBuf[i] = as->buf[i];
+        if (as->bufSize[i] == 0) continue;
+        newBuf[i] = laik_bufpool_get(as->inst, as->bufSize[i]);
+        if (newBuf[i] != as->buf[i]) moved = true;
+    }
+    as->bufReturned = false;
+
+    if (moved) {
+        laik_log(1, "action seq '%s': buffers moved, updating actions",
+                 as->name);
+        rebaseActions(as, newBuf);
+        if (as->backend && as->backend->rebase)
+            (as->backend->rebase)(as, newBuf);
+        for(int i = 0; i < as->bufferCount; i++)
+            as->buf[i] = newBuf[i];
+    }
+    free(newBuf);
+}
+
+
 // append actions to <as>
 // allows to change round of added action when <round> >= 0
 void laik_aseq_add(Laik_Action* a, Laik_ActionSeq* as, int round)
@@ -1092,49 +1567,60 @@ void laik_aseq_copySeq(Laik_ActionSeq* as)
 
 // helpers for action combining
 
+// can actions <a1> and <a2> be combined into one message/reduction?
+// true for actions from same transition, but also from transitions on
+// containers with same data type (all transitions use the same group)
+static bool isSameElemType(Laik_ActionSeq* as, Laik_Action* a1, Laik_Action* a2)
+{
+    if (a1->tid == a2->tid) return true;
+    return actionContext(as, a1)->data->type == actionContext(as, a2)->data->type;
+}
+
 // check that <a> is a BufSend action with same round and peer rank as <bsa>
-static bool isSameBufSend(Laik_A_BufSend* bsa, Laik_Action* a)
+static bool isSameBufSend(Laik_ActionSeq* as, Laik_A_BufSend* bsa, Laik_Action* a)
 {
     assert(bsa->h.type == LAIK_AT_BufSend);
     if (a->type != LAIK_AT_BufSend) return false;
     if (a->round != bsa->h.round) return false;
     if ( ((Laik_A_BufSend*)a)->to_rank != bsa->to_rank) return false;
-    return true;
+    return isSameElemType(as, (Laik_Action*) bsa, a);
 }
 
 // check that <a> is a BufRecv action with same round and peer rank as <bra>
-static bool isSameBufRecv(Laik_A_BufRecv* bra, Laik_Action* a)
+static bool isSameBufRecv(Laik_ActionSeq* as, Laik_A_BufRecv* bra, Laik_Action* a)
 {
     assert(bra->h.type == LAIK_AT_BufRecv);
     if (a->type != LAIK_AT_BufRecv) return false;
     if (a->round != bra->h.round) return false;
     if ( ((Laik_A_BufRecv*)a)->from_rank != bra->from_rank) return false;
-    return true;
+    return isSameElemType(as, (Laik_Action*) bra, a);
 }
 
-static bool isSameGroupReduce(Laik_BackendAction* ba, Laik_Action* a)
+// subgroup IDs are specific to a transition: only combine within one
+static bool isSameGroupReduce(Laik_A_GroupReduce* ba, Laik_Action* a)
 {
     assert(ba->h.type == LAIK_AT_GroupReduce);
     if (a->type != LAIK_AT_GroupReduce) return false;
     if (a->round != ba->h.round) return false;
+    if (a->tid != ba->h.tid) return false;
 
-    Laik_BackendAction* ba2 = (Laik_BackendAction*) a;
+    Laik_A_GroupReduce* ba2 = (Laik_A_GroupReduce*) a;
     if (ba2->inputGroup != ba->inputGroup) return false;
     if (ba2->outputGroup != ba->outputGroup) return false;
     if (ba2->redOp != ba->redOp) return false;
     return true;
 }
 
-static bool isSameReduce(Laik_BackendAction* ba, Laik_Action* a)
+static bool isSameReduce(Laik_ActionSeq* as, Laik_A_Reduce* ba, Laik_Action* a)
 {
     assert(ba->h.type == LAIK_AT_Reduce);
     if (a->type != LAIK_AT_Reduce) return false;
     if (a->round != ba->h.round) return false;
 
-    Laik_BackendAction* ba2 = (Laik_BackendAction*) a;
-    if (ba2->rank != ba->rank) return false;
+    Laik_A_Reduce* ba2 = (Laik_A_Reduce*) a;
+    if (ba2->rootTask != ba->rootTask) return false;
     if (ba2->redOp != ba->redOp) return false;
-    return true;
+    return isSameElemType(as, (Laik_Action*) ba, a);
 }
 
 
@@ -1154,6 +1640,10 @@ static bool isSameReduce(Laik_BackendAction* ba, Laik_Action* a)
  * Action round numbers are spreaded by *3+1, allowing space for added
  * combine/split copy actions before/after.
  *
+ * Actions from different transitions in the sequence are merged if the
+ * containers use the same data type, reducing the number of messages
+ * between a pair of processes for transitions done together.
+ *
  * This merge transformation is easy to see in LAIK_LOG=1 output of the
  * "the markov2 -f ..." test.
  *
@@ -1169,9 +1659,8 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
     // must not have new actions, we want to start a new build
     assert(as->newActionCount == 0);
 
+    // all transitions are within same group
     Laik_TransitionContext* tc = as->context[0];
-    Laik_Data* d = tc->data;
-    unsigned int elemsize = d->elemsize;
     // used for combining GroupReduce actions
     int myid = tc->transition->group->myid;
 
@@ -1181,13 +1670,16 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a))
         a->mark = 0;
 
-    // first pass: how much buffer space / copy range elements is needed?
+    // first pass: how much buffer space (in bytes) / copy range elements is needed?
     unsigned int bufSize = 0, copyRanges = 0;
     a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
         // skip already combined actions
         if (a->mark == 1) continue;
 
+        tc = actionContext(as, a);
+        unsigned int elemsize = tc->data->elemsize;
+
         switch(a->type) {
         case LAIK_AT_BufSend: {
             // combine all BufSend actions in same round with same target rank
@@ -1196,14 +1688,14 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
             unsigned int actionCount = 0;
             Laik_Action* a2 = a;
             for(unsigned int j = i; j < as->actionCount; j++, a2 = nextAction(a2)) {
-                if (!isSameBufSend(bsa, a2)) continue;
+                if (!isSameBufSend(as, bsa, a2)) continue;
 
                 a2->mark = 1;
                 countSum += ((Laik_A_BufSend*)a2)->count;
                 actionCount++;
             }
             if (actionCount > 1) {
-                bufSize += countSum;
+                bufSize += countSum * elemsize;
                 copyRanges += actionCount;
             }
             break;
@@ -1216,14 +1708,14 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
             unsigned int actionCount = 0;
             Laik_Action* a2 = a;
             for(unsigned int j = i; j < as->actionCount; j++, a2 = nextAction(a2)) {
-                if (!isSameBufRecv(bra, a2)) continue;
+                if (!isSameBufRecv(as, bra, a2)) continue;
 
                 a2->mark = 1;
                 countSum += ((Laik_A_BufRecv*)a2)->count;
                 actionCount++;
             }
             if (actionCount > 1) {
-                bufSize += countSum;
+                bufSize += countSum * elemsize;
                 copyRanges += actionCount;
             }
             break;
@@ -1232,7 +1724,7 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
         case LAIK_AT_GroupReduce: {
             // combine all GroupReduce actions with same
             // inputGroup, outputGroup, and redOp
-            Laik_BackendAction* ba = (Laik_BackendAction*) a;
+            Laik_A_GroupReduce* ba = (Laik_A_GroupReduce*) a;
             unsigned int countSum = 0;
             unsigned int actionCount = 0;
             Laik_Action* a2 = a;
@@ -1240,11 +1732,11 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
                 if (!isSameGroupReduce(ba, a2)) continue;
 
                 a2->mark = 1;
-                countSum += ((Laik_BackendAction*)a2)->count;
+                countSum += ((Laik_A_GroupReduce*)a2)->count;
                 actionCount++;
             }
             if (actionCount > 1) {
-                bufSize += countSum;
+                bufSize += countSum * elemsize;
                 if (laik_trans_isInGroup(tc->transition, ba->inputGroup, myid))
                     copyRanges += actionCount;
                 if (laik_trans_isInGroup(tc->transition, ba->outputGroup, myid))
@@ -1255,23 +1747,23 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
 
         case LAIK_AT_Reduce: {
             // combine all reduce actions with same root and redOp
-            Laik_BackendAction* ba = (Laik_BackendAction*) a;
+            Laik_A_Reduce* ba = (Laik_A_Reduce*) a;
             unsigned int countSum = 0;
             unsigned int actionCount = 0;
             Laik_Action* a2 = a;
             for(unsigned int j = i; j < as->actionCount; j++, a2 = nextAction(a2)) {
-                if (!isSameReduce(ba, a2)) continue;
+                if (!isSameReduce(as, ba, a2)) continue;
 
                 a2->mark = 1;
-                countSum += ((Laik_BackendAction*)a2)->count;
+                countSum += ((Laik_A_Reduce*)a2)->count;
                 actionCount++;
             }
             if (actionCount > 1) {
-                bufSize += countSum;
+                bufSize += countSum * elemsize;
                 // always providing input, copy input ranges
                 copyRanges += actionCount;
                 // if I want result, we can reuse the input ranges
-                if ((ba->rank == myid) || (ba->rank == -1))
+                if ((ba->rootTask == myid) || (ba->rootTask == -1))
                     copyRanges += actionCount;
             }
             break;
@@ -1291,17 +1783,22 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
 
     assert(copyRanges > 0);
     Laik_CopyEntry* ce = malloc(copyRanges * sizeof(Laik_CopyEntry));
-
-    assert(as->ceCount < ASEQ_COPYENTRY_MAX);
-    assert(as->ce[as->ceCount] == 0);
+    if (as->ceCount == as->ceCapacity) {
+        as->ceCapacity = (as->ceCapacity + 2) * 2;
+        as->ce = realloc(as->ce, as->ceCapacity * sizeof(Laik_CopyEntry*));
+    }
+    if (!ce || !as->ce) {
+        laik_panic("Out of memory allocating copy entries of action seq");
+        exit(1); // not actually needed, laik_panic never returns
+    }
     as->ce[as->ceCount] = ce;
     as->ceCount++;
     as->ceRanges += copyRanges;
 
-    int bufID = laik_aseq_addBufReserve(as, bufSize * elemsize, -1);
+    int bufID = laik_aseq_addBufReserve(as, bufSize, -1);
 
-    laik_log(1, "Reservation for combined actions: length %d x %d, ranges %d",
-             bufSize, elemsize, copyRanges);
+    laik_log(1, "Reservation for combined actions: %d bytes, ranges %d",
+             bufSize, copyRanges);
 
     // unmark all actions: restart for finding same type of actions
     a = as->action;
@@ -1317,6 +1814,11 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
         // skip already processed actions
         if (a->mark == 1) continue;
 
+        // combined actions use context of first action
+        as->currentTID = a->tid;
+        tc = actionContext(as, a);
+        unsigned int elemsize = tc->data->elemsize;
+
         switch(a->type) {
         case LAIK_AT_BufSend: {
             Laik_A_BufSend* bsa = (Laik_A_BufSend*) a;
@@ -1324,7 +1826,7 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
             unsigned int actionCount = 0;
             Laik_Action* a2 = a;
             for(unsigned int j = i; j < as->actionCount; j++, a2 = nextAction(a2)) {
-                if (!isSameBufSend(bsa, a2)) continue;
+                if (!isSameBufSend(as, bsa, a2)) continue;
 
                 a2->mark = 1;
                 countSum += ((Laik_A_BufSend*)a2)->count;
@@ -1338,19 +1840,19 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
                                         bufID, 0,
                                         actionCount);
                 laik_aseq_addRBufSend(as, 3 * a->round + 1,
-                                      bufID, bufOff * elemsize,
+                                      bufID, bufOff,
                                       countSum, bsa->to_rank);
                 unsigned int oldRangeOff = rangeOff;
                 Laik_Action* a2 = a;
                 for(unsigned int k = i; k < as->actionCount; k++, a2 = nextAction(a2)) {
-                    if (!isSameBufSend(bsa, a2)) continue;
+                    if (!isSameBufSend(as, bsa, a2)) continue;
 
                     Laik_A_BufSend* bsa2 = (Laik_A_BufSend*) a2;
                     assert(rangeOff < copyRanges);
                     ce[rangeOff].ptr = bsa2->buf;
                     ce[rangeOff].bytes = bsa2->count * elemsize;
-                    ce[rangeOff].offset = bufOff * elemsize;
-                    bufOff += bsa2->count;
+                    ce[rangeOff].offset = bufOff;
+                    bufOff += bsa2->count * elemsize;
                     rangeOff++;
                 }
                 assert(oldRangeOff + actionCount == rangeOff);
@@ -1367,7 +1869,7 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
             unsigned int actionCount = 0;
             Laik_Action* a2 = a;
             for(unsigned int j = i; j < as->actionCount; j++, a2 = nextAction(a2)) {
-                if (!isSameBufRecv(bra, a2)) continue;
+                if (!isSameBufRecv(as, bra, a2)) continue;
 
                 a2->mark = 1;
                 countSum += ((Laik_A_BufRecv*)a2)->count;
@@ -1375,7 +1877,7 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
             }
             if (actionCount > 1) {
                 laik_aseq_addRBufRecv(as, 3 * a->round + 1,
-                                      bufID, bufOff * elemsize,
+                                      bufID, bufOff,
                                       countSum, bra->from_rank);
                 laik_aseq_addCopyFromRBuf(as, 3 * a->round + 2,
                                           ce + rangeOff,
@@ -1384,14 +1886,14 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
                 unsigned int oldRangeOff = rangeOff;
                 Laik_Action* a2 = a;
                 for(unsigned int k = i; k < as->actionCount; k++, a2 = nextAction(a2)) {
-                    if (!isSameBufRecv(bra, a2)) continue;
+                    if (!isSameBufRecv(as, bra, a2)) continue;
 
                     Laik_A_BufRecv* bra2 = (Laik_A_BufRecv*) a2;
                     assert(rangeOff < copyRanges);
                     ce[rangeOff].ptr = bra2->buf;
                     ce[rangeOff].bytes = bra2->count * elemsize;
-                    ce[rangeOff].offset = bufOff * elemsize;
-                    bufOff += bra2->count;
+                    ce[rangeOff].offset = bufOff;
+                    bufOff += bra2->count * elemsize;
                     rangeOff++;
                 }
                 assert(oldRangeOff + actionCount == rangeOff);
@@ -1403,7 +1905,7 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
         }
 
         case LAIK_AT_GroupReduce: {
-            Laik_BackendAction* ba = (Laik_BackendAction*) a;
+            Laik_A_GroupReduce* ba = (Laik_A_GroupReduce*) a;
             unsigned int countSum = 0;
             unsigned int actionCount = 0;
             Laik_Action* a2 = a;
@@ -1411,7 +1913,7 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
                 if (!isSameGroupReduce(ba, a2)) continue;
 
                 a2->mark = 1;
-                countSum += ((Laik_BackendAction*)a2)->count;
+                countSum += ((Laik_A_GroupReduce*)a2)->count;
                 actionCount++;
             }
             if (actionCount > 1) {
@@ -1430,22 +1932,22 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
                     for(unsigned int k = i; k < as->actionCount; k++, a2 = nextAction(a2)) {
                         if (!isSameGroupReduce(ba, a2)) continue;
 
-                        Laik_BackendAction* ba2 = (Laik_BackendAction*) a2;
+                        Laik_A_GroupReduce* ba2 = (Laik_A_GroupReduce*) a2;
                         assert(rangeOff < copyRanges);
                         ce[rangeOff].ptr = ba2->fromBuf;
                         ce[rangeOff].bytes = ba2->count * elemsize;
-                        ce[rangeOff].offset = bufOff * elemsize;
-                        bufOff += ba2->count;
+                        ce[rangeOff].offset = bufOff;
+                        bufOff += ba2->count * elemsize;
                         rangeOff++;
                     }
                     assert(oldRangeOff + actionCount == rangeOff);
-                    assert(startBufOff + countSum == bufOff);
+                    assert(startBufOff + countSum * elemsize == bufOff);
                 }
 
                 // use temporary buffer for both input and output
                 laik_aseq_addRBufGroupReduce(as, 3 * a->round + 1,
                                              ba->inputGroup, ba->outputGroup,
-                                             bufID, startBufOff * elemsize,
+                                             bufID, startBufOff,
                                              countSum, ba->redOp);
 
                 // if I want output: copy pieces from temporary buffer
@@ -1460,18 +1962,18 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
                     for(unsigned int k = i; k < as->actionCount; k++, a2 = nextAction(a2)) {
                         if (!isSameGroupReduce(ba, a2)) continue;
 
-                        Laik_BackendAction* ba2 = (Laik_BackendAction*) a2;
+                        Laik_A_GroupReduce* ba2 = (Laik_A_GroupReduce*) a2;
                         assert(rangeOff < copyRanges);
                         ce[rangeOff].ptr = ba2->toBuf;
                         ce[rangeOff].bytes = ba2->count * elemsize;
-                        ce[rangeOff].offset = bufOff * elemsize;
-                        bufOff += ba2->count;
+                        ce[rangeOff].offset = bufOff;
+                        bufOff += ba2->count * elemsize;
                         rangeOff++;
                     }
                     assert(oldRangeOff + actionCount == rangeOff);
-                    assert(startBufOff + countSum == bufOff);
+                    assert(startBufOff + countSum * elemsize == bufOff);
                 }
-                bufOff = startBufOff + countSum;
+                bufOff = startBufOff + countSum * elemsize;
             }
             else
                 laik_aseq_addGroupReduce(as, 3 * a->round + 1,
@@ -1482,15 +1984,15 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
         }
 
         case LAIK_AT_Reduce: {
-            Laik_BackendAction* ba = (Laik_BackendAction*) a;
+            Laik_A_Reduce* ba = (Laik_A_Reduce*) a;
             unsigned int countSum = 0;
             unsigned int actionCount = 0;
             Laik_Action* a2 = a;
             for(unsigned int j = i; j < as->actionCount; j++, a2 = nextAction(a2)) {
-                if (!isSameReduce(ba, a2)) continue;
+                if (!isSameReduce(as, ba, a2)) continue;
 
                 a2->mark = 1;
-                countSum += ((Laik_BackendAction*)a2)->count;
+                countSum += ((Laik_A_Reduce*)a2)->count;
                 actionCount++;
             }
             if (actionCount > 1) {
@@ -1506,26 +2008,26 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
                 unsigned int oldRangeOff = rangeOff;
                 Laik_Action* a2 = a;
                 for(unsigned int k = i; k < as->actionCount; k++, a2 = nextAction(a2)) {
-                    if (!isSameReduce(ba, a2)) continue;
+                    if (!isSameReduce(as, ba, a2)) continue;
 
-                    Laik_BackendAction* ba2 = (Laik_BackendAction*) a2;
+                    Laik_A_Reduce* ba2 = (Laik_A_Reduce*) a2;
                     assert(rangeOff < copyRanges);
                     ce[rangeOff].ptr = ba2->fromBuf;
                     ce[rangeOff].bytes = ba2->count * elemsize;
-                    ce[rangeOff].offset = bufOff * elemsize;
-                    bufOff += ba2->count;
+                    ce[rangeOff].offset = bufOff;
+                    bufOff += ba2->count * elemsize;
                     rangeOff++;
                 }
                 assert(oldRangeOff + actionCount == rangeOff);
-                assert(startBufOff + countSum == bufOff);
+                assert(startBufOff + countSum * elemsize == bufOff);
 
                 // use temporary buffer for both input and output
                 laik_aseq_addRBufReduce(as, 3 * a->round + 1,
-                                           bufID, startBufOff * elemsize,
-                                           countSum, ba->rank, ba->redOp);
+                                           bufID, startBufOff,
+                                           countSum, ba->rootTask, ba->redOp);
 
                 // if I want result, copy output ranges
-                if ((ba->rank == myid) || (ba->rank == -1)) {
+                if ((ba->rootTask == myid) || (ba->rootTask == -1)) {
                     // collect output ranges: we cannot reuse copy ranges from
                     // input pieces because of potentially other output buffers
                     laik_aseq_addCopyFromRBuf(as, 3 * a->round + 2,
@@ -1536,25 +2038,25 @@ bool laik_aseq_combineActions(Laik_ActionSeq* as)
                     unsigned int oldRangeOff = rangeOff;
                     Laik_Action* a2 = a;
                     for(unsigned int k = i; k < as->actionCount; k++, a2 = nextAction(a2)) {
-                        if (!isSameReduce(ba, a2)) continue;
+                        if (!isSameReduce(as, ba, a2)) continue;
 
-                        Laik_BackendAction* ba2 = (Laik_BackendAction*) a2;
+                        Laik_A_Reduce* ba2 = (Laik_A_Reduce*) a2;
                         assert(rangeOff < copyRanges);
                         ce[rangeOff].ptr = ba2->toBuf;
                         ce[rangeOff].bytes = ba2->count * elemsize;
-                        ce[rangeOff].offset = bufOff * elemsize;
-                        bufOff += ba2->count;
+                        ce[rangeOff].offset = bufOff;
+                        bufOff += ba2->count * elemsize;
                         rangeOff++;
                     }
                     assert(oldRangeOff + actionCount == rangeOff);
-                    assert(startBufOff + countSum == bufOff);
+                    assert(startBufOff + countSum * elemsize == bufOff);
                 }
-                bufOff = startBufOff + countSum;
+                bufOff = startBufOff + countSum * elemsize;
             }
             else
                 laik_aseq_addReduce(as, 3 * a->round + 1,
                                     ba->fromBuf, ba->toBuf,
-                                    ba->count, ba->rank, ba->redOp);
+                                    ba->count, ba->rootTask, ba->redOp);
             break;
         }
 
@@ -1609,11 +2111,12 @@ int getActionPeer(Laik_Action* a)
         return ((Laik_A_MapPackAndSend*)a)->to_rank;
     case LAIK_AT_MapRecvAndUnpack:
         return ((Laik_A_MapRecvAndUnpack*)a)->from_rank;
-    case LAIK_AT_MapSend:
-    case LAIK_AT_MapRecv:
+    case LAIK_AT_MapSend:  return ((Laik_A_MapSend*)a)->to_rank;
+    case LAIK_AT_MapRecv:  return ((Laik_A_MapRecv*)a)->from_rank;
     case LAIK_AT_PackAndSend:
+        return ((Laik_A_PackAndSend*)a)->to_rank;
     case LAIK_AT_RecvAndUnpack:
-        return ((Laik_BackendAction*)a)->rank;
+        return ((Laik_A_RecvAndUnpack*)a)->from_rank;
     default: assert(0); // only should be called for send/recv actions
     }
     return 0;
@@ -1724,8 +2227,8 @@ int cmp_rankdigits(const void* aptr1, const void* aptr2)
     bool a2isSend = laik_action_isSend(a2);
     bool a1isRecv = laik_action_isRecv(a1);
     bool a2isRecv = laik_action_isRecv(a2);
-    int a1peer = getActionPeer(a1);
-    int a2peer = getActionPeer(a2);
+    int a1peer = (a1isSend || a1isRecv) ? getActionPeer(a1) : 0;
+    int a2peer = (a2isSend || a2isRecv) ? getActionPeer(a2) : 0;
 
     // phase number is number of lower digits equal to my rank
     int a1phase = 0, a2phase = 0, mask = 0;
@@ -1883,15 +2386,15 @@ bool laik_aseq_flattenPacking(Laik_ActionSeq* as)
     // must not have new actions, we want to start a new build
     assert(as->newActionCount == 0);
 
-    Laik_TransitionContext* tc = as->context[0];
-    unsigned int elemsize = tc->data->elemsize;
-    int myid = tc->transition->group->myid;
-
     Laik_Action* a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
-        Laik_BackendAction* ba = (Laik_BackendAction*) a;
         bool handled = false;
 
+        Laik_TransitionContext* tc = actionContext(as, a);
+        unsigned int elemsize = tc->data->elemsize;
+        int myid = tc->transition->group->myid;
+        as->currentTID = a->tid;
+
         switch(a->type) {
         case LAIK_AT_MapPackAndSend: {
             Laik_A_MapPackAndSend* aa = (Laik_A_MapPackAndSend*) a;
@@ -1986,7 +2489,8 @@ bool laik_aseq_flattenPacking(Laik_ActionSeq* as)
             break;
         }
 
-        case LAIK_AT_MapGroupReduce:
+        case LAIK_AT_MapGroupReduce: {
+            Laik_A_MapGroupReduce* ba = (Laik_A_MapGroupReduce*) a;
 
             // TODO: for >1 dims, use pack/unpack with buffer
             if (ba->slc->space->dims == 1) {
@@ -2039,6 +2543,7 @@ bool laik_aseq_flattenPacking(Laik_ActionSeq* as)
                 handled = true;
             }
             break;
+        }
 
         default: break;
         }
@@ -2065,7 +2570,7 @@ bool laik_aseq_flattenPacking(Laik_ActionSeq* as)
 // round 0: send to reduce task, round 1: reduction, round 2: send back
 static
 void laik_aseq_addReduce3Rounds(Laik_ActionSeq* as,
-                                Laik_TransitionContext* tc, Laik_BackendAction* ba)
+                                Laik_TransitionContext* tc, Laik_A_GroupReduce* ba)
 {
     assert(ba->h.type == LAIK_AT_GroupReduce);
     Laik_Transition* t = tc->transition;
@@ -2183,7 +2688,7 @@ void laik_aseq_addReduce3Rounds(Laik_ActionSeq* as,
 // round 0: send/recv, round 1: reduction
 static
 void laik_aseq_addReduce2Rounds(Laik_ActionSeq* as,
-                                Laik_TransitionContext* tc, Laik_BackendAction* ba)
+                                Laik_TransitionContext* tc, Laik_A_GroupReduce* ba)
 {
     assert(ba->h.type == LAIK_AT_GroupReduce);
     Laik_Transition* t = tc->transition;
@@ -2283,16 +2788,15 @@ void laik_aseq_addReduce2Rounds(Laik_ActionSeq* as,
 
 // transformation for split reduce actions into basic multiple actions.
 // action round numbers are spreaded by *3+1, allowing space for 3-step
+// <mode> selects 2-step or 3-step reduction (see Laik_ReduceSplit)
 // return true if sequence changed
-bool laik_aseq_splitReduce(Laik_ActionSeq* as)
+bool laik_aseq_splitReduce(Laik_ActionSeq* as, Laik_ReduceSplit mode)
 {
     bool reduceFound = false;
 
     // must not have new actions, we want to start a new build
     assert(as->newActionCount == 0);
 
-    Laik_TransitionContext* tc = as->context[0];
-
     Laik_Action* a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
         if (a->type == LAIK_AT_GroupReduce) {
@@ -2305,15 +2809,25 @@ bool laik_aseq_splitReduce(Laik_ActionSeq* as)
 
     a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
-        Laik_BackendAction* ba = (Laik_BackendAction*) a;
-
         switch(a->type) {
         case LAIK_AT_GroupReduce: {
+            Laik_A_GroupReduce* ba = (Laik_A_GroupReduce*) a;
+            Laik_TransitionContext* tc = actionContext(as, a);
+            as->currentTID = a->tid;
             int inCount, outCount;
             inCount = laik_trans_groupCount(tc->transition, ba->inputGroup);
-            outCount = laik_trans_groupCount(tc->transition, ba->inputGroup);
-            // use simple 3-step reduction if too many messages for 2-step
-            if (inCount * outCount > 4 * (inCount + outCount))
+            outCount = laik_trans_groupCount(tc->transition, ba->outputGroup);
+            bool use3Rounds;
+            if (mode == LAIK_RS_Auto) {
+                // use simple 3-step reduction if too many messages for 2-step
+                use3Rounds = (inCount * outCount > 4 * (inCount + outCount));
+            }
+            else
+                use3Rounds = (mode == LAIK_RS_3Rounds);
+            // 2-step reduction supports at most 32 inputs
+            if (inCount > 32) use3Rounds = true;
+
+            if (use3Rounds)
                 laik_aseq_addReduce3Rounds(as, tc, ba);
             else
                 laik_aseq_addReduce2Rounds(as, tc, ba);
@@ -2337,16 +2851,15 @@ bool laik_aseq_replaceWithAllReduce(Laik_ActionSeq* as)
     bool changed = false;
     assert(as->newActionCount == 0);
 
-    Laik_TransitionContext* tc = as->context[0];
-    Laik_Transition* t = tc->transition;
-
     Laik_Action* a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
-        Laik_BackendAction* ba = (Laik_BackendAction*) a;
+        Laik_Transition* t = actionContext(as, a)->transition;
+        as->currentTID = a->tid;
 
         switch(a->type) {
         // TODO: LAIK_AT_MapGroupReduce
-        case LAIK_AT_GroupReduce:
+        case LAIK_AT_GroupReduce: {
+            Laik_A_GroupReduce* ba = (Laik_A_GroupReduce*) a;
             if (ba->inputGroup == -1) {
                 if (ba->outputGroup == -1) {
                     laik_aseq_addReduce(as, a->round, ba->fromBuf, ba->toBuf,
@@ -2364,6 +2877,7 @@ bool laik_aseq_replaceWithAllReduce(Laik_ActionSeq* as)
             }
             laik_aseq_add(a, as, -1);
             break;
+        }
 
         default:
             laik_aseq_add(a, as, -1);
@@ -2386,7 +2900,6 @@ bool laik_aseq_splitTransitionExecs(Laik_ActionSeq* as)
     // must not have new actions, we want to start a new build
     assert(as->newActionCount == 0);
 
-    Laik_TransitionContext* tc = as->context[0];
     bool found = false;
     Laik_Action* a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
@@ -2401,12 +2914,14 @@ bool laik_aseq_splitTransitionExecs(Laik_ActionSeq* as)
     a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
         switch(a->type) {
-        case LAIK_AT_TExec:
-            assert(a->tid == 0);
+        case LAIK_AT_TExec: {
+            Laik_TransitionContext* tc = actionContext(as, a);
+            as->currentTID = a->tid;
             laik_aseq_addReds(as, a->round, tc->data, tc->transition);
             laik_aseq_addSends(as, a->round, tc->data, tc->transition);
             laik_aseq_addRecvs(as, a->round, tc->data, tc->transition);
             break;
+        }
 
         default:
             laik_aseq_add(a, as, -1);
@@ -2419,19 +2934,311 @@ bool laik_aseq_splitTransitionExecs(Laik_ActionSeq* as)
     return true;
 }
 
-// calculate stats of one run of the action sequence
-// (if the action seq has backend-specific actions, a corresponding function in the
-//  backend needs to be called in addition)
-// must be called before laik_switchstat_addASeq() for correct stats
-// return number of not handled actions
-int laik_aseq_calc_stats(Laik_ActionSeq* as)
+// helpers for aggregation of messages by node
+
+// element count sent from task <from> to task <to> in context <tid>.
+// one of the tasks must have its counts in <nc>
+static
+unsigned int aggCount(const Laik_NodeComm* nc, int tid, int from, int to)
 {
-    Laik_CopyEntry* ce;
-    int not_processed = 0;
-    unsigned int count = 0;
+    if (nc->index[from] >= 0)
+        return nc->sent[tid][nc->index[from] * nc->size + to];
+    assert(nc->index[to] >= 0);
+    return nc->received[tid][nc->index[to] * nc->size + from];
+}
 
-    as->msgSendCount = 0;
-    as->msgRecvCount = 0;
+// is the message from task <from> to task <to> in context <tid> forwarded
+// via node leaders? one of the tasks must be on node of <myleader>
+static
+bool isAggregated(const Laik_NodeComm* nc, int tid, int myleader,
+                  int from, int to)
+{
+    int leaderFrom = nc->leader[from];
+    int leaderTo = nc->leader[to];
+    if (leaderFrom == leaderTo) return false;
+    if (leaderFrom == myleader)
+        return nc->pairsTo[tid][leaderTo] > 1;
+    assert(leaderTo == myleader);
+    return nc->pairsFrom[tid][leaderFrom] > 1;
+}
+
+// add actions to pack all data sent to task <to> in context <tid> into
+// buffer <bufID> at element offset <off>, in original order.
+// returns offset after packed data
+static
+unsigned int addAggregatedPacks(Laik_ActionSeq* as, int tid, int to,
+                                int bufID, unsigned int off,
+                                unsigned int elemsize)
+{
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        if ((a->tid != tid) || (a->type != LAIK_AT_MapPackAndSend)) continue;
+        Laik_A_MapPackAndSend* aa = (Laik_A_MapPackAndSend*) a;
+        if (aa->to_rank != to) continue;
+
+        laik_aseq_addMapPackToRBuf(as, 0, aa->fromMapNo, aa->slc,
+                                   bufID, off * elemsize);
+        off += aa->count;
+    }
+    return off;
+}
+
+// add actions to unpack all data received from task <from> in context <tid>
+// from buffer <bufID> at element offset <off>, in original order.
+// returns offset after unpacked data
+static
+unsigned int addAggregatedUnpacks(Laik_ActionSeq* as, int tid, int from,
+                                  int bufID, unsigned int off,
+                                  unsigned int elemsize)
+{
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        if ((a->tid != tid) || (a->type != LAIK_AT_MapRecvAndUnpack)) continue;
+        Laik_A_MapRecvAndUnpack* aa = (Laik_A_MapRecvAndUnpack*) a;
+        if (aa->from_rank != from) continue;
+
+        laik_aseq_addMapUnpackFromRBuf(as, 4, bufID, off * elemsize,
+                                       aa->toMapNo, aa->slc);
+        off += aa->count;
+    }
+    return off;
+}
+
+/* forward messages among tasks on different nodes via node leaders
+ *
+ * If there are at least 2 communicating task pairs between two nodes,
+ * all data from one node to the other is sent as one message among the
+ * node leaders, using the following rounds:
+ * - round 0: tasks pack data for remote nodes (leaders directly into the
+ *            aggregated messages)
+ * - round 1: tasks send packed data to their leader, one message per node
+ * - round 2: leaders exchange aggregated messages
+ * - round 3: leaders send data to receiving tasks (one message per sender)
+ * - round 4: tasks unpack received data
+ * The message from node X to node Y is ordered by sending task in X, then
+ * by receiving task in Y, then by the order of the original send actions.
+ * Packing and sending is in separate rounds, as further transformations
+ * (combining) may add copy actions before the sends of a round.
+ * Send/recv actions from transition execs all are in round 0. Other
+ * actions are kept, with round numbers spreaded by *5.
+ *
+ * return true if action sequence changed
+ */
+bool laik_aseq_aggregateByNode(Laik_ActionSeq* as, const Laik_NodeComm* nc)
+{
+    // must not have new actions, we want to start a new build
+    assert(as->newActionCount == 0);
+
+    // all transitions are within same group
+    Laik_TransitionContext* tc = as->context[0];
+    int size = tc->transition->group->size;
+    int myid = tc->transition->group->myid;
+    const int* leader = nc->leader;
+    int myleader = leader[myid];
+    assert(nc->size == size);
+    assert(nc->index[myid] >= 0);
+
+    // anything to forward from/to own node?
+    // node pair counts are the same on both nodes of a pair
+    bool found = false;
+    for(int tid = 0; tid < as->contextCount; tid++)
+        for(int node = 0; node < size; node++)
+            if ((nc->pairsTo[tid][node] > 1) || (nc->pairsFrom[tid][node] > 1))
+                found = true;
+    if (!found)
+        return false;
+
+    // pass through actions not forwarded via leaders
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        bool forwarded = false;
+        switch(a->type) {
+        case LAIK_AT_MapPackAndSend:
+            forwarded = isAggregated(nc, a->tid, myleader, myid,
+                                     ((Laik_A_MapPackAndSend*)a)->to_rank);
+            break;
+        case LAIK_AT_MapRecvAndUnpack:
+            forwarded = isAggregated(nc, a->tid, myleader,
+                                     ((Laik_A_MapRecvAndUnpack*)a)->from_rank, myid);
+            break;
+        default:
+            // only send/recv actions from transition execs expected
+            assert(!laik_action_isSend(a) && !laik_action_isRecv(a));
+            break;
+        }
+        if (forwarded) {
+            assert(a->round == 0);
+            continue;
+        }
+        laik_aseq_add(a, as, 5 * a->round);
+    }
+
+    for(int tid = 0; tid < as->contextCount; tid++) {
+        tc = as->context[tid];
+        unsigned int elemsize = tc->data->elemsize;
+        as->currentTID = tid;
+
+        unsigned int off, start, total;
+        if (myid != myleader) {
+            // data sent by me, one message to my leader per remote node
+            total = 0;
+            for(int to = 0; to < size; to++)
+                if (isAggregated(nc, tid, myleader, myid, to))
+                    total += aggCount(nc, tid, myid, to);
+            if (total > 0) {
+                int bufID = laik_aseq_addBufReserve(as, total * elemsize, -1);
+                off = 0;
+                for(int node = 0; node < size; node++) {
+                    if (leader[node] != node) continue;
+                    start = off;
+                    for(int to = 0; to < size; to++) {
+                        if (leader[to] != node) continue;
+                        if (!isAggregated(nc, tid, myleader, myid, to)) continue;
+                        unsigned int o = off;
+                        off = addAggregatedPacks(as, tid, to, bufID, off, elemsize);
+                        assert(off - o == aggCount(nc, tid, myid, to));
+                        (void) o;
+                    }
+                    if (off > start)
+                        laik_aseq_addRBufSend(as, 1, bufID, start * elemsize,
+                                              off - start, myleader);
+                }
+                assert(off == total);
+            }
+
+            // data for me, one message from my leader per remote sender
+            total = 0;
+            for(int from = 0; from < size; from++)
+                if (isAggregated(nc, tid, myleader, from, myid))
+                    total += aggCount(nc, tid, from, myid);
+            if (total > 0) {
+                int bufID = laik_aseq_addBufReserve(as, total * elemsize, -1);
+                off = 0;
+                for(int node = 0; node < size; node++) {
+                    if (leader[node] != node) continue;
+                    for(int from = 0; from < size; from++) {
+                        if (leader[from] != node) continue;
+                        if (!isAggregated(nc, tid, myleader, from, myid)) continue;
+                        unsigned int count = aggCount(nc, tid, from, myid);
+                        if (count == 0) continue;
+                        laik_aseq_addRBufRecv(as, 3, bufID, off * elemsize,
+                                              count, myleader);
+                        off = addAggregatedUnpacks(as, tid, from, bufID, off, elemsize);
+                    }
+                }
+                assert(off == total);
+            }
+            continue;
+        }
+
+        // leader: collect data from tasks on my node, one message per
+        // remote node
+        total = 0;
+        for(int from = 0; from < size; from++) {
+            if (leader[from] != myid) continue;
+            for(int to = 0; to < size; to++)
+                if (isAggregated(nc, tid, myleader, from, to))
+                    total += aggCount(nc, tid, from, to);
+        }
+        if (total > 0) {
+            int bufID = laik_aseq_addBufReserve(as, total * elemsize, -1);
+            off = 0;
+            for(int node = 0; node < size; node++) {
+                if ((leader[node] != node) || (node == myid)) continue;
+                start = off;
+                for(int from = 0; from < size; from++) {
+                    if (leader[from] != myid) continue;
+                    unsigned int fromStart = off;
+                    for(int to = 0; to < size; to++) {
+                        if (leader[to] != node) continue;
+                        if (!isAggregated(nc, tid, myleader, from, to)) continue;
+                        if (from == myid) {
+                            unsigned int o = off;
+                            off = addAggregatedPacks(as, tid, to, bufID, off, elemsize);
+                            assert(off - o == aggCount(nc, tid, myid, to));
+                            (void) o;
+                        }
+                        else
+                            off += aggCount(nc, tid, from, to);
+                    }
+                    if ((from != myid) && (off > fromStart))
+                        laik_aseq_addRBufRecv(as, 1, bufID, fromStart * elemsize,
+                                              off - fromStart, from);
+                }
+                if (off > start)
+                    laik_aseq_addRBufSend(as, 2, bufID, start * elemsize,
+                                          off - start, node);
+            }
+            assert(off == total);
+        }
+
+        // leader: receive data for tasks on my node, one message per
+        // remote node, and pass it on
+        total = 0;
+        for(int to = 0; to < size; to++) {
+            if (leader[to] != myid) continue;
+            for(int from = 0; from < size; from++)
+                if (isAggregated(nc, tid, myleader, from, to))
+                    total += aggCount(nc, tid, from, to);
+        }
+        if (total > 0) {
+            int bufID = laik_aseq_addBufReserve(as, total * elemsize, -1);
+            off = 0;
+            for(int node = 0; node < size; node++) {
+                if ((leader[node] != node) || (node == myid)) continue;
+                start = off;
+                for(int from = 0; from < size; from++) {
+                    if (leader[from] != node) continue;
+                    for(int to = 0; to < size; to++)
+                        if ((leader[to] == myid) && isAggregated(nc, tid, myleader, from, to))
+                            off += aggCount(nc, tid, from, to);
+                }
+                if (off == start) continue;
+
+                laik_aseq_addRBufRecv(as, 2, bufID, start * elemsize,
+                                      off - start, node);
+                off = start;
+                for(int from = 0; from < size; from++) {
+                    if (leader[from] != node) continue;
+                    for(int to = 0; to < size; to++) {
+                        if (leader[to] != myid) continue;
+                        if (!isAggregated(nc, tid, myleader, from, to)) continue;
+                        unsigned int count = aggCount(nc, tid, from, to);
+                        if (count == 0) continue;
+                        if (to == myid) {
+                            unsigned int o = off;
+                            off = addAggregatedUnpacks(as, tid, from, bufID, off, elemsize);
+                            assert(off - o == count);
+                            (void) o;
+                        }
+                        else {
+                            laik_aseq_addRBufSend(as, 3, bufID, off * elemsize,
+                                                  count, to);
+                            off += count;
+                        }
+                    }
+                }
+            }
+            assert(off == total);
+        }
+    }
+    laik_aseq_activateNewActions(as);
+    return true;
+}
+
+// calculate stats of one run of the action sequence
+// (if the action seq has backend-specific actions, a corresponding function in the
+//  backend needs to be called in addition)
+// must be called before laik_switchstat_addASeq() for correct stats
+// return number of not handled actions
+int laik_aseq_calc_stats(Laik_ActionSeq* as)
+{
+    Laik_CopyEntry* ce;
+    int not_processed = 0;
+    unsigned int count = 0;
+
+    as->msgSendCount = 0;
+    as->msgRecvCount = 0;
     as->msgReduceCount = 0;
     as->msgAsyncSendCount = 0;
     as->msgAsyncRecvCount = 0;
@@ -2445,14 +3252,11 @@ int laik_aseq_calc_stats(Laik_ActionSeq* as)
     as->reduceOpCount = 0;
     as->byteBufCopyCount = 0;
 
-    // TODO: we only allow 1 transition at the moment
-    Laik_TransitionContext* tc = as->context[0];
-    int current_tid = 0;
-    as->transitionCount = 1;
+    as->transitionCount = as->contextCount;
 
     Laik_Action* a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
-        assert(a->tid == current_tid); // TODO: only assumes actions from one transition
+        Laik_TransitionContext* tc = actionContext(as, a);
 
         switch(a->type) {
         case LAIK_AT_TExec:
@@ -2468,14 +3272,7 @@ int laik_aseq_calc_stats(Laik_ActionSeq* as)
         case LAIK_AT_RBufSend:
         case LAIK_AT_PackAndSend:
         case LAIK_AT_MapPackAndSend:
-            switch(a->type) {
-            case LAIK_AT_RBufSend:    count = ((Laik_A_RBufSend*)a)->count; break;
-            case LAIK_AT_MapSend:
-            case LAIK_AT_PackAndSend: count = ((Laik_BackendAction*)a)->count; break;
-            case LAIK_AT_BufSend:     count = ((Laik_A_BufSend*)a)->count; break;
-            case LAIK_AT_MapPackAndSend:
-                count = ((Laik_A_MapPackAndSend*)a)->count; break;
-            }
+            count = laik_action_count(a);
             as->msgSendCount++;
             as->elemSendCount += count;
             as->byteSendCount += count * tc->data->elemsize;
@@ -2493,14 +3290,7 @@ int laik_aseq_calc_stats(Laik_ActionSeq* as)
         case LAIK_AT_RBufRecv:
         case LAIK_AT_RecvAndUnpack:
         case LAIK_AT_MapRecvAndUnpack:
-            switch(a->type) {
-            case LAIK_AT_RBufRecv:      count = ((Laik_A_RBufRecv*)a)->count; break;
-            case LAIK_AT_MapRecv:
-            case LAIK_AT_RecvAndUnpack: count = ((Laik_BackendAction*)a)->count; break;
-            case LAIK_AT_BufRecv:       count = ((Laik_A_BufRecv*)a)->count; break;
-            case LAIK_AT_MapRecvAndUnpack:
-                count = ((Laik_A_MapRecvAndUnpack*)a)->count; break;
-            }
+            count = laik_action_count(a);
             as->msgRecvCount++;
             as->elemRecvCount += count;
             as->byteRecvCount += count * tc->data->elemsize;
@@ -2518,18 +3308,18 @@ int laik_aseq_calc_stats(Laik_ActionSeq* as)
         case LAIK_AT_MapGroupReduce:
         case LAIK_AT_GroupReduce:
         case LAIK_AT_RBufGroupReduce:
-            count = ((Laik_BackendAction*)a)->count;
+            count = laik_action_count(a);
             as->msgReduceCount++;
             as->elemReduceCount += count;
             as->byteReduceCount += count * tc->data->elemsize;
             break;
 
         case LAIK_AT_RBufLocalReduce:
-            as->reduceOpCount += ((Laik_BackendAction*)a)->count;
+            as->reduceOpCount += laik_action_count(a);
             break;
 
         case LAIK_AT_BufInit:
-            as->initOpCount += ((Laik_BackendAction*)a)->count;
+            as->initOpCount += laik_action_count(a);
             break;
 
         case LAIK_AT_RBufCopy:
@@ -2542,15 +3332,21 @@ int laik_aseq_calc_stats(Laik_ActionSeq* as)
         case LAIK_AT_UnpackFromBuf:
         case LAIK_AT_MapUnpackFromRBuf:
         case LAIK_AT_MapUnpackFromBuf:
-            as->byteBufCopyCount += ((Laik_BackendAction*)a)->count * tc->data->elemsize;
+            as->byteBufCopyCount += laik_action_count(a) * tc->data->elemsize;
             break;
 
         case LAIK_AT_CopyToBuf:
         case LAIK_AT_CopyToRBuf:
         case LAIK_AT_CopyFromBuf:
         case LAIK_AT_CopyFromRBuf:
-            count = ((Laik_BackendAction*)a)->count;
-            ce = ((Laik_BackendAction*)a)->ce;
+            count = laik_action_count(a);
+            switch(a->type) {
+            case LAIK_AT_CopyToBuf:    ce = ((Laik_A_CopyToBuf*)a)->ce; break;
+            case LAIK_AT_CopyToRBuf:   ce = ((Laik_A_CopyToRBuf*)a)->ce; break;
+            case LAIK_AT_CopyFromBuf:  ce = ((Laik_A_CopyFromBuf*)a)->ce; break;
+            case LAIK_AT_CopyFromRBuf: ce = ((Laik_A_CopyFromRBuf*)a)->ce; break;
+            default: assert(0); ce = 0; break;
+            }
             for(unsigned int i = 0; i < count; i++)
                 as->byteBufCopyCount += ce[i].bytes;
             break;
@@ -2564,30 +3360,609 @@ int laik_aseq_calc_stats(Laik_ActionSeq* as)
     return not_processed;
 }
 
+// does <as> need execution by the backend?
+// besides communication in transitions, backend transformations may add
+// messages for tasks without own transfers, e.g. for forwarding
+bool laik_aseq_needsExec(Laik_ActionSeq* as)
+{
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_Transition* t = ((Laik_TransitionContext*) as->context[i])->transition;
+        if (t->sendCount + t->recvCount + t->redCount > 0)
+            return true;
+    }
+    // stats not calculated yet?
+    if (as->transitionCount == 0) return false;
+
+    return (as->msgSendCount + as->msgRecvCount + as->msgReduceCount +
+            as->msgAsyncSendCount + as->msgAsyncRecvCount) > 0;
+}
+
+// does action <a> need to wait for data from other processes?
+// used by backends for split-phase execution: everything before the
+// first such action can be triggered without blocking
+bool laik_action_waitsForRemote(Laik_Action* a)
+{
+    switch(a->type) {
+    case LAIK_AT_MapRecv:
+    case LAIK_AT_BufRecv:
+    case LAIK_AT_RBufRecv:
+    case LAIK_AT_RecvAndUnpack:
+    case LAIK_AT_MapRecvAndUnpack:
+    case LAIK_AT_Reduce:
+    case LAIK_AT_RBufReduce:
+    case LAIK_AT_MapGroupReduce:
+    case LAIK_AT_GroupReduce:
+    case LAIK_AT_RBufGroupReduce:
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+
+// helpers for laik_aseq_validate
+
+static void validateFail(Laik_ActionSeq* as, unsigned int i, Laik_Action* a,
+                         const char* msg)
+{
+    laik_log(LAIK_LL_Panic, "action seq '%s': invalid action %d (type %d): %s",
+             as->name, i, a->type, msg);
+}
+
+// check buffer ID/offset of an RBuf action
+static void validateRBuf(Laik_ActionSeq* as, unsigned int i, Laik_Action* a,
+                         int bufID, unsigned int offset, unsigned int bytes)
+{
+    if (bufID >= ASEQ_RBUF_FIRSTID) {
+        // not yet allocated reservation
+        if (bufID >= (int)(ASEQ_RBUF_FIRSTID + as->bufReserveCount))
+            validateFail(as, i, a, "unknown buffer reservation");
+        return;
+    }
+    if ((bufID < 0) || (bufID >= as->bufferCount))
+        validateFail(as, i, a, "unknown buffer ID");
+    else if ((uint64_t) offset + bytes > as->bufSize[bufID])
+        validateFail(as, i, a, "buffer range out of bounds");
+}
+
+// check a map number into mapping list <ml> (may not be known yet)
+static void validateMapNo(Laik_ActionSeq* as, unsigned int i, Laik_Action* a,
+                          Laik_MappingList* ml, int mapNo)
+{
+    if ((mapNo < 0) || (ml && (mapNo >= ml->count)))
+        validateFail(as, i, a, "mapping number out of range");
+}
+
+// check consistency of all actions in a sequence, panics on error.
+// only active in debug builds (without NDEBUG), no-op otherwise
+void laik_aseq_validate(Laik_ActionSeq* as)
+{
+#ifdef NDEBUG
+    (void) as;
+#else
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        if (a->type == LAIK_AT_Invalid)
+            validateFail(as, i, a, "invalid type");
+        if ((a->type >= LAIK_AT_Backend) && (a->type <= LAIK_AT_Backend_Max)) {
+            // backend-specific action: only check generic header
+            if (a->len < sizeof(Laik_Action))
+                validateFail(as, i, a, "length too small");
+            continue;
+        }
+        if (a->len != laik_action_size(a->type))
+            validateFail(as, i, a, "length does not match action type");
+        if (a->round >= as->roundCount)
+            validateFail(as, i, a, "round out of range");
+        if (a->type == LAIK_AT_BufReserve) continue;
+        if ((a->type == LAIK_At_Halt) || (a->type == LAIK_AT_Nop)) continue;
+
+        if (a->tid >= as->contextCount) {
+            validateFail(as, i, a, "unknown transition context");
+            continue;
+        }
+        Laik_TransitionContext* tc = actionContext(as, a);
+        unsigned int elemsize = tc->data->elemsize;
+        unsigned int count = laik_action_count(a);
+        if ((a->type != LAIK_AT_TExec) && (count == 0))
+            validateFail(as, i, a, "zero element count");
+
+        switch(a->type) {
+        case LAIK_AT_BufSend:
+            if (((Laik_A_BufSend*)a)->buf == 0)
+                validateFail(as, i, a, "no buffer");
+            break;
+        case LAIK_AT_BufRecv:
+            if (((Laik_A_BufRecv*)a)->buf == 0)
+                validateFail(as, i, a, "no buffer");
+            break;
+        case LAIK_AT_RBufSend: {
+            Laik_A_RBufSend* aa = (Laik_A_RBufSend*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            break;
+        }
+        case LAIK_AT_RBufRecv: {
+            Laik_A_RBufRecv* aa = (Laik_A_RBufRecv*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            break;
+        }
+        case LAIK_AT_RBufCopy: {
+            Laik_A_RBufCopy* aa = (Laik_A_RBufCopy*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            break;
+        }
+        case LAIK_AT_RBufLocalReduce: {
+            Laik_A_RBufLocalReduce* aa = (Laik_A_RBufLocalReduce*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            break;
+        }
+        case LAIK_AT_RBufReduce: {
+            Laik_A_RBufReduce* aa = (Laik_A_RBufReduce*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            break;
+        }
+        case LAIK_AT_RBufGroupReduce: {
+            Laik_A_RBufGroupReduce* aa = (Laik_A_RBufGroupReduce*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            break;
+        }
+        case LAIK_AT_PackToRBuf: {
+            Laik_A_PackToRBuf* aa = (Laik_A_PackToRBuf*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            break;
+        }
+        case LAIK_AT_UnpackFromRBuf: {
+            Laik_A_UnpackFromRBuf* aa = (Laik_A_UnpackFromRBuf*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            break;
+        }
+        case LAIK_AT_MapPackToRBuf: {
+            Laik_A_MapPackToRBuf* aa = (Laik_A_MapPackToRBuf*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            validateMapNo(as, i, a, tc->fromList, aa->fromMapNo);
+            break;
+        }
+        case LAIK_AT_MapUnpackFromRBuf: {
+            Laik_A_MapUnpackFromRBuf* aa = (Laik_A_MapUnpackFromRBuf*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, count * elemsize);
+            validateMapNo(as, i, a, tc->toList, aa->toMapNo);
+            break;
+        }
+        // copy ranges may cover elements of different containers: no size check
+        case LAIK_AT_CopyToRBuf: {
+            Laik_A_CopyToRBuf* aa = (Laik_A_CopyToRBuf*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, 0);
+            break;
+        }
+        case LAIK_AT_CopyFromRBuf: {
+            Laik_A_CopyFromRBuf* aa = (Laik_A_CopyFromRBuf*) a;
+            validateRBuf(as, i, a, aa->bufID, aa->offset, 0);
+            break;
+        }
+        case LAIK_AT_MapSend:
+            validateMapNo(as, i, a, tc->fromList, ((Laik_A_MapSend*)a)->fromMapNo);
+            break;
+        case LAIK_AT_MapRecv:
+            validateMapNo(as, i, a, tc->toList, ((Laik_A_MapRecv*)a)->toMapNo);
+            break;
+        case LAIK_AT_MapPackAndSend:
+            validateMapNo(as, i, a, tc->fromList,
+                          ((Laik_A_MapPackAndSend*)a)->fromMapNo);
+            break;
+        case LAIK_AT_MapRecvAndUnpack:
+            validateMapNo(as, i, a, tc->toList,
+                          ((Laik_A_MapRecvAndUnpack*)a)->toMapNo);
+            break;
+        case LAIK_AT_MapPackToBuf:
+            validateMapNo(as, i, a, tc->fromList,
+                          ((Laik_A_MapPackToBuf*)a)->fromMapNo);
+            break;
+        case LAIK_AT_MapUnpackFromBuf:
+            validateMapNo(as, i, a, tc->toList,
+                          ((Laik_A_MapUnpackFromBuf*)a)->toMapNo);
+            break;
+        default:
+            break;
+        }
+    }
+    if (as->bytesUsed != (size_t) (((char*)a) - ((char*)as->action)))
+        laik_log(LAIK_LL_Panic, "action seq '%s': action lengths do not sum up",
+                 as->name);
+#endif
+}
+
 
 //-------------------------------------------------------------------
 // Default Exec implementations for actions not specific to a backend.
 // Backends can to use them or implement their own versions
+// LAIK_AT_PackToBuf / LAIK_AT_MapPackToBuf:
+// pack <count> elements of slice <slc> from mapping <map> into <toBuf>
+void laik_exec_pack(Laik_Mapping* map, Laik_Slice* slc,
+                    char* toBuf, unsigned int count)
+{
+    Laik_Index idx = slc->from;
+    int dims = slc->space->dims;
+    unsigned int byteCount = count * map->data->elemsize;
+    unsigned int packed = (map->layout->pack)(map, slc, &idx, toBuf, byteCount);
+    assert(packed == count);
+    assert(laik_index_isEqual(dims, &idx, &(slc->to)));
+}
+
+// LAIK_AT_UnpackFromBuf / LAIK_AT_MapUnpackFromBuf:
+// unpack <count> elements from <fromBuf> into slice <slc> of mapping <map>
+void laik_exec_unpack(Laik_Mapping* map, Laik_Slice* slc,
+                      char* fromBuf, unsigned int count)
+{
+    Laik_Index idx = slc->from;
+    int dims = slc->space->dims;
+    unsigned int byteCount = count * map->data->elemsize;
+    unsigned int unpacked = (map->layout->unpack)(map, slc, &idx,
+                                                  fromBuf, byteCount);
+    assert(unpacked == count);
+    assert(laik_index_isEqual(dims, &idx, &(slc->to)));
+}
+
+
+//-------------------------------------------------------------------
+// Multi-threaded execution of local data movement (see LAIK_THREADS)
+//
+// Pack, unpack and copy actions of the same round which directly follow
+// each other in a prepared sequence are independent if they write into the
+// same kind of target: packing into buffers only reads mappings. Unpacking
+// and copying into mappings is only independent if the written parts do
+// not overlap, which is checked when determining runs at preparation time.
+// Such a run is split into pieces which are distributed among the threads
+// of the instance. Large slices are split along their outermost dimension,
+// giving contiguous buffer parts.
+
+// pieces smaller than this are not worth a thread
+#define LOCALMOVE_MINBYTES 65536
+
+// class of local data movement actions which can run in parallel to other
+// actions of the same class in the same round, 0 if not a local movement
+static
+int localMoveClass(Laik_Action* a)
+{
+    switch(a->type) {
+    case LAIK_AT_PackToBuf:
+    case LAIK_AT_MapPackToBuf:
+    case LAIK_AT_CopyToBuf:
+        return 1; // writes into buffers
+    case LAIK_AT_UnpackFromBuf:
+    case LAIK_AT_MapUnpackFromBuf:
+        return 2; // writes into slices of mappings
+    case LAIK_AT_BufCopy:
+    case LAIK_AT_RBufCopy:
+        return 3; // first input of reductions
+    case LAIK_AT_CopyFromBuf:
+        return 4; // writes into memory ranges of mappings
+    default:
+        break;
+    }
+    return 0;
+}
+
+// piece of local data movement for one thread
+typedef struct {
+    Laik_Mapping* map; // pack/unpack with mapping, 0 for plain memory copy
+    Laik_Slice slc;    // sub-slice to pack/unpack
+    bool unpack;
+    char* to;          // pack: buffer; memory copy: destination
+    char* from;        // unpack: buffer; memory copy: source
+    uint64_t count;    // elements to pack/unpack, or bytes to copy
+} LocalPiece;
+
+static
+void execLocalPiece(void* ctx, int i)
+{
+    LocalPiece* p = ((LocalPiece*) ctx) + i;
+    if (p->map == 0)
+        memcpy(p->to, p->from, p->count);
+    else if (p->unpack)
+        laik_exec_unpack(p->map, &(p->slc), p->from, (unsigned int) p->count);
+    else
+        laik_exec_pack(p->map, &(p->slc), p->to, (unsigned int) p->count);
+}
+
+// number of pieces to split <bytes> into with <threads> threads
+static
+int localPieceCount(uint64_t bytes, int threads)
+{
+    uint64_t parts = bytes / LOCALMOVE_MINBYTES;
+    if (parts > (uint64_t) threads) parts = threads;
+    return (parts < 1) ? 1 : (int) parts;
+}
+
+// add pieces for copying <bytes> bytes from <from> to <to> into <piece>
+// (only counting if 0). Returns number of pieces
+static
+int addCopyPieces(LocalPiece* piece, char* to, char* from, uint64_t bytes,
+                  int threads)
+{
+    int parts = localPieceCount(bytes, threads);
+    if (!piece) return parts;
+
+    for(int k = 0; k < parts; k++) {
+        uint64_t off = bytes * k / parts;
+        piece[k].map = 0;
+        piece[k].to = to + off;
+        piece[k].from = from + off;
+        piece[k].count = bytes * (k + 1) / parts - off;
+    }
+    return parts;
+}
+
+// add pieces for packing/unpacking <count> elements of slice <slc> in
+// mapping <map> into <piece> (only counting if 0). Returns number of pieces
+static
+int addSlicePieces(LocalPiece* piece, Laik_Mapping* map, Laik_Slice* slc,
+                   bool unpack, char* buf, uint64_t count, int threads)
+{
+    unsigned int elemsize = map->data->elemsize;
+    int parts = localPieceCount(count * elemsize, threads);
+
+    // split along outermost dimension with more than one index
+    int d = slc->space->dims - 1;
+    while((d > 0) && (slc->to.i[d] - slc->from.i[d] == 1)) d--;
+    int64_t from = slc->from.i[d];
+    int64_t ext = slc->to.i[d] - from;
+    if (parts > ext) parts = (int) ext;
+    if (!piece) return parts;
+
+    // elements per index in dimension d (all inner dimensions are full)
+    uint64_t inner = count / ext;
+    assert(inner * ext == count);
+    for(int k = 0; k < parts; k++) {
+        int64_t f = from + ext * k / parts;
+        int64_t t = from + ext * (k + 1) / parts;
+        piece[k].map = map;
+        piece[k].slc = *slc;
+        piece[k].slc.from.i[d] = f;
+        piece[k].slc.to.i[d] = t;
+        piece[k].unpack = unpack;
+        char* b = buf + (f - from) * inner * elemsize;
+        piece[k].to = unpack ? 0 : b;
+        piece[k].from = unpack ? b : 0;
+        piece[k].count = (t - f) * inner;
+    }
+    return parts;
+}
+
+// add pieces for local data movement action <a> into <piece> (only counting
+// if 0). Returns number of pieces
+static
+int addLocalPieces(Laik_ActionSeq* as, Laik_Action* a, LocalPiece* piece,
+                   int threads)
+{
+    Laik_TransitionContext* tc = actionContext(as, a);
+    unsigned int elemsize = tc->data->elemsize;
+    int n = 0;
+
+    switch(a->type) {
+    case LAIK_AT_PackToBuf: {
+        Laik_A_PackToBuf* aa = (Laik_A_PackToBuf*) a;
+        return addSlicePieces(piece, aa->map, aa->slc, false,
+                              aa->toBuf, aa->count, threads);
+    }
+    case LAIK_AT_MapPackToBuf: {
+        Laik_A_MapPackToBuf* aa = (Laik_A_MapPackToBuf*) a;
+        assert(aa->fromMapNo < tc->fromList->count);
+        Laik_Mapping* fromMap = &(tc->fromList->map[aa->fromMapNo]);
+        assert(fromMap->base != 0);
+        return addSlicePieces(piece, fromMap, aa->slc, false,
+                              aa->toBuf, aa->count, threads);
+    }
+    case LAIK_AT_UnpackFromBuf: {
+        Laik_A_UnpackFromBuf* aa = (Laik_A_UnpackFromBuf*) a;
+        return addSlicePieces(piece, aa->map, aa->slc, true,
+                              aa->fromBuf, aa->count, threads);
+    }
+    case LAIK_AT_MapUnpackFromBuf: {
+        Laik_A_MapUnpackFromBuf* aa = (Laik_A_MapUnpackFromBuf*) a;
+        assert(aa->toMapNo < tc->toList->count);
+        Laik_Mapping* toMap = &(tc->toList->map[aa->toMapNo]);
+        assert(toMap->base != 0);
+        return addSlicePieces(piece, toMap, aa->slc, true,
+                              aa->fromBuf, aa->count, threads);
+    }
+    case LAIK_AT_CopyToBuf: {
+        Laik_A_CopyToBuf* aa = (Laik_A_CopyToBuf*) a;
+        for(unsigned int i = 0; i < aa->count; i++)
+            n += addCopyPieces(piece ? piece + n : 0,
+                               aa->toBuf + aa->ce[i].offset, aa->ce[i].ptr,
+                               aa->ce[i].bytes, threads);
+        return n;
+    }
+    case LAIK_AT_CopyFromBuf: {
+        Laik_A_CopyFromBuf* aa = (Laik_A_CopyFromBuf*) a;
+        for(unsigned int i = 0; i < aa->count; i++)
+            n += addCopyPieces(piece ? piece + n : 0,
+                               aa->ce[i].ptr, aa->fromBuf + aa->ce[i].offset,
+                               aa->ce[i].bytes, threads);
+        return n;
+    }
+    case LAIK_AT_BufCopy: {
+        Laik_A_BufCopy* aa = (Laik_A_BufCopy*) a;
+        return addCopyPieces(piece, aa->toBuf, aa->fromBuf,
+                             (uint64_t) aa->count * elemsize, threads);
+    }
+    case LAIK_AT_RBufCopy: {
+        Laik_A_RBufCopy* aa = (Laik_A_RBufCopy*) a;
+        assert(aa->bufID < as->bufferCount);
+        return addCopyPieces(piece, aa->toBuf, as->buf[aa->bufID] + aa->offset,
+                             (uint64_t) aa->count * elemsize, threads);
+    }
+    default:
+        assert(0);
+    }
+    return 0;
+}
 
-// LAIK_AT_PackToBuf
-void laik_exec_pack(Laik_BackendAction* a, Laik_Mapping* map)
+// container and slice written by unpack action <a> (class 2)
+static
+Laik_Slice* unpackTarget(Laik_ActionSeq* as, Laik_Action* a, Laik_Data** d)
 {
-    Laik_Index idx = a->slc->from;
-    int dims = a->slc->space->dims;
-    unsigned int byteCount = a->count * map->data->elemsize;
-    unsigned int packed = (map->layout->pack)(map, a->slc, &idx, a->toBuf, byteCount);
-    assert(packed == a->count);
-    assert(laik_index_isEqual(dims, &idx, &(a->slc->to)));
+    if (a->type == LAIK_AT_UnpackFromBuf) {
+        Laik_A_UnpackFromBuf* aa = (Laik_A_UnpackFromBuf*) a;
+        *d = aa->map->data;
+        return aa->slc;
+    }
+    assert(a->type == LAIK_AT_MapUnpackFromBuf);
+    *d = actionContext(as, a)->data;
+    return ((Laik_A_MapUnpackFromBuf*) a)->slc;
 }
 
-// LAIK_AT_UnpackFromBuf
-void laik_exec_unpack(Laik_BackendAction* a, Laik_Mapping* map)
+// does unpack action <b> write indexes also written by one of the <n>
+// actions starting at <a>? Different indexes of a container never share
+// memory (also in mappings embedded into reservations)
+static
+bool unpackOverlaps(Laik_ActionSeq* as, Laik_Action* a, unsigned int n,
+                    Laik_Action* b)
+{
+    Laik_Data *d1, *d2;
+    Laik_Slice* s2 = unpackTarget(as, b, &d2);
+    for(unsigned int i = 0; i < n; i++, a = nextAction(a)) {
+        Laik_Slice* s1 = unpackTarget(as, a, &d1);
+        if ((d1 == d2) && laik_slice_intersect(s1, s2)) return true;
+    }
+    return false;
+}
+
+static
+int cmpCopyEntryPtr(const void* p1, const void* p2)
 {
-    Laik_Index idx = a->slc->from;
-    int dims = a->slc->space->dims;
-    unsigned int byteCount = a->count * map->data->elemsize;
-    unsigned int unpacked = (map->layout->unpack)(map, a->slc, &idx,
-                                                  a->fromBuf, byteCount);
-    assert(unpacked == a->count);
-    assert(laik_index_isEqual(dims, &idx, &(a->slc->to)));
+    const Laik_CopyEntry* e1 = *((Laik_CopyEntry* const*) p1);
+    const Laik_CopyEntry* e2 = *((Laik_CopyEntry* const*) p2);
+    if (e1->ptr == e2->ptr) return 0;
+    return (e1->ptr < e2->ptr) ? -1 : 1;
+}
+
+// do memory ranges written by the <n> CopyFromBuf actions (class 4)
+// starting at <a> overlap?
+static
+bool copyOverlaps(Laik_Action* a, unsigned int n)
+{
+    unsigned int count = 0;
+    Laik_Action* b = a;
+    for(unsigned int i = 0; i < n; i++, b = nextAction(b))
+        count += ((Laik_A_CopyFromBuf*) b)->count;
+
+    Laik_CopyEntry** e = malloc(count * sizeof(Laik_CopyEntry*));
+    if (!e) {
+        laik_panic("Out of memory checking local data movement");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    unsigned int o = 0;
+    for(unsigned int i = 0; i < n; i++, a = nextAction(a)) {
+        Laik_A_CopyFromBuf* aa = (Laik_A_CopyFromBuf*) a;
+        for(unsigned int j = 0; j < aa->count; j++)
+            e[o++] = &(aa->ce[j]);
+    }
+    qsort(e, count, sizeof(Laik_CopyEntry*), cmpCopyEntryPtr);
+
+    bool overlap = false;
+    for(unsigned int i = 1; i < count; i++) {
+        if (e[i-1]->ptr + e[i-1]->bytes > e[i]->ptr) {
+            overlap = true;
+            break;
+        }
+    }
+    free(e);
+    return overlap;
+}
+
+// determine runs of independent local data movement actions in <as> and
+// allocate space for the pieces of the largest run. Unpacking into
+// overlapping slices ends a run; a run of copies into overlapping memory
+// ranges is executed sequentially.
+// Backends call this at the end of preparing a sequence
+void laik_aseq_prepareLocalMoves(Laik_ActionSeq* as)
+{
+    free(as->localRun);
+    as->localRun = 0;
+    Laik_ThreadPool* pool = as->inst->threadPool;
+    if (!pool || (as->actionCount == 0)) return;
+
+    as->localRun = calloc(as->actionCount, sizeof(unsigned int));
+    if (!as->localRun) {
+        laik_panic("Out of memory preparing local data movement");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    int threads = laik_threadpool_size(pool);
+    int maxPieces = 0;
+    unsigned int i = 0;
+    Laik_Action* a = as->action;
+    while(i < as->actionCount) {
+        int cls = localMoveClass(a);
+        if (cls == 0) {
+            i++;
+            a = nextAction(a);
+            continue;
+        }
+
+        unsigned int n = 0;
+        int pieces = 0;
+        Laik_Action* b = a;
+        for(; i + n < as->actionCount; n++, b = nextAction(b)) {
+            if ((b->round != a->round) || (localMoveClass(b) != cls)) break;
+            if ((cls == 2) && (n > 0) && unpackOverlaps(as, a, n, b)) break;
+            pieces += addLocalPieces(as, b, 0, threads);
+        }
+        assert(n > 0);
+
+        if ((cls == 4) && (n > 1) && copyOverlaps(a, n)) {
+            // execute by caller, action by action
+            laik_log(1, "local moves at %u: %u copies with overlapping "
+                        "targets, not parallelized", i, n);
+        }
+        else {
+            as->localRun[i] = n;
+            if (pieces > maxPieces) maxPieces = pieces;
+        }
+        i += n;
+        a = b;
+    }
+
+    if (maxPieces > as->localPieceCount) {
+        free(as->localPiece);
+        as->localPiece = malloc(maxPieces * sizeof(LocalPiece));
+        if (!as->localPiece) {
+            laik_panic("Out of memory preparing local data movement");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        as->localPieceCount = maxPieces;
+    }
+}
+
+// execute the run of independent local data movement actions starting at
+// <a> (at position <pos>) with the thread pool of the instance, as
+// determined by laik_aseq_prepareLocalMoves.
+// Returns the number of actions executed, or 0 if <a> must be executed by
+// the caller (no run starting at <a>, or logging enabled - pack/unpack
+// logging is not thread-safe).
+// Backends call this from their exec loop; worker threads only copy
+// memory, all communication stays in the calling thread.
+unsigned int laik_aseq_execLocalMoves(Laik_ActionSeq* as, Laik_Action* a,
+                                      unsigned int pos)
+{
+    if (!as->localRun || laik_log_shown(1)) return 0;
+    assert(pos < as->actionCount);
+    unsigned int n = as->localRun[pos];
+    if (n == 0) return 0;
+
+    // buffer addresses may change between executions: fill pieces now
+    Laik_ThreadPool* pool = as->inst->threadPool;
+    int threads = laik_threadpool_size(pool);
+    LocalPiece* piece = (LocalPiece*) as->localPiece;
+    int pieces = 0;
+    Laik_Action* b = a;
+    for(unsigned int i = 0; i < n; i++, b = nextAction(b))
+        pieces += addLocalPieces(as, b, piece + pieces, threads);
+    assert(pieces <= as->localPieceCount);
+
+    laik_threadpool_run(pool, pieces, execLocalPiece, piece);
+
+    return n;
 }
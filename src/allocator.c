@@ -0,0 +1,213 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2017-2019 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "laik-internal.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+//
+// Built-in allocators for mappings (see laik_new_allocator_preset)
+//
+// Mappings of at least PRESET_MMAP_MIN bytes are allocated via mmap,
+// allowing huge pages, NUMA placement via mbind, and first touch from
+// multiple threads. Smaller mappings just use malloc.
+// Memory is preceded by a header storing the length of the mmap'ed
+// region (0 for malloc), as the free callback does not get the size.
+//
+
+#define PRESET_MMAP_MIN (64 * 1024)
+#define PRESET_HEADER   64  // keeps alignment of returned memory
+#define PRESET_HUGE     ((size_t) 2 * 1024 * 1024)
+#define PRESET_HUGE1G   ((size_t) 1024 * 1024 * 1024)
+#define PRESET_TOUCH    ((size_t) 2 * 1024 * 1024) // bytes per touch block
+
+// mmap anonymous memory of <len> bytes aligned to <align>, unmapping
+// unaligned parts of a larger region
+static char* mmapAligned(size_t len, size_t align)
+{
+    char* p = mmap(0, len + align, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return 0;
+
+    size_t head = (size_t) ((uintptr_t) p % align);
+    if (head > 0) head = align - head;
+    if (head > 0) munmap(p, head);
+    if (align - head > 0) munmap(p + head + len, align - head);
+    return p + head;
+}
+
+// try to get <*len> bytes from reserved huge pages of size 1 << <shift>
+static char* mmapHugeTLB(size_t* len, int shift)
+{
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    size_t psize = (size_t) 1 << shift;
+    size_t hlen = (*len + psize - 1) & ~(psize - 1);
+    char* p = mmap(0, hlen, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                   (shift << MAP_HUGE_SHIFT), -1, 0);
+    if (p != MAP_FAILED) {
+        *len = hlen;
+        return p;
+    }
+    laik_log(1, "no huge pages of %llu KB available, using transparent "
+             "huge pages", (unsigned long long) (psize >> 10));
+#else
+    (void) len;
+    (void) shift;
+#endif
+    return 0;
+}
+
+// apply NUMA policy of allocator <a> to region [p; p+len[
+static void bindNuma(Laik_Allocator* a, char* p, size_t len)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long mask = (unsigned long) a->numaNodes;
+    int mode = (a->flags & LAIK_AF_NumaInterleave) ? MPOL_INTERLEAVE : MPOL_BIND;
+    if (mask == 0) {
+        if (mode == MPOL_INTERLEAVE) {
+            // all nodes we are allowed to use
+            if (syscall(SYS_get_mempolicy, 0, &mask, 8 * sizeof(mask) + 1,
+                        0, MPOL_F_MEMS_ALLOWED) != 0)
+                mask = 0;
+        }
+        else {
+            // node we are running on
+            unsigned int cpu, node;
+            if ((syscall(SYS_getcpu, &cpu, &node, 0) == 0) &&
+                (node < 8 * sizeof(mask)))
+                mask = 1UL << node;
+        }
+    }
+    if (mask == 0) return;
+
+    if (syscall(SYS_mbind, p, len, mode, &mask, 8 * sizeof(mask) + 1, 0) != 0)
+        laik_log(1, "mbind to NUMA nodes 0x%lx failed: %s",
+                 mask, strerror(errno));
+#else
+    (void) a;
+    (void) p;
+    (void) len;
+    laik_log(1, "NUMA placement not supported on this platform");
+#endif
+}
+
+struct touchCtx {
+    char* p;
+    size_t len;
+};
+
+static void touchBlock(void* ctx, int item)
+{
+    struct touchCtx* c = (struct touchCtx*) ctx;
+    size_t off = (size_t) item * PRESET_TOUCH;
+    size_t len = c->len - off;
+    if (len > PRESET_TOUCH) len = PRESET_TOUCH;
+    memset(c->p + off, 0, len);
+}
+
+// initialize <size> bytes at <ptr> from the threads working on it
+static void firstTouch(Laik_Data* d, char* ptr, size_t size)
+{
+    Laik_Allocator* a = d->allocator;
+    if (a->touch) {
+        (a->touch)(d, ptr, size);
+        return;
+    }
+
+    struct touchCtx c = { ptr, size };
+    int blocks = (int) ((size + PRESET_TOUCH - 1) / PRESET_TOUCH);
+    laik_threadpool_run(d->space->inst->threadPool, blocks, touchBlock, &c);
+}
+
+static void* presetMalloc(Laik_Data* d, size_t size)
+{
+    Laik_Allocator* a = d->allocator;
+    size_t len = size + PRESET_HEADER;
+
+    char* p = 0;
+    if (len < PRESET_MMAP_MIN) {
+        p = malloc(len);
+        if (!p) return 0;
+        *((size_t*) p) = 0;
+        return p + PRESET_HEADER;
+    }
+
+    bool huge = (a->flags & (LAIK_AF_HugePages |
+                             LAIK_AF_HugeTLB2M | LAIK_AF_HugeTLB1G)) &&
+                (len >= PRESET_HUGE);
+    // 1GB pages only for mappings of at least 1GB, to not waste most of it
+    if (huge && (a->flags & LAIK_AF_HugeTLB1G) && (len >= PRESET_HUGE1G))
+        p = mmapHugeTLB(&len, 30);
+    if (huge && !p && (a->flags & LAIK_AF_HugeTLB2M))
+        p = mmapHugeTLB(&len, 21);
+    if (!p) {
+        // align to huge page size for transparent huge pages to be usable
+        size_t psize = (size_t) sysconf(_SC_PAGESIZE);
+        len = (len + psize - 1) & ~(psize - 1);
+        p = mmapAligned(len, huge ? PRESET_HUGE : psize);
+        if (!p) return 0;
+#ifdef MADV_HUGEPAGE
+        if (huge) madvise(p, len, MADV_HUGEPAGE);
+#endif
+    }
+
+    if (a->flags & (LAIK_AF_NumaInterleave | LAIK_AF_NumaBind))
+        bindNuma(a, p, len);
+    if (a->flags & LAIK_AF_FirstTouch)
+        firstTouch(d, p + PRESET_HEADER, size);
+
+    *((size_t*) p) = len;
+    return p + PRESET_HEADER;
+}
+
+static void presetFree(Laik_Data* d, void* ptr)
+{
+    (void) d;
+    if (!ptr) return;
+
+    char* p = (char*) ptr - PRESET_HEADER;
+    size_t len = *((size_t*) p);
+    if (len == 0)
+        free(p);
+    else
+        munmap(p, len);
+}
+
+// returns a built-in allocator using mmap for large mappings, with huge
+// page, NUMA placement and first touch options given by <flags>
+Laik_Allocator* laik_new_allocator_preset(int flags, uint64_t numaNodes)
+{
+    Laik_Allocator* a = laik_new_allocator();
+    a->malloc = presetMalloc;
+    a->free = presetFree;
+    a->flags = flags;
+    a->numaNodes = numaNodes;
+
+    return a;
+}
@@ -40,7 +40,11 @@ static Laik_Backend laik_backend_mpi = {
     .finalize    = laik_mpi_finalize,
     .prepare     = laik_mpi_prepare,
     .cleanup     = laik_mpi_cleanup,
+    .rebase      = laik_mpi_rebase,
     .exec        = laik_mpi_exec,
+    .exec_start  = laik_mpi_exec_start,
+    .exec_test   = laik_mpi_exec_test,
+    .exec_wait   = laik_mpi_exec_wait,
     .updateGroup = laik_mpi_updateGroup,
     .log_action  = laik_mpi_log_action,
     .sync        = laik_mpi_sync,
@@ -59,6 +63,33 @@ static int mpi_reduce = 1;
 // LAIK_MPI_ASYNC: convert send/recv to isend/irecv? Default: Yes
 static int mpi_async = 1;
 
+// LAIK_MPI_PERSISTENT: with async, use persistent requests created at
+// prepare time instead of isend/irecv on each exec? Default: Yes
+static int mpi_persistent = 1;
+
+// LAIK_MPI_COMBINE: combine actions (e.g. sends to same task)? Default: Yes
+static int mpi_combine = 1;
+
+// LAIK_MPI_SORT: ordering of send/recv actions to avoid deadlocks,
+// "2phases" (default) or "rankdigits"
+static int mpi_sort_rankdigits = 0;
+
+// LAIK_MPI_REDUCESPLIT: with own reduction algorithm, do reductions in
+// 2 or 3 rounds (see Laik_ReduceSplit)? Default: 0, choose by group sizes
+static Laik_ReduceSplit mpi_reduce_split = LAIK_RS_Auto;
+
+// LAIK_MPI_AUTOTUNE: on first executions of a prepared sequence, try
+// variants of the transformations done in prepare (combining, sorting,
+// reduction rounds), and keep the fastest? Split-phase executions are
+// timed from start to completion. Default: No
+static int mpi_autotune = 0;
+
+// LAIK_MPI_AGGREGATE: forward messages among nodes via node leaders,
+// aggregating them? Only done for cached/reused action sequences.
+// 1: nodes given by locations of tasks (host names),
+// N > 1: emulate nodes of N consecutive tasks (for testing). Default: No
+static int mpi_aggregate = 0;
+
 
 //----------------------------------------------------------------
 // buffer space for messages if packing/unpacking from/to not-1d layout
@@ -75,16 +106,29 @@ static char packbuf[PACKBUFSIZE];
 #define LAIK_AT_MpiIrecv (LAIK_AT_Backend + 1)
 #define LAIK_AT_MpiIsend (LAIK_AT_Backend + 2)
 #define LAIK_AT_MpiWait  (LAIK_AT_Backend + 3)
+#define LAIK_AT_MpiStartAll (LAIK_AT_Backend + 4)
 
 // action structs must be packed
 #pragma pack(push,1)
 
+// parameters of a persistent request, to create it again if the buffer
+// it is bound to moves (see laik_mpi_rebase)
+typedef struct {
+    char* buf;
+    unsigned int count;
+    int rank; // destination for sends, source for receives
+    int tid;  // transition context, for the data type
+    bool send;
+} MPIPersistentReq;
+
 // ReqBuf action: provide base address for MPI_Request array
-// referenced in following IRecv/Wait actions via req_it operands
+// referenced in following IRecv/Wait actions via req_it operands.
+// With persistent requests, also their parameters
 typedef struct {
     Laik_Action h;
     unsigned int count;
     MPI_Request* req;
+    MPIPersistentReq* preq;
 } Laik_A_MpiReq;
 
 // IRecv action
@@ -116,6 +160,7 @@ void laik_mpi_addMpiReq(Laik_ActionSeq* as, int round,
                                              LAIK_AT_MpiReq, round, 0);
     a->count = count;
     a->req = buf;
+    a->preq = 0;
 }
 
 static
@@ -124,7 +169,8 @@ void laik_mpi_addMpiIrecv(Laik_ActionSeq* as, int round,
 {
     Laik_A_MpiIrecv* a;
     a = (Laik_A_MpiIrecv*) laik_aseq_addAction(as, sizeof(*a),
-                                               LAIK_AT_MpiIrecv, round, 0);
+                                               LAIK_AT_MpiIrecv, round,
+                                               as->currentTID);
     a->buf = toBuf;
     a->count = count;
     a->from_rank = from;
@@ -137,7 +183,8 @@ void laik_mpi_addMpiIsend(Laik_ActionSeq* as, int round,
 {
     Laik_A_MpiIsend* a;
     a = (Laik_A_MpiIsend*) laik_aseq_addAction(as, sizeof(*a),
-                                               LAIK_AT_MpiIsend, round, 0);
+                                               LAIK_AT_MpiIsend, round,
+                                               as->currentTID);
     a->buf = fromBuf;
     a->count = count;
     a->to_rank = to;
@@ -155,10 +202,30 @@ void laik_mpi_addMpiWait(Laik_ActionSeq* as, int round, int req_id)
 {
     Laik_A_MpiWait* a;
     a = (Laik_A_MpiWait*) laik_aseq_addAction(as, sizeof(*a),
-                                              LAIK_AT_MpiWait, round, 0);
+                                              LAIK_AT_MpiWait, round,
+                                              as->currentTID);
     a->req_id = req_id;
 }
 
+// StartAll action: start persistent requests [req_id; req_id+count[
+typedef struct {
+    Laik_Action h;
+    int req_id;
+    unsigned int count;
+} Laik_A_MpiStartAll;
+
+static
+void laik_mpi_addMpiStartAll(Laik_ActionSeq* as, int round,
+                             int req_id, unsigned int count)
+{
+    Laik_A_MpiStartAll* a;
+    a = (Laik_A_MpiStartAll*) laik_aseq_addAction(as, sizeof(*a),
+                                                  LAIK_AT_MpiStartAll, round,
+                                                  as->currentTID);
+    a->req_id = req_id;
+    a->count = count;
+}
+
 static
 bool laik_mpi_log_action(Laik_Action* a)
 {
@@ -189,6 +256,13 @@ bool laik_mpi_log_action(Laik_Action* a)
         break;
     }
 
+    case LAIK_AT_MpiStartAll: {
+        Laik_A_MpiStartAll* aa = (Laik_A_MpiStartAll*) a;
+        laik_log_append("MPI-StartAll: reqid %d - %d",
+                        aa->req_id, aa->req_id + aa->count - 1);
+        break;
+    }
+
     default:
         return false;
     }
@@ -219,11 +293,19 @@ bool laik_mpi_asyncSendRecv(Laik_ActionSeq* as)
     // - round maxround+2 gets Waits from MpiISend actions
 
     MPI_Request* buf = malloc(count * sizeof(MPI_Request));
+    if (!buf) {
+        laik_panic("Out of memory allocating MPI_Request array");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    // entries not MPI_REQUEST_NULL get freed on cleanup
+    for(unsigned int i = 0; i < count; i++)
+        buf[i] = MPI_REQUEST_NULL;
     laik_mpi_addMpiReq(as, 0, count, buf);
 
     int req_id = 0;
     a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        as->currentTID = a->tid;
         switch(a->type) {
         case LAIK_AT_BufSend: {
             Laik_A_BufSend* aa = (Laik_A_BufSend*) a;
@@ -312,11 +394,17 @@ Laik_Instance* laik_init_mpi_generic_backend(int* argc, char*** argv, Laik_Backe
     }
 
     // eventually initialize MPI first before accessing MPI_COMM_WORLD
+    // worker threads of LAIK (see LAIK_THREADS) never call MPI
+    int threadLevel;
     if (argc) {
-        err = MPI_Init(argc, argv);
+        err = MPI_Init_thread(argc, argv, MPI_THREAD_FUNNELED, &threadLevel);
         if (err != MPI_SUCCESS) laik_mpi_panic(err);
         d->didInit = true;
     }
+    else {
+        err = MPI_Query_thread(&threadLevel);
+        if (err != MPI_SUCCESS) laik_mpi_panic(err);
+    }
 
     // create own communicator duplicating WORLD to
     // - not have to worry about conflicting use of MPI_COMM_WORLD by application
@@ -353,6 +441,12 @@ Laik_Instance* laik_init_mpi_generic_backend(int* argc, char*** argv, Laik_Backe
     laik_log(2, "MPI backend initialized (at '%s', rank %d/%d)\n",
              inst->mylocation, rank, size);
 
+    if ((threadLevel < MPI_THREAD_FUNNELED) && (laik_get_threads(inst) > 1)) {
+        laik_log(LAIK_LL_Warning, "MPI without thread support: "
+                 "not using threads for local data movement");
+        laik_set_threads(inst, 1);
+    }
+
     // do own reduce algorithm?
     char* str = getenv("LAIK_MPI_REDUCE");
     if (str) mpi_reduce = atoi(str);
@@ -361,7 +455,42 @@ Laik_Instance* laik_init_mpi_generic_backend(int* argc, char*** argv, Laik_Backe
     str = getenv("LAIK_MPI_ASYNC");
     if (str) mpi_async = atoi(str);
 
+    // use persistent requests?
+    str = getenv("LAIK_MPI_PERSISTENT");
+    if (str) mpi_persistent = atoi(str);
+
+    // combine actions?
+    str = getenv("LAIK_MPI_COMBINE");
+    if (str) mpi_combine = atoi(str);
+
+    // which deadlock avoidance ordering?
+    str = getenv("LAIK_MPI_SORT");
+    if (str) mpi_sort_rankdigits = (strcmp(str, "rankdigits") == 0);
+
+    // number of rounds for reductions?
+    str = getenv("LAIK_MPI_REDUCESPLIT");
+    if (str) {
+        int rounds = atoi(str);
+        if (rounds == 2) mpi_reduce_split = LAIK_RS_2Rounds;
+        else if (rounds == 3) mpi_reduce_split = LAIK_RS_3Rounds;
+        else mpi_reduce_split = LAIK_RS_Auto;
+    }
+
+    // try transformation variants?
+    str = getenv("LAIK_MPI_AUTOTUNE");
+    if (str) mpi_autotune = atoi(str);
+    if (mpi_autotune && !mpi_async)
+        laik_log(2, "MPI autotune: only blocking send/recv allowed, disabled");
+
     mpi_instance = inst;
+
+    // aggregate messages among nodes?
+    str = getenv("LAIK_MPI_AGGREGATE");
+    if (str) mpi_aggregate = atoi(str);
+    // node detection uses locations of all tasks
+    if (mpi_aggregate == 1)
+        laik_sync_location(inst);
+
     return inst;
 }
 
@@ -509,13 +638,13 @@ void laik_mpi_exec_recvAndUnpack(Laik_Mapping* map, Laik_Slice* slc,
 }
 
 static
-void laik_mpi_exec_reduce(Laik_TransitionContext* tc, Laik_BackendAction* a,
+void laik_mpi_exec_reduce(Laik_TransitionContext* tc, Laik_A_Reduce* a,
                           MPI_Datatype dataType, MPI_Comm comm)
 {
     assert(mpi_reduce > 0);
 
     MPI_Op mpiRedOp = getMPIOp(a->redOp);
-    int rootTask = a->rank;
+    int rootTask = a->rootTask;
     int err;
 
     if (rootTask == -1) {
@@ -553,7 +682,7 @@ void laik_mpi_exec_reduce(Laik_TransitionContext* tc, Laik_BackendAction* a,
 // interested in the result
 static
 void laik_mpi_exec_groupReduce(Laik_TransitionContext* tc,
-                               Laik_BackendAction* a,
+                               Laik_A_GroupReduce* a,
                                MPI_Datatype dataType, MPI_Comm comm)
 {
     assert(a->h.type == LAIK_AT_GroupReduce);
@@ -666,9 +795,13 @@ void laik_mpi_exec_groupReduce(Laik_TransitionContext* tc,
     }
 }
 
+// prepare execution of <as> from start (also for split-phase execution)
 static
-void laik_mpi_exec(Laik_ActionSeq* as)
+void laik_mpi_exec_init(Laik_ActionSeq* as)
 {
+    as->execPos = 0;
+    as->execAction = as->action;
+
     if (as->actionCount == 0) {
         laik_log(1, "MPI backend exec: nothing to do\n");
         return;
@@ -689,6 +822,10 @@ void laik_mpi_exec(Laik_ActionSeq* as)
 
         int not_handled = laik_aseq_calc_stats(as);
         assert(not_handled == 0); // there should be no MPI-specific actions
+        laik_aseq_prepareLocalMoves(as);
+
+        // sequence was rewritten
+        as->execAction = as->action;
     }
 
     if (laik_log_begin(1)) {
@@ -696,34 +833,93 @@ void laik_mpi_exec(Laik_ActionSeq* as)
         laik_log_ActionSeq(as, false);
         laik_log_flush(0);
     }
+}
 
-    // TODO: use transition context given by each action
-    Laik_TransitionContext* tc = as->context[0];
-    Laik_MappingList* fromList = tc->fromList;
-    Laik_MappingList* toList = tc->toList;
-    int elemsize = tc->data->elemsize;
+// how far laik_mpi_exec_actions should go
+typedef enum _Laik_MpiExecMode {
+    LAIK_MPI_EXEC_ALL = 0, // execute all remaining actions
+    LAIK_MPI_EXEC_START,   // stop before first action waiting for remote data
+    LAIK_MPI_EXEC_TEST,    // same, but pass over waits for completed requests
+} Laik_MpiExecMode;
 
-    // common for all MPI calls: tag, comm, datatype
+// execute actions of <as>, continuing at the position remembered in <as>.
+// Returns true if all actions are done
+static
+bool laik_mpi_exec_actions(Laik_ActionSeq* as, Laik_MpiExecMode mode)
+{
+    if (as->execPos >= as->actionCount)
+        return true;
+
+    // common for all MPI calls: tag, comm (all transitions use same group)
     int tag = 1;
+    Laik_TransitionContext* tc = as->context[0];
     MPIGroupData* gd = mpiGroupData(tc->transition->group);
     assert(gd);
     MPI_Comm comm = gd->comm;
-    MPI_Datatype dataType = getMPIDataType(tc->data);
     MPI_Status st;
-    int err, count;
+    int err, count, flag;
 
-    // MPI_Request array: not set yet
+    // depending on transition context of action, set on context change
+    int tid = -1;
+    Laik_MappingList* fromList = 0;
+    Laik_MappingList* toList = 0;
+    int elemsize = 0;
+    MPI_Datatype dataType = MPI_DATATYPE_NULL;
+
+    // MPI_Request array: if existing, set up by first action.
+    // needed here when continuing a split-phase execution
     int req_count = 0;
     MPI_Request* req = 0;
+    if (as->action->type == LAIK_AT_MpiReq) {
+        req_count = ((Laik_A_MpiReq*) as->action)->count;
+        req = ((Laik_A_MpiReq*) as->action)->req;
+    }
+
+    unsigned int i = as->execPos;
+    Laik_Action* a = as->execAction;
+    for(; i < as->actionCount; i++, a = nextAction(a)) {
+        if (mode != LAIK_MPI_EXEC_ALL) {
+            // split-phase: stop before blocking
+            if (a->type == LAIK_AT_MpiWait) {
+                if (mode == LAIK_MPI_EXEC_START) break;
+
+                // request completed? then MPI_Wait below returns immediately
+                Laik_A_MpiWait* aa = (Laik_A_MpiWait*) a;
+                assert(aa->req_id < req_count);
+                err = MPI_Test(req + aa->req_id, &flag, &st);
+                if (err != MPI_SUCCESS) laik_mpi_panic(err);
+                if (!flag) break;
+            }
+            else if (laik_action_waitsForRemote(a))
+                break;
+            // blocking sends may wait for the matching receive, which
+            // the receiver may only post when finishing its sequence
+            else if (laik_action_isSend(a))
+                break;
+        }
+
+        // run of independent pack/unpack/copy actions: use thread pool
+        unsigned int done = laik_aseq_execLocalMoves(as, a, i);
+        if (done > 0) {
+            i += done - 1;
+            while(--done > 0) a = nextAction(a);
+            continue;
+        }
 
-    Laik_Action* a = as->action;
-    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
-        Laik_BackendAction* ba = (Laik_BackendAction*) a;
         if (laik_log_begin(1)) {
             laik_log_Action(a, as);
             laik_log_flush(0);
         }
 
+        if (a->tid != tid) {
+            tid = a->tid;
+            tc = as->context[tid];
+            fromList = tc->fromList;
+            toList = tc->toList;
+            elemsize = tc->data->elemsize;
+            dataType = getMPIDataType(tc->data);
+        }
+
         switch(a->type) {
         case LAIK_AT_BufReserve:
         case LAIK_AT_Nop:
@@ -769,19 +965,29 @@ void laik_mpi_exec(Laik_ActionSeq* as)
             break;
         }
 
+        case LAIK_AT_MpiStartAll: {
+            // MPI-specific action: start persistent requests
+            Laik_A_MpiStartAll* aa = (Laik_A_MpiStartAll*) a;
+            assert(aa->req_id + (int) aa->count <= req_count);
+            err = MPI_Startall(aa->count, req + aa->req_id);
+            if (err != MPI_SUCCESS) laik_mpi_panic(err);
+            break;
+        }
+
         case LAIK_AT_MapSend: {
-            assert(ba->fromMapNo < fromList->count);
-            Laik_Mapping* fromMap = &(fromList->map[ba->fromMapNo]);
+            Laik_A_MapSend* aa = (Laik_A_MapSend*) a;
+            assert(aa->fromMapNo < fromList->count);
+            Laik_Mapping* fromMap = &(fromList->map[aa->fromMapNo]);
             assert(fromMap->base != 0);
-            err = MPI_Send(fromMap->base + ba->offset, ba->count,
-                           dataType, ba->rank, tag, comm);
+            err = MPI_Send(fromMap->base + aa->offset, aa->count,
+                           dataType, aa->to_rank, tag, comm);
             if (err != MPI_SUCCESS) laik_mpi_panic(err);
             break;
         }
 
         case LAIK_AT_RBufSend: {
             Laik_A_RBufSend* aa = (Laik_A_RBufSend*) a;
-            assert(aa->bufID < ASEQ_BUFFER_MAX);
+            assert(aa->bufID < as->bufferCount);
             err = MPI_Send(as->buf[aa->bufID] + aa->offset, aa->count,
                            dataType, aa->to_rank, tag, comm);
             if (err != MPI_SUCCESS) laik_mpi_panic(err);
@@ -797,23 +1003,24 @@ void laik_mpi_exec(Laik_ActionSeq* as)
         }
 
         case LAIK_AT_MapRecv: {
-            assert(ba->toMapNo < toList->count);
-            Laik_Mapping* toMap = &(toList->map[ba->toMapNo]);
+            Laik_A_MapRecv* aa = (Laik_A_MapRecv*) a;
+            assert(aa->toMapNo < toList->count);
+            Laik_Mapping* toMap = &(toList->map[aa->toMapNo]);
             assert(toMap->base != 0);
-            err = MPI_Recv(toMap->base + ba->offset, ba->count,
-                           dataType, ba->rank, tag, comm, &st);
+            err = MPI_Recv(toMap->base + aa->offset, aa->count,
+                           dataType, aa->from_rank, tag, comm, &st);
             if (err != MPI_SUCCESS) laik_mpi_panic(err);
 
             // check that we received the expected number of elements
             err = MPI_Get_count(&st, dataType, &count);
             if (err != MPI_SUCCESS) laik_mpi_panic(err);
-            assert((int)ba->count == count);
+            assert((int)aa->count == count);
             break;
         }
 
         case LAIK_AT_RBufRecv: {
             Laik_A_RBufRecv* aa = (Laik_A_RBufRecv*) a;
-            assert(aa->bufID < ASEQ_BUFFER_MAX);
+            assert(aa->bufID < as->bufferCount);
             err = MPI_Recv(as->buf[aa->bufID] + aa->offset, aa->count,
                            dataType, aa->from_rank, tag, comm, &st);
             if (err != MPI_SUCCESS) laik_mpi_panic(err);
@@ -821,7 +1028,7 @@ void laik_mpi_exec(Laik_ActionSeq* as)
             // check that we received the expected number of elements
             err = MPI_Get_count(&st, dataType, &count);
             if (err != MPI_SUCCESS) laik_mpi_panic(err);
-            assert((int)ba->count == count);
+            assert((int)aa->count == count);
             break;
         }
 
@@ -834,45 +1041,55 @@ void laik_mpi_exec(Laik_ActionSeq* as)
             // check that we received the expected number of elements
             err = MPI_Get_count(&st, dataType, &count);
             if (err != MPI_SUCCESS) laik_mpi_panic(err);
-            assert((int)ba->count == count);
+            assert((int)aa->count == count);
             break;
         }
 
-        case LAIK_AT_CopyFromBuf:
-            for(unsigned int i = 0; i < ba->count; i++)
-                memcpy(ba->ce[i].ptr,
-                       ba->fromBuf + ba->ce[i].offset,
-                       ba->ce[i].bytes);
+        case LAIK_AT_CopyFromBuf: {
+            Laik_A_CopyFromBuf* aa = (Laik_A_CopyFromBuf*) a;
+            for(unsigned int i = 0; i < aa->count; i++)
+                memcpy(aa->ce[i].ptr,
+                       aa->fromBuf + aa->ce[i].offset,
+                       aa->ce[i].bytes);
             break;
+        }
 
-        case LAIK_AT_CopyToBuf:
-            for(unsigned int i = 0; i < ba->count; i++)
-                memcpy(ba->toBuf + ba->ce[i].offset,
-                       ba->ce[i].ptr,
-                       ba->ce[i].bytes);
+        case LAIK_AT_CopyToBuf: {
+            Laik_A_CopyToBuf* aa = (Laik_A_CopyToBuf*) a;
+            for(unsigned int i = 0; i < aa->count; i++)
+                memcpy(aa->toBuf + aa->ce[i].offset,
+                       aa->ce[i].ptr,
+                       aa->ce[i].bytes);
             break;
+        }
 
-        case LAIK_AT_PackToBuf:
-            laik_exec_pack(ba, ba->map);
+        case LAIK_AT_PackToBuf: {
+            Laik_A_PackToBuf* aa = (Laik_A_PackToBuf*) a;
+            laik_exec_pack(aa->map, aa->slc, aa->toBuf, aa->count);
             break;
+        }
 
         case LAIK_AT_MapPackToBuf: {
-            assert(ba->fromMapNo < fromList->count);
-            Laik_Mapping* fromMap = &(fromList->map[ba->fromMapNo]);
+            Laik_A_MapPackToBuf* aa = (Laik_A_MapPackToBuf*) a;
+            assert(aa->fromMapNo < fromList->count);
+            Laik_Mapping* fromMap = &(fromList->map[aa->fromMapNo]);
             assert(fromMap->base != 0);
-            laik_exec_pack(ba, fromMap);
+            laik_exec_pack(fromMap, aa->slc, aa->toBuf, aa->count);
             break;
         }
 
-        case LAIK_AT_UnpackFromBuf:
-            laik_exec_unpack(ba, ba->map);
+        case LAIK_AT_UnpackFromBuf: {
+            Laik_A_UnpackFromBuf* aa = (Laik_A_UnpackFromBuf*) a;
+            laik_exec_unpack(aa->map, aa->slc, aa->fromBuf, aa->count);
             break;
+        }
 
         case LAIK_AT_MapUnpackFromBuf: {
-            assert(ba->toMapNo < toList->count);
-            Laik_Mapping* toMap = &(toList->map[ba->toMapNo]);
+            Laik_A_MapUnpackFromBuf* aa = (Laik_A_MapUnpackFromBuf*) a;
+            assert(aa->toMapNo < toList->count);
+            Laik_Mapping* toMap = &(toList->map[aa->toMapNo]);
             assert(toMap->base);
-            laik_exec_unpack(ba, toMap);
+            laik_exec_unpack(toMap, aa->slc, aa->fromBuf, aa->count);
             break;
         }
 
@@ -887,11 +1104,13 @@ void laik_mpi_exec(Laik_ActionSeq* as)
             break;
         }
 
-        case LAIK_AT_PackAndSend:
-            laik_mpi_exec_packAndSend(ba->map, ba->slc, ba->rank,
-                                      (uint64_t) ba->count,
+        case LAIK_AT_PackAndSend: {
+            Laik_A_PackAndSend* aa = (Laik_A_PackAndSend*) a;
+            laik_mpi_exec_packAndSend(aa->map, aa->slc, aa->to_rank,
+                                      (uint64_t) aa->count,
                                       dataType, tag, comm);
             break;
+        }
 
         case LAIK_AT_MapRecvAndUnpack: {
             Laik_A_MapRecvAndUnpack* aa = (Laik_A_MapRecvAndUnpack*) a;
@@ -903,40 +1122,50 @@ void laik_mpi_exec(Laik_ActionSeq* as)
             break;
         }
 
-        case LAIK_AT_RecvAndUnpack:
-            laik_mpi_exec_recvAndUnpack(ba->map, ba->slc, ba->rank,
-                                        (uint64_t) ba->count,
+        case LAIK_AT_RecvAndUnpack: {
+            Laik_A_RecvAndUnpack* aa = (Laik_A_RecvAndUnpack*) a;
+            laik_mpi_exec_recvAndUnpack(aa->map, aa->slc, aa->from_rank,
+                                        (uint64_t) aa->count,
                                         elemsize, dataType, tag, comm);
             break;
+        }
 
         case LAIK_AT_Reduce:
-            laik_mpi_exec_reduce(tc, ba, dataType, comm);
+            laik_mpi_exec_reduce(tc, (Laik_A_Reduce*) a, dataType, comm);
             break;
 
         case LAIK_AT_GroupReduce:
-            laik_mpi_exec_groupReduce(tc, ba, dataType, comm);
+            laik_mpi_exec_groupReduce(tc, (Laik_A_GroupReduce*) a, dataType, comm);
             break;
 
-        case LAIK_AT_RBufLocalReduce:
-            assert(ba->bufID < ASEQ_BUFFER_MAX);
-            assert(ba->dtype->reduce != 0);
-            (ba->dtype->reduce)(ba->toBuf, ba->toBuf, as->buf[ba->bufID] + ba->offset,
-                               ba->count, ba->redOp);
+        case LAIK_AT_RBufLocalReduce: {
+            Laik_A_RBufLocalReduce* aa = (Laik_A_RBufLocalReduce*) a;
+            assert(aa->bufID < as->bufferCount);
+            assert(aa->dtype->reduce != 0);
+            (aa->dtype->reduce)(aa->toBuf, aa->toBuf, as->buf[aa->bufID] + aa->offset,
+                                aa->count, aa->redOp);
             break;
+        }
 
-        case LAIK_AT_RBufCopy:
-            assert(ba->bufID < ASEQ_BUFFER_MAX);
-            memcpy(ba->toBuf, as->buf[ba->bufID] + ba->offset, ba->count * elemsize);
+        case LAIK_AT_RBufCopy: {
+            Laik_A_RBufCopy* aa = (Laik_A_RBufCopy*) a;
+            assert(aa->bufID < as->bufferCount);
+            memcpy(aa->toBuf, as->buf[aa->bufID] + aa->offset, aa->count * elemsize);
             break;
+        }
 
-        case LAIK_AT_BufCopy:
-            memcpy(ba->toBuf, ba->fromBuf, ba->count * elemsize);
+        case LAIK_AT_BufCopy: {
+            Laik_A_BufCopy* aa = (Laik_A_BufCopy*) a;
+            memcpy(aa->toBuf, aa->fromBuf, aa->count * elemsize);
             break;
+        }
 
-        case LAIK_AT_BufInit:
-            assert(ba->dtype->init != 0);
-            (ba->dtype->init)(ba->toBuf, ba->count, ba->redOp);
+        case LAIK_AT_BufInit: {
+            Laik_A_BufInit* aa = (Laik_A_BufInit*) a;
+            assert(aa->dtype->init != 0);
+            (aa->dtype->init)(aa->toBuf, aa->count, aa->redOp);
             break;
+        }
 
         default:
             laik_log(LAIK_LL_Panic, "mpi_exec: no idea how to exec action %d (%s)",
@@ -944,20 +1173,205 @@ void laik_mpi_exec(Laik_ActionSeq* as)
             assert(0);
         }
     }
+    as->execPos = i;
+    as->execAction = a;
+    if (i < as->actionCount)
+        return false;
+
     assert( ((char*)as->action) + as->bytesUsed == ((char*)a) );
+    return true;
+}
+
+// autotuning state, see laik_mpi_autotuneUpdate
+typedef struct _MPIAutotune MPIAutotune;
+static
+void laik_mpi_autotuneUpdate(Laik_ActionSeq* as, MPIAutotune* at, double t);
+static
+MPIAutotune* laik_mpi_autotuneBegin(Laik_ActionSeq* as);
+static
+void laik_mpi_autotuneEnd(MPIAutotune* at);
+
+static
+void laik_mpi_exec(Laik_ActionSeq* as)
+{
+    // with autotuning state, measure time
+    MPIAutotune* at = laik_mpi_autotuneBegin(as);
+    double start = at ? MPI_Wtime() : 0.0;
+
+    laik_mpi_exec_init(as);
+    laik_mpi_exec_actions(as, LAIK_MPI_EXEC_ALL);
+
+    if (at)
+        laik_mpi_autotuneUpdate(as, at, MPI_Wtime() - start);
+}
+
+// split-phase execution: with async send/recv (LAIK_MPI_ASYNC), start
+// posts all receives and sends, and waits are done in exec_test/exec_wait.
+// For autotuning, the time from start to completion is measured. It includes
+// work done by the application in-between, which is the same for all variants
+
+static
+void laik_mpi_exec_start(Laik_ActionSeq* as)
+{
+    laik_mpi_autotuneBegin(as);
+
+    laik_mpi_exec_init(as);
+    laik_mpi_exec_actions(as, LAIK_MPI_EXEC_START);
+}
+
+static
+bool laik_mpi_exec_test(Laik_ActionSeq* as)
+{
+    if (!laik_mpi_exec_actions(as, LAIK_MPI_EXEC_TEST))
+        return false;
+
+    MPIAutotune* at = as->backend_data;
+    if (at)
+        laik_mpi_autotuneEnd(at);
+    return true;
+}
+
+static
+void laik_mpi_exec_wait(Laik_ActionSeq* as)
+{
+    laik_mpi_exec_actions(as, LAIK_MPI_EXEC_ALL);
+
+    MPIAutotune* at = as->backend_data;
+    if (at)
+        laik_mpi_autotuneEnd(at);
+}
+
+
+// create persistent request <req> for sequence <as> with parameters <p>
+static
+void laik_mpi_initPersistent(Laik_ActionSeq* as, MPI_Request* req,
+                             MPIPersistentReq* p)
+{
+    int tag = 1;
+    MPIGroupData* gd = mpiGroupData(((Laik_TransitionContext*) as->context[0])->transition->group);
+    assert(gd);
+    Laik_TransitionContext* tc = as->context[p->tid];
+    MPI_Datatype dataType = getMPIDataType(tc->data);
+    int err;
+    if (p->send)
+        err = MPI_Send_init(p->buf, p->count, dataType, p->rank,
+                            tag, gd->comm, req);
+    else
+        err = MPI_Recv_init(p->buf, p->count, dataType, p->rank,
+                            tag, gd->comm, req);
+    if (err != MPI_SUCCESS) laik_mpi_panic(err);
 }
 
+// transformation: replace MpiIsend/MpiIrecv actions by persistent requests
+// which are created here once, to be started on each exec by MpiStartAll
+// actions. This avoids setup of requests on each execution of a prepared
+// sequence. Consecutive isend/irecv actions in the same round are started
+// with one MpiStartAll, thus request IDs get renumbered. As MpiStartAll
+// does not show message sizes, statistics must be calculated before.
+static
+bool laik_mpi_persistentRequests(Laik_ActionSeq* as)
+{
+    // must not have new actions, we want to start a new build
+    assert(as->newActionCount == 0);
+
+    // request array is set up by first action (see laik_mpi_asyncSendRecv)
+    if ((as->actionCount == 0) || (as->action->type != LAIK_AT_MpiReq))
+        return false;
+    Laik_A_MpiReq* ra = (Laik_A_MpiReq*) as->action;
+    MPI_Request* req = ra->req;
+
+    // new request IDs in order of isend/irecv actions
+    int* newID = malloc(ra->count * sizeof(int));
+    MPIPersistentReq* preq = malloc(ra->count * sizeof(MPIPersistentReq));
+    if (!newID || !preq) {
+        laik_panic("Out of memory allocating request ID map");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(unsigned int i = 0; i < ra->count; i++)
+        newID[i] = -1;
+
+    int next_id = 0;
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        if ((a->type != LAIK_AT_MpiIsend) && (a->type != LAIK_AT_MpiIrecv))
+            continue;
+
+        MPIPersistentReq* p = preq + next_id;
+        p->tid = a->tid;
+        if (a->type == LAIK_AT_MpiIsend) {
+            Laik_A_MpiIsend* aa = (Laik_A_MpiIsend*) a;
+            assert(newID[aa->req_id] < 0);
+            newID[aa->req_id] = next_id;
+            p->buf = aa->buf;
+            p->count = aa->count;
+            p->rank = aa->to_rank;
+            p->send = true;
+        }
+        else {
+            Laik_A_MpiIrecv* aa = (Laik_A_MpiIrecv*) a;
+            assert(newID[aa->req_id] < 0);
+            newID[aa->req_id] = next_id;
+            p->buf = aa->buf;
+            p->count = aa->count;
+            p->rank = aa->from_rank;
+            p->send = false;
+        }
+        laik_mpi_initPersistent(as, req + next_id, p);
+        next_id++;
+    }
+    assert(next_id == (int) ra->count);
+    ra->preq = preq;
+
+    // start ID and count of currently collected requests to start
+    int start_id = 0, start_count = 0, start_round = 0;
+    a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        as->currentTID = a->tid;
+        if ((a->type == LAIK_AT_MpiIsend) || (a->type == LAIK_AT_MpiIrecv)) {
+            int id = (a->type == LAIK_AT_MpiIsend) ?
+                         ((Laik_A_MpiIsend*) a)->req_id :
+                         ((Laik_A_MpiIrecv*) a)->req_id;
+            if ((start_count > 0) && (a->round == start_round)) {
+                assert(newID[id] == start_id + start_count);
+                start_count++;
+                continue;
+            }
+            if (start_count > 0)
+                laik_mpi_addMpiStartAll(as, start_round, start_id, start_count);
+            start_id = newID[id];
+            start_count = 1;
+            start_round = a->round;
+            continue;
+        }
+
+        if (start_count > 0) {
+            laik_mpi_addMpiStartAll(as, start_round, start_id, start_count);
+            start_count = 0;
+        }
+
+        if (a->type == LAIK_AT_MpiWait) {
+            Laik_A_MpiWait* aa = (Laik_A_MpiWait*) a;
+            laik_mpi_addMpiWait(as, a->round, newID[aa->req_id]);
+        }
+        else
+            laik_aseq_add(a, as, -1);
+    }
+    if (start_count > 0)
+        laik_mpi_addMpiStartAll(as, start_round, start_id, start_count);
+
+    free(newID);
+    laik_aseq_activateNewActions(as);
+    return true;
+}
 
 // calc statistics updates for MPI-specific actions
 static
 void laik_mpi_aseq_calc_stats(Laik_ActionSeq* as)
 {
     unsigned int count;
-    Laik_TransitionContext* tc = as->context[0];
-    int current_tid = 0;
     Laik_Action* a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
-        assert(a->tid == current_tid); // TODO: only assumes actions from one transition
+        Laik_TransitionContext* tc = actionContext(as, a);
         switch(a->type) {
         case LAIK_AT_MpiIsend:
             count = ((Laik_A_MpiIsend*)a)->count;
@@ -977,20 +1391,226 @@ void laik_mpi_aseq_calc_stats(Laik_ActionSeq* as)
 }
 
 
+//----------------------------------------------------------------------------
+// aggregation of messages among nodes (LAIK_MPI_AGGREGATE)
+//
+// Messages among tasks on different nodes are forwarded via node leaders,
+// see laik_aseq_aggregateByNode. For this, leaders need to know the
+// communication of all tasks on their node: when preparing a cached
+// sequence, each task sends its element counts to its leader, which
+// returns the number of communicating task pairs per node pair.
+// No communication among nodes is needed: leaders of both nodes of a
+// pair see the same task pairs, once as sends and once as receives
+
+// tag for exchange of element counts with node leader (data uses tag 1)
+#define MPI_AGGREGATE_TAG 2
+
+// are locations <loc1> and <loc2> on same node?
+// MPI locations are "<host name>:<pid>"
 static
-void laik_mpi_prepare(Laik_ActionSeq* as)
+bool laik_mpi_isSameNode(const char* loc1, const char* loc2)
 {
-    if (laik_log_begin(1)) {
-        laik_log_append("MPI backend prepare:\n");
-        laik_log_ActionSeq(as, false);
-        laik_log_flush(0);
+    const char* end1 = strrchr(loc1, ':');
+    const char* end2 = strrchr(loc2, ':');
+    size_t len1 = end1 ? (size_t)(end1 - loc1) : strlen(loc1);
+    size_t len2 = end2 ? (size_t)(end2 - loc2) : strlen(loc2);
+    return (len1 == len2) && (strncmp(loc1, loc2, len1) == 0);
+}
+
+static
+void laik_mpi_aggregationFree(Laik_NodeComm* nc)
+{
+    if (!nc) return;
+    free(nc->sent[0]);
+    free(nc->pairsTo[0]);
+    free(nc->index);
+    free(nc->leader);
+    free(nc);
+}
+
+// collect information for aggregation of messages in <as>.
+// returns 0 if not enabled or all tasks are on same node.
+// must be called by all tasks on the node of this task
+static
+Laik_NodeComm* laik_mpi_aggregationNew(Laik_ActionSeq* as)
+{
+    if ((mpi_aggregate == 0) || (as->contextCount == 0)) return 0;
+
+    Laik_TransitionContext* tc = as->context[0];
+    Laik_Group* g = tc->transition->group;
+    if (g->myid < 0) return 0;
+    int size = g->size;
+    int myid = g->myid;
+
+    int* leader = malloc(size * sizeof(int));
+    if (!leader) {
+        laik_panic("Out of memory allocating node leaders");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    bool multiNode = false;
+    for(int i = 0; i < size; i++) {
+        if (mpi_aggregate > 1)
+            leader[i] = i - i % mpi_aggregate;
+        else {
+            char* loc = laik_group_location(g, i);
+            if (!loc) {
+                // locations not known
+                free(leader);
+                return 0;
+            }
+            // leader is the first task on same node
+            leader[i] = i;
+            for(int j = 0; j < i; j++) {
+                if (!laik_mpi_isSameNode(loc, laik_group_location(g, j))) continue;
+                leader[i] = j;
+                break;
+            }
+        }
+        if (leader[i] != leader[0]) multiNode = true;
+    }
+    if (!multiNode) {
+        free(leader);
+        return 0;
+    }
+
+    // leaders get rows for all tasks on their node, others only own row
+    bool isLeader = (leader[myid] == myid);
+    Laik_NodeComm* nc = malloc(sizeof(Laik_NodeComm));
+    int* index = malloc(size * sizeof(int));
+    if (!nc || !index) {
+        laik_panic("Out of memory allocating node communication");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    int rows = 0;
+    for(int i = 0; i < size; i++) {
+        if ((i == myid) || (isLeader && (leader[i] == myid)))
+            index[i] = rows++;
+        else
+            index[i] = -1;
+    }
+    nc->size = size;
+    nc->leader = leader;
+    nc->index = index;
+    nc->rows = rows;
+
+    // sent/received counts of all contexts in one block; for non-leaders,
+    // this is the message to the leader
+    int cc = as->contextCount;
+    int n = cc * size;
+    unsigned int* counts = malloc(2 * n * rows * sizeof(unsigned int));
+    int* pairs = malloc(2 * n * sizeof(int));
+    if (!counts || !pairs) {
+        laik_panic("Out of memory allocating node communication");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(int i = 0; i < 2 * n * rows; i++)
+        counts[i] = 0;
+    for(int tid = 0; tid < ASEQ_CONTEXTS_MAX; tid++) {
+        bool used = (tid < cc);
+        nc->sent[tid] = used ? counts + tid * rows * size : 0;
+        nc->received[tid] = used ? counts + (cc + tid) * rows * size : 0;
+        nc->pairsTo[tid] = used ? pairs + tid * size : 0;
+        nc->pairsFrom[tid] = used ? pairs + (cc + tid) * size : 0;
+    }
+
+    // own element counts
+    int myrow = index[myid] * size;
+    for(int tid = 0; tid < cc; tid++) {
+        Laik_Transition* t = ((Laik_TransitionContext*) as->context[tid])->transition;
+        assert(t->group == g);
+        for(int i = 0; i < t->sendCount; i++) {
+            struct sendTOp* op = &(t->send[i]);
+            nc->sent[tid][myrow + op->toTask] += (unsigned int) laik_slice_size(&(op->slc));
+        }
+        for(int i = 0; i < t->recvCount; i++) {
+            struct recvTOp* op = &(t->recv[i]);
+            nc->received[tid][myrow + op->fromTask] += (unsigned int) laik_slice_size(&(op->slc));
+        }
+    }
+
+    MPIGroupData* gd = mpiGroupData(g);
+    assert(gd);
+    int err;
+    if (!isLeader) {
+        err = MPI_Send(counts, 2 * n, MPI_UNSIGNED, leader[myid],
+                       MPI_AGGREGATE_TAG, gd->comm);
+        if (err != MPI_SUCCESS) laik_mpi_panic(err);
+        err = MPI_Recv(pairs, 2 * n, MPI_INT, leader[myid],
+                       MPI_AGGREGATE_TAG, gd->comm, MPI_STATUS_IGNORE);
+        if (err != MPI_SUCCESS) laik_mpi_panic(err);
+        return nc;
+    }
+
+    // leader: collect counts of tasks on my node, in rows of each context
+    unsigned int* msg = malloc(2 * n * sizeof(unsigned int));
+    if (!msg) {
+        laik_panic("Out of memory allocating node communication");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(int task = 0; task < size; task++) {
+        if ((index[task] < 0) || (task == myid)) continue;
+        err = MPI_Recv(msg, 2 * n, MPI_UNSIGNED, task,
+                       MPI_AGGREGATE_TAG, gd->comm, MPI_STATUS_IGNORE);
+        if (err != MPI_SUCCESS) laik_mpi_panic(err);
+        int row = index[task] * size;
+        for(int tid = 0; tid < cc; tid++)
+            for(int i = 0; i < size; i++) {
+                nc->sent[tid][row + i] = msg[tid * size + i];
+                nc->received[tid][row + i] = msg[n + tid * size + i];
+            }
+    }
+    free(msg);
+
+    // count communicating task pairs with remote nodes
+    for(int i = 0; i < 2 * n; i++)
+        pairs[i] = 0;
+    for(int tid = 0; tid < cc; tid++)
+        for(int row = 0; row < rows; row++)
+            for(int i = 0; i < size; i++) {
+                if (leader[i] == myid) continue;
+                if (nc->sent[tid][row * size + i] > 0)
+                    nc->pairsTo[tid][leader[i]]++;
+                if (nc->received[tid][row * size + i] > 0)
+                    nc->pairsFrom[tid][leader[i]]++;
+            }
+
+    for(int task = 0; task < size; task++) {
+        if ((index[task] < 0) || (task == myid)) continue;
+        err = MPI_Send(pairs, 2 * n, MPI_INT, task,
+                       MPI_AGGREGATE_TAG, gd->comm);
+        if (err != MPI_SUCCESS) laik_mpi_panic(err);
     }
 
+    return nc;
+}
+
+
+// options for transformations done in prepare
+typedef struct _MPIPipeline {
+    Laik_NodeComm* agg; // aggregate messages among nodes if set
+    bool combine;
+    bool rankdigits;
+    bool async;
+    bool persistent; // only used with async send/recv
+    Laik_ReduceSplit reduceSplit;
+} MPIPipeline;
+
+// run transformations on <as> as given by <p>
+static
+void laik_mpi_prepareWith(Laik_ActionSeq* as, MPIPipeline* p)
+{
     // mark as prepared by MPI backend: for MPI-specific cleanup + action logging
     as->backend = &laik_backend_mpi;
 
     bool changed = laik_aseq_splitTransitionExecs(as);
     laik_log_ActionSeqIfChanged(changed, as, "After splitting transition execs");
+
+    if (p->agg) {
+        // may add actions even if this task has no own communication
+        changed = laik_aseq_aggregateByNode(as, p->agg);
+        laik_log_ActionSeqIfChanged(changed, as, "After aggregating messages by node");
+    }
+
     if (as->actionCount == 0) {
         laik_aseq_calc_stats(as);
         return;
@@ -1006,13 +1626,15 @@ void laik_mpi_prepare(Laik_ActionSeq* as)
         laik_log_ActionSeqIfChanged(changed, as, "After all-reduce detection");
     }
 
-    changed = laik_aseq_combineActions(as);
-    laik_log_ActionSeqIfChanged(changed, as, "After combining actions 1");
+    if (p->combine) {
+        changed = laik_aseq_combineActions(as);
+        laik_log_ActionSeqIfChanged(changed, as, "After combining actions 1");
+    }
 
     changed = laik_aseq_allocBuffer(as);
     laik_log_ActionSeqIfChanged(changed, as, "After buffer allocation 1");
 
-    changed = laik_aseq_splitReduce(as);
+    changed = laik_aseq_splitReduce(as, p->reduceSplit);
     laik_log_ActionSeqIfChanged(changed, as, "After splitting reduce actions");
 
     changed = laik_aseq_allocBuffer(as);
@@ -1021,27 +1643,308 @@ void laik_mpi_prepare(Laik_ActionSeq* as)
     changed = laik_aseq_sort_rounds(as);
     laik_log_ActionSeqIfChanged(changed, as, "After sorting rounds");
 
-    changed = laik_aseq_combineActions(as);
-    laik_log_ActionSeqIfChanged(changed, as, "After combining actions 2");
+    if (p->combine) {
+        changed = laik_aseq_combineActions(as);
+        laik_log_ActionSeqIfChanged(changed, as, "After combining actions 2");
+    }
 
     changed = laik_aseq_allocBuffer(as);
     laik_log_ActionSeqIfChanged(changed, as, "After buffer allocation 3");
 
-    changed = laik_aseq_sort_2phases(as);
-    //changed = laik_aseq_sort_rankdigits(as);
+    if (p->rankdigits)
+        changed = laik_aseq_sort_rankdigits(as);
+    else
+        changed = laik_aseq_sort_2phases(as);
     laik_log_ActionSeqIfChanged(changed, as, "After sorting for deadlock avoidance");
 
-    if (mpi_async) {
+    if (p->async) {
         changed = laik_mpi_asyncSendRecv(as);
         laik_log_ActionSeqIfChanged(changed, as, "After makeing send/recv async");
 
         changed = laik_aseq_sort_rounds(as);
         laik_log_ActionSeqIfChanged(changed, as, "After sorting rounds 2");
     }
-    laik_aseq_freeTempSpace(as);
 
     laik_aseq_calc_stats(as);
     laik_mpi_aseq_calc_stats(as);
+
+    if (p->async && p->persistent) {
+        // must be done after statistics, see laik_mpi_persistentRequests
+        changed = laik_mpi_persistentRequests(as);
+        laik_log_ActionSeqIfChanged(changed, as, "After using persistent requests");
+    }
+    laik_aseq_freeTempSpace(as);
+    laik_aseq_prepareLocalMoves(as);
+}
+
+
+//----------------------------------------------------------------------------
+// autotuning of transformations (LAIK_MPI_AUTOTUNE)
+//
+// The first executions of a prepared sequence are used to measure the
+// variants of send/recv: async with persistent requests, async, and
+// blocking. Each variant is executed MPI_AUTOTUNE_RUNS times, taking the
+// fastest run. Afterwards, the sequence is prepared with the best variant.
+//
+// Each task decides on its own, from its own measurements: tasks may differ
+// in cache hits and evictions, so there is no common point to agree on a
+// variant. Thus, variants must not change the messages exchanged or the
+// order they are waited for. Combining actions, sorting for deadlock
+// avoidance and splitting reductions do, and are set by LAIK_MPI_COMBINE,
+// LAIK_MPI_SORT and LAIK_MPI_REDUCESPLIT. LAIK_MPI_ASYNC=0 and
+// LAIK_MPI_PERSISTENT=0 exclude variants.
+
+#define MPI_AUTOTUNE_RUNS 3
+#define MPI_AUTOTUNE_VARIANTS 3
+
+// autotuning state of a prepared sequence, in as->backend_data
+struct _MPIAutotune {
+    Laik_NodeComm* agg;        // for preparing variants, see MPIPipeline
+    int variant;               // variant currently prepared
+    int runs;                  // measured executions of current variant
+    double time;               // fastest execution of current variant
+    int best;                  // fastest variant so far
+    double bestTime;
+    double start;              // start of current execution
+    double splitTime;          // split-phase execution not accounted yet
+};
+
+static
+void laik_mpi_autotuneFree(MPIAutotune* at)
+{
+    if (!at) return;
+    laik_mpi_aggregationFree(at->agg);
+    free(at);
+}
+
+// transformation options for autotuning variant <v>:
+// 0: async with persistent requests, 1: async, 2: blocking
+static
+void laik_mpi_autotuneVariant(int v, MPIPipeline* p)
+{
+    p->combine = mpi_combine;
+    p->rankdigits = mpi_sort_rankdigits;
+    p->reduceSplit = mpi_reduce_split;
+    p->async = (v < 2);
+    p->persistent = (v == 0);
+}
+
+static
+void laik_mpi_autotuneLog(int v, const char* msg)
+{
+    laik_log_append("%s variant %d: send/recv %s", msg, v,
+                    (v == 0) ? "async, persistent" :
+                    (v == 1) ? "async" : "blocking");
+}
+
+// release MPI requests used by a prepared sequence
+static
+void laik_mpi_freeRequests(Laik_ActionSeq* as)
+{
+    if ((as->actionCount > 0) && (as->action->type == LAIK_AT_MpiReq)) {
+        Laik_A_MpiReq* aa = (Laik_A_MpiReq*) as->action;
+        // free persistent requests
+        for(unsigned int i = 0; i < aa->count; i++)
+            if (aa->req[i] != MPI_REQUEST_NULL)
+                MPI_Request_free(aa->req + i);
+        free(aa->req);
+        free(aa->preq);
+        laik_log(1, "  freed MPI_Request array with %d entries", aa->count);
+    }
+}
+
+// prepare <as> again with autotuning variant <v>
+static
+void laik_mpi_autotuneSwitch(Laik_ActionSeq* as, MPIAutotune* at, int v)
+{
+    laik_mpi_freeRequests(as);
+    laik_aseq_reset(as);
+
+    // prepare with the mappings used in the original preparation:
+    // mappings provided for this execution may be temporary
+    Laik_MappingList *fromList[ASEQ_CONTEXTS_MAX], *toList[ASEQ_CONTEXTS_MAX];
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_TransitionContext* tc = as->context[i];
+        fromList[i] = tc->fromList;
+        toList[i] = tc->toList;
+        tc->fromList = tc->prepFromList;
+        tc->toList = tc->prepToList;
+    }
+
+    MPIPipeline p;
+    p.agg = at->agg;
+    laik_mpi_autotuneVariant(v, &p);
+    laik_mpi_prepareWith(as, &p);
+    laik_aseq_validate(as);
+
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_TransitionContext* tc = as->context[i];
+        tc->fromList = fromList[i];
+        tc->toList = toList[i];
+    }
+
+    at->variant = v;
+    at->runs = 0;
+    at->time = -1.0;
+    as->backend_data = at;
+}
+
+// account execution time <t> of current variant, switch variants if needed
+static
+void laik_mpi_autotuneUpdate(Laik_ActionSeq* as, MPIAutotune* at, double t)
+{
+    if ((at->time < 0) || (t < at->time))
+        at->time = t;
+    at->runs++;
+    if (at->runs < MPI_AUTOTUNE_RUNS) return;
+
+    if (laik_log_begin(1)) {
+        laik_mpi_autotuneLog(at->variant, "MPI autotune: ");
+        laik_log_flush(" for '%s': %.3f us", as->name, 1000000.0 * at->time);
+    }
+    if ((at->best < 0) || (at->time < at->bestTime)) {
+        at->best = at->variant;
+        at->bestTime = at->time;
+    }
+
+    if (at->variant + 1 < MPI_AUTOTUNE_VARIANTS) {
+        laik_mpi_autotuneSwitch(as, at, at->variant + 1);
+        return;
+    }
+
+    // all variants checked
+    if (laik_log_begin(2)) {
+        laik_mpi_autotuneLog(at->best, "MPI autotune: chose");
+        laik_log_flush(" for '%s' (%.3f us)", as->name, 1000000.0 * at->bestTime);
+    }
+    if (at->best != at->variant)
+        laik_mpi_autotuneSwitch(as, at, at->best);
+    laik_mpi_autotuneFree(at);
+    as->backend_data = 0;
+}
+
+// execution of <as> starts: account time of a previous split-phase
+// execution, and return autotuning state with start time set, or 0 if
+// autotuning is finished
+static
+MPIAutotune* laik_mpi_autotuneBegin(Laik_ActionSeq* as)
+{
+    MPIAutotune* at = as->backend_data;
+    if (!at) return 0;
+
+    if (at->splitTime >= 0.0) {
+        double t = at->splitTime;
+        at->splitTime = -1.0;
+        laik_mpi_autotuneUpdate(as, at, t);
+        at = as->backend_data;
+        if (!at) return 0;
+    }
+    at->start = MPI_Wtime();
+    return at;
+}
+
+// split-phase execution completed. The time is accounted on next start:
+// switching variants prepares the sequence again, which is not possible
+// before the switch using it is finished
+static
+void laik_mpi_autotuneEnd(MPIAutotune* at)
+{
+    at->splitTime = MPI_Wtime() - at->start;
+}
+
+// start autotuning for <as> prepared with its first variant and aggregation
+// information <agg>, which is taken over
+static
+void laik_mpi_autotuneStart(Laik_ActionSeq* as, Laik_NodeComm* agg)
+{
+    // only tasks with communication call the backend for execution (see
+    // startASeq)
+    if (!laik_aseq_needsExec(as)) {
+        laik_mpi_aggregationFree(agg);
+        return;
+    }
+
+    MPIAutotune* at = malloc(sizeof(MPIAutotune));
+    if (!at) {
+        laik_panic("Out of memory allocating autotuning state");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    at->agg = agg;
+    at->variant = mpi_persistent ? 0 : 1;
+    at->runs = 0;
+    at->time = -1.0;
+    at->best = -1;
+    at->bestTime = 0.0;
+    at->start = 0.0;
+    at->splitTime = -1.0;
+    as->backend_data = at;
+}
+
+static
+void laik_mpi_prepare(Laik_ActionSeq* as)
+{
+    if (laik_log_begin(1)) {
+        laik_log_append("MPI backend prepare:\n");
+        laik_log_ActionSeq(as, false);
+        laik_log_flush(0);
+    }
+
+    MPIPipeline p;
+    // exchange with node leader only pays off for repeated executions
+    p.agg = as->reused ? laik_mpi_aggregationNew(as) : 0;
+    if (!mpi_autotune || !mpi_async || !as->reused) {
+        p.combine = mpi_combine;
+        p.rankdigits = mpi_sort_rankdigits;
+        p.async = mpi_async;
+        p.persistent = mpi_persistent;
+        p.reduceSplit = mpi_reduce_split;
+        laik_mpi_prepareWith(as, &p);
+        laik_mpi_aggregationFree(p.agg);
+        return;
+    }
+
+    // autotuning: start with first variant
+    laik_mpi_autotuneVariant(mpi_persistent ? 0 : 1, &p);
+    laik_mpi_prepareWith(as, &p);
+    laik_mpi_autotuneStart(as, p.agg);
+}
+
+// buffers of <as> moved to <newBuf> before an execution: update async
+// send/recv actions, and create persistent requests bound to moved buffers
+// again
+static void laik_mpi_rebase(Laik_ActionSeq* as, char** newBuf)
+{
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        if (a->type == LAIK_AT_MpiIsend) {
+            Laik_A_MpiIsend* aa = (Laik_A_MpiIsend*) a;
+            aa->buf = laik_aseq_rebasePtr(as, newBuf, aa->buf);
+        }
+        else if (a->type == LAIK_AT_MpiIrecv) {
+            Laik_A_MpiIrecv* aa = (Laik_A_MpiIrecv*) a;
+            aa->buf = laik_aseq_rebasePtr(as, newBuf, aa->buf);
+        }
+    }
+
+    if ((as->actionCount == 0) || (as->action->type != LAIK_AT_MpiReq))
+        return;
+    Laik_A_MpiReq* ra = (Laik_A_MpiReq*) as->action;
+    if (!ra->preq) return;
+
+    int count = 0;
+    for(unsigned int i = 0; i < ra->count; i++) {
+        MPIPersistentReq* p = ra->preq + i;
+        char* buf = laik_aseq_rebasePtr(as, newBuf, p->buf);
+        if (buf == p->buf) continue;
+
+        // not active: execution of <as> is completed
+        MPI_Request_free(ra->req + i);
+        p->buf = buf;
+        laik_mpi_initPersistent(as, ra->req + i, p);
+        count++;
+    }
+    laik_log(1, "MPI backend: %d persistent requests of '%s' created again",
+             count, as->name);
 }
 
 static void laik_mpi_cleanup(Laik_ActionSeq* as)
@@ -1054,11 +1957,11 @@ static void laik_mpi_cleanup(Laik_ActionSeq* as)
 
     assert(as->backend == &laik_backend_mpi);
 
-    if ((as->actionCount > 0) && (as->action->type == LAIK_AT_MpiReq)) {
-        Laik_A_MpiReq* aa = (Laik_A_MpiReq*) as->action;
-        free(aa->req);
-        laik_log(1, "  freed MPI_Request array with %d entries", aa->count);
-    }
+    laik_mpi_freeRequests(as);
+
+    // autotuning state, if still tuning
+    laik_mpi_autotuneFree(as->backend_data);
+    as->backend_data = 0;
 }
 
 
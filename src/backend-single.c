@@ -60,16 +60,9 @@ Laik_Group* laik_single_world()
     return single_instance->group[0];
 }
 
-void laik_single_exec(Laik_ActionSeq* as)
+static
+void laik_single_exec_transition(Laik_TransitionContext* tc)
 {
-    if (as->backend == 0) {
-        as->backend = &laik_backend_single;
-        laik_aseq_calc_stats(as);
-    }
-    // we only support 1 transition exec action
-    assert(as->actionCount == 1);
-    assert(as->action[0].type == LAIK_AT_TExec);
-    Laik_TransitionContext* tc = as->context[0];
     Laik_Data* d = tc->data;
     Laik_Transition* t = tc->transition;
     Laik_MappingList* fromList = tc->fromList;
@@ -107,6 +100,20 @@ void laik_single_exec(Laik_ActionSeq* as)
     assert(t->sendCount == 0);
 }
 
+void laik_single_exec(Laik_ActionSeq* as)
+{
+    if (as->backend == 0) {
+        as->backend = &laik_backend_single;
+        laik_aseq_calc_stats(as);
+    }
+    // we only support transition exec actions, one per context
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        assert(a->type == LAIK_AT_TExec);
+        laik_single_exec_transition(actionContext(as, a));
+    }
+}
+
 void laik_single_sync(Laik_KVStore* kvs)
 {
     // nothing to do
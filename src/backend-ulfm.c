@@ -21,7 +21,11 @@ static Laik_Backend laik_backend_ulfm = {
         .finalize    = laik_mpi_finalize,
         .prepare     = laik_mpi_prepare,
         .cleanup     = laik_mpi_cleanup,
+        .rebase      = laik_mpi_rebase,
         .exec        = laik_mpi_exec,
+        .exec_start  = laik_mpi_exec_start,
+        .exec_test   = laik_mpi_exec_test,
+        .exec_wait   = laik_mpi_exec_wait,
         .updateGroup = laik_mpi_updateGroup,
         .log_action  = laik_mpi_log_action,
         .sync        = laik_mpi_sync,
@@ -52,6 +52,9 @@ static void laik_tcp_finalize(Laik_Instance*);
 static void laik_tcp_prepare(Laik_ActionSeq*);
 static void laik_tcp_cleanup(Laik_ActionSeq*);
 static void laik_tcp_exec(Laik_ActionSeq* as);
+static void laik_tcp_exec_start(Laik_ActionSeq* as);
+static bool laik_tcp_exec_test(Laik_ActionSeq* as);
+static void laik_tcp_exec_wait(Laik_ActionSeq* as);
 static void laik_tcp_updateGroup(Laik_Group*);
 static void laik_tcp_sync(Laik_KVStore* kvs);
 static void laik_tcp_eliminate_nodes(Laik_Group *oldGroup, Laik_Group *newGroup, int *nodeStatuses);
@@ -63,6 +66,9 @@ static Laik_Backend laik_backend_tcp = {
     .prepare     = laik_tcp_prepare,
     .cleanup     = laik_tcp_cleanup,
     .exec        = laik_tcp_exec,
+    .exec_start  = laik_tcp_exec_start,
+    .exec_test   = laik_tcp_exec_test,
+    .exec_wait   = laik_tcp_exec_wait,
     .updateGroup = laik_tcp_updateGroup,
     .eliminateNodes = laik_tcp_eliminate_nodes,
     .sync        = laik_tcp_sync
@@ -361,13 +367,13 @@ void laik_mpi_exec_recvAndUnpack(Laik_Mapping* map, Laik_Slice* slc,
 }
 
 static
-void laik_mpi_exec_reduce(Laik_TransitionContext* tc, Laik_BackendAction* a,
+void laik_mpi_exec_reduce(Laik_TransitionContext* tc, Laik_A_Reduce* a,
                           MPI_Datatype dataType, MPI_Comm comm)
 {
     assert(tcp_reduce > 0);
 
     MPI_Op mpiRedOp = getMPIOp(a->redOp);
-    int rootTask = a->rank;
+    int rootTask = a->rootTask;
     int err;
 
     if (rootTask == -1) {
@@ -405,7 +411,7 @@ void laik_mpi_exec_reduce(Laik_TransitionContext* tc, Laik_BackendAction* a,
 // interested in the result
 static
 void laik_mpi_exec_groupReduce(Laik_TransitionContext* tc,
-                               Laik_BackendAction* a,
+                               Laik_A_GroupReduce* a,
                                MPI_Datatype dataType, MPI_Comm comm)
 {
     assert(a->h.type == LAIK_AT_GroupReduce);
@@ -518,9 +524,13 @@ void laik_mpi_exec_groupReduce(Laik_TransitionContext* tc,
     }
 }
 
+// prepare execution of <as> from start (also for split-phase execution)
 static
-void laik_tcp_exec(Laik_ActionSeq* as)
+void laik_tcp_exec_init(Laik_ActionSeq* as)
 {
+    as->execPos = 0;
+    as->execAction = as->action;
+
     if (as->actionCount == 0) {
         laik_log(1, "TCP backend exec: nothing to do\n");
         return;
@@ -541,6 +551,10 @@ void laik_tcp_exec(Laik_ActionSeq* as)
 
         int not_handled = laik_aseq_calc_stats(as);
         assert(not_handled == 0); // there should be no MPI-specific actions
+        laik_aseq_prepareLocalMoves(as);
+
+        // sequence was rewritten
+        as->execAction = as->action;
     }
 
     if (laik_log_begin(1)) {
@@ -548,30 +562,63 @@ void laik_tcp_exec(Laik_ActionSeq* as)
         laik_log_ActionSeq(as, false);
         laik_log_flush(0);
     }
+}
 
-    // TODO: use transition context given by each action
-    Laik_TransitionContext* tc = as->context[0];
-    Laik_MappingList* fromList = tc->fromList;
-    Laik_MappingList* toList = tc->toList;
-    int elemsize = tc->data->elemsize;
+// execute actions of <as>, continuing at the position remembered in <as>.
+// With <split>, stop before first action waiting for remote data.
+// Returns true if all actions are done
+static
+bool laik_tcp_exec_actions(Laik_ActionSeq* as, bool split)
+{
+    if (as->execPos >= as->actionCount)
+        return true;
 
-    // common for all MPI calls: tag, comm, datatype
+    // common for all MPI calls: tag, comm (all transitions use same group)
     int tag = 1;
+    Laik_TransitionContext* tc = as->context[0];
     TCPGroupData* gd = tcpGroupData(tc->transition->group);
     assert(gd);
     MPI_Comm comm = gd->comm;
-    MPI_Datatype dataType = getMPIDataType(tc->data);
     MPI_Status st;
     int err, count;
 
-    Laik_Action* a = as->action;
-    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
-        Laik_BackendAction* ba = (Laik_BackendAction*) a;
+    // depending on transition context of action, set on context change
+    int tid = -1;
+    Laik_MappingList* fromList = 0;
+    Laik_MappingList* toList = 0;
+    int elemsize = 0;
+    MPI_Datatype dataType = 0;
+
+    unsigned int i = as->execPos;
+    Laik_Action* a = as->execAction;
+    for(; i < as->actionCount; i++, a = nextAction(a)) {
+        // sends are pushed asynchronously to the messenger, thus only
+        // receives and reductions have to wait
+        if (split && laik_action_waitsForRemote(a))
+            break;
+
+        // run of independent pack/unpack/copy actions: use thread pool
+        unsigned int done = laik_aseq_execLocalMoves(as, a, i);
+        if (done > 0) {
+            i += done - 1;
+            while(--done > 0) a = nextAction(a);
+            continue;
+        }
+
         if (laik_log_begin(1)) {
             laik_log_Action(a, as);
             laik_log_flush(0);
         }
 
+        if (a->tid != tid) {
+            tid = a->tid;
+            tc = as->context[tid];
+            fromList = tc->fromList;
+            toList = tc->toList;
+            elemsize = tc->data->elemsize;
+            dataType = getMPIDataType(tc->data);
+        }
+
         switch(a->type) {
         case LAIK_AT_BufReserve:
         case LAIK_AT_Nop:
@@ -579,18 +626,19 @@ void laik_tcp_exec(Laik_ActionSeq* as)
             break;
 
         case LAIK_AT_MapSend: {
-            assert(ba->fromMapNo < fromList->count);
-            Laik_Mapping* fromMap = &(fromList->map[ba->fromMapNo]);
+            Laik_A_MapSend* aa = (Laik_A_MapSend*) a;
+            assert(aa->fromMapNo < fromList->count);
+            Laik_Mapping* fromMap = &(fromList->map[aa->fromMapNo]);
             assert(fromMap->base != 0);
-            err = MPI_Send(fromMap->base + ba->offset, ba->count,
-                           dataType, ba->rank, tag, comm);
+            err = MPI_Send(fromMap->base + aa->offset, aa->count,
+                           dataType, aa->to_rank, tag, comm);
             if (err != MPI_SUCCESS) laik_tcp_panic(err);
             break;
         }
 
         case LAIK_AT_RBufSend: {
             Laik_A_RBufSend* aa = (Laik_A_RBufSend*) a;
-            assert(aa->bufID < ASEQ_BUFFER_MAX);
+            assert(aa->bufID < as->bufferCount);
             err = MPI_Send(as->buf[aa->bufID] + aa->offset, aa->count,
                            dataType, aa->to_rank, tag, comm);
             if (err != MPI_SUCCESS) laik_tcp_panic(err);
@@ -606,23 +654,24 @@ void laik_tcp_exec(Laik_ActionSeq* as)
         }
 
         case LAIK_AT_MapRecv: {
-            assert(ba->toMapNo < toList->count);
-            Laik_Mapping* toMap = &(toList->map[ba->toMapNo]);
+            Laik_A_MapRecv* aa = (Laik_A_MapRecv*) a;
+            assert(aa->toMapNo < toList->count);
+            Laik_Mapping* toMap = &(toList->map[aa->toMapNo]);
             assert(toMap->base != 0);
-            err = MPI_Recv(toMap->base + ba->offset, ba->count,
-                           dataType, ba->rank, tag, comm, &st);
+            err = MPI_Recv(toMap->base + aa->offset, aa->count,
+                           dataType, aa->from_rank, tag, comm, &st);
             if (err != MPI_SUCCESS) laik_tcp_panic(err);
 
             // check that we received the expected number of elements
             err = MPI_Get_count(&st, dataType, &count);
             if (err != MPI_SUCCESS) laik_tcp_panic(err);
-            assert((int)ba->count == count);
+            assert((int)aa->count == count);
             break;
         }
 
         case LAIK_AT_RBufRecv: {
             Laik_A_RBufRecv* aa = (Laik_A_RBufRecv*) a;
-            assert(aa->bufID < ASEQ_BUFFER_MAX);
+            assert(aa->bufID < as->bufferCount);
             err = MPI_Recv(as->buf[aa->bufID] + aa->offset, aa->count,
                            dataType, aa->from_rank, tag, comm, &st);
             if (err != MPI_SUCCESS) laik_tcp_panic(err);
@@ -630,7 +679,7 @@ void laik_tcp_exec(Laik_ActionSeq* as)
             // check that we received the expected number of elements
             err = MPI_Get_count(&st, dataType, &count);
             if (err != MPI_SUCCESS) laik_tcp_panic(err);
-            assert((int)ba->count == count);
+            assert((int)aa->count == count);
             break;
         }
 
@@ -643,45 +692,55 @@ void laik_tcp_exec(Laik_ActionSeq* as)
             // check that we received the expected number of elements
             err = MPI_Get_count(&st, dataType, &count);
             if (err != MPI_SUCCESS) laik_tcp_panic(err);
-//            assert((int)ba->count == count);
+//            assert((int)aa->count == count);
             break;
         }
 
-        case LAIK_AT_CopyFromBuf:
-            for(unsigned int i = 0; i < ba->count; i++)
-                memcpy(ba->ce[i].ptr,
-                       ba->fromBuf + ba->ce[i].offset,
-                       ba->ce[i].bytes);
+        case LAIK_AT_CopyFromBuf: {
+            Laik_A_CopyFromBuf* aa = (Laik_A_CopyFromBuf*) a;
+            for(unsigned int i = 0; i < aa->count; i++)
+                memcpy(aa->ce[i].ptr,
+                       aa->fromBuf + aa->ce[i].offset,
+                       aa->ce[i].bytes);
             break;
+        }
 
-        case LAIK_AT_CopyToBuf:
-            for(unsigned int i = 0; i < ba->count; i++)
-                memcpy(ba->toBuf + ba->ce[i].offset,
-                       ba->ce[i].ptr,
-                       ba->ce[i].bytes);
+        case LAIK_AT_CopyToBuf: {
+            Laik_A_CopyToBuf* aa = (Laik_A_CopyToBuf*) a;
+            for(unsigned int i = 0; i < aa->count; i++)
+                memcpy(aa->toBuf + aa->ce[i].offset,
+                       aa->ce[i].ptr,
+                       aa->ce[i].bytes);
             break;
+        }
 
-        case LAIK_AT_PackToBuf:
-            laik_exec_pack(ba, ba->map);
+        case LAIK_AT_PackToBuf: {
+            Laik_A_PackToBuf* aa = (Laik_A_PackToBuf*) a;
+            laik_exec_pack(aa->map, aa->slc, aa->toBuf, aa->count);
             break;
+        }
 
         case LAIK_AT_MapPackToBuf: {
-            assert(ba->fromMapNo < fromList->count);
-            Laik_Mapping* fromMap = &(fromList->map[ba->fromMapNo]);
+            Laik_A_MapPackToBuf* aa = (Laik_A_MapPackToBuf*) a;
+            assert(aa->fromMapNo < fromList->count);
+            Laik_Mapping* fromMap = &(fromList->map[aa->fromMapNo]);
             assert(fromMap->base != 0);
-            laik_exec_pack(ba, fromMap);
+            laik_exec_pack(fromMap, aa->slc, aa->toBuf, aa->count);
             break;
         }
 
-        case LAIK_AT_UnpackFromBuf:
-            laik_exec_unpack(ba, ba->map);
+        case LAIK_AT_UnpackFromBuf: {
+            Laik_A_UnpackFromBuf* aa = (Laik_A_UnpackFromBuf*) a;
+            laik_exec_unpack(aa->map, aa->slc, aa->fromBuf, aa->count);
             break;
+        }
 
         case LAIK_AT_MapUnpackFromBuf: {
-            assert(ba->toMapNo < toList->count);
-            Laik_Mapping* toMap = &(toList->map[ba->toMapNo]);
+            Laik_A_MapUnpackFromBuf* aa = (Laik_A_MapUnpackFromBuf*) a;
+            assert(aa->toMapNo < toList->count);
+            Laik_Mapping* toMap = &(toList->map[aa->toMapNo]);
             assert(toMap->base);
-            laik_exec_unpack(ba, toMap);
+            laik_exec_unpack(toMap, aa->slc, aa->fromBuf, aa->count);
             break;
         }
 
@@ -696,11 +755,13 @@ void laik_tcp_exec(Laik_ActionSeq* as)
             break;
         }
 
-        case LAIK_AT_PackAndSend:
-            laik_mpi_exec_packAndSend(ba->map, ba->slc, ba->rank,
-                                      (uint64_t) ba->count,
+        case LAIK_AT_PackAndSend: {
+            Laik_A_PackAndSend* aa = (Laik_A_PackAndSend*) a;
+            laik_mpi_exec_packAndSend(aa->map, aa->slc, aa->to_rank,
+                                      (uint64_t) aa->count,
                                       dataType, tag, comm);
             break;
+        }
 
         case LAIK_AT_MapRecvAndUnpack: {
             Laik_A_MapRecvAndUnpack* aa = (Laik_A_MapRecvAndUnpack*) a;
@@ -712,40 +773,50 @@ void laik_tcp_exec(Laik_ActionSeq* as)
             break;
         }
 
-        case LAIK_AT_RecvAndUnpack:
-            laik_mpi_exec_recvAndUnpack(ba->map, ba->slc, ba->rank,
-                                        (uint64_t) ba->count,
+        case LAIK_AT_RecvAndUnpack: {
+            Laik_A_RecvAndUnpack* aa = (Laik_A_RecvAndUnpack*) a;
+            laik_mpi_exec_recvAndUnpack(aa->map, aa->slc, aa->from_rank,
+                                        (uint64_t) aa->count,
                                         elemsize, dataType, tag, comm);
             break;
+        }
 
         case LAIK_AT_Reduce:
-            laik_mpi_exec_reduce(tc, ba, dataType, comm);
+            laik_mpi_exec_reduce(tc, (Laik_A_Reduce*) a, dataType, comm);
             break;
 
         case LAIK_AT_GroupReduce:
-            laik_mpi_exec_groupReduce(tc, ba, dataType, comm);
+            laik_mpi_exec_groupReduce(tc, (Laik_A_GroupReduce*) a, dataType, comm);
             break;
 
-        case LAIK_AT_RBufLocalReduce:
-            assert(ba->bufID < ASEQ_BUFFER_MAX);
-            assert(ba->dtype->reduce != 0);
-            (ba->dtype->reduce)(ba->toBuf, ba->toBuf, as->buf[ba->bufID] + ba->offset,
-                               ba->count, ba->redOp);
+        case LAIK_AT_RBufLocalReduce: {
+            Laik_A_RBufLocalReduce* aa = (Laik_A_RBufLocalReduce*) a;
+            assert(aa->bufID < as->bufferCount);
+            assert(aa->dtype->reduce != 0);
+            (aa->dtype->reduce)(aa->toBuf, aa->toBuf, as->buf[aa->bufID] + aa->offset,
+                                aa->count, aa->redOp);
             break;
+        }
 
-        case LAIK_AT_RBufCopy:
-            assert(ba->bufID < ASEQ_BUFFER_MAX);
-            memcpy(ba->toBuf, as->buf[ba->bufID] + ba->offset, ba->count * elemsize);
+        case LAIK_AT_RBufCopy: {
+            Laik_A_RBufCopy* aa = (Laik_A_RBufCopy*) a;
+            assert(aa->bufID < as->bufferCount);
+            memcpy(aa->toBuf, as->buf[aa->bufID] + aa->offset, aa->count * elemsize);
             break;
+        }
 
-        case LAIK_AT_BufCopy:
-            memcpy(ba->toBuf, ba->fromBuf, ba->count * elemsize);
+        case LAIK_AT_BufCopy: {
+            Laik_A_BufCopy* aa = (Laik_A_BufCopy*) a;
+            memcpy(aa->toBuf, aa->fromBuf, aa->count * elemsize);
             break;
+        }
 
-        case LAIK_AT_BufInit:
-            assert(ba->dtype->init != 0);
-            (ba->dtype->init)(ba->toBuf, ba->count, ba->redOp);
+        case LAIK_AT_BufInit: {
+            Laik_A_BufInit* aa = (Laik_A_BufInit*) a;
+            assert(aa->dtype->init != 0);
+            (aa->dtype->init)(aa->toBuf, aa->count, aa->redOp);
             break;
+        }
 
         default:
             laik_log(LAIK_LL_Panic, "mpi_exec: no idea how to exec action %d (%s)",
@@ -753,7 +824,41 @@ void laik_tcp_exec(Laik_ActionSeq* as)
             assert(0);
         }
     }
+    as->execPos = i;
+    as->execAction = a;
+    if (i < as->actionCount)
+        return false;
+
     assert( ((char*)as->action) + as->bytesUsed == ((char*)a) );
+    return true;
+}
+
+static
+void laik_tcp_exec(Laik_ActionSeq* as)
+{
+    laik_tcp_exec_init(as);
+    laik_tcp_exec_actions(as, false);
+}
+
+static
+void laik_tcp_exec_start(Laik_ActionSeq* as)
+{
+    laik_tcp_exec_init(as);
+    laik_tcp_exec_actions(as, true);
+}
+
+// the messenger receives incoming data in the background, but has no
+// non-blocking way to query it. Thus, test completes the sequence
+static
+bool laik_tcp_exec_test(Laik_ActionSeq* as)
+{
+    return laik_tcp_exec_actions(as, false);
+}
+
+static
+void laik_tcp_exec_wait(Laik_ActionSeq* as)
+{
+    laik_tcp_exec_actions(as, false);
 }
 
 
@@ -792,7 +897,7 @@ void laik_tcp_prepare(Laik_ActionSeq* as)
     changed = laik_aseq_allocBuffer(as);
     laik_log_ActionSeqIfChanged(changed, as, "After buffer allocation 1");
 
-    changed = laik_aseq_splitReduce(as);
+    changed = laik_aseq_splitReduce(as, LAIK_RS_Auto);
     laik_log_ActionSeqIfChanged(changed, as, "After splitting reduce actions");
 
     changed = laik_aseq_allocBuffer(as);
@@ -813,6 +918,7 @@ void laik_tcp_prepare(Laik_ActionSeq* as)
 
     laik_aseq_freeTempSpace(as);
     laik_aseq_calc_stats(as);
+    laik_aseq_prepareLocalMoves(as);
 }
 
 static void laik_tcp_cleanup(Laik_ActionSeq* as)
@@ -152,6 +152,23 @@ void laik_finalize(Laik_Instance* inst)
         laik_log_flush(0);
     }
 
+    laik_bufpool_release(inst);
+    // shared slice arrays still in use stay valid, just not shared anymore
+    for(unsigned int i = 0; i < inst->saTableSize; i++) {
+        Laik_SliceArray* sa = inst->saTable[i];
+        while(sa) {
+            Laik_SliceArray* next = sa->nextShared;
+            sa->nextShared = 0;
+            sa = next;
+        }
+    }
+    free(inst->saTable);
+    inst->saTable = 0;
+    inst->saTableSize = 0;
+    inst->saTableCount = 0;
+    laik_threadpool_free(inst->threadPool);
+    inst->threadPool = 0;
+
     laik_close_profiling_file(inst);
     laik_free_profiling(inst);
     free(inst->control);
@@ -205,6 +222,17 @@ Laik_Instance* laik_new_instance(const Laik_Backend* b,
     instance->repart_ctrl = 0;
     instance->errorHandler = NULL;
 
+    instance->bufPool = laik_bufpool_new();
+
+    instance->saTable = 0;
+    instance->saTableSize = 0;
+    instance->saTableCount = 0;
+
+    // threads for local data movement?
+    instance->threadPool = 0;
+    char* str = getenv("LAIK_THREADS");
+    if (str) instance->threadPool = laik_threadpool_new(atoi(str));
+
     // logging (TODO: multiple instances)
     laik_log_init(instance);
 
@@ -33,9 +33,31 @@ unsigned int laik_pack_def(const Laik_Mapping *m, const Laik_Slice *s,
 unsigned int laik_unpack_def(const Laik_Mapping *m, const Laik_Slice *s,
                              Laik_Index *idx, char *buf, unsigned int size);
 
+// LAIK_TRANSCACHE: reuse transitions/prepared action sequences for
+// repeated switches between same partitionings? Default: Yes
+static int transcache_enabled = 1;
+
+// LAIK_TRANSUPDATE: calculate transitions for new partitionings
+// incrementally from cached ones, only recalculating operations
+// with tasks whose slices changed? Default: Yes
+static int transupdate_enabled = 1;
+
+// LAIK_ASEQ_SAVE: if set, save each prepared action sequence into file
+// "<prefix>-<seq id>-<rank>.aseq", for replay (see laik_aseq_load)
+static char* aseq_save_prefix = 0;
+
 // initialize the LAIK data module, called from laik_new_instance
 void laik_data_init() {
     laik_type_init();
+
+    char* str = getenv("LAIK_TRANSCACHE");
+    if (str) transcache_enabled = atoi(str);
+
+    str = getenv("LAIK_TRANSUPDATE");
+    if (str) transupdate_enabled = atoi(str);
+
+    str = getenv("LAIK_ASEQ_SAVE");
+    if (str && (*str != 0)) aseq_save_prefix = str;
 }
 
 
@@ -73,6 +95,8 @@ Laik_SwitchStat *laik_newSwitchStat() {
     ss->initOpCount = 0;
     ss->reduceOpCount = 0;
     ss->byteBufCopyCount = 0;
+    ss->poolHits = 0;
+    ss->poolMisses = 0;
 
     return ss;
 }
@@ -103,6 +127,8 @@ void laik_addSwitchStat(Laik_SwitchStat *target, Laik_SwitchStat *src) {
     target->initOpCount += src->initOpCount;
     target->reduceOpCount += src->reduceOpCount;
     target->byteBufCopyCount += src->byteBufCopyCount;
+    target->poolHits += src->poolHits;
+    target->poolMisses += src->poolMisses;
 }
 
 void laik_switchstat_addASeq(Laik_SwitchStat *target, Laik_ActionSeq *as) {
@@ -169,10 +195,17 @@ Laik_Data *laik_new_data(Laik_Space *space, Laik_Type *type) {
     d->activePartitioning = 0;
     d->activeMappings = 0;
     d->allocator = 0; // default: malloc/free
+    d->pool = 0;
     d->stat = laik_newSwitchStat();
 
     d->activeReservation = 0;
 
+    d->pendingASeq = 0;
+    d->pendingASeqOwned = false;
+
+    d->transCacheCount = 0;
+    d->transCacheUse = 0;
+
     laik_log(1, "new data '%s':\n"
                 "  type '%s' (elemsize %d), space '%s' (%lu elems, %.3f MB)\n",
              d->name, type->name, d->elemsize, space->name,
@@ -240,6 +273,8 @@ void initMapping(Laik_Mapping *m, Laik_Data *d) {
 
     // not backed by memory yet
     m->capacity = 0;
+    m->fromPool = false;
+    m->allocator = 0;
     m->start = 0;
     m->base = 0;
     m->layout = 0;
@@ -248,6 +283,15 @@ void initMapping(Laik_Mapping *m, Laik_Data *d) {
     m->baseMapping = 0;
 }
 
+static
+void setRequiredSlice(Laik_Mapping *m, Laik_Slice *slc, int dims) {
+    m->requiredSlice = *slc;
+    m->count = laik_slice_size(slc);
+    m->size[0] = slc->to.i[0] - slc->from.i[0];
+    m->size[1] = (dims > 1) ? (slc->to.i[1] - slc->from.i[1]) : 0;
+    m->size[2] = (dims > 2) ? (slc->to.i[2] - slc->from.i[2]) : 0;
+}
+
 static
 Laik_MappingList *prepareMaps(Laik_Data *d, Laik_Partitioning *p)
  {
@@ -314,11 +358,7 @@ Laik_MappingList *prepareMaps(Laik_Data *d, Laik_Partitioning *p)
             laik_slice_expand(&slc, &(sa->tslice[o].s));
         }
         lastOff = o;
-        m->requiredSlice = slc;
-        m->count = laik_slice_size(&slc);
-        m->size[0] = slc.to.i[0] - slc.from.i[0];
-        m->size[1] = (dims > 1) ? (slc.to.i[1] - slc.from.i[1]) : 0;
-        m->size[2] = (dims > 2) ? (slc.to.i[2] - slc.from.i[2]) : 0;
+        setRequiredSlice(m, &slc, dims);
 
         if (laik_log_begin(1)) {
             laik_log_append("    mapNo %d: req.slice ", mapNo);
@@ -332,6 +372,134 @@ Laik_MappingList *prepareMaps(Laik_Data *d, Laik_Partitioning *p)
     return ml;
 }
 
+// allocate/free memory for mappings of <d> via allocator <a> (0: malloc)
+static
+char *allocMem(Laik_Data *d, Laik_Allocator *a, uint64_t size) {
+    if ((!a) || (!a->malloc))
+        return malloc(size);
+    return (a->malloc)(d, size);
+}
+
+static
+void freeMem(Laik_Data *d, Laik_Allocator *a, char *p) {
+    if ((!a) || (!a->free))
+        free(p);
+    else
+        (a->free)(d, p);
+}
+
+// size class of mapping pool for <size> bytes, class size in <csize>
+static
+int mappool_class(uint64_t size, uint64_t *csize) {
+    int k = MAPPOOL_MINCLASS;
+    while (((uint64_t) 1 << (k + 1)) < size) k++;
+
+    // classes above 2^k in steps of 2^k / MAPPOOL_STEPS
+    uint64_t base = (uint64_t) 1 << k;
+    uint64_t step = base / MAPPOOL_STEPS;
+    int i = 0;
+    while (base + i * step < size) i++;
+
+    *csize = base + i * step;
+    int c = (k - MAPPOOL_MINCLASS) * MAPPOOL_STEPS + i;
+    assert(c < MAPPOOL_CLASSES);
+    return c;
+}
+
+// get memory of at least <*size> bytes from pool of <d>, set <*size>
+// to the size of the class. Only new allocations are counted as malloc
+static
+char *mappool_get(Laik_Data *d, uint64_t *size, Laik_SwitchStat *ss) {
+    if (!d->pool) {
+        d->pool = calloc(1, sizeof(Laik_MapPool));
+        if (!d->pool) {
+            laik_panic("Out of memory allocating Laik_MapPool object");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        d->pool->allocator = d->allocator;
+    }
+    Laik_MapPool *p = d->pool;
+    assert(p->allocator == d->allocator);
+
+    uint64_t csize;
+    int c = mappool_class(*size, &csize);
+    char *mem = p->freeList[c];
+    if (mem) {
+        p->freeList[c] = *((void **) mem);
+        p->cachedBytes -= csize;
+        if (ss) ss->poolHits++;
+    } else {
+        mem = allocMem(d, p->allocator, csize);
+        if (ss) ss->poolMisses++;
+        if (mem) laik_switchstat_malloc(ss, csize);
+    }
+    *size = csize;
+    return mem;
+}
+
+// free cached memory of largest classes in pool of <d> until at most
+// <maxBytes> are cached
+static
+void mappool_shrink(Laik_Data *d, uint64_t maxBytes, Laik_SwitchStat *ss) {
+    Laik_MapPool *p = d->pool;
+    for (int c = MAPPOOL_CLASSES - 1; c >= 0; c--) {
+        if (p->cachedBytes <= maxBytes) return;
+        int k = MAPPOOL_MINCLASS + c / MAPPOOL_STEPS;
+        uint64_t csize = ((uint64_t) 1 << k) +
+                         (c % MAPPOOL_STEPS) * (((uint64_t) 1 << k) / MAPPOOL_STEPS);
+        while (p->freeList[c] && (p->cachedBytes > maxBytes)) {
+            char *mem = p->freeList[c];
+            p->freeList[c] = *((void **) mem);
+            p->cachedBytes -= csize;
+            laik_switchstat_free(ss, csize);
+            freeMem(d, p->allocator, mem);
+        }
+    }
+}
+
+// give back memory of mapping <m> got via mappool_get
+static
+void mappool_put(Laik_Data *d, Laik_Mapping *m, Laik_SwitchStat *ss) {
+    Laik_MapPool *p = d->pool;
+    if ((!p) || (p->allocator != m->allocator) ||
+        (m->allocator->policy != LAIK_MP_UsePool)) {
+        // allocator changed meanwhile: free via allocator used for <m>
+        laik_switchstat_free(ss, m->capacity);
+        freeMem(d, m->allocator, m->start);
+        return;
+    }
+
+    uint64_t csize;
+    int c = mappool_class(m->capacity, &csize);
+    assert(csize == m->capacity);
+
+    uint64_t maxBytes = p->allocator->poolMaxBytes;
+    if (maxBytes > 0) {
+        if (csize > maxBytes) {
+            laik_switchstat_free(ss, csize);
+            freeMem(d, p->allocator, m->start);
+            return;
+        }
+        mappool_shrink(d, maxBytes - csize, ss);
+    }
+
+    *((void **) m->start) = p->freeList[c];
+    p->freeList[c] = m->start;
+    p->cachedBytes += csize;
+}
+
+// free all memory cached in pool of <d>
+static
+void mappool_free(Laik_Data *d) {
+    if (!d->pool) return;
+
+    laik_log(1, "mapping pool of data '%s': releasing %llu bytes",
+             d->name, (unsigned long long) d->pool->cachedBytes);
+    mappool_shrink(d, 0, d->stat);
+    free(d->pool);
+    d->pool = 0;
+}
+
 static
 void freeMap(Laik_Mapping *m, Laik_Data *d, Laik_SwitchStat *ss) {
     assert(d == m->data);
@@ -347,13 +515,12 @@ void freeMap(Laik_Mapping *m, Laik_Data *d, Laik_SwitchStat *ss) {
             m->layout = 0;
         }
 
-        laik_switchstat_free(ss, m->capacity);
-
-        // TODO: different policies
-        if ((!d->allocator) || (!d->allocator->free))
-            free(m->start);
-        else
-            (d->allocator->free)(d, m->start);
+        if (m->fromPool)
+            mappool_put(d, m, ss);
+        else {
+            laik_switchstat_free(ss, m->capacity);
+            freeMem(d, m->allocator, m->start);
+        }
 
         m->base = 0;
         m->start = 0;
@@ -434,13 +601,15 @@ void laik_allocateMap(Laik_Mapping *m, Laik_SwitchStat *ss) {
     Laik_Data *d = m->data;
 
     m->capacity = m->count * d->elemsize;
-    laik_switchstat_malloc(ss, m->capacity);
-
-    // TODO: different policies
-    if ((!d->allocator) || (!d->allocator->malloc))
-        m->base = malloc(m->capacity);
-    else
-        m->base = (d->allocator->malloc)(d, m->capacity);
+    m->allocator = d->allocator;
+    if (d->allocator && (d->allocator->policy == LAIK_MP_UsePool)) {
+        m->base = mappool_get(d, &(m->capacity), ss);
+        m->fromPool = true;
+    }
+    else {
+        m->base = allocMem(d, d->allocator, m->capacity);
+        if (m->base) laik_switchstat_malloc(ss, m->capacity);
+    }
 
     if (!m->base) {
         laik_log(LAIK_LL_Panic,
@@ -488,6 +657,66 @@ void laik_allocateMap(Laik_Mapping *m, Laik_SwitchStat *ss) {
              (unsigned long long) m->layout->stride[2]);
 }
 
+// block of elements to copy between mappings, see copyMaps
+typedef struct {
+    char *fromPtr, *toPtr;
+    Laik_Index count;                // elements in each dimension
+    uint64_t fromStride[3], toStride[3]; // layout strides in bytes
+    unsigned int elemsize;
+} CopyBlock;
+
+// blocks smaller than this are not split among threads
+#define COPYBLOCK_MINBYTES 65536
+
+static
+void copyBlock(void *ctx, int i) {
+    CopyBlock *b = ((CopyBlock *) ctx) + i;
+    char *fromPtr = b->fromPtr;
+    char *toPtr = b->toPtr;
+    for (int64_t i3 = 0; i3 < b->count.i[2]; i3++) {
+        char *fromPtr2 = fromPtr;
+        char *toPtr2 = toPtr;
+        for (int64_t i2 = 0; i2 < b->count.i[1]; i2++) {
+            memcpy(toPtr2, fromPtr2, b->count.i[0] * b->elemsize);
+            fromPtr2 += b->fromStride[1];
+            toPtr2 += b->toStride[1];
+        }
+        fromPtr += b->fromStride[2];
+        toPtr += b->toStride[2];
+    }
+}
+
+// add block <b> to <blocks>, split into up to <parts> blocks along the
+// outermost dimension with more than one element. Returns blocks added
+static
+int addCopyBlocks(CopyBlock *blocks, CopyBlock *b, int parts) {
+    uint64_t bytes = b->count.i[0] * b->count.i[1] * b->count.i[2] * b->elemsize;
+    if ((uint64_t) parts > bytes / COPYBLOCK_MINBYTES)
+        parts = (int) (bytes / COPYBLOCK_MINBYTES);
+
+    int d = 2;
+    while ((d > 0) && (b->count.i[d] == 1)) d--;
+    if (parts > b->count.i[d]) parts = (int) b->count.i[d];
+    if (parts < 2) {
+        blocks[0] = *b;
+        return 1;
+    }
+
+    // for dimension 0, stride is the element size
+    uint64_t fromStride = (d > 0) ? b->fromStride[d] : b->elemsize;
+    uint64_t toStride = (d > 0) ? b->toStride[d] : b->elemsize;
+    int64_t ext = b->count.i[d];
+    for (int k = 0; k < parts; k++) {
+        int64_t from = ext * k / parts;
+        int64_t to = ext * (k + 1) / parts;
+        blocks[k] = *b;
+        blocks[k].count.i[d] = to - from;
+        blocks[k].fromPtr += from * fromStride;
+        blocks[k].toPtr += from * toStride;
+    }
+    return parts;
+}
+
 static
 void copyMaps(Laik_Transition *t,
               Laik_MappingList *toList, Laik_MappingList *fromList,
@@ -499,6 +728,17 @@ void copyMaps(Laik_Transition *t,
     // no copy required if we stay in same reservation
     if ((fromList->res != 0) && (fromList->res == toList->res)) return;
 
+    // copies are collected as blocks, executed by the threads of the
+    // instance (see LAIK_THREADS); large blocks are split among threads
+    Laik_Instance *inst = t->group->inst;
+    int threads = laik_get_threads(inst);
+    CopyBlock *blocks = malloc(t->localCount * threads * sizeof(CopyBlock));
+    if (!blocks) {
+        laik_panic("Out of memory allocating copy blocks");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    int blockCount = 0;
+
     for (int i = 0; i < t->localCount; i++) {
         struct localTOp *op = &(t->local[i]);
         assert(op->fromMapNo < fromList->count);
@@ -582,18 +822,22 @@ void copyMaps(Laik_Transition *t,
         if (ss)
             ss->copiedBytes += ccount * d->elemsize;
 
-        for (int64_t i3 = 0; i3 < count.i[2]; i3++) {
-            char *fromPtr2 = fromPtr;
-            char *toPtr2 = toPtr;
-            for (int64_t i2 = 0; i2 < count.i[1]; i2++) {
-                memcpy(toPtr2, fromPtr2, count.i[0] * d->elemsize);
-                fromPtr2 += fromMap->layout->stride[1] * d->elemsize;
-                toPtr2 += toMap->layout->stride[1] * d->elemsize;
-            }
-            fromPtr += fromMap->layout->stride[2] * d->elemsize;
-            toPtr += toMap->layout->stride[2] * d->elemsize;
+        CopyBlock b;
+        b.fromPtr = fromPtr;
+        b.toPtr = toPtr;
+        b.count = count;
+        b.elemsize = d->elemsize;
+        for (int j = 0; j < 3; j++) {
+            b.fromStride[j] = fromMap->layout->stride[j] * d->elemsize;
+            b.toStride[j] = toMap->layout->stride[j] * d->elemsize;
         }
+        blockCount += addCopyBlocks(blocks + blockCount, &b, threads);
     }
+
+    // logging in copies not thread-safe
+    laik_threadpool_run(laik_log_shown(1) ? 0 : inst->threadPool,
+                        blockCount, copyBlock, blocks);
+    free(blocks);
 }
 
 // given that memory for a mapping is already allocated,
@@ -614,6 +858,8 @@ void initEmbeddedMapping(Laik_Mapping *toMap, Laik_Mapping *fromMap) {
     toMap->allocatedSlice = fromMap->allocatedSlice;
     toMap->allocCount = fromMap->allocCount;
     toMap->capacity = fromMap->capacity;
+    toMap->fromPool = fromMap->fromPool;
+    toMap->allocator = fromMap->allocator;
     toMap->layout = fromMap->layout;
 
     // set <base> of embedded mapping according to required vs. allocated
@@ -734,6 +980,41 @@ void allocateMappings(Laik_MappingList *toList, Laik_SwitchStat *ss) {
     }
 }
 
+// create a mapping list for <d> with <n> mappings covering given slices,
+// not bound to a partitioning. Memory is allocated and zeroed.
+// Used for action sequences loaded from file (see laik_aseq_load)
+Laik_MappingList *laik_mappinglist_new(Laik_Data *d, int n, Laik_Slice *slc) {
+    Laik_MappingList *ml;
+    ml = malloc(sizeof(Laik_MappingList) + n * sizeof(Laik_Mapping));
+    if (!ml) {
+        laik_panic("Out of memory allocating Laik_MappingList object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    ml->res = 0;
+    ml->count = n;
+
+    for (int mapNo = 0; mapNo < n; mapNo++) {
+        Laik_Mapping *m = &(ml->map[mapNo]);
+        initMapping(m, d);
+        m->mapNo = mapNo;
+        setRequiredSlice(m, &(slc[mapNo]), d->space->dims);
+        laik_allocateMap(m, d->stat);
+        if (m->base)
+            memset(m->base, 0, m->capacity);
+    }
+    return ml;
+}
+
+// free a mapping list created with laik_mappinglist_new
+void laik_mappinglist_free(Laik_MappingList *ml) {
+    if (ml == 0) return;
+    if (ml->count == 0) {
+        free(ml);
+        return;
+    }
+    freeMaps(ml, ml->map[0].data->stat);
+}
+
 static
 Laik_ActionSeq *createTransASeq(Laik_Data *d, Laik_Transition *t,
                                 Laik_MappingList *fromList,
@@ -750,21 +1031,272 @@ Laik_ActionSeq *createTransASeq(Laik_Data *d, Laik_Transition *t,
     return as;
 }
 
+// let backend prepare a sequence, remembering mappings used for preparation
+static
+void prepareTransASeq(Laik_ActionSeq *as) {
+    const Laik_Backend *backend = as->inst->backend;
+    if (backend->prepare) {
+        (backend->prepare)(as);
+        laik_aseq_validate(as);
+
+        // remember mappings at prepare time
+        for(int i = 0; i < as->contextCount; i++) {
+            Laik_TransitionContext *tc = as->context[i];
+            tc->prepFromList = tc->fromList;
+            tc->prepToList = tc->toList;
+        }
+    } else {
+        // for statistics: usually called in backend prepare function
+        laik_aseq_calc_stats(as);
+    }
+
+    if (aseq_save_prefix && !as->loaded) {
+        Laik_TransitionContext *tc = as->context[0];
+        char fname[256];
+        snprintf(fname, sizeof(fname), "%s-%d-%d.aseq", aseq_save_prefix,
+                 as->id, laik_myid(tc->transition->group));
+        laik_aseq_save(as, fname);
+    }
+
+    // buffers are only needed during execution
+    laik_aseq_returnBuffers(as);
+}
+
+
+//
+// Transition cache
+//
+// Iterative codes switch between the same partitionings again and again.
+// Instead of recalculating the transition (and preparing an action
+// sequence) on each switch, keep them per container.
+//
 
 static
-void doTransition(Laik_Data *d, Laik_Transition *t, Laik_ActionSeq *as,
-                  Laik_MappingList *fromList, Laik_MappingList *toList) {
-    if (d->stat) {
-        d->stat->switches++;
-        if (!t || (t->actionCount == 0))
-            d->stat->switches_noactions++;
+void transcache_freeASeq(Laik_TransCacheEntry *e) {
+    if (e->as &&
+        (((Laik_TransitionContext*) e->as->context[0])->data->pendingASeq == e->as)) {
+        laik_panic("Cached transition freed during pending switch!");
+        exit(1); // not actually needed, laik_panic never returns
     }
+    if (e->as)
+        laik_aseq_free(e->as);
+    e->as = 0;
+    e->fromList = 0;
+    e->toList = 0;
+}
 
-    if (t == 0) {
-        // no transition to exec, just free old mappings
-        freeMaps(fromList, d->stat);
+static
+void transcache_freeEntry(Laik_TransCacheEntry *e) {
+    transcache_freeASeq(e);
+    laik_free_transition(e->t);
+    e->t = 0;
+}
+
+static
+Laik_TransCacheEntry *transcache_lookup(Laik_Data *d,
+                                        Laik_Partitioning *fromP,
+                                        Laik_Partitioning *toP,
+                                        Laik_DataFlow flow,
+                                        Laik_ReductionOperation redOp) {
+    for (int i = 0; i < d->transCacheCount; i++) {
+        Laik_TransCacheEntry *e = &(d->transCache[i]);
+        if (e->retired) continue;
+        if ((e->fromP != fromP) || (e->toP != toP)) continue;
+        if ((e->flow != flow) || (e->redOp != redOp)) continue;
+
+        e->lastUse = ++d->transCacheUse;
+        return e;
+    }
+    return 0;
+}
+
+static
+Laik_TransCacheEntry *transcache_insert(Laik_Data *d, Laik_Transition *t,
+                                        Laik_DataFlow flow,
+                                        Laik_ReductionOperation redOp) {
+    Laik_TransCacheEntry *e;
+    if (d->transCacheCount < TRANSCACHE_SIZE)
+        e = &(d->transCache[d->transCacheCount++]);
+    else {
+        // full: replace least recently used entry
+        e = &(d->transCache[0]);
+        for (int i = 1; i < TRANSCACHE_SIZE; i++)
+            if (d->transCache[i].lastUse < e->lastUse)
+                e = &(d->transCache[i]);
+
+        laik_log(1, "transition cache of data '%s': evict transition '%s'",
+                 d->name, e->t->name);
+        transcache_freeEntry(e);
+    }
+
+    e->fromP = t->fromPartitioning;
+    e->toP = t->toPartitioning;
+    e->retired = false;
+    e->gid = t->group->gid;
+    e->fromPr = e->fromP ? e->fromP->partitioner : 0;
+    e->toPr = e->toP ? e->toP->partitioner : 0;
+    e->flow = flow;
+    e->redOp = redOp;
+    e->t = t;
+    e->fromList = 0;
+    e->toList = 0;
+    e->as = 0;
+    e->lastUse = ++d->transCacheUse;
+
+    return e;
+}
+
+// return most recently used entry with transition which can be used
+// as base for calculating the transition between <fromP> and <toP>
+// incrementally, or 0. The partitionings of the base transition must
+// have been created by the same partitioners to be similar
+static
+Laik_TransCacheEntry *transcache_findBase(Laik_Data *d,
+                                          Laik_Partitioning *fromP,
+                                          Laik_Partitioning *toP,
+                                          Laik_DataFlow flow,
+                                          Laik_ReductionOperation redOp) {
+    Laik_TransCacheEntry *base = 0;
+    for (int i = 0; i < d->transCacheCount; i++) {
+        Laik_TransCacheEntry *e = &(d->transCache[i]);
+        if (!e->t || !e->t->fromDep || (e->gid != toP->group->gid)) continue;
+        if ((e->flow != flow) || (e->redOp != redOp)) continue;
+        if ((e->fromPr != fromP->partitioner) ||
+            (e->toPr != toP->partitioner)) continue;
+        if (!base || (e->lastUse > base->lastUse))
+            base = e;
+    }
+    return base;
+}
+
+// mappings not from a reservation get reallocated on each switch
+static
+bool isStableMList(Laik_MappingList *ml) {
+    return (ml == 0) || (ml->res != 0);
+}
+
+// return action sequence for cached transition prepared for given mappings,
+// or 0 if mappings are not stable
+static
+Laik_ActionSeq *transcache_getASeq(Laik_Data *d, Laik_TransCacheEntry *e,
+                                   Laik_MappingList *fromList,
+                                   Laik_MappingList *toList) {
+    if (!isStableMList(fromList) || !isStableMList(toList))
+        return 0;
+
+    if (e->as && (e->fromList == fromList) && (e->toList == toList))
+        return e->as;
+
+    if (e->as)
+        laik_aseq_free(e->as);
+
+    e->as = createTransASeq(d, e->t, fromList, toList);
+    e->as->reused = true;
+    prepareTransASeq(e->as);
+    e->fromList = fromList;
+    e->toList = toList;
+
+    laik_log(1, "transition cache of data '%s': prepared '%s' for trans '%s'",
+             d->name, e->as->name, e->t->name);
+
+    return e->as;
+}
+
+// drop cached sequences prepared for mappings from reservation <r>
+static
+void transcache_dropReservation(Laik_Data *d, Laik_Reservation *r) {
+    for (int i = 0; i < d->transCacheCount; i++) {
+        Laik_TransCacheEntry *e = &(d->transCache[i]);
+        if (!e->as) continue;
+        if ((e->fromList && (e->fromList->res == r)) ||
+            (e->toList && (e->toList->res == r))) {
+            // a pending switch may still run this sequence: complete it first
+            if (d->pendingASeq == e->as) {
+                laik_log(1, "transition cache of data '%s': complete pending switch"
+                            " using reservation '%s'", d->name, r->name);
+                laik_switchto_wait(d);
+            }
+            transcache_freeASeq(e);
+        }
+    }
+}
+
+static
+void transcache_free(Laik_Data *d) {
+    for (int i = 0; i < d->transCacheCount; i++)
+        transcache_freeEntry(&(d->transCache[i]));
+    d->transCacheCount = 0;
+}
+
+// a switch started with laik_switchto_partitioning_start() may still be
+// pending with a (possibly cached) action sequence referencing <p>:
+// complete it before transitions for <p> get dropped
+static
+void transcache_finishPending(Laik_Data *d, Laik_Partitioning *p) {
+    Laik_ActionSeq *as = d->pendingASeq;
+    if (!as) return;
+
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_Transition *t = ((Laik_TransitionContext*) as->context[i])->transition;
+        if ((t->fromPartitioning != p) && (t->toPartitioning != p)) continue;
+
+        laik_log(1, "transition cache of data '%s': complete pending switch"
+                    " using partitioning '%s'", d->name, p->name);
+        laik_switchto_wait(d);
         return;
     }
+}
+
+// drop cached entries referencing partitioning <p> from all containers
+void laik_data_transcache_invalidate(Laik_Instance *inst, Laik_Partitioning *p) {
+    for (int i = 0; i < inst->data_count; i++) {
+        Laik_Data *d = inst->data[i];
+        if (!d) continue;
+
+        transcache_finishPending(d, p);
+
+        int j = 0;
+        while (j < d->transCacheCount) {
+            Laik_TransCacheEntry *e = &(d->transCache[j]);
+            if ((e->fromP != p) && (e->toP != p)) {
+                j++;
+                continue;
+            }
+            if (transupdate_enabled && e->t->fromDep) {
+                // keep transition as base for incremental calculation
+                laik_log(1, "transition cache of data '%s': retire transition '%s'",
+                         d->name, e->t->name);
+                transcache_freeASeq(e);
+                e->fromP = 0;
+                e->toP = 0;
+                e->t->fromPartitioning = 0;
+                e->t->toPartitioning = 0;
+                e->t->group = 0;
+                e->retired = true;
+                j++;
+                continue;
+            }
+            laik_log(1, "transition cache of data '%s': drop transition '%s'",
+                     d->name, e->t->name);
+            transcache_freeEntry(e);
+            // fill gap with last entry
+            d->transCacheCount--;
+            if (j < d->transCacheCount)
+                *e = d->transCache[d->transCacheCount];
+        }
+    }
+}
+
+
+// bookkeeping and mapping allocation before executing transition <t>
+static
+void beginTransition(Laik_Data *d, Laik_Transition *t,
+                     Laik_MappingList *fromList, Laik_MappingList *toList) {
+    if (d->stat) {
+        d->stat->switches++;
+        if (t->actionCount == 0)
+            d->stat->switches_noactions++;
+    }
 
     // be careful when reusing mappings:
     // the backend wants to send/receive data in arbitrary order
@@ -777,12 +1309,144 @@ void doTransition(Laik_Data *d, Laik_Transition *t, Laik_ActionSeq *as,
 
     // allocate space for mappings for which reuse is not possible
     allocateMappings(toList, d->stat);
+}
+
+// let backend execute actions of <as> which are triggered from
+// transitions in contexts (mappings must be set in the contexts, and
+// beginTransition() must have been called for each).
+// With <split>, only actions not needing to wait for remote data are
+// done (if supported by backend), to be completed with finishASeq().
+// Afterwards, the new partitionings are active. Before finishASeq(),
+// only data not received from other processes is valid
+static
+void startASeq(Laik_ActionSeq *as, bool split) {
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_TransitionContext *tc = as->context[i];
+        Laik_Data *d = tc->data;
+
+        assert(d->pendingASeq == 0);
+        d->pendingASeq = as;
+        d->pendingASeqOwned = false;
+    }
+
+    if (laik_aseq_needsExec(as)) {
+        // one backend call for all transitions in the sequence
+        Laik_Instance *inst = as->inst;
+        if (inst->profiling->do_profiling)
+            inst->profiling->timer_backend = laik_wtime();
+
+        laik_aseq_borrowBuffers(as);
+        if (split && inst->backend->exec_start) {
+            (inst->backend->exec_start)(as);
+            as->execPending = true;
+        }
+        else {
+            (inst->backend->exec)(as);
+            laik_aseq_returnBuffers(as);
+        }
+
+        if (inst->profiling->do_profiling)
+            inst->profiling->time_backend += laik_wtime() - inst->profiling->timer_backend;
+    }
+
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_TransitionContext *tc = as->context[i];
+        Laik_Transition *t = tc->transition;
+        Laik_Data *d = tc->data;
+
+        // local copy actions: these never touch data received from others,
+        // thus can be done before completion of backend actions
+        if (t->localCount > 0)
+            copyMaps(t, tc->toList, tc->fromList, d->stat);
+
+        d->activePartitioning = t->toPartitioning;
+        d->activeMappings = tc->toList;
+    }
+}
+
+// make progress on backend actions of <as> started with startASeq(),
+// return true if backend actions are completed
+static
+bool testASeq(Laik_ActionSeq *as) {
+    if (!as->execPending) return true;
+
+    Laik_Instance *inst = as->inst;
+    if (inst->profiling->do_profiling)
+        inst->profiling->timer_backend = laik_wtime();
+
+    if ((inst->backend->exec_test)(as)) {
+        as->execPending = false;
+        laik_aseq_returnBuffers(as);
+    }
+
+    if (inst->profiling->do_profiling)
+        inst->profiling->time_backend += laik_wtime() - inst->profiling->timer_backend;
+
+    return !as->execPending;
+}
+
+// complete execution of <as> started with startASeq()
+static
+void finishASeq(Laik_ActionSeq *as) {
+    if (as->execPending) {
+        Laik_Instance *inst = as->inst;
+        if (inst->profiling->do_profiling)
+            inst->profiling->timer_backend = laik_wtime();
+
+        (inst->backend->exec_wait)(as);
+        as->execPending = false;
+        laik_aseq_returnBuffers(as);
+
+        if (inst->profiling->do_profiling)
+            inst->profiling->time_backend += laik_wtime() - inst->profiling->timer_backend;
+    }
+
+    Laik_Data *d0 = ((Laik_TransitionContext*) as->context[0])->data;
+    if (d0->stat)
+        laik_switchstat_addASeq(d0->stat, as);
+
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_TransitionContext *tc = as->context[i];
+        Laik_Transition *t = tc->transition;
+        Laik_Data *d = tc->data;
+
+        // local init action
+        if (t->initCount > 0)
+            initMaps(t, tc->toList, tc->fromList, d->stat);
+
+        // free old mapping/partitioning
+        if (tc->fromList)
+            freeMaps(tc->fromList, d->stat);
+
+        assert(d->pendingASeq == as);
+        d->pendingASeq = 0;
+    }
+}
 
-    bool doASeqCleanup = false;
+// start transition <t> on data container <d> with action sequence <as>,
+// which gets created if not given. See startASeq() for <split>
+static
+void startTransition(Laik_Data *d, Laik_Transition *t, Laik_ActionSeq *as,
+                     Laik_MappingList *fromList, Laik_MappingList *toList,
+                     bool split) {
+    if (t == 0) {
+        if (d->stat) {
+            d->stat->switches++;
+            d->stat->switches_noactions++;
+        }
+        // no transition to exec, just free old mappings
+        freeMaps(fromList, d->stat);
+        return;
+    }
+
+    beginTransition(d, t, fromList, toList);
+
+    bool owned = false;
     if (as) {
         // we are given a prepared action sequence:
         // check that <as> has actions for given transition
         Laik_TransitionContext *tc = as->context[0];
+        assert(as->contextCount == 1);
         assert(tc->data == d);
         assert(tc->transition == t);
         // provide current mappings to context
@@ -794,49 +1458,31 @@ void doTransition(Laik_Data *d, Laik_Transition *t, Laik_ActionSeq *as,
     } else {
         // create the action sequence for requested transition on the fly
         as = createTransASeq(d, t, fromList, toList);
-#if 1
-        const Laik_Backend *backend = d->space->inst->backend;
-        if (backend->prepare)
-            (backend->prepare)(as);
-        else {
-            // for statistics: usually called in backend prepare function
-            laik_aseq_calc_stats(as);
-        }
-#endif
-        doASeqCleanup = true;
+        prepareTransASeq(as);
+        owned = true;
     }
 
-    if (t->sendCount + t->recvCount + t->redCount > 0) {
-        // let backend do send/recv/reduce actions
-
-        Laik_Instance *inst = d->space->inst;
-        if (inst->profiling->do_profiling)
-            inst->profiling->timer_backend = laik_wtime();
-
-        (inst->backend->exec)(as);
-
-        if (inst->profiling->do_profiling)
-            inst->profiling->time_backend += laik_wtime() - inst->profiling->timer_backend;
-
-    }
+    startASeq(as, split);
+    d->pendingASeqOwned = owned;
+}
 
-    if (d->stat)
-        laik_switchstat_addASeq(d->stat, as);
+// complete a transition started on <d>, if any
+static
+void finishTransition(Laik_Data *d) {
+    Laik_ActionSeq *as = d->pendingASeq;
+    if (!as) return;
 
-    if (doASeqCleanup)
+    bool owned = d->pendingASeqOwned;
+    finishASeq(as);
+    if (owned)
         laik_aseq_free(as);
+}
 
-    // local copy actions
-    if (t->localCount > 0)
-        copyMaps(t, toList, fromList, d->stat);
-
-    // local init action
-    if (t->initCount > 0)
-        initMaps(t, toList, fromList, d->stat);
-
-    // free old mapping/partitioning
-    if (fromList)
-        freeMaps(fromList, d->stat);
+static
+void doTransition(Laik_Data *d, Laik_Transition *t, Laik_ActionSeq *as,
+                  Laik_MappingList *fromList, Laik_MappingList *toList) {
+    startTransition(d, t, as, fromList, toList, false);
+    finishTransition(d);
 }
 
 // make data container aware of reservation
@@ -902,6 +1548,9 @@ void laik_reservation_add(Laik_Reservation *r, Laik_Partitioning *p) {
 
 // free the memory space allocated in this reservation
 void laik_reservation_free(Laik_Reservation *r) {
+    // cached action sequences may refer to the mappings
+    transcache_dropReservation(r->data, r);
+
     for (int i = 0; i < r->count; i++) {
         assert(r->entry[i].mList != 0);
         free(r->entry[i].mList);
@@ -1169,6 +1818,11 @@ void laik_exec_transition(Laik_Data *d, Laik_Transition *t) {
         laik_log_flush(" on data '%s'", d->name);
     }
 
+    if (d->pendingASeq) {
+        laik_panic("laik_exec_transition: previous switch not completed!");
+        exit(1);
+    }
+
     // we only can execute transtion if start state in transition is correct
     if (d->activePartitioning != t->fromPartitioning) {
         laik_panic("laik_exec_transition starts in wrong partitioning!");
@@ -1187,30 +1841,40 @@ Laik_ActionSeq *laik_calc_actions(Laik_Data *d,
                                   Laik_Transition *t,
                                   Laik_Reservation *fromRes,
                                   Laik_Reservation *toRes) {
-    // never create a sequence with an invalid transition
-    if (t == 0) return 0;
-
-    Laik_MappingList *fromList = 0;
-    Laik_MappingList *toList = 0;
-    if (fromRes)
-        fromList = laik_reservation_getMList(fromRes, t->fromPartitioning);
-    if (toRes)
-        toList = laik_reservation_getMList(toRes, t->toPartitioning);
-
+    return laik_calc_actions_multi(1, &d, &t, &fromRes, &toRes);
+}
 
-    Laik_ActionSeq *as = createTransASeq(d, t, fromList, toList);
-    const Laik_Backend *backend = d->space->inst->backend;
-    if (backend->prepare) {
-        (backend->prepare)(as);
+Laik_ActionSeq *laik_calc_actions_multi(int n, Laik_Data **d,
+                                        Laik_Transition **t,
+                                        Laik_Reservation **fromRes,
+                                        Laik_Reservation **toRes) {
+    assert((n > 0) && (n <= ASEQ_CONTEXTS_MAX));
 
-        // remember mappings at prepare time
-        Laik_TransitionContext *tc = as->context[0];
-        tc->prepFromList = fromList;
-        tc->prepToList = toList;
-    } else {
-        // for statistics: usually called in backend prepare function
-        laik_aseq_calc_stats(as);
+    // never create a sequence with an invalid transition
+    for(int i = 0; i < n; i++)
+        if (t[i] == 0) return 0;
+
+    Laik_ActionSeq *as = laik_aseq_new(d[0]->space->inst);
+    for(int i = 0; i < n; i++) {
+        // a container can only do one transition at a time
+        for(int j = 0; j < i; j++)
+            assert(d[j] != d[i]);
+
+        Laik_MappingList *fromList = 0;
+        Laik_MappingList *toList = 0;
+        if (fromRes && fromRes[i])
+            fromList = laik_reservation_getMList(fromRes[i],
+                                                 t[i]->fromPartitioning);
+        if (toRes && toRes[i])
+            toList = laik_reservation_getMList(toRes[i],
+                                               t[i]->toPartitioning);
+
+        int tid = laik_aseq_addTContext(as, d[i], t[i], fromList, toList);
+        laik_aseq_addTExec(as, tid);
     }
+    laik_aseq_activateNewActions(as);
+    as->reused = true;
+    prepareTransASeq(as);
 
     if (laik_log_begin(2)) {
         laik_log_append("calculated ");
@@ -1221,51 +1885,123 @@ Laik_ActionSeq *laik_calc_actions(Laik_Data *d,
     return as;
 }
 
-// execute a previously calculated transition on a data container
-void laik_exec_actions(Laik_ActionSeq *as) {
-    Laik_TransitionContext *tc = as->context[0];
-    Laik_Transition *t = tc->transition;
-    Laik_Data *d = tc->data;
+// check that transitions in <as> can be executed, and set mappings
+static
+void setupASeqExec(Laik_ActionSeq *as) {
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_TransitionContext *tc = as->context[i];
+        Laik_Transition *t = tc->transition;
+        Laik_Data *d = tc->data;
 
-    if (laik_log_begin(1)) {
-        laik_log_append("exec action seq '%s' for transition ", as->name);
-        laik_log_Transition(t, false);
-        laik_log_flush(" on data '%s'", d->name);
-    }
+        if (laik_log_begin(1)) {
+            laik_log_append("exec action seq '%s' for transition ", as->name);
+            laik_log_Transition(t, false);
+            laik_log_flush(" on data '%s'", d->name);
+        }
 
-    // we only can execute transtion if start state in transition is correct
-    if (d->activePartitioning != t->fromPartitioning) {
-        laik_panic("laik_exec_actions starts in wrong partitioning!");
-        exit(1);
-    }
+        if (d->pendingASeq) {
+            laik_panic("laik_exec_actions: previous switch not completed!");
+            exit(1);
+        }
 
-    Laik_MappingList* toList = prepareMaps(d, t->toPartitioning);
+        // we only can execute transtion if start state in transition is correct
+        if (d->activePartitioning != t->fromPartitioning) {
+            laik_panic("laik_exec_actions starts in wrong partitioning!");
+            exit(1);
+        }
 
-    if (tc->prepFromList && (tc->prepFromList != d->activeMappings)) {
-        laik_panic("laik_exec_actions: start mappings mismatch!");
-        exit(1);
+        Laik_MappingList* toList = prepareMaps(d, t->toPartitioning);
+
+        if (tc->prepFromList && (tc->prepFromList != d->activeMappings)) {
+            laik_panic("laik_exec_actions: start mappings mismatch!");
+            exit(1);
+        }
+        if (tc->prepToList && (tc->prepToList != toList)) {
+            laik_panic("laik_exec_actions: end mappings mismatch!");
+            exit(1);
+        }
+
+        // only execute by backend which optimized the sequence
+        if (as->backend)
+            assert(as->backend == d->space->inst->backend);
+
+        // provide current mappings to context
+        tc->fromList = d->activeMappings;
+        tc->toList = toList;
+
+        beginTransition(d, t, tc->fromList, tc->toList);
     }
-    if (tc->prepToList && (tc->prepToList != toList)) {
-        laik_panic("laik_exec_actions: end mappings mismatch!");
-        exit(1);
+}
+
+// execute a previously calculated action sequence, which may contain
+// transitions for multiple data containers
+void laik_exec_actions(Laik_ActionSeq *as) {
+    setupASeqExec(as);
+    startASeq(as, false);
+    finishASeq(as);
+}
+
+// let the backend prepare an action sequence loaded with laik_aseq_load
+void laik_aseq_prepare(Laik_ActionSeq *as) {
+    assert(as->loaded);
+    prepareTransASeq(as);
+}
+
+// execute an action sequence loaded with laik_aseq_load on its containers.
+// Containers have no partitionings, thus there is no state to update
+void laik_aseq_replay(Laik_ActionSeq *as) {
+    assert(as->loaded);
+    Laik_Instance *inst = as->inst;
+
+    laik_aseq_borrowBuffers(as);
+    (inst->backend->exec)(as);
+    laik_aseq_returnBuffers(as);
+
+    for(int i = 0; i < as->contextCount; i++) {
+        Laik_TransitionContext *tc = as->context[i];
+        if (tc->transition->localCount > 0)
+            copyMaps(tc->transition, tc->toList, tc->fromList, tc->data->stat);
     }
 
-    // only execute by backend which optimized the sequence
-    if (as->backend)
-        assert(as->backend == d->space->inst->backend);
+    Laik_Data *d0 = ((Laik_TransitionContext*) as->context[0])->data;
+    laik_switchstat_addASeq(d0->stat, as);
+}
 
-    doTransition(d, t, as, d->activeMappings, toList);
+// start executing a previously calculated action sequence
+void laik_exec_actions_start(Laik_ActionSeq *as) {
+    setupASeqExec(as);
+    startASeq(as, true);
+}
 
-    // set new mapping/partitioning active
-    d->activePartitioning = t->toPartitioning;
-    d->activeMappings = toList;
+// check for completion of an action sequence started before
+bool laik_exec_actions_test(Laik_ActionSeq *as) {
+    Laik_Data *d0 = ((Laik_TransitionContext*) as->context[0])->data;
+    if (d0->pendingASeq != as) return true; // already completed
+
+    if (!testASeq(as)) return false;
+    finishASeq(as);
+    return true;
 }
 
+// wait for completion of an action sequence started before
+void laik_exec_actions_wait(Laik_ActionSeq *as) {
+    Laik_Data *d0 = ((Laik_TransitionContext*) as->context[0])->data;
+    if (d0->pendingASeq != as) return; // already completed
+
+    finishASeq(as);
+}
+
+
+// start switching to given partitioning, see startASeq() for <split>
+static
+void startSwitch(Laik_Data *d,
+                 Laik_Partitioning *toP, Laik_DataFlow flow,
+                 Laik_ReductionOperation redOp, bool split) {
+    if (d->pendingASeq) {
+        laik_panic("laik_switchto: previous switch not completed!");
+        exit(1);
+    }
 
-// switch to given partitioning
-void laik_switchto_partitioning(Laik_Data *d,
-                                Laik_Partitioning *toP, Laik_DataFlow flow,
-                                Laik_ReductionOperation redOp) {
     // calculate actions to be done for switching
 
     Laik_Group *toGroup = toP ? toP->group : 0;
@@ -1282,11 +2018,40 @@ void laik_switchto_partitioning(Laik_Data *d,
     }
 
     Laik_MappingList* toList = prepareMaps(d, toP);
-    Laik_Transition *t = do_calc_transition(d->space,
+
+    // no caching if partitioning was migrated temporarily
+    bool useCache = transcache_enabled && toP && (toGroup == toP->group);
+    Laik_TransCacheEntry *e = 0;
+    if (useCache)
+        e = transcache_lookup(d, d->activePartitioning, toP, flow, redOp);
+
+    Laik_Transition *t;
+    if (e) {
+        t = e->t;
+        laik_log(1, "switch data '%s': reuse cached transition '%s'",
+                 d->name, t->name);
+    } else {
+        Laik_TransCacheEntry *base = 0;
+        if (useCache && transupdate_enabled && d->activePartitioning)
+            base = transcache_findBase(d, d->activePartitioning, toP,
+                                       flow, redOp);
+        if (base)
+            t = laik_calc_transition_update(base->t, d->space,
                                             d->activePartitioning, toP,
                                             flow, redOp);
+        else
+            t = do_calc_transition(d->space,
+                                   d->activePartitioning, toP,
+                                   flow, redOp);
+        if (useCache && t)
+            e = transcache_insert(d, t, flow, redOp);
+    }
 
-    doTransition(d, t, 0, d->activeMappings, toList);
+    Laik_ActionSeq *as = 0;
+    if (e)
+        as = transcache_getASeq(d, e, d->activeMappings, toList);
+
+    startTransition(d, t, as, d->activeMappings, toList, split);
 
     // if we migrated "toP" to old group before, migrate back to new
     if (toGroup != toP->group)
@@ -1297,6 +2062,36 @@ void laik_switchto_partitioning(Laik_Data *d,
     d->activeMappings = toList;
 }
 
+// switch to given partitioning
+void laik_switchto_partitioning(Laik_Data *d,
+                                Laik_Partitioning *toP, Laik_DataFlow flow,
+                                Laik_ReductionOperation redOp) {
+    startSwitch(d, toP, flow, redOp, false);
+    finishTransition(d);
+}
+
+// start switching to given partitioning
+void laik_switchto_partitioning_start(Laik_Data *d,
+                                      Laik_Partitioning *toP, Laik_DataFlow flow,
+                                      Laik_ReductionOperation redOp) {
+    startSwitch(d, toP, flow, redOp, true);
+}
+
+// check for completion of a switch started before
+bool laik_switchto_test(Laik_Data *d) {
+    Laik_ActionSeq *as = d->pendingASeq;
+    if (!as) return true;
+
+    if (!testASeq(as)) return false;
+    finishTransition(d);
+    return true;
+}
+
+// wait for completion of a switch started before
+void laik_switchto_wait(Laik_Data *d) {
+    finishTransition(d);
+}
+
 
 // switch to another data flow, keep partitioning
 void laik_switchto_flow(Laik_Data *d,
@@ -1309,6 +2104,156 @@ void laik_switchto_flow(Laik_Data *d,
 }
 
 
+//
+// Predicting the cost of a switch
+//
+// Before accepting a new partitioning (e.g. from a load balancer), an
+// application may want to know how expensive the migration of data will
+// be. The transition is calculated (and kept in the transition cache for
+// a following switch), and its actions are generated without mappings
+// to get statistics. Backend optimizations (e.g. message aggregation)
+// are not taken into account.
+//
+
+static
+Laik_SwitchCost *newSwitchCost(int peers) {
+    Laik_SwitchCost *c = calloc(1, sizeof(Laik_SwitchCost));
+    if (c) {
+        c->peers = peers;
+        c->peerByteSend = calloc(peers, sizeof(uint64_t));
+        c->peerByteRecv = calloc(peers, sizeof(uint64_t));
+        c->peerMsgSend = calloc(peers, sizeof(unsigned int));
+        c->peerMsgRecv = calloc(peers, sizeof(unsigned int));
+    }
+    if (!c || !c->peerByteSend || !c->peerByteRecv ||
+        !c->peerMsgSend || !c->peerMsgRecv) {
+        laik_panic("Out of memory allocating Laik_SwitchCost object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    return c;
+}
+
+void laik_free_switchcost(Laik_SwitchCost *c) {
+    if (!c) return;
+
+    free(c->peerByteSend);
+    free(c->peerByteRecv);
+    free(c->peerMsgSend);
+    free(c->peerMsgRecv);
+    free(c);
+}
+
+// fill cost <c> from transition <t> on container <d>
+static
+void calcSwitchCost(Laik_SwitchCost *c, Laik_Data *d, Laik_Transition *t) {
+    uint64_t elemsize = (uint64_t) d->elemsize;
+
+    for(int i = 0; i < t->localCount; i++)
+        c->byteCopyCount += laik_slice_size(&(t->local[i].slc)) * elemsize;
+    for(int i = 0; i < t->initCount; i++)
+        c->byteInitCount += laik_slice_size(&(t->init[i].slc)) * elemsize;
+
+    // generate actions without mappings, as done by backends on prepare
+    Laik_ActionSeq *as = laik_aseq_new(d->space->inst);
+    int tid = laik_aseq_addTContext(as, d, t, 0, 0);
+    laik_aseq_addTExec(as, tid);
+    laik_aseq_activateNewActions(as);
+    laik_aseq_splitTransitionExecs(as);
+    laik_aseq_calc_stats(as);
+
+    c->msgSendCount = as->msgSendCount;
+    c->msgRecvCount = as->msgRecvCount;
+    c->msgReduceCount = as->msgReduceCount;
+    c->byteSendCount = as->byteSendCount;
+    c->byteRecvCount = as->byteRecvCount;
+    c->byteReduceCount = as->byteReduceCount;
+
+    Laik_Action *a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        switch(a->type) {
+        case LAIK_AT_MapPackAndSend: {
+            Laik_A_MapPackAndSend *aa = (Laik_A_MapPackAndSend*) a;
+            assert((aa->to_rank >= 0) && (aa->to_rank < c->peers));
+            c->peerMsgSend[aa->to_rank]++;
+            c->peerByteSend[aa->to_rank] += aa->count * elemsize;
+            break;
+        }
+        case LAIK_AT_MapRecvAndUnpack: {
+            Laik_A_MapRecvAndUnpack *aa = (Laik_A_MapRecvAndUnpack*) a;
+            assert((aa->from_rank >= 0) && (aa->from_rank < c->peers));
+            c->peerMsgRecv[aa->from_rank]++;
+            c->peerByteRecv[aa->from_rank] += aa->count * elemsize;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    laik_aseq_free(as);
+}
+
+// predict cost of switching <d> to partitioning <toP> with given flow,
+// without communication or allocation of mappings. Returns 0 if this
+// process is not involved. Result must be freed with laik_free_switchcost
+Laik_SwitchCost *laik_data_predict_switch(Laik_Data *d,
+                                          Laik_Partitioning *toP,
+                                          Laik_DataFlow flow,
+                                          Laik_ReductionOperation redOp) {
+    if (d->pendingASeq) {
+        laik_panic("laik_data_predict_switch: previous switch not completed!");
+        exit(1);
+    }
+    if (!toP) return 0;
+
+    Laik_Partitioning *fromP = d->activePartitioning;
+    Laik_Group *toGroup = toP->group;
+    if (fromP && (fromP->group != toP->group)) {
+        // as in switch: transition is calculated in old group
+        laik_partitioning_migrate(toP, fromP->group);
+    }
+
+    // no caching if partitioning was migrated temporarily
+    bool useCache = transcache_enabled && (toGroup == toP->group);
+    Laik_TransCacheEntry *e = 0;
+    if (useCache)
+        e = transcache_lookup(d, fromP, toP, flow, redOp);
+
+    Laik_Transition *t = e ? e->t : 0;
+    if (!t) {
+        t = do_calc_transition(d->space, fromP, toP, flow, redOp);
+        // keep for a following switch
+        if (useCache && t)
+            e = transcache_insert(d, t, flow, redOp);
+    }
+
+    Laik_SwitchCost *c = 0;
+    if (t) {
+        c = newSwitchCost(t->group->size);
+        calcSwitchCost(c, d, t);
+        if (!e) laik_free_transition(t);
+    }
+
+    if (toGroup != toP->group)
+        laik_partitioning_migrate(toP, toGroup);
+
+    if (c && laik_log_begin(1)) {
+        laik_log_append("predicted switch of data '%s' to '%s': ",
+                        d->name, toP->name);
+        laik_log_flush("%d/%d msgs (%llu/%llu bytes) send/recv, "
+                       "%d reduce (%llu bytes), %llu bytes copy, %llu init",
+                       c->msgSendCount, c->msgRecvCount,
+                       (unsigned long long) c->byteSendCount,
+                       (unsigned long long) c->byteRecvCount,
+                       c->msgReduceCount,
+                       (unsigned long long) c->byteReduceCount,
+                       (unsigned long long) c->byteCopyCount,
+                       (unsigned long long) c->byteInitCount);
+    }
+
+    return c;
+}
+
+
 // get slice number <n> in own partition
 Laik_TaskSlice *laik_data_slice(Laik_Data *d, int n) {
     if (d->activePartitioning == 0) return 0;
@@ -1851,8 +2796,13 @@ int laik_map_get_mapNo(const Laik_Mapping *map) {
 void laik_free(Laik_Data *d) {
     // TODO: free space, partitionings
 
+    // cached action sequences may still be in use by a pending switch
+    laik_switchto_wait(d);
+    transcache_free(d);
+
     // Modification by VB: Make sure that no active mappings are left before deleting data
     freeMaps(d->activeMappings, d->stat);
+    mappool_free(d);
 
     // Modification by VB: Make sure that there is no dangling pointer in the instance array
     laik_data_get_inst(d)->data[d->id] = NULL;
@@ -1877,6 +2827,20 @@ Laik_Allocator *laik_new_allocator() {
     a->free = 0;    // use free
     a->realloc = 0; // use malloc/free for reallocation
     a->unmap = 0;   // no notification
+    a->poolMaxBytes = 0;
+    a->flags = LAIK_AF_None;
+    a->numaNodes = 0;
+    a->touch = 0;
+
+    return a;
+}
+
+// returns an allocator with policy LAIK_MP_UsePool, keeping at most
+// <maxBytes> of freed mapping memory per container for reuse (0: no limit)
+Laik_Allocator *laik_new_pool_allocator(uint64_t maxBytes) {
+    Laik_Allocator *a = laik_new_allocator();
+    a->policy = LAIK_MP_UsePool;
+    a->poolMaxBytes = maxBytes;
 
     return a;
 }
@@ -1884,6 +2848,9 @@ Laik_Allocator *laik_new_allocator() {
 void laik_set_allocator(Laik_Data *d, Laik_Allocator *a) {
     // TODO: decrement reference count for existing allocator
 
+    // cached memory was allocated via previous allocator. Memory of
+    // still active mappings is freed via the allocator stored in them
+    mappool_free(d);
     d->allocator = a;
 }
 
@@ -254,17 +254,21 @@ void laik_log_SliceFilter(Laik_SliceFilter* sf)
 {
     if (!sf)
         laik_log_append("no filter");
-    else if (sf->filter_tid >=0)
-        laik_log_append("filter for task %d", sf->filter_tid);
     else if (sf->pfilter1) {
-        laik_log_append("intersection filter with %d [%lld;%lld[",
-                        sf->pfilter1->len,
-                        (long long) sf->pfilter1->from, (long long) sf->pfilter1->to);
-        if (sf->pfilter2)
-            laik_log_append(" and %d [%lld;%lld[", sf->pfilter2->len,
-                        (long long) sf->pfilter2->from, (long long) sf->pfilter2->to);
-        laik_log_append(" slices");
+        laik_log_append("intersection filter with %d slices in ",
+                        sf->pfilter1->len);
+        laik_log_Slice(&(sf->pfilter1->bb));
+        if (sf->pfilter2) {
+            laik_log_append(" and %d slices in ", sf->pfilter2->len);
+            laik_log_Slice(&(sf->pfilter2->bb));
+        }
+        if (sf->reach > 0)
+            laik_log_append(", reach %lld", (long long) sf->reach);
+        if (sf->filter_tid >= 0)
+            laik_log_append(", keeping task %d", sf->filter_tid);
     }
+    else if (sf->filter_tid >=0)
+        laik_log_append("filter for task %d", sf->filter_tid);
 }
 
 void laik_log_Partitioning(Laik_Partitioning* p)
@@ -335,6 +339,9 @@ void laik_log_SwitchStat(Laik_SwitchStat* ss)
         laik_log_PrettyInt(ss->copiedBytes);
         laik_log_append("B\n");
     }
+    if (ss->poolHits + ss->poolMisses > 0)
+        laik_log_append("    data pool: %d hits, %d misses\n",
+                        ss->poolHits, ss->poolMisses);
     int out = 0;
     unsigned int msgSendCount = ss->msgSendCount + ss->msgAsyncSendCount;
     if (msgSendCount > 0) {
@@ -433,10 +440,10 @@ void laik_log_Action(Laik_Action* a, Laik_ActionSeq* as)
                     ((char*)a) - ((char*)(as->action)),
                     a->round, a->tid, laik_at_str(a->type));
 
-    Laik_BackendAction* ba = (Laik_BackendAction*) a;
     switch(a->type) {
     case LAIK_AT_Nop:
     case LAIK_AT_TExec:
+    case LAIK_AT_Copy:
         break;
 
     case LAIK_AT_BufReserve: {
@@ -445,13 +452,15 @@ void laik_log_Action(Laik_Action* a, Laik_ActionSeq* as)
         break;
     }
 
-    case LAIK_AT_MapSend:
+    case LAIK_AT_MapSend: {
+        Laik_A_MapSend* aa = (Laik_A_MapSend*) a;
         laik_log_append(": from mapNo %d, off %d, count %d ==> T%d",
-                        ba->fromMapNo,
-                        ba->offset,
-                        ba->count,
-                        ba->rank);
+                        aa->fromMapNo,
+                        aa->offset,
+                        aa->count,
+                        aa->to_rank);
         break;
+    }
 
     case LAIK_AT_BufSend: {
         Laik_A_BufSend* aa = (Laik_A_BufSend*) a;
@@ -471,13 +480,15 @@ void laik_log_Action(Laik_Action* a, Laik_ActionSeq* as)
         break;
     }
 
-    case LAIK_AT_MapRecv:
+    case LAIK_AT_MapRecv: {
+        Laik_A_MapRecv* aa = (Laik_A_MapRecv*) a;
         laik_log_append(": T%d ==> to mapNo %d, off %lld, count %d",
-                        ba->rank,
-                        ba->toMapNo,
-                        (long long int) ba->offset,
-                        ba->count);
+                        aa->from_rank,
+                        aa->toMapNo,
+                        (long long int) aa->offset,
+                        aa->count);
         break;
+    }
 
     case LAIK_AT_BufRecv: {
         Laik_A_BufRecv* aa = (Laik_A_BufRecv*) a;
@@ -497,157 +508,187 @@ void laik_log_Action(Laik_Action* a, Laik_ActionSeq* as)
         break;
     }
 
-    case LAIK_AT_CopyFromBuf:
+    case LAIK_AT_CopyFromBuf: {
+        Laik_A_CopyFromBuf* aa = (Laik_A_CopyFromBuf*) a;
         laik_log_append(": buf %p, ranges %d",
-                        ba->fromBuf,
-                        ba->count);
-        for(unsigned int i = 0; i < ba->count; i++)
+                        aa->fromBuf,
+                        aa->count);
+        for(unsigned int i = 0; i < aa->count; i++)
             laik_log_append("\n        off %d, bytes %d => to %p",
-                            ba->ce[i].offset,
-                            ba->ce[i].bytes,
-                            ba->ce[i].ptr);
+                            aa->ce[i].offset,
+                            aa->ce[i].bytes,
+                            aa->ce[i].ptr);
         break;
+    }
 
-    case LAIK_AT_CopyToBuf:
+    case LAIK_AT_CopyToBuf: {
+        Laik_A_CopyToBuf* aa = (Laik_A_CopyToBuf*) a;
         laik_log_append(": buf %p, ranges %d",
-                        ba->toBuf,
-                        ba->count);
-        for(unsigned int i = 0; i < ba->count; i++)
+                        aa->toBuf,
+                        aa->count);
+        for(unsigned int i = 0; i < aa->count; i++)
             laik_log_append("\n        %p => off %d, bytes %d",
-                            ba->ce[i].ptr,
-                            ba->ce[i].offset,
-                            ba->ce[i].bytes);
+                            aa->ce[i].ptr,
+                            aa->ce[i].offset,
+                            aa->ce[i].bytes);
         break;
+    }
 
-    case LAIK_AT_CopyFromRBuf:
+    case LAIK_AT_CopyFromRBuf: {
+        Laik_A_CopyFromRBuf* aa = (Laik_A_CopyFromRBuf*) a;
         laik_log_append(": buf %d, off %lld, ranges %d",
-                        ba->bufID, (long long int) ba->offset,
-                        ba->count);
-        for(unsigned int i = 0; i < ba->count; i++)
+                        aa->bufID, (long long int) aa->offset,
+                        aa->count);
+        for(unsigned int i = 0; i < aa->count; i++)
             laik_log_append("\n        off %d, bytes %d => to %p",
-                            ba->ce[i].offset,
-                            ba->ce[i].bytes,
-                            ba->ce[i].ptr);
+                            aa->ce[i].offset,
+                            aa->ce[i].bytes,
+                            aa->ce[i].ptr);
         break;
+    }
 
-    case LAIK_AT_CopyToRBuf:
+    case LAIK_AT_CopyToRBuf: {
+        Laik_A_CopyToRBuf* aa = (Laik_A_CopyToRBuf*) a;
         laik_log_append(": buf %d, off %lld, ranges %d",
-                        ba->bufID, (long long int) ba->offset,
-                        ba->count);
-        for(unsigned int i = 0; i < ba->count; i++)
+                        aa->bufID, (long long int) aa->offset,
+                        aa->count);
+        for(unsigned int i = 0; i < aa->count; i++)
             laik_log_append("\n        %p => off %d, bytes %d",
-                            ba->ce[i].ptr,
-                            ba->ce[i].offset,
-                            ba->ce[i].bytes);
+                            aa->ce[i].ptr,
+                            aa->ce[i].offset,
+                            aa->ce[i].bytes);
         break;
+    }
 
-    case LAIK_AT_BufCopy:
+    case LAIK_AT_BufCopy: {
+        Laik_A_BufCopy* aa = (Laik_A_BufCopy*) a;
         laik_log_append(": from %p, to %p, count %d",
-                        ba->fromBuf,
-                        ba->toBuf,
-                        ba->count);
+                        aa->fromBuf,
+                        aa->toBuf,
+                        aa->count);
         break;
+    }
 
-    case LAIK_AT_RBufCopy:
+    case LAIK_AT_RBufCopy: {
+        Laik_A_RBufCopy* aa = (Laik_A_RBufCopy*) a;
         laik_log_append(": from buf %d off %lld, to %p, count %d",
-                        ba->bufID, (long long int) ba->offset,
-                        (void*) ba->toBuf,
-                        ba->count);
-        break;
-
-    case LAIK_AT_Copy:
-        laik_log_append(": count %d", ba->count);
+                        aa->bufID, (long long int) aa->offset,
+                        (void*) aa->toBuf,
+                        aa->count);
         break;
+    }
 
-    case LAIK_AT_Reduce:
+    case LAIK_AT_Reduce: {
+        Laik_A_Reduce* aa = (Laik_A_Reduce*) a;
         laik_log_append(": count %d, from %p, to %p, root ",
-                        ba->count,
-                        (void*) ba->fromBuf, (void*) ba->toBuf);
-        if (ba->rank == -1)
+                        aa->count,
+                        (void*) aa->fromBuf, (void*) aa->toBuf);
+        if (aa->rootTask == -1)
             laik_log_append("(all)");
         else
-            laik_log_append("%d", ba->rank);
+            laik_log_append("%d", aa->rootTask);
         break;
+    }
 
-    case LAIK_AT_RBufReduce:
+    case LAIK_AT_RBufReduce: {
+        Laik_A_RBufReduce* aa = (Laik_A_RBufReduce*) a;
         laik_log_append(": count %d, from/to buf %d off %lld, root ",
-                        ba->count, ba->bufID, ba->offset);
-        if (ba->rank == -1)
+                        aa->count, aa->bufID, aa->offset);
+        if (aa->rootTask == -1)
             laik_log_append("(all)");
         else
-            laik_log_append("%d", ba->rank);
+            laik_log_append("%d", aa->rootTask);
         break;
+    }
 
-    case LAIK_AT_MapGroupReduce:
+    case LAIK_AT_MapGroupReduce: {
+        Laik_A_MapGroupReduce* aa = (Laik_A_MapGroupReduce*) a;
         laik_log_append(": ");
-        laik_log_Slice(ba->slc);
+        laik_log_Slice(aa->slc);
         laik_log_append(" myInMapNo %d, myOutMapNo %d, count %d, input ",
-                        ba->fromMapNo, ba->toMapNo, ba->count);
-        laik_log_TransitionGroup(tc->transition, ba->inputGroup);
+                        aa->fromMapNo, aa->toMapNo, aa->count);
+        laik_log_TransitionGroup(tc->transition, aa->inputGroup);
         laik_log_append(", output ");
-        laik_log_TransitionGroup(tc->transition, ba->outputGroup);
+        laik_log_TransitionGroup(tc->transition, aa->outputGroup);
         break;
+    }
 
-    case LAIK_AT_GroupReduce:
+    case LAIK_AT_GroupReduce: {
+        Laik_A_GroupReduce* aa = (Laik_A_GroupReduce*) a;
         laik_log_append(": count %d, from %p, to %p, input ",
-                        ba->count,
-                        (void*) ba->fromBuf, (void*) ba->toBuf);
-        laik_log_TransitionGroup(tc->transition, ba->inputGroup);
+                        aa->count,
+                        (void*) aa->fromBuf, (void*) aa->toBuf);
+        laik_log_TransitionGroup(tc->transition, aa->inputGroup);
         laik_log_append(", output ");
-        laik_log_TransitionGroup(tc->transition, ba->outputGroup);
+        laik_log_TransitionGroup(tc->transition, aa->outputGroup);
         break;
+    }
 
-    case LAIK_AT_RBufGroupReduce:
+    case LAIK_AT_RBufGroupReduce: {
+        Laik_A_RBufGroupReduce* aa = (Laik_A_RBufGroupReduce*) a;
         laik_log_append(": count %d, from/to buf %d, off %lld, input ",
-                        ba->count,
-                        ba->bufID, (long long int) ba->offset);
-        laik_log_TransitionGroup(tc->transition, ba->inputGroup);
+                        aa->count,
+                        aa->bufID, (long long int) aa->offset);
+        laik_log_TransitionGroup(tc->transition, aa->inputGroup);
         laik_log_append(", output ");
-        laik_log_TransitionGroup(tc->transition, ba->outputGroup);
+        laik_log_TransitionGroup(tc->transition, aa->outputGroup);
         break;
+    }
 
-    case LAIK_AT_RBufLocalReduce:
-        laik_log_append(": type %s, redOp ", ba->dtype->name);
-        laik_log_Reduction(ba->redOp);
+    case LAIK_AT_RBufLocalReduce: {
+        Laik_A_RBufLocalReduce* aa = (Laik_A_RBufLocalReduce*) a;
+        laik_log_append(": type %s, redOp ", aa->dtype->name);
+        laik_log_Reduction(aa->redOp);
         laik_log_append(", from buf %d off %lld, to %p, count %d",
-                        ba->bufID, (long long int) ba->offset,
-                        ba->toBuf, ba->count);
+                        aa->bufID, (long long int) aa->offset,
+                        aa->toBuf, aa->count);
         break;
+    }
 
-    case LAIK_AT_BufInit:
-        laik_log_append(": type %s, redOp ", ba->dtype->name);
-        laik_log_Reduction(ba->redOp);
+    case LAIK_AT_BufInit: {
+        Laik_A_BufInit* aa = (Laik_A_BufInit*) a;
+        laik_log_append(": type %s, redOp ", aa->dtype->name);
+        laik_log_Reduction(aa->redOp);
         laik_log_append(", to %p, count %d",
-                        (void*) ba->toBuf, ba->count);
+                        (void*) aa->toBuf, aa->count);
         break;
+    }
 
-    case LAIK_AT_PackToBuf:
+    case LAIK_AT_PackToBuf: {
+        Laik_A_PackToBuf* aa = (Laik_A_PackToBuf*) a;
         laik_log_append(": ");
-        laik_log_Slice(ba->slc);
+        laik_log_Slice(aa->slc);
         laik_log_append(" count %d ==> buf %p",
-                        ba->count, (void*) ba->toBuf);
+                        aa->count, (void*) aa->toBuf);
         break;
+    }
 
-    case LAIK_AT_PackToRBuf:
+    case LAIK_AT_PackToRBuf: {
+        Laik_A_PackToRBuf* aa = (Laik_A_PackToRBuf*) a;
         laik_log_append(": ");
-        laik_log_Slice(ba->slc);
+        laik_log_Slice(aa->slc);
         laik_log_append(" count %d ==> buf %d off %lld",
-                        ba->count, ba->bufID, ba->offset);
+                        aa->count, aa->bufID, aa->offset);
         break;
+    }
 
-    case LAIK_AT_MapPackToRBuf:
+    case LAIK_AT_MapPackToRBuf: {
+        Laik_A_MapPackToRBuf* aa = (Laik_A_MapPackToRBuf*) a;
         laik_log_append(": ");
-        laik_log_Slice(ba->slc);
+        laik_log_Slice(aa->slc);
         laik_log_append(" mapNo %d, count %d ==> buf %d off %lld",
-                        ba->fromMapNo, ba->count, ba->bufID, ba->offset);
+                        aa->fromMapNo, aa->count, aa->bufID, aa->offset);
         break;
+    }
 
-    case LAIK_AT_MapPackToBuf:
+    case LAIK_AT_MapPackToBuf: {
+        Laik_A_MapPackToBuf* aa = (Laik_A_MapPackToBuf*) a;
         laik_log_append(": ");
-        laik_log_Slice(ba->slc);
+        laik_log_Slice(aa->slc);
         laik_log_append(" mapNo %d, count %d ==> buf %p",
-                        ba->fromMapNo, ba->count, (void*) ba->toBuf);
+                        aa->fromMapNo, aa->count, (void*) aa->toBuf);
         break;
+    }
 
     case LAIK_AT_MapPackAndSend: {
         Laik_A_MapPackAndSend* aa = (Laik_A_MapPackAndSend*) a;
@@ -658,42 +699,54 @@ void laik_log_Action(Laik_Action* a, Laik_ActionSeq* as)
         break;
     }
 
-    case LAIK_AT_PackAndSend:
+    case LAIK_AT_PackAndSend: {
+        Laik_A_PackAndSend* aa = (Laik_A_PackAndSend*) a;
         laik_log_append(": ");
-        laik_log_Slice(ba->slc);
+        laik_log_Slice(aa->slc);
         laik_log_append(" count %d ==> T%d",
-                        ba->count, ba->rank);
+                        aa->count, aa->to_rank);
         break;
+    }
 
-    case LAIK_AT_UnpackFromBuf:
-        laik_log_append(": buf %p ==> ", (void*) ba->fromBuf);
-        laik_log_Slice(ba->slc);
-        laik_log_append(", count %d", ba->count);
+    case LAIK_AT_UnpackFromBuf: {
+        Laik_A_UnpackFromBuf* aa = (Laik_A_UnpackFromBuf*) a;
+        laik_log_append(": buf %p ==> ", (void*) aa->fromBuf);
+        laik_log_Slice(aa->slc);
+        laik_log_append(", count %d", aa->count);
         break;
+    }
 
-    case LAIK_AT_UnpackFromRBuf:
-        laik_log_append(": buf %d, off %lld ==> ", ba->bufID, ba->offset);
-        laik_log_Slice(ba->slc);
-        laik_log_append(", count %d", ba->count);
+    case LAIK_AT_UnpackFromRBuf: {
+        Laik_A_UnpackFromRBuf* aa = (Laik_A_UnpackFromRBuf*) a;
+        laik_log_append(": buf %d, off %lld ==> ", aa->bufID, aa->offset);
+        laik_log_Slice(aa->slc);
+        laik_log_append(", count %d", aa->count);
         break;
+    }
 
-    case LAIK_AT_MapUnpackFromRBuf:
-        laik_log_append(": buf %d, off %lld ==> ", ba->bufID, ba->offset);
-        laik_log_Slice(ba->slc);
-        laik_log_append(" mapNo %d, count %d", ba->toMapNo, ba->count);
+    case LAIK_AT_MapUnpackFromRBuf: {
+        Laik_A_MapUnpackFromRBuf* aa = (Laik_A_MapUnpackFromRBuf*) a;
+        laik_log_append(": buf %d, off %lld ==> ", aa->bufID, aa->offset);
+        laik_log_Slice(aa->slc);
+        laik_log_append(" mapNo %d, count %d", aa->toMapNo, aa->count);
         break;
+    }
 
-    case LAIK_AT_MapUnpackFromBuf:
-        laik_log_append(": buf %p ==> ", (void*) ba->fromBuf);
-        laik_log_Slice(ba->slc);
-        laik_log_append(" mapNo %d, count %d", ba->toMapNo, ba->count);
+    case LAIK_AT_MapUnpackFromBuf: {
+        Laik_A_MapUnpackFromBuf* aa = (Laik_A_MapUnpackFromBuf*) a;
+        laik_log_append(": buf %p ==> ", (void*) aa->fromBuf);
+        laik_log_Slice(aa->slc);
+        laik_log_append(" mapNo %d, count %d", aa->toMapNo, aa->count);
         break;
+    }
 
-    case LAIK_AT_RecvAndUnpack:
-        laik_log_append(": T%d ==> ", ba->rank);
-        laik_log_Slice(ba->slc);
-        laik_log_append(", count %d", ba->count);
+    case LAIK_AT_RecvAndUnpack: {
+        Laik_A_RecvAndUnpack* aa = (Laik_A_RecvAndUnpack*) a;
+        laik_log_append(": T%d ==> ", aa->from_rank);
+        laik_log_Slice(aa->slc);
+        laik_log_append(", count %d", aa->count);
         break;
+    }
 
     case LAIK_AT_MapRecvAndUnpack: {
         Laik_A_MapRecvAndUnpack* aa = (Laik_A_MapRecvAndUnpack*) a;
@@ -729,11 +782,10 @@ void laik_log_ActionSeq(Laik_ActionSeq *as, bool showDetails)
     Laik_TransitionContext* tc = 0;
     for(int i = 0; i < as->contextCount; i++) {
         tc = as->context[i];
-        laik_log_append("  transition %d: ", 0);
+        laik_log_append("  transition %d: ", i);
         laik_log_Transition(tc->transition, false);
         laik_log_append(" on data '%s'\n", tc->data->name);
     }
-    assert(as->contextCount == 1);
     if (!showDetails) return;
 
     for(int i = 0; i < as->bufferCount; i++) {
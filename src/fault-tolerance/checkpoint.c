@@ -290,6 +290,8 @@ void laik_checkpoint_remove_redundant_slices(Laik_Checkpoint *checkpoint) {
     Laik_Partitioning *backupPartitioning = checkpoint->data->activePartitioning;
 
     assert(backupPartitioning->saList->next == NULL && backupPartitioning->saList->info == LAIK_AI_FULL);
+    // slices get modified: must not be shared with other partitionings
+    backupPartitioning->saList->slices = laik_slicearray_unshare(backupPartitioning->saList->slices);
     Laik_SliceArray *sliceArray = backupPartitioning->saList->slices;
     for (unsigned int oldIndex = 0; oldIndex < sliceArray->count; ++oldIndex) {
         for (unsigned int newIndex = 0; newIndex < oldIndex; ++newIndex) {
@@ -306,6 +308,8 @@ bool laik_checkpoint_remove_failed_slices(Laik_Checkpoint *checkpoint, Laik_Grou
     assert(backupPartitioning->saList->next == NULL && backupPartitioning->saList->info == LAIK_AI_FULL);
 
     assert(backupPartitioning->group->gid == checkGroup->gid);
+    // slices get modified: must not be shared with other partitionings
+    backupPartitioning->saList->slices = laik_slicearray_unshare(backupPartitioning->saList->slices);
     Laik_SliceArray *sliceArray = backupPartitioning->saList->slices;
     for (unsigned int oldIndex = 0; oldIndex < sliceArray->count; ++oldIndex) {
         Laik_TaskSlice_Gen *taskSlice = &sliceArray->tslice[oldIndex];
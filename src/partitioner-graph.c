@@ -0,0 +1,748 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2017, 2018 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "laik-internal.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-------------------------------------------------------------------
+// multilevel graph partitioner
+//
+// For 1d spaces whose indexes are vertices of a graph given in CSR format
+// (as used by METIS: neighbors of vertex i are adjncy[xadj[i]..xadj[i+1]-1]).
+// Edges are taken as undirected. Partitioning follows the multilevel
+// scheme:
+// - coarsening: repeatedly contract heavy-edge matchings, summing up
+//   vertex and edge weights, until the graph is small
+// - initial partitioning of the coarsest graph by recursive bisection,
+//   growing parts in breadth-first order from a peripheral vertex
+// - uncoarsening: project the partitioning back level by level, at each
+//   level refining it by greedily moving border vertices to the part
+//   they are most connected to (if this reduces the edge cut or fixes
+//   an imbalance)
+//
+// All steps are deterministic, as every task runs the partitioner.
+// The result is cached in the partitioner for further runs with same
+// task count (e.g. for distributed partitionings). Thus, the graph must
+// not be changed while the partitioner is in use.
+
+typedef struct _Laik_GraphPartitionerData {
+    int n;
+    const int* xadj;
+    const int* adjncy;
+    const double* vwgt; // optional
+
+    // cached result of last run
+    int parts;
+    int* part;
+} Laik_GraphPartitionerData;
+
+// graph at one level
+typedef struct _GGraph GGraph;
+struct _GGraph {
+    int n;
+    int* xadj;
+    int* adj;
+    int* ew;      // edge weights
+    double* vw;   // vertex weights
+    int* cmap;    // mapping to vertex in next coarser graph
+    GGraph* coarser;
+};
+
+// maximal allowed imbalance of parts
+#define GP_IMBALANCE 0.03
+// stop coarsening at <GP_COARSEN_PER_PART> vertices per part
+// (at least <GP_COARSEN_MIN>)
+#define GP_COARSEN_PER_PART 20
+#define GP_COARSEN_MIN 100
+// number of initial partitionings tried (starting from different vertices)
+#define GP_INIT_TRIALS 4
+// maximal number of refinement passes per level
+#define GP_REFINE_PASSES 8
+// moves without improvement before stopping a refinement pass
+#define GP_REFINE_CLIMB 50
+
+static void* gpAlloc(size_t size)
+{
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        laik_panic("Out of memory in graph partitioner");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    return p;
+}
+
+static void* gpCalloc(size_t count, size_t size)
+{
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        laik_panic("Out of memory in graph partitioner");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    return p;
+}
+
+static void gpFree(GGraph* g)
+{
+    while(g) {
+        GGraph* c = g->coarser;
+        free(g->xadj);
+        free(g->adj);
+        free(g->ew);
+        free(g->vw);
+        free(g->cmap);
+        free(g);
+        g = c;
+    }
+}
+
+// build symmetric graph without self loops and duplicate edges from input
+static GGraph* gpBuildGraph(Laik_GraphPartitionerData* data)
+{
+    int n = data->n;
+    GGraph* g = gpAlloc(sizeof(GGraph));
+    g->n = n;
+    g->coarser = 0;
+    g->cmap = 0;
+    g->vw = gpAlloc(n * sizeof(double));
+    for(int i = 0; i < n; i++)
+        g->vw[i] = data->vwgt ? data->vwgt[i] : 1.0;
+
+    // count edges in both directions
+    int* deg = gpCalloc(n + 1, sizeof(int));
+    for(int i = 0; i < n; i++) {
+        for(int o = data->xadj[i]; o < data->xadj[i+1]; o++) {
+            int j = data->adjncy[o];
+            assert((j >= 0) && (j < n));
+            if (j == i) continue;
+            deg[i]++;
+            deg[j]++;
+        }
+    }
+    int* xadj = gpAlloc((n + 1) * sizeof(int));
+    xadj[0] = 0;
+    for(int i = 0; i < n; i++)
+        xadj[i+1] = xadj[i] + deg[i];
+    int* adj = gpAlloc(xadj[n] * sizeof(int));
+    memset(deg, 0, n * sizeof(int));
+    for(int i = 0; i < n; i++) {
+        for(int o = data->xadj[i]; o < data->xadj[i+1]; o++) {
+            int j = data->adjncy[o];
+            if (j == i) continue;
+            adj[xadj[i] + deg[i]++] = j;
+            adj[xadj[j] + deg[j]++] = i;
+        }
+    }
+
+    // merge duplicate edges, summing up weights
+    int* pos = deg; // reuse: position of neighbor in merged row, or -1
+    for(int i = 0; i < n; i++) pos[i] = -1;
+    g->xadj = gpAlloc((n + 1) * sizeof(int));
+    g->adj = gpAlloc(xadj[n] * sizeof(int));
+    g->ew = gpAlloc(xadj[n] * sizeof(int));
+    int e = 0;
+    for(int i = 0; i < n; i++) {
+        g->xadj[i] = e;
+        for(int o = xadj[i]; o < xadj[i+1]; o++) {
+            int j = adj[o];
+            if (pos[j] >= g->xadj[i])
+                g->ew[pos[j]]++;
+            else {
+                pos[j] = e;
+                g->adj[e] = j;
+                g->ew[e] = 1;
+                e++;
+            }
+        }
+    }
+    g->xadj[n] = e;
+
+    free(deg);
+    free(xadj);
+    free(adj);
+    return g;
+}
+
+// contract heavy-edge matching of <g> into new coarser graph
+static GGraph* gpCoarsen(GGraph* g, double maxVW)
+{
+    int n = g->n;
+    int* match = gpAlloc(n * sizeof(int));
+    for(int i = 0; i < n; i++) match[i] = -1;
+    g->cmap = gpAlloc(n * sizeof(int));
+
+    // visit vertices in a fixed pseudo-random order to avoid bias
+    // (stride coprime to n)
+    int stride = 1;
+    if (n > 2) {
+        stride = (int) (n * 0.618) | 1;
+        int a = n, b = stride;
+        while(b) { int t = a % b; a = b; b = t; }
+        if (a != 1) stride = 1;
+    }
+    int cn = 0;
+    for(int k = 0, u = 0; k < n; k++, u = (int) (((int64_t) u + stride) % n)) {
+        if (match[u] >= 0) continue;
+        int best = u, bestW = 0;
+        for(int o = g->xadj[u]; o < g->xadj[u+1]; o++) {
+            int v = g->adj[o];
+            if (match[v] >= 0) continue;
+            if (g->vw[u] + g->vw[v] > maxVW) continue;
+            if (g->ew[o] > bestW) {
+                best = v;
+                bestW = g->ew[o];
+            }
+        }
+        match[u] = best;
+        match[best] = u;
+        g->cmap[u] = cn;
+        g->cmap[best] = cn;
+        cn++;
+    }
+
+    GGraph* c = gpAlloc(sizeof(GGraph));
+    c->n = cn;
+    c->coarser = 0;
+    c->cmap = 0;
+    c->vw = gpCalloc(cn, sizeof(double));
+    for(int u = 0; u < n; u++)
+        c->vw[g->cmap[u]] += g->vw[u];
+
+    // coarse edges: neighbors of both matched vertices, merged
+    int* pos = gpAlloc(cn * sizeof(int));
+    for(int i = 0; i < cn; i++) pos[i] = -1;
+    c->xadj = gpAlloc((cn + 1) * sizeof(int));
+    c->adj = gpAlloc(g->xadj[n] * sizeof(int));
+    c->ew = gpAlloc(g->xadj[n] * sizeof(int));
+    int e = 0;
+    int ci = 0;
+    // coarse vertices are numbered in order of first matched vertex
+    for(int k = 0, u = 0; k < n; k++, u = (int) (((int64_t) u + stride) % n)) {
+        if (g->cmap[u] != ci) continue;
+        c->xadj[ci] = e;
+        int v = match[u];
+        for(int m = 0; m < ((v == u) ? 1 : 2); m++) {
+            int w = (m == 0) ? u : v;
+            for(int o = g->xadj[w]; o < g->xadj[w+1]; o++) {
+                int cj = g->cmap[g->adj[o]];
+                if (cj == ci) continue;
+                if (pos[cj] >= c->xadj[ci])
+                    c->ew[pos[cj]] += g->ew[o];
+                else {
+                    pos[cj] = e;
+                    c->adj[e] = cj;
+                    c->ew[e] = g->ew[o];
+                    e++;
+                }
+            }
+        }
+        ci++;
+    }
+    assert(ci == cn);
+    c->xadj[cn] = e;
+
+    free(pos);
+    free(match);
+    return c;
+}
+
+// initial partitioning: recursively bisect vertices in <list> (<count>
+// entries) into parts [fromPart;toPart[. A region is grown from a
+// peripheral vertex, always adding the border vertex with highest gain
+// (edge weight into the region minus edge weight to other vertices).
+// <start> selects the vertex to search the peripheral vertex from.
+// <mark>, <conn>, <queue> are temporary arrays of size n, with <mark>
+// and <conn> expected to be zero
+static void gpBisect(GGraph* g, int* list, int count, int fromPart, int toPart,
+                     int start, int* part, int* mark, int* conn, int* queue)
+{
+    if (count == 0) return;
+    if (toPart - fromPart == 1) {
+        for(int i = 0; i < count; i++)
+            part[list[i]] = fromPart;
+        return;
+    }
+
+    // mark vertices of this subset: 1 unassigned, 2 border, 3 in region
+    double total = 0.0;
+    for(int i = 0; i < count; i++) {
+        mark[list[i]] = 1;
+        total += g->vw[list[i]];
+    }
+    int midPart = (fromPart + toPart) / 2;
+    double target = total * (midPart - fromPart) / (toPart - fromPart);
+
+    // find peripheral vertex: last one reached by BFS
+    int seed = list[start % count];
+    int qh = 0, qt = 0;
+    queue[qt++] = seed;
+    mark[seed] = 3;
+    while(qh < qt) {
+        int u = queue[qh++];
+        seed = u;
+        for(int o = g->xadj[u]; o < g->xadj[u+1]; o++) {
+            int v = g->adj[o];
+            if (mark[v] != 1) continue;
+            mark[v] = 3;
+            queue[qt++] = v;
+        }
+    }
+    for(int i = 0; i < qt; i++) mark[queue[i]] = 1;
+
+    // grow region, <queue> holds border vertices.
+    // Restart in unconnected components if border gets empty
+    double w = 0.0;
+    int next = 0; // next candidate in <list> for restart
+    int bcount = 0;
+    while(w < target) {
+        int u = -1;
+        if (bcount == 0) {
+            if (seed < 0) {
+                while((next < count) && (mark[list[next]] != 1)) next++;
+                if (next == count) break;
+                seed = list[next];
+            }
+            u = seed;
+            seed = -1;
+        }
+        else {
+            int best = 0, bestGain = 0;
+            for(int i = 0; i < bcount; i++) {
+                int v = queue[i];
+                int gain = 2 * conn[v];
+                for(int o = g->xadj[v]; o < g->xadj[v+1]; o++)
+                    gain -= g->ew[o];
+                if ((i == 0) || (gain > bestGain)) {
+                    best = i;
+                    bestGain = gain;
+                }
+            }
+            u = queue[best];
+            queue[best] = queue[--bcount];
+        }
+        if ((w > 0.0) && (w + g->vw[u] / 2 > target)) break;
+
+        mark[u] = 3;
+        conn[u] = 0;
+        w += g->vw[u];
+        for(int o = g->xadj[u]; o < g->xadj[u+1]; o++) {
+            int v = g->adj[o];
+            if (mark[v] == 1) {
+                mark[v] = 2;
+                queue[bcount++] = v;
+            }
+            if (mark[v] == 2) conn[v] += g->ew[o];
+        }
+    }
+
+    // split list: grown region first (stable), then rest
+    int c1 = 0;
+    int* tmp = gpAlloc(count * sizeof(int));
+    int c2 = 0;
+    for(int i = 0; i < count; i++) {
+        int u = list[i];
+        if (mark[u] == 3) list[c1++] = u;
+        else tmp[c2++] = u;
+        mark[u] = 0;
+        conn[u] = 0;
+    }
+    memcpy(list + c1, tmp, c2 * sizeof(int));
+    free(tmp);
+
+    gpBisect(g, list, c1, fromPart, midPart, start, part, mark, conn, queue);
+    gpBisect(g, list + c1, c2, midPart, toPart, start, part, mark, conn, queue);
+}
+
+// edge cut of partitioning <part> of <g>
+static int64_t gpEdgeCut(GGraph* g, int* part)
+{
+    int64_t cut = 0;
+    for(int u = 0; u < g->n; u++)
+        for(int o = g->xadj[u]; o < g->xadj[u+1]; o++)
+            if (part[g->adj[o]] != part[u]) cut += g->ew[o];
+    return cut / 2;
+}
+
+// state for refinement of a partitioning
+typedef struct _GPRefine {
+    GGraph* g;
+    int parts;
+    int* part;
+    double* pw;      // weight per part
+    double maxPW;    // maximal allowed part weight
+    int* conn;       // temporary: connectivity per part
+    int* touched;    // temporary: parts with conn != 0
+
+    // max-heap of move candidates (gain, vertex), lazily updated
+    int* hGain;
+    int* hVertex;
+    int hCount, hSize;
+} GPRefine;
+
+// best move of vertex <u> to another part allowed by balance constraint.
+// Returns target part (-1 if none) and sets <gain> (reduction of cut)
+static int gpBestMove(GPRefine* rs, int u, int* gain)
+{
+    GGraph* g = rs->g;
+    int from = rs->part[u];
+    int tcount = 0;
+    for(int o = g->xadj[u]; o < g->xadj[u+1]; o++) {
+        int q = rs->part[g->adj[o]];
+        if (rs->conn[q] == 0) rs->touched[tcount++] = q;
+        rs->conn[q] += g->ew[o];
+    }
+
+    int best = -1;
+    if (rs->pw[from] > g->vw[u]) { // do not make a part empty
+        for(int i = 0; i < tcount; i++) {
+            int q = rs->touched[i];
+            if (q == from) continue;
+            if (rs->pw[q] + g->vw[u] > rs->maxPW) continue;
+            if ((best < 0) || (rs->conn[q] > rs->conn[best]) ||
+                ((rs->conn[q] == rs->conn[best]) && (rs->pw[q] < rs->pw[best])))
+                best = q;
+        }
+    }
+    if (best >= 0)
+        *gain = rs->conn[best] - rs->conn[from];
+
+    for(int i = 0; i < tcount; i++)
+        rs->conn[rs->touched[i]] = 0;
+    return best;
+}
+
+static void gpHeapPush(GPRefine* rs, int gain, int u)
+{
+    if (rs->hCount == rs->hSize) {
+        rs->hSize = (rs->hSize + 20) * 2;
+        rs->hGain = realloc(rs->hGain, rs->hSize * sizeof(int));
+        rs->hVertex = realloc(rs->hVertex, rs->hSize * sizeof(int));
+        if (!rs->hGain || !rs->hVertex) {
+            laik_panic("Out of memory in graph partitioner");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+    }
+    int i = rs->hCount++;
+    while(i > 0) {
+        int pi = (i - 1) / 2;
+        if (rs->hGain[pi] >= gain) break;
+        rs->hGain[i] = rs->hGain[pi];
+        rs->hVertex[i] = rs->hVertex[pi];
+        i = pi;
+    }
+    rs->hGain[i] = gain;
+    rs->hVertex[i] = u;
+}
+
+static void gpHeapPop(GPRefine* rs, int* gain, int* u)
+{
+    *gain = rs->hGain[0];
+    *u = rs->hVertex[0];
+    int lg = rs->hGain[--rs->hCount];
+    int lv = rs->hVertex[rs->hCount];
+    int i = 0;
+    while(1) {
+        int ci = 2 * i + 1;
+        if (ci >= rs->hCount) break;
+        if ((ci + 1 < rs->hCount) && (rs->hGain[ci + 1] > rs->hGain[ci])) ci++;
+        if (rs->hGain[ci] <= lg) break;
+        rs->hGain[i] = rs->hGain[ci];
+        rs->hVertex[i] = rs->hVertex[ci];
+        i = ci;
+    }
+    rs->hGain[i] = lg;
+    rs->hVertex[i] = lv;
+}
+
+static void gpMove(GPRefine* rs, int u, int to)
+{
+    int from = rs->part[u];
+    rs->pw[from] -= rs->g->vw[u];
+    rs->pw[to] += rs->g->vw[u];
+    rs->part[u] = to;
+}
+
+// k-way refinement of partitioning <part> of <g>.
+// First, parts exceeding the balance constraint give away vertices.
+// Then, passes similar to Fiduccia-Mattheyses are done: border vertices
+// are moved to the part giving highest gain (also negative, to escape
+// local minima), each vertex at most once per pass. Afterwards,
+// moves after reaching the smallest cut are undone.
+static void gpRefine(GGraph* g, int parts, int* part)
+{
+    int n = g->n;
+    GPRefine rs;
+    rs.g = g;
+    rs.parts = parts;
+    rs.part = part;
+    rs.pw = gpCalloc(parts, sizeof(double));
+    rs.conn = gpCalloc(parts, sizeof(int));
+    rs.touched = gpAlloc(parts * sizeof(int));
+    rs.hGain = 0;
+    rs.hVertex = 0;
+    rs.hCount = 0;
+    rs.hSize = 0;
+
+    // allow one heaviest vertex of imbalance: coarse levels otherwise
+    // need many moves just to get balanced
+    double total = 0.0, maxVW = 0.0;
+    for(int u = 0; u < n; u++) {
+        rs.pw[part[u]] += g->vw[u];
+        total += g->vw[u];
+        if (g->vw[u] > maxVW) maxVW = g->vw[u];
+    }
+    rs.maxPW = (1.0 + GP_IMBALANCE) * total / parts;
+    if (maxVW > 1.0) rs.maxPW += maxVW;
+
+    // balancing: move vertices out of overweight parts
+    for(int u = 0; u < n; u++) {
+        int gain;
+        if (rs.pw[part[u]] <= rs.maxPW) continue;
+        int to = gpBestMove(&rs, u, &gain);
+        if (to >= 0) gpMove(&rs, u, to);
+    }
+
+    int* locked = gpCalloc(n, sizeof(int));
+    int* movedV = gpAlloc(n * sizeof(int));
+    int* movedFrom = gpAlloc(n * sizeof(int));
+    for(int pass = 1; pass <= GP_REFINE_PASSES; pass++) {
+        rs.hCount = 0;
+        for(int u = 0; u < n; u++) {
+            int gain;
+            for(int o = g->xadj[u]; o < g->xadj[u+1]; o++) {
+                if (part[g->adj[o]] == part[u]) continue;
+                if (gpBestMove(&rs, u, &gain) >= 0)
+                    gpHeapPush(&rs, gain, u);
+                break;
+            }
+        }
+
+        int64_t delta = 0, bestDelta = 0;
+        int moves = 0, bestMoves = 0;
+        while(rs.hCount > 0) {
+            int gain, gain2, u;
+            gpHeapPop(&rs, &gain, &u);
+            if (locked[u] == pass) continue;
+            int to = gpBestMove(&rs, u, &gain2);
+            if (to < 0) continue;
+            if (gain2 != gain) {
+                // outdated entry
+                gpHeapPush(&rs, gain2, u);
+                continue;
+            }
+
+            locked[u] = pass;
+            movedV[moves] = u;
+            movedFrom[moves] = part[u];
+            moves++;
+            gpMove(&rs, u, to);
+            delta -= gain;
+            if (delta < bestDelta) {
+                bestDelta = delta;
+                bestMoves = moves;
+            }
+            else if (moves - bestMoves > GP_REFINE_CLIMB) break;
+
+            for(int o = g->xadj[u]; o < g->xadj[u+1]; o++) {
+                int v = g->adj[o];
+                if (locked[v] == pass) continue;
+                if (gpBestMove(&rs, v, &gain2) >= 0)
+                    gpHeapPush(&rs, gain2, v);
+            }
+        }
+
+        // undo moves after smallest cut was reached
+        while(moves > bestMoves) {
+            moves--;
+            gpMove(&rs, movedV[moves], movedFrom[moves]);
+        }
+        if (bestDelta == 0) break;
+    }
+
+    free(locked);
+    free(movedV);
+    free(movedFrom);
+    free(rs.hGain);
+    free(rs.hVertex);
+    free(rs.pw);
+    free(rs.conn);
+    free(rs.touched);
+}
+
+// run multilevel partitioning into <parts> parts, result in data->part
+static void gpPartition(Laik_GraphPartitionerData* data, int parts)
+{
+    GGraph* g = gpBuildGraph(data);
+    double total = 0.0;
+    for(int i = 0; i < g->n; i++)
+        total += g->vw[i];
+
+    // coarsening
+    int levels = 1;
+    GGraph* c = g;
+    int limit = GP_COARSEN_PER_PART * parts;
+    if (limit < GP_COARSEN_MIN) limit = GP_COARSEN_MIN;
+    while(c->n > limit) {
+        GGraph* cc = gpCoarsen(c, 1.5 * total / limit);
+        c->coarser = cc;
+        levels++;
+        if (cc->n > 0.95 * c->n) {
+            c = cc;
+            break;
+        }
+        c = cc;
+    }
+
+    // initial partitioning of coarsest graph: use best of multiple trials
+    int* part = gpAlloc(c->n * sizeof(int));
+    int* tpart = gpAlloc(c->n * sizeof(int));
+    int* list = gpAlloc(c->n * sizeof(int));
+    int* mark = gpCalloc(c->n, sizeof(int));
+    int* conn = gpCalloc(c->n, sizeof(int));
+    int* queue = gpAlloc(c->n * sizeof(int));
+    int64_t bestCut = -1;
+    for(int t = 0; t < GP_INIT_TRIALS; t++) {
+        for(int i = 0; i < c->n; i++) list[i] = i;
+        int start = (int) ((int64_t) c->n * t / GP_INIT_TRIALS);
+        gpBisect(c, list, c->n, 0, parts, start, tpart, mark, conn, queue);
+        gpRefine(c, parts, tpart);
+        int64_t cut = gpEdgeCut(c, tpart);
+        if ((bestCut < 0) || (cut < bestCut)) {
+            bestCut = cut;
+            int* tmp = part; part = tpart; tpart = tmp;
+        }
+    }
+    free(tpart);
+    free(list);
+    free(mark);
+    free(conn);
+    free(queue);
+
+    // uncoarsening with refinement
+    for(int l = levels - 2; l >= 0; l--) {
+        GGraph* f = g;
+        for(int i = 0; i < l; i++) f = f->coarser;
+        int* fpart = gpAlloc(f->n * sizeof(int));
+        for(int u = 0; u < f->n; u++)
+            fpart[u] = part[f->cmap[u]];
+        free(part);
+        part = fpart;
+        gpRefine(f, parts, part);
+    }
+
+    laik_log(1, "graph partitioner: %d vertices, %d levels, %d parts, edge cut %lld",
+             g->n, levels, parts, (long long) gpEdgeCut(g, part));
+
+    gpFree(g);
+    free(data->part);
+    data->part = part;
+    data->parts = parts;
+}
+
+void runGraphPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
+{
+    Laik_GraphPartitionerData* data;
+    data = (Laik_GraphPartitionerData*) p->partitioner->data;
+    assert(data);
+    assert(p->space->dims == 1);
+    assert(p->space->s.from.i[0] == 0);
+    assert(p->space->s.to.i[0] == data->n);
+
+    int parts = p->group->size;
+    if ((data->part == 0) || (data->parts != parts))
+        gpPartition(data, parts);
+
+    for(int i = 0; i < data->n; i++)
+        laik_append_index_1d(r, data->part[i], i);
+}
+
+Laik_Partitioner* laik_new_graph_partitioner(int n, const int* xadj,
+                                             const int* adjncy,
+                                             const double* vwgt)
+{
+    Laik_GraphPartitionerData* data;
+    data = malloc(sizeof(Laik_GraphPartitionerData));
+    if (!data) {
+        laik_panic("Out of memory allocating Laik_GraphPartitionerData object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    data->n = n;
+    data->xadj = xadj;
+    data->adjncy = adjncy;
+    data->vwgt = vwgt;
+    data->parts = 0;
+    data->part = 0;
+
+    return laik_new_partitioner("graph", runGraphPartitioner, data,
+                                LAIK_PF_Merge);
+}
+
+
+//-------------------------------------------------------------------
+// graph halo partitioner: vertices of base partitioning plus neighbors
+// (in direction given by CSR arrays), e.g. to read input values of rows
+// in SpMV or incoming states in a Markov chain
+
+void runGraphHaloPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
+{
+    Laik_GraphPartitionerData* data;
+    data = (Laik_GraphPartitionerData*) p->partitioner->data;
+    assert(data);
+    assert(p->other != 0);
+    assert(p->other->group == p->group);
+    assert(p->space->dims == 1);
+
+    // neighbors may be anywhere: filtered runs need all base slices
+    int64_t size = p->space->s.to.i[0] - p->space->s.from.i[0];
+    Laik_SliceArray* sa = laik_slicereceiver_otherslices(r, size);
+    int count = laik_slicearray_slicecount(sa);
+    for(int i = 0; i < count; i++) {
+        Laik_TaskSlice* ts = laik_slicearray_tslice(sa, i);
+        const Laik_Slice* s = laik_taskslice_get_slice(ts);
+        int task = laik_taskslice_get_task(ts);
+        for(int64_t v = s->from.i[0]; v < s->to.i[0]; v++) {
+            laik_append_index_1d(r, task, v);
+            for(int o = data->xadj[v]; o < data->xadj[v+1]; o++)
+                laik_append_index_1d(r, task, data->adjncy[o]);
+        }
+    }
+}
+
+Laik_Partitioner* laik_new_graph_halo_partitioner(int n, const int* xadj,
+                                                  const int* adjncy)
+{
+    Laik_GraphPartitionerData* data;
+    data = malloc(sizeof(Laik_GraphPartitionerData));
+    if (!data) {
+        laik_panic("Out of memory allocating Laik_GraphPartitionerData object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    data->n = n;
+    data->xadj = xadj;
+    data->adjncy = adjncy;
+    data->vwgt = 0;
+    data->parts = 0;
+    data->part = 0;
+
+    return laik_new_partitioner("graph-halo", runGraphHaloPartitioner, data,
+                                LAIK_PF_Merge);
+}
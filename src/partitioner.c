@@ -71,11 +71,17 @@ Laik_SliceArray* laik_run_partitioner(Laik_PartitionerParams* params,
     r.params = params;
     r.array = array;
     r.filter = filter;
+    r.otherSA = 0;
 
     Laik_Partitioner* pr = params->partitioner;
 
     (pr->run)(&r, params);
 
+    if (r.otherSA) {
+        laik_slicearray_free(r.otherSA);
+        free(r.otherSA);
+    }
+
     bool doMerge = (pr->flags & LAIK_PF_Merge) > 0;
     laik_slicearray_freeze(array, doMerge);
 
@@ -97,8 +103,17 @@ Laik_SliceArray* laik_run_partitioner(Laik_PartitionerParams* params,
     if (pr) doCoverageCheck = (pr->flags & LAIK_PF_NoFullCoverage) == 0;
     if (filter) doCoverageCheck = false;
     if (doCoverageCheck) {
-        if (!laik_slicearray_coversSpace(array))
+        int overlap[2];
+        if (!laik_slicearray_checkCoverage(array, overlap))
             laik_log(LAIK_LL_Panic, "slice array does not cover space");
+
+        // overlapping slices are fine (e.g. halos), but worth to know
+        if (overlap[0] >= 0) {
+            Laik_TaskSlice_Gen* ts1 = &(array->tslice[overlap[0]]);
+            Laik_TaskSlice_Gen* ts2 = &(array->tslice[overlap[1]]);
+            laik_log(1, "partitioner '%s': slices %d (task %d) and %d (task %d) overlap",
+                     pr->name, overlap[0], ts1->task, overlap[1], ts2->task);
+        }
     }
 
     return array;
@@ -143,6 +158,51 @@ void laik_append_index_1d(Laik_SliceReceiver* r, int task, int64_t idx)
     laik_slicearray_append_single1d(r->array, task, idx);
 }
 
+// partitioner API: may a slice for tasks in [fromTask;toTask[ within
+// <s> be stored? If not, the partitioner can skip this region.
+// Used to only enumerate relevant regions in filtered runs
+bool laik_slicereceiver_wants(Laik_SliceReceiver* r,
+                              int fromTask, int toTask, const Laik_Slice* s)
+{
+    return laik_slicefilter_wants(r->filter, fromTask, toTask, s);
+}
+
+// partitioner API: slices of the base partitioning relevant for this run.
+// For partitioners deriving slices from the base partitioning, with
+// derived slices extending base slices by at most <reach> indexes.
+// Without filter, these are all slices of the base partitioning. Otherwise,
+// if the base partitioning is distributed, only slices required for
+// this run are calculated (valid until end of partitioner run)
+Laik_SliceArray* laik_slicereceiver_otherslices(Laik_SliceReceiver* r,
+                                                int64_t reach)
+{
+    Laik_Partitioning* other = r->params->other;
+    assert(other != 0);
+
+    Laik_SliceArray* sa = laik_partitioning_allslices(other);
+    if (sa) return sa;
+
+    if (r->filter == 0) {
+        laik_panic("All slices of distributed base partitioning requested");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    // the filter is given in indexes of our space
+    assert(other->space == r->params->space);
+
+    if (r->otherSA == 0) {
+        Laik_PartitionerParams params;
+        params.space       = other->space;
+        params.group       = other->group;
+        params.partitioner = other->partitioner;
+        params.other       = other->other;
+
+        Laik_SliceFilter* sf = laik_slicefilter_extend(r->filter, reach);
+        r->otherSA = laik_run_partitioner(&params, sf);
+        laik_slicefilter_free(sf);
+    }
+    return r->otherSA;
+}
+
 
 
 
@@ -263,9 +323,10 @@ void runCornerHaloPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
     int d = *((int*) p->partitioner->data);
 
     // take all slices and extend them if possible
-    int count = laik_partitioning_slicecount(other);
+    Laik_SliceArray* sa = laik_slicereceiver_otherslices(r, d);
+    int count = laik_slicearray_slicecount(sa);
     for(int i = 0; i < count; i++) {
-        Laik_TaskSlice* ts = laik_partitioning_get_tslice(other, i);
+        Laik_TaskSlice* ts = laik_slicearray_tslice(sa, i);
         const Laik_Slice* s = laik_taskslice_get_slice(ts);
         const Laik_Index* from = &(s->from);
         const Laik_Index* to = &(s->to);
@@ -322,9 +383,10 @@ void runHaloPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
     Laik_Slice sp = p->space->s;
 
     // take all slices and extend them if possible
-    int count = laik_partitioning_slicecount(other);
+    Laik_SliceArray* sa = laik_slicereceiver_otherslices(r, depth);
+    int count = laik_slicearray_slicecount(sa);
     for(int i = 0; i < count; i++) {
-        Laik_TaskSlice* ts = laik_partitioning_get_tslice(other, i);
+        Laik_TaskSlice* ts = laik_slicearray_tslice(sa, i);
         const Laik_Slice* s = laik_taskslice_get_slice(ts);
         int task = laik_taskslice_get_task(ts);
         int tag = laik_taskslice_get_tag(ts);
@@ -387,6 +449,119 @@ Laik_Partitioner* laik_new_halo_partitioner(int depth)
 }
 
 
+// stencil partitioner: extend borders of another partitioning according
+// to a stencil shape, with separate depths per dimension towards lower
+// and higher indexes. Without corners, only the faces of each slice are
+// extended (5-point 2d / 7-point 3d stencil), otherwise the full box.
+// All halos of a slice go into the same mapping as the slice itself.
+// For this, tags of original slices are kept; slices with tag 0 each get
+// an own mapping (with tags numbered above the largest tag of the task).
+// Halos must not overlap other slices of the same task.
+
+typedef struct _Laik_StencilPartitionerData {
+    int dims;
+    int lo[3], hi[3];
+    bool corners;
+} Laik_StencilPartitionerData;
+
+void runStencilPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
+{
+    Laik_Partitioning* other = p->other;
+    assert(other->group == p->group); // must use same task group
+    assert(other->space == p->space);
+
+    Laik_StencilPartitionerData* data;
+    data = (Laik_StencilPartitionerData*) p->partitioner->data;
+    int dims = p->space->dims;
+    assert(data->dims == dims);
+    Laik_Slice sp = p->space->s;
+
+    int reach = 0;
+    for(int d = 0; d < dims; d++) {
+        if (data->lo[d] > reach) reach = data->lo[d];
+        if (data->hi[d] > reach) reach = data->hi[d];
+    }
+
+    Laik_SliceArray* sa = laik_slicereceiver_otherslices(r, reach);
+    int count = laik_slicearray_slicecount(sa);
+    int lastTask = -1, maxTag = 0;
+    for(int i = 0; i < count; i++) {
+        Laik_TaskSlice* ts = laik_slicearray_tslice(sa, i);
+        const Laik_Slice* s = laik_taskslice_get_slice(ts);
+        int task = laik_taskslice_get_task(ts);
+        int tag = laik_taskslice_get_tag(ts);
+
+        // slices of a task are sorted, position is same on all processes.
+        // Synthetic tags start above the largest tag of the task
+        if (task != lastTask) {
+            lastTask = task;
+            maxTag = 0;
+            for(int j = i; j < count; j++) {
+                Laik_TaskSlice* ts2 = laik_slicearray_tslice(sa, j);
+                if (laik_taskslice_get_task(ts2) != task) break;
+                int tag2 = laik_taskslice_get_tag(ts2);
+                if (tag2 > maxTag) maxTag = tag2;
+            }
+        }
+        if (tag == 0) tag = ++maxTag;
+
+        Laik_Slice slc = *s;
+        if (data->corners) {
+            for(int d = 0; d < dims; d++) {
+                slc.from.i[d] -= data->lo[d];
+                if (slc.from.i[d] < sp.from.i[d]) slc.from.i[d] = sp.from.i[d];
+                slc.to.i[d] += data->hi[d];
+                if (slc.to.i[d] > sp.to.i[d]) slc.to.i[d] = sp.to.i[d];
+            }
+            laik_append_slice(r, task, &slc, tag, 0);
+            continue;
+        }
+
+        laik_append_slice(r, task, &slc, tag, 0);
+        for(int d = 0; d < dims; d++) {
+            slc = *s;
+            if ((data->lo[d] > 0) && (s->from.i[d] > sp.from.i[d])) {
+                slc.to.i[d] = s->from.i[d];
+                slc.from.i[d] = s->from.i[d] - data->lo[d];
+                if (slc.from.i[d] < sp.from.i[d]) slc.from.i[d] = sp.from.i[d];
+                laik_append_slice(r, task, &slc, tag, 0);
+            }
+            slc = *s;
+            if ((data->hi[d] > 0) && (s->to.i[d] < sp.to.i[d])) {
+                slc.from.i[d] = s->to.i[d];
+                slc.to.i[d] = s->to.i[d] + data->hi[d];
+                if (slc.to.i[d] > sp.to.i[d]) slc.to.i[d] = sp.to.i[d];
+                laik_append_slice(r, task, &slc, tag, 0);
+            }
+        }
+    }
+}
+
+Laik_Partitioner* laik_new_stencil_partitioner(int dims, const int* lo,
+                                               const int* hi, bool corners)
+{
+    assert((dims >= 1) && (dims <= 3));
+    assert(lo != 0);
+
+    Laik_StencilPartitionerData* data;
+    data = malloc(sizeof(Laik_StencilPartitionerData));
+    if (!data) {
+        laik_panic("Out of memory allocating Laik_StencilPartitionerData");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    data->dims = dims;
+    for(int d = 0; d < 3; d++) {
+        data->lo[d] = (d < dims) ? lo[d] : 0;
+        data->hi[d] = (d < dims) ? (hi ? hi[d] : lo[d]) : 0;
+        assert((data->lo[d] >= 0) && (data->hi[d] >= 0));
+    }
+    data->corners = corners;
+
+    return laik_new_partitioner("stencil", runStencilPartitioner, data, 0);
+}
+
+
 // bisection partitioner
 
 // recursive helper: distribute slice <s> to tasks in range [fromTask;toTask[
@@ -396,6 +571,9 @@ static void doBisection(Laik_SliceReceiver* r, Laik_PartitionerParams* p,
     int tag = 1; // TODO: make it a parameter
 
     assert(toTask > fromTask);
+    // skip regions not relevant for filtered runs
+    if (!laik_slicereceiver_wants(r, fromTask, toTask, s)) return;
+
     if (toTask - fromTask == 1) {
         laik_append_slice(r, fromTask, s, tag, 0);
         return;
@@ -446,6 +624,461 @@ Laik_Partitioner* laik_new_bisection_partitioner()
 }
 
 
+//-------------------------------------------------------------------
+// weighted bisection partitioner
+//
+// Recursive coordinate bisection supporting index weights (cut positions
+// from prefix sums over weights of slabs orthogonal to the cut dimension)
+// and task weights (weight of a part is proportional to the weight sum of
+// its tasks). Instead of always halving the task range and cutting the
+// widest dimension, for each candidate task split and dimension the size
+// of the cut plus an estimation of the cuts needed further down is
+// compared, choosing the variant with smallest total halo surface.
+// This matters for task counts which are not a power of two.
+
+typedef struct _Laik_WBisectionPartitionerData {
+    Laik_GetIdxWeight_t getIdxW;
+    Laik_GetTaskWeight_t getTaskW;
+    const void* userData;
+} Laik_WBisectionPartitionerData;
+
+// estimated surface of cuts needed to split a box with side lengths <w>
+// into <k> parts of same size, using geometric bisection
+static double wbEstimate(int dims, const double* w, int k)
+{
+    if (k < 2) return 0.0;
+
+    int dim = 0;
+    for(int d = 1; d < dims; d++)
+        if (w[d] > w[dim]) dim = d;
+    double area = 1.0;
+    for(int d = 0; d < dims; d++)
+        if (d != dim) area *= w[d];
+
+    int k1 = k / 2;
+    double w1[3], w2[3];
+    for(int d = 0; d < dims; d++)
+        w1[d] = w2[d] = w[d];
+    w1[dim] = w[dim] * k1 / k;
+    w2[dim] = w[dim] - w1[dim];
+    return area + wbEstimate(dims, w1, k1) + wbEstimate(dims, w2, k - k1);
+}
+
+// recursive helper: distribute slice <s> to tasks in range [fromTask;toTask[
+// <taskW> has prefix sums of task weights
+static void doWBisection(Laik_SliceReceiver* r, Laik_PartitionerParams* p,
+                         Laik_Slice* s, int fromTask, int toTask,
+                         double* taskW)
+{
+    int tag = 1;
+    int dims = p->space->dims;
+    Laik_WBisectionPartitionerData* data;
+    data = (Laik_WBisectionPartitionerData*) p->partitioner->data;
+
+    assert(toTask > fromTask);
+    // skip regions not relevant for filtered runs
+    if (!laik_slicereceiver_wants(r, fromTask, toTask, s)) return;
+
+    uint64_t size = laik_slice_size(s);
+    if ((toTask - fromTask == 1) || (size == 1)) {
+        laik_append_slice(r, fromTask, s, tag, 0);
+        return;
+    }
+
+    // weights of slabs orthogonal to each dimension
+    int64_t width[3] = {1, 1, 1};
+    double* slabW[3] = {0, 0, 0};
+    for(int d = 0; d < dims; d++) {
+        width[d] = s->to.i[d] - s->from.i[d];
+        slabW[d] = malloc(width[d] * sizeof(double));
+        if (!slabW[d]) {
+            laik_panic("Out of memory in weighted bisection partitioner");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        for(int64_t i = 0; i < width[d]; i++)
+            slabW[d][i] = (double) size / width[d];
+    }
+    double weight = (double) size;
+    if (data->getIdxW) {
+        double* idxSlabW[3];
+        for(int d = 0; d < dims; d++) {
+            idxSlabW[d] = calloc(width[d], sizeof(double));
+            if (!idxSlabW[d]) {
+                laik_panic("Out of memory in weighted bisection partitioner");
+                exit(1); // not actually needed, laik_panic never returns
+            }
+        }
+        Laik_Index idx = s->from;
+        while(1) {
+            double w = (data->getIdxW)(&idx, data->userData);
+            for(int d = 0; d < dims; d++)
+                idxSlabW[d][idx.i[d] - s->from.i[d]] += w;
+            int d = 0;
+            while(d < dims) {
+                idx.i[d]++;
+                if (idx.i[d] < s->to.i[d]) break;
+                idx.i[d] = s->from.i[d];
+                d++;
+            }
+            if (d == dims) break;
+        }
+
+        // without any weight, fall back to uniform weights
+        double sum = 0.0;
+        for(int64_t i = 0; i < width[0]; i++)
+            sum += idxSlabW[0][i];
+        for(int d = 0; d < dims; d++) {
+            if (sum > 0.0) {
+                free(slabW[d]);
+                slabW[d] = idxSlabW[d];
+            }
+            else
+                free(idxSlabW[d]);
+        }
+        if (sum > 0.0) weight = sum;
+    }
+
+    // candidate task splits: halve, and for odd prime factors p of the
+    // task count, split at a multiple of count/p (e.g. 2:4 for 6 tasks)
+    int count = toTask - fromTask;
+    int splits[32], splitCount = 0;
+    splits[splitCount++] = count / 2;
+    int c = count;
+    for(int f = 3; (f <= c) && (splitCount < 32); f += 2) {
+        if (c % f) continue;
+        while((c % f) == 0) c /= f;
+        int k1 = count / f * (f / 2);
+        if (k1 != count / 2) splits[splitCount++] = k1;
+    }
+
+    // find cut with smallest estimated total surface
+    int bestDim = -1, bestMid = 0;
+    int64_t bestPos = 0;
+    double bestScore = 0.0;
+    for(int i = 0; i < splitCount; i++) {
+        int midTask = fromTask + splits[i];
+        double f = (taskW[midTask] - taskW[fromTask]) /
+                   (taskW[toTask] - taskW[fromTask]);
+        for(int d = 0; d < dims; d++) {
+            if (width[d] < 2) continue;
+
+            // cut position with prefix weight nearest to target
+            double target = f * weight;
+            double w1 = slabW[d][0];
+            int64_t pos = 1;
+            while((pos < width[d] - 1) &&
+                  (w1 + slabW[d][pos] / 2 < target)) {
+                w1 += slabW[d][pos];
+                pos++;
+            }
+
+            double area = 1.0, ws1[3], ws2[3];
+            for(int dd = 0; dd < dims; dd++) {
+                ws1[dd] = ws2[dd] = (double) width[dd];
+                if (dd != d) area *= (double) width[dd];
+            }
+            ws1[d] = (double) pos;
+            ws2[d] = (double) (width[d] - pos);
+            double score = area + wbEstimate(dims, ws1, splits[i]) +
+                           wbEstimate(dims, ws2, count - splits[i]);
+            if ((bestDim < 0) || (score < bestScore)) {
+                bestDim = d;
+                bestMid = midTask;
+                bestPos = pos;
+                bestScore = score;
+            }
+        }
+    }
+    for(int d = 0; d < dims; d++)
+        free(slabW[d]);
+    assert(bestDim >= 0);
+
+    Laik_Slice s1 = *s, s2 = *s;
+    s1.to.i[bestDim] = s->from.i[bestDim] + bestPos;
+    s2.from.i[bestDim] = s->from.i[bestDim] + bestPos;
+    doWBisection(r, p, &s1, fromTask, bestMid, taskW);
+    doWBisection(r, p, &s2, bestMid, toTask, taskW);
+}
+
+void runWBisectionPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
+{
+    Laik_WBisectionPartitionerData* data;
+    data = (Laik_WBisectionPartitionerData*) p->partitioner->data;
+    assert(data);
+
+    int count = p->group->size;
+    double* taskW = malloc((count + 1) * sizeof(double));
+    if (!taskW) {
+        laik_panic("Out of memory in weighted bisection partitioner");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    taskW[0] = 0.0;
+    for(int task = 0; task < count; task++)
+        taskW[task + 1] = taskW[task] +
+                          (data->getTaskW ? (data->getTaskW)(task, data->userData) : 1.0);
+
+    doWBisection(r, p, &(p->space->s), 0, count, taskW);
+    free(taskW);
+}
+
+Laik_Partitioner*
+laik_new_weighted_bisection_partitioner(Laik_GetIdxWeight_t ifunc,
+                                        Laik_GetTaskWeight_t tfunc,
+                                        const void* userData)
+{
+    Laik_WBisectionPartitionerData* data;
+    data = malloc(sizeof(Laik_WBisectionPartitionerData));
+    if (!data) {
+        laik_panic("Out of memory allocating Laik_WBisectionPartitionerData object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    data->getIdxW = ifunc;
+    data->getTaskW = tfunc;
+    data->userData = userData;
+
+    return laik_new_partitioner("wbisection", runWBisectionPartitioner, data, 0);
+}
+
+
+//-------------------------------------------------------------------
+// space-filling-curve partitioner
+//
+// Orders the indexes of a space along a Morton (Z-order) or Hilbert curve
+// and cuts the curve into chunks of similar weight, one per task.
+// The curve is traversed recursively on aligned power-of-2 blocks (a
+// quadtree/octree on a cube covering the space). Blocks completely
+// assigned to one task become one slice, so a task gets few rectangular
+// slices with locality given by the curve. Slices of a task share one tag,
+// resulting in one mapping per task.
+//
+// Without index weights, only blocks crossed by a chunk border are
+// refined. With weights, every index is visited (weights are queried
+// twice per index, as for the block partitioner).
+
+typedef struct _Laik_SFCPartitionerData {
+    Laik_SFCType type;
+    Laik_GetIdxWeight_t getIdxW;
+    const void* userData;
+} Laik_SFCPartitionerData;
+
+// state during one partitioner run
+typedef struct _SFCRun {
+    Laik_SliceReceiver* r;
+    Laik_SFCPartitionerData* data;
+    Laik_Slice* ss;  // space
+    int dims, bits, tasks;
+    double totalW;
+    double cum;      // weight of indexes already visited
+    int task;        // task of last visited index
+} SFCRun;
+
+// curve position of relative coordinates <c> using <bits> bits per dim
+static uint64_t sfcKey(Laik_SFCType type, int dims, int bits, const int64_t* c)
+{
+    uint64_t x[3];
+    for(int d = 0; d < dims; d++)
+        x[d] = (uint64_t) c[d];
+
+    if ((type == LAIK_SFC_Hilbert) && (dims > 1)) {
+        // transform axes into transposed Hilbert index (J. Skilling,
+        // "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004)
+        uint64_t m = ((uint64_t) 1) << (bits - 1);
+        for(uint64_t q = m; q > 1; q >>= 1) {
+            uint64_t p = q - 1;
+            for(int d = 0; d < dims; d++) {
+                if (x[d] & q)
+                    x[0] ^= p;
+                else {
+                    uint64_t t = (x[0] ^ x[d]) & p;
+                    x[0] ^= t;
+                    x[d] ^= t;
+                }
+            }
+        }
+        // Gray encode
+        for(int d = 1; d < dims; d++)
+            x[d] ^= x[d-1];
+        uint64_t t = 0;
+        for(uint64_t q = m; q > 1; q >>= 1)
+            if (x[dims-1] & q) t ^= q - 1;
+        for(int d = 0; d < dims; d++)
+            x[d] ^= t;
+    }
+
+    // interleave bits, first dimension most significant
+    uint64_t key = 0;
+    for(int b = bits - 1; b >= 0; b--)
+        for(int d = 0; d < dims; d++)
+            key = (key << 1) | ((x[d] >> b) & 1);
+    return key;
+}
+
+// task for index whose weight center is at cumulative weight <w>
+static int sfcTask(SFCRun* sr, double w)
+{
+    int t = sr->task;
+    while((t < sr->tasks - 1) &&
+          (w >= sr->totalW * (t + 1) / sr->tasks)) t++;
+    return t;
+}
+
+// traverse block at relative position <c> with side length 2^<level>
+// returns task if all indexes of block are assigned to same task,
+// -1 if assigned to multiple tasks, -2 if block is outside of space.
+// Slices are appended for largest blocks completely assigned to one task,
+// if the parent block is not
+static int sfcTraverse(SFCRun* sr, const int64_t* c, int level)
+{
+    // block clipped to space
+    Laik_Slice s = *(sr->ss);
+    int64_t side = ((int64_t) 1) << level;
+    for(int d = 0; d < sr->dims; d++) {
+        s.from.i[d] = sr->ss->from.i[d] + c[d];
+        if (s.from.i[d] >= sr->ss->to.i[d]) return -2;
+        s.to.i[d] = s.from.i[d] + side;
+        if (s.to.i[d] > sr->ss->to.i[d]) s.to.i[d] = sr->ss->to.i[d];
+    }
+
+    Laik_SFCPartitionerData* data = sr->data;
+    if (level == 0) {
+        double w = data->getIdxW ? (data->getIdxW)(&(s.from), data->userData) : 1.0;
+        sr->task = sfcTask(sr, sr->cum + w / 2);
+        sr->cum += w;
+        return sr->task;
+    }
+
+    if (!data->getIdxW) {
+        // without weights, check first and last index of block
+        double size = (double) laik_slice_size(&s);
+        int t1 = sfcTask(sr, sr->cum + 0.5);
+        int t2 = sfcTask(sr, sr->cum + size - 0.5);
+        if (t1 == t2) {
+            sr->task = t2;
+            sr->cum += size;
+            return t2;
+        }
+        // skip regions not relevant for filtered runs
+        if (!laik_slicereceiver_wants(sr->r, t1, t2 + 1, &s)) {
+            sr->task = t2;
+            sr->cum += size;
+            return -1;
+        }
+    }
+
+    // sub-blocks in curve order (sort by curve position)
+    int cCount = 1 << sr->dims;
+    int64_t cc[8][3];
+    uint64_t key[8];
+    int ord[8];
+    int64_t half = side / 2;
+    for(int i = 0; i < cCount; i++) {
+        for(int d = 0; d < sr->dims; d++)
+            cc[i][d] = c[d] + ((i >> d) & 1) * half;
+        key[i] = sfcKey(data->type, sr->dims, sr->bits, cc[i]);
+        int j = i;
+        while((j > 0) && (key[ord[j-1]] > key[i])) {
+            ord[j] = ord[j-1];
+            j--;
+        }
+        ord[j] = i;
+    }
+
+    int res[8];
+    int task = -2;
+    for(int i = 0; i < cCount; i++) {
+        res[i] = sfcTraverse(sr, cc[ord[i]], level - 1);
+        if (res[i] == -2) continue;
+        if (task == -2) task = res[i];
+        else if (task != res[i]) task = -1;
+    }
+    if (task != -1) return task;
+
+    // multiple tasks: append sub-blocks assigned to one task
+    for(int i = 0; i < cCount; i++) {
+        if (res[i] < 0) continue;
+        Laik_Slice cs = s;
+        for(int d = 0; d < sr->dims; d++) {
+            cs.from.i[d] = sr->ss->from.i[d] + cc[ord[i]][d];
+            cs.to.i[d] = cs.from.i[d] + half;
+            if (cs.to.i[d] > sr->ss->to.i[d]) cs.to.i[d] = sr->ss->to.i[d];
+        }
+        laik_append_slice(sr->r, res[i], &cs, 1, 0);
+    }
+    return -1;
+}
+
+void runSFCPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
+{
+    Laik_SFCPartitionerData* data;
+    data = (Laik_SFCPartitionerData*) p->partitioner->data;
+    assert(data);
+
+    SFCRun sr;
+    sr.r = r;
+    sr.data = data;
+    sr.ss = &(p->space->s);
+    sr.dims = p->space->dims;
+    sr.tasks = p->group->size;
+    sr.cum = 0.0;
+    sr.task = 0;
+
+    // bits per dimension for cube covering the space
+    int64_t maxSize = 1;
+    for(int d = 0; d < sr.dims; d++) {
+        int64_t size = sr.ss->to.i[d] - sr.ss->from.i[d];
+        assert(size > 0);
+        if (size > maxSize) maxSize = size;
+    }
+    sr.bits = 0;
+    while((((int64_t) 1) << sr.bits) < maxSize) sr.bits++;
+    if (sr.bits * sr.dims > 64)
+        laik_panic("SFC partitioner: space too large for 64-bit curve index");
+
+    if (data->getIdxW) {
+        sr.totalW = 0.0;
+        Laik_Index idx = sr.ss->from;
+        while(1) {
+            sr.totalW += (data->getIdxW)(&idx, data->userData);
+            int d = 0;
+            while(d < sr.dims) {
+                idx.i[d]++;
+                if (idx.i[d] < sr.ss->to.i[d]) break;
+                idx.i[d] = sr.ss->from.i[d];
+                d++;
+            }
+            if (d == sr.dims) break;
+        }
+    }
+    else
+        sr.totalW = (double) laik_slice_size(sr.ss);
+
+    int64_t c[3] = {0, 0, 0};
+    int task = sfcTraverse(&sr, c, sr.bits);
+    if (task >= 0)
+        laik_append_slice(r, task, sr.ss, 1, 0);
+}
+
+Laik_Partitioner* laik_new_sfc_partitioner(Laik_SFCType type,
+                                           Laik_GetIdxWeight_t ifunc,
+                                           const void* userData)
+{
+    Laik_SFCPartitionerData* data;
+    data = malloc(sizeof(Laik_SFCPartitionerData));
+    if (!data) {
+        laik_panic("Out of memory allocating Laik_SFCPartitionerData object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    data->type = type;
+    data->getIdxW = ifunc;
+    data->userData = userData;
+
+    const char* name = (type == LAIK_SFC_Hilbert) ? "hilbert" : "morton";
+    return laik_new_partitioner(name, runSFCPartitioner, data, 0);
+}
+
+
 //-------------------------------------------------------------------
 // 3d grid partitioner
 
@@ -535,6 +1168,15 @@ laik_new_grid_partitioner(int xblocks, int yblocks, int zblocks)
 //
 // when distributing indexes, a given number of rounds is done over tasks,
 // defaulting to 1 (see cycle parameter).
+//
+// Index weights are requested in chunks (either via a bulk callback, or
+// by calling the per-index callback), reduced to one weight sum per chunk.
+// Cut points are found by binary search on the prefix sums of chunks,
+// requesting weights again only for the chunks containing cuts. Chunk
+// sums from a bulk callback are kept for further runs (e.g. with changed
+// task weights or a shrinked group).
+
+#define BLOCK_CHUNK 4096
 
 typedef struct _Laik_BlockPartitionerData Laik_BlockPartitionerData;
 struct _Laik_BlockPartitionerData {
@@ -546,10 +1188,87 @@ struct _Laik_BlockPartitionerData {
 
     // weighted partitioning (Block) uses callbacks
     Laik_GetIdxWeight_t getIdxW;
+    Laik_GetIdxWeights_t getIdxWs;
     Laik_GetTaskWeight_t getTaskW;
     const void* userData;
+
+    // cached prefix sums of chunk weights (only with getIdxWs)
+    double* chunkPrefix;
+    int64_t cacheFrom, cacheSize;
+    const void* cacheUserData;
 };
 
+static void dropBlockCache(Laik_BlockPartitionerData* data)
+{
+    free(data->chunkPrefix);
+    data->chunkPrefix = 0;
+}
+
+// get weights of indexes [from;to[ in partitioning dimension into <w>
+static void getBlockWeights(Laik_BlockPartitionerData* data,
+                            int64_t from, int64_t to, double* w)
+{
+    if (data->getIdxWs) {
+        (data->getIdxWs)(from, to, w, data->userData);
+        return;
+    }
+    if (data->getIdxW) {
+        Laik_Index idx;
+        laik_index_init(&idx, 0, 0, 0);
+        for(int64_t i = from; i < to; i++) {
+            idx.i[data->pdim] = i;
+            w[i - from] = (data->getIdxW)(&idx, data->userData);
+        }
+        return;
+    }
+    // without weighting function, use weight 1 for every index
+    for(int64_t i = from; i < to; i++)
+        w[i - from] = 1.0;
+}
+
+// calculate prefix sums of weights of chunks of <size> indexes at <from>
+static double* getChunkPrefix(Laik_BlockPartitionerData* data,
+                              int64_t from, int64_t size, double* buf)
+{
+    if (data->chunkPrefix) {
+        if ((data->cacheFrom == from) && (data->cacheSize == size) &&
+            (data->cacheUserData == data->userData))
+            return data->chunkPrefix;
+        dropBlockCache(data);
+    }
+
+    int64_t chunks = (size + BLOCK_CHUNK - 1) / BLOCK_CHUNK;
+    double* prefix = malloc((chunks + 1) * sizeof(double));
+    if (!prefix) {
+        laik_panic("Out of memory allocating chunk weights for block partitioner");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    prefix[0] = 0.0;
+    for(int64_t c = 0; c < chunks; c++) {
+        int64_t cFrom = from + c * BLOCK_CHUNK;
+        int64_t cTo = cFrom + BLOCK_CHUNK;
+        if (cTo > from + size) cTo = from + size;
+        double w = 0.0;
+        if (data->getIdxW || data->getIdxWs) {
+            getBlockWeights(data, cFrom, cTo, buf);
+            for(int64_t i = 0; i < cTo - cFrom; i++)
+                w += buf[i];
+        }
+        else
+            w = (double) (cTo - cFrom);
+        prefix[c + 1] = prefix[c] + w;
+    }
+
+    if (data->getIdxWs) {
+        data->chunkPrefix = prefix;
+        data->cacheFrom = from;
+        data->cacheSize = size;
+        data->cacheUserData = data->userData;
+    }
+    return prefix;
+}
+
 void runBlockPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
 {
     Laik_BlockPartitionerData* data;
@@ -560,27 +1279,21 @@ void runBlockPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
 
     int count = p->group->size;
     int pdim = data->pdim;
-    int64_t size = s->s.to.i[pdim] - s->s.from.i[pdim];
+    int64_t from = s->s.from.i[pdim];
+    int64_t size = s->s.to.i[pdim] - from;
     assert(size > 0);
 
-    Laik_Index idx;
-    double totalW;
-    if (data && data->getIdxW) {
-        // element-wise weighting
-        totalW = 0.0;
-        laik_index_init(&idx, 0, 0, 0);
-        for(int64_t i = 0; i < size; i++) {
-            idx.i[pdim] = i + s->s.from.i[pdim];
-            totalW += (data->getIdxW)(&idx, data->userData);
-        }
-    }
-    else {
-        // without weighting function, use weight 1 for every index
-        totalW = (double) size;
+    double* buf = malloc(BLOCK_CHUNK * sizeof(double));
+    if (!buf) {
+        laik_panic("Out of memory allocating chunk weights for block partitioner");
+        exit(1); // not actually needed, laik_panic never returns
     }
+    double* prefix = getChunkPrefix(data, from, size, buf);
+    int64_t chunks = (size + BLOCK_CHUNK - 1) / BLOCK_CHUNK;
+    double totalW = prefix[chunks];
 
     double totalTW = 0.0;
-    if (data && data->getTaskW) {
+    if (data->getTaskW) {
         // task-wise weighting
         totalTW = 0.0;
         for(int task = 0; task < count; task++)
@@ -591,55 +1304,60 @@ void runBlockPartitioner(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
         totalTW = (double) count;
     }
 
-    int cycles = data ? data->cycles : 1;
+    int cycles = data->cycles;
     double perPart = totalW / count / cycles;
-    double w = -0.5;
-    int task = 0;
-    int cycle = 0;
 
-    // taskW is a correction factor, which is 1.0 without task weights
-    double taskW;
-    if (data && data->getTaskW)
-        taskW = (data->getTaskW)(task, data->userData)
-                * ((double) count) / totalTW;
-    else
-        taskW = 1.0;
-
-    slc.from.i[pdim] = s->s.from.i[pdim];
-    for(int64_t i = 0; i < size; i++) {
-        if (data && data->getIdxW) {
-            idx.i[pdim] = i + s->s.from.i[pdim];
-            w += (data->getIdxW)(&idx, data->userData);
+    // task <t> gets the indexes after weight sum <target> is reached,
+    // with the first index of the next task being the one for which the
+    // prefix weight sum (minus 1/2 for rounding) reaches <target> plus
+    // the weight assigned to <t>.
+    double target = 0.5;
+    int64_t loaded = -1; // chunk with weights in <buf>
+    slc.from.i[pdim] = from;
+    for(int part = 0; part < count * cycles - 1; part++) {
+        int task = part % count;
+
+        // taskW is a correction factor, which is 1.0 without task weights
+        double taskW = 1.0;
+        if (data->getTaskW)
+            taskW = (data->getTaskW)(task, data->userData)
+                    * ((double) count) / totalTW;
+        target += perPart * taskW;
+
+        // binary search for first chunk whose end reaches target
+        int64_t lo = 0, hi = chunks;
+        while(lo < hi) {
+            int64_t mid = (lo + hi) / 2;
+            if (prefix[mid + 1] >= target) hi = mid;
+            else lo = mid + 1;
         }
-        else
-            w += 1.0;
-
-        while (w >= perPart * taskW) {
-            w = w - (perPart * taskW);
-            if ((task+1 == count) && (cycle+1 == cycles)) break;
-            slc.to.i[pdim] = i + s->s.from.i[pdim];
-            if (slc.from.i[pdim] < slc.to.i[pdim])
-                laik_append_slice(r, task, &slc, 0, 0);
-            task++;
-            if (task == count) {
-                task = 0;
-                cycle++;
-            }
-            // update taskW
-            if (data && data->getTaskW)
-                taskW = (data->getTaskW)(task, data->userData)
-                        * ((double) count) / totalTW;
-            else
-                taskW = 1.0;
 
-            // start new slice
-            slc.from.i[pdim] = i + s->s.from.i[pdim];
+        int64_t cut = from + size;
+        if (lo < chunks) {
+            int64_t cFrom = from + lo * BLOCK_CHUNK;
+            int64_t cTo = cFrom + BLOCK_CHUNK;
+            if (cTo > from + size) cTo = from + size;
+            if (loaded != lo) {
+                getBlockWeights(data, cFrom, cTo, buf);
+                loaded = lo;
+            }
+            double w = prefix[lo];
+            for(cut = cFrom; cut < cTo - 1; cut++) {
+                w += buf[cut - cFrom];
+                if (w >= target) break;
+            }
         }
-        if ((task+1 == count) && (cycle+1 == cycles)) break;
+
+        slc.to.i[pdim] = cut;
+        if (slc.from.i[pdim] < slc.to.i[pdim])
+            laik_append_slice(r, task, &slc, 0, 0);
+        slc.from.i[pdim] = cut;
     }
-    assert((task+1 == count) && (cycle+1 == cycles));
     slc.to.i[pdim] = s->s.to.i[pdim];
-    laik_append_slice(r, task, &slc, 0, 0);
+    laik_append_slice(r, count - 1, &slc, 0, 0);
+
+    if (prefix != data->chunkPrefix) free(prefix);
+    free(buf);
 }
 
 
@@ -658,8 +1376,10 @@ Laik_Partitioner* laik_new_block_partitioner(int pdim, int cycles,
     data->pdim = pdim;
     data->cycles = cycles;
     data->getIdxW = ifunc;
+    data->getIdxWs = 0;
     data->userData = userData;
     data->getTaskW = tfunc;
+    data->chunkPrefix = 0;
 
     return laik_new_partitioner("block", runBlockPartitioner, data, 0);
 }
@@ -690,7 +1410,23 @@ void laik_set_index_weight(Laik_Partitioner* pr, Laik_GetIdxWeight_t f,
     data = (Laik_BlockPartitionerData*) pr->data;
 
     data->getIdxW = f;
+    data->getIdxWs = 0;
+    data->userData = userData;
+    dropBlockCache(data);
+}
+
+void laik_set_index_weights(Laik_Partitioner* pr, Laik_GetIdxWeights_t f,
+                            const void* userData)
+{
+    assert(pr->run == runBlockPartitioner);
+
+    Laik_BlockPartitionerData* data;
+    data = (Laik_BlockPartitionerData*) pr->data;
+
+    data->getIdxW = 0;
+    data->getIdxWs = f;
     data->userData = userData;
+    dropBlockCache(data);
 }
 
 void laik_set_task_weight(Laik_Partitioner* pr, Laik_GetTaskWeight_t f,
@@ -53,6 +53,7 @@ Laik_SliceFilter* laik_slicefilter_new()
     sf->filter_tid = -1;
     sf->pfilter1 = 0;
     sf->pfilter2 = 0;
+    sf->reach = 0;
 
     return sf;
 }
@@ -83,18 +84,18 @@ void laik_slicefilter_set_myfilter(Laik_SliceFilter* sf, Laik_Group* g)
 }
 
 
-// helper for laik_slicefilter_set_idxfilter
+// helper for laik_slicefilter_add_idxfilter
 
-// check if [from;to[ intersects slices given in par
-static bool idxfilter_check(int64_t from, int64_t to, PFilterPar* par)
+// check if [from;to[ intersects 1d slices given in par (sorted)
+static bool idxfilter_check1d(int64_t from, int64_t to, PFilterPar* par)
 {
     assert(par->len > 0);
 
     laik_log(1,"  filter [%lld;%lld[ check with range [%lld;%lld[",
              (long long) from, (long long) to,
-             (long long) par->from, (long long) par->to);
+             (long long) par->bb.from.i[0], (long long) par->bb.to.i[0]);
 
-    if ((from >= par->to) || (to <= par->from)) {
+    if ((from >= par->bb.to.i[0]) || (to <= par->bb.from.i[0])) {
         laik_log(1,"    no intersection!");
         return false;
     }
@@ -139,17 +140,34 @@ static bool idxfilter_check(int64_t from, int64_t to, PFilterPar* par)
     return true;
 }
 
+// check if <s> intersects slices given in par
+static bool idxfilter_check(const Laik_Slice* s, PFilterPar* par)
+{
+    if (par->sorted)
+        return idxfilter_check1d(s->from.i[0], s->to.i[0], par);
+
+    if (laik_slice_intersect(s, &(par->bb)) == 0) return false;
+    for(unsigned int i = 0; i < par->len; i++)
+        if (laik_slice_intersect(s, &(par->ts[i].s))) return true;
+    return false;
+}
+
 
 static
 bool idxfilter(Laik_SliceFilter* sf, int task, const Laik_Slice* s)
 {
-    (void) task; // unused parameter of filter signature
+    // own slices are always kept, even if empty
+    if ((sf->filter_tid >= 0) && (task == sf->filter_tid)) return true;
 
-    int64_t from = s->from.i[0];
-    int64_t to = s->to.i[0];
+    // check slice extended by reach
+    Laik_Slice slc = *s;
+    for(int d = 0; d < s->space->dims; d++) {
+        slc.from.i[d] -= sf->reach;
+        slc.to.i[d] += sf->reach;
+    }
 
-    if (sf->pfilter1 && idxfilter_check(from, to, sf->pfilter1)) return true;
-    if (sf->pfilter2 && idxfilter_check(from, to, sf->pfilter2)) return true;
+    if (sf->pfilter1 && idxfilter_check(&slc, sf->pfilter1)) return true;
+    if (sf->pfilter2 && idxfilter_check(&slc, sf->pfilter2)) return true;
     return false;
 }
 
@@ -158,31 +176,93 @@ void laik_slicefilter_add_idxfilter(Laik_SliceFilter* sf, Laik_SliceArray* sa, i
 {
     assert(sa);
     assert(sa->off != 0);
-    assert(sa->space->dims == 1); // TODO: only for 1d for now
+    assert((sf->filter_func == 0) || (sf->filter_func == idxfilter));
+
+    // install filter function
+    sf->filter_func = idxfilter;
 
     assert((tid >= 0) && (tid < (int) sa->tid_count));
     // no own slices?
     unsigned mycount = sa->off[tid+1] - sa->off[tid];
     if (mycount == 0) return;
 
-    Laik_TaskSlice_Gen* ts1 = sa->tslice + sa->off[tid];
-    Laik_TaskSlice_Gen* ts2 = sa->tslice + sa->off[tid+1]-1;
+    Laik_TaskSlice_Gen* ts = sa->tslice + sa->off[tid];
+    int dims = sa->space->dims;
 
     PFilterPar* par = malloc(sizeof(PFilterPar));
+    if (!par) {
+        laik_panic("Out of memory allocating PFilterPar object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
     par->len = mycount;
-    par->from = ts1->s.from.i[0];
-    par->to   = ts2->s.to.i[0];
-    par->ts = ts1;
+    par->ts = ts;
+    par->bb = ts[0].s;
+    par->sorted = (dims == 1);
+    for(unsigned int i = 1; i < mycount; i++) {
+        for(int d = 0; d < dims; d++) {
+            if (ts[i].s.from.i[d] < par->bb.from.i[d])
+                par->bb.from.i[d] = ts[i].s.from.i[d];
+            if (ts[i].s.to.i[d] > par->bb.to.i[d])
+                par->bb.to.i[d] = ts[i].s.to.i[d];
+        }
+        // binary search in 1d requires ordered, disjoint slices
+        if ((dims == 1) && (ts[i].s.from.i[0] < ts[i-1].s.to.i[0]))
+            par->sorted = false;
+    }
 
     if      (sf->pfilter1 == 0) sf->pfilter1 = par;
     else if (sf->pfilter2 == 0) sf->pfilter2 = par;
     else assert(0);
 
-    laik_log(1,"Set pfilter to intersection with %d slices between [%lld;%lld[",
-             par->len, (long long) par->from, (long long) par->to);
+    if (laik_log_begin(1)) {
+        laik_log_append("Set pfilter to intersection with %d slices within ",
+                        par->len);
+        laik_log_Slice(&(par->bb));
+        laik_log_flush(0);
+    }
+}
 
-    // install filter function
-    sf->filter_func = idxfilter;
+// may a slice for tasks in [fromTask;toTask[ within <s> pass the filter?
+// Allows partitioners to skip enumeration of irrelevant regions
+bool laik_slicefilter_wants(Laik_SliceFilter* sf,
+                            int fromTask, int toTask, const Laik_Slice* s)
+{
+    if ((sf == 0) || (sf->filter_func == 0)) return true;
+
+    bool ownTask = (sf->filter_tid >= fromTask) && (sf->filter_tid < toTask);
+    if (sf->filter_func == tidfilter) return ownTask;
+    if (sf->filter_func == idxfilter) return ownTask || idxfilter(sf, -1, s);
+
+    // unknown filter function, cannot decide
+    return true;
+}
+
+static
+PFilterPar* copyPFilter(PFilterPar* par)
+{
+    if (par == 0) return 0;
+
+    PFilterPar* par2 = malloc(sizeof(PFilterPar));
+    if (!par2) {
+        laik_panic("Out of memory allocating PFilterPar object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    *par2 = *par;
+    return par2;
+}
+
+// new filter with same settings as <sf>, with reach enlarged by <reach>.
+// Used to get slices of a base partitioning which are required to
+// calculate slices passing <sf> for a derived partitioning
+Laik_SliceFilter* laik_slicefilter_extend(Laik_SliceFilter* sf, int64_t reach)
+{
+    Laik_SliceFilter* sf2 = laik_slicefilter_new();
+    sf2->filter_func = sf->filter_func;
+    sf2->filter_tid = sf->filter_tid;
+    sf2->pfilter1 = copyPFilter(sf->pfilter1);
+    sf2->pfilter2 = copyPFilter(sf->pfilter2);
+    sf2->reach = sf->reach + reach;
+    return sf2;
 }
 
 
@@ -293,10 +373,15 @@ Laik_Partitioning* laik_clone_empty_partitioning(Laik_Partitioning* p)
 // free resources allocated for a partitioning object
 void laik_free_partitioning(Laik_Partitioning* p)
 {
+    // transitions cached for containers must not refer to <p>
+    laik_data_transcache_invalidate(p->group->inst, p);
+
     SliceArray_Entry* e = p->saList;
     while(e) {
-        laik_slicearray_free(e->slices);
-        e = e->next;
+        SliceArray_Entry* next = e->next;
+        laik_slicearray_release(e->slices);
+        free(e);
+        e = next;
     }
     free(p);
 }
@@ -350,7 +435,7 @@ Laik_SliceArray* laik_partitioning_interslices(Laik_Partitioning* p,
             return e->slices;
         }
         if ((e->info == LAIK_AI_INTERSECT) &&
-            (e->other == p2)) {
+            (e->other == p2) && (e->otherId == p2->id)) {
             return e->slices;
         }
 
@@ -417,6 +502,9 @@ void laik_partitioning_store_allslices(Laik_Partitioning* p)
 {
     SliceArray_Entry* e = laik_partitioning_run(p, 0);
     e->info = LAIK_AI_FULL;
+
+    // share with identical partitionings
+    e->slices = laik_slicearray_intern(e->slices, p->group->myid);
 }
 
 
@@ -465,12 +553,15 @@ void laik_partitioning_store_intersectslices(Laik_Partitioning* p,
     laik_slicefilter_add_idxfilter(sf, sa, p->group->myid);
     if (p2 != p) // no need to add same slices twice to filter
         laik_slicefilter_add_idxfilter(sf, sa2, p2->group->myid);
+    // own slices are kept in any case
+    sf->filter_tid = p->group->myid;
 
     SliceArray_Entry* e = laik_partitioning_run(p, sf);
     laik_slicefilter_free(sf);
 
     e->info = LAIK_AI_INTERSECT;
     e->other = p2;
+    e->otherId = p2->id;
 }
 
 
@@ -561,6 +652,18 @@ bool laik_partitioning_coversSpace(Laik_Partitioning* p)
     return laik_slicearray_coversSpace(sa);
 }
 
+// do the slices of this partitioning cover the full space without overlap?
+bool laik_partitioning_isExclusive(Laik_Partitioning* p)
+{
+    // no filter allowed
+    Laik_SliceArray* sa = laik_partitioning_allslices(p);
+    assert(sa != 0); // TODO: API user error
+
+    int overlap[2];
+    if (!laik_slicearray_checkCoverage(sa, overlap)) return false;
+    return (overlap[0] < 0);
+}
+
 // public: are the borders of two partitionings equal?
 bool laik_partitioning_isEqual(Laik_Partitioning* p1, Laik_Partitioning* p2)
 {
@@ -588,6 +691,24 @@ Laik_Partitioning* laik_new_partitioning(Laik_Partitioner* pr,
     return p;
 }
 
+// public: create a new partitioning only storing own slices.
+// Slices of other tasks are calculated on demand, when needed for
+// transitions to/from this partitioning: then, only slices intersecting
+// with own slices are stored (see laik_partitioning_store_intersectslices).
+// The partitioner may be called multiple times with different filters,
+// and partitionings with all slices required (such as the base partitioning
+// for copy/reassign partitioners) are not supported
+Laik_Partitioning* laik_new_distributed_partitioning(Laik_Partitioner* pr,
+                                                     Laik_Group* g,
+                                                     Laik_Space* space,
+                                                     Laik_Partitioning* otherP)
+{
+    Laik_Partitioning* p;
+    p = laik_new_empty_partitioning(g, space, pr, otherP);
+    laik_partitioning_store_myslices(p);
+    return p;
+}
+
 
 
 // migrate partitioning borders to new group without changing borders
@@ -598,6 +719,9 @@ void laik_partitioning_migrate(Laik_Partitioning* p, Laik_Group* newg)
     Laik_Group* oldg = p->group;
     int* fromOld; // mapping of IDs from old group to new group
 
+    // cached transitions for <p> get invalid
+    laik_data_transcache_invalidate(oldg->inst, p);
+
     if (newg->parent == oldg) {
         // new group is child of old
         fromOld = newg->fromParent;
@@ -620,7 +744,11 @@ void laik_partitioning_migrate(Laik_Partitioning* p, Laik_Group* newg)
             assert(e->filter_tid < oldg->size);
             e->filter_tid = fromOld[e->filter_tid];
         }
+        // shared slice arrays are immutable: migrate a copy
+        e->slices = laik_slicearray_unshare(e->slices);
         laik_slicearray_migrate(e->slices, fromOld, (unsigned int) newg->size);
+        if (e->info == LAIK_AI_FULL)
+            e->slices = laik_slicearray_intern(e->slices, newg->myid);
         e = e->next;
     }
 
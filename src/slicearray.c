@@ -18,6 +18,8 @@
 #include "laik-internal.h"
 
 #include <assert.h>
+#include <limits.h>
+#include <pthread.h>
 #include <string.h>
 
 /// Laik_SliceArray
@@ -48,11 +50,21 @@ Laik_SliceArray* laik_slicearray_new(Laik_Space* space, unsigned int tid_count)
     sa->map_off = 0;
     sa->map_count = 0;
 
+    sa->index = 0;
+
+    sa->hash = 0;
+    sa->refcount = 0; // not shared
+    sa->shareTid = -1;
+    sa->nextShared = 0;
+
     return sa;
 }
 
+static void freeIndex(Laik_SliceArray* sa);
+
 void laik_slicearray_free(Laik_SliceArray* sa)
 {
+    freeIndex(sa);
     free(sa->tslice);
     free(sa->tss1d);
     free(sa->off);
@@ -88,6 +100,10 @@ bool laik_slicearray_isEqual(Laik_SliceArray* sa1, Laik_SliceArray* sa2)
     // partitionings needs to be valid
     assert(sa1 && sa1->off);
     assert(sa2 && sa2->off);
+    if (sa1 == sa2) return true;
+    // hashes of shared slice arrays are valid, as these are immutable
+    if ((sa1->refcount > 0) && (sa2->refcount > 0) &&
+        (sa1->hash != sa2->hash)) return false;
     if (sa1->tid_count != sa2->tid_count) return false;
     if (sa1->space != sa2->space) return false;
     if (sa1->count != sa2->count) return false;
@@ -158,148 +174,183 @@ Laik_TaskSlice* laik_slicearray_tidslice(Laik_SliceArray* sa, int tid, int n)
 }
 
 
-// internal helpers for laik_slicearray_coversSpace
-
-// print verbose debug output?
-//#define DEBUG_COVERSPACE 1
-
-// TODO: use dynamic list
-#define COVERLIST_MAX 100
-static Laik_Slice notcovered[COVERLIST_MAX];
-static int notcovered_count;
-
-static void appendToNotcovered(Laik_Slice* s)
-{
-    assert(notcovered_count < COVERLIST_MAX);
-    notcovered[notcovered_count] = *s;
-    notcovered_count++;
-}
-
-#ifdef DEBUG_COVERSPACE
-static void log_Notcovered(int dims, Laik_Slice* toRemove)
-{
-    laik_log_append("not covered: (");
-    for(int j = 0; j < notcovered_count; j++) {
-        if (j>0) laik_log_append(", ");
-        laik_log_Slice(dims, &(notcovered[j]));
-    }
-    laik_log_append(")");
-    if (toRemove) {
-        laik_log_append("\n  removing ");
-        laik_log_Slice(dims, toRemove);
-    }
-}
-#endif
-
-static
-    int tsgen_cmpfrom(const void *p1, const void *p2)
+// internal helpers for coverage checks
+//
+// We sweep over the space along dimension 0: between consecutive slice
+// borders in that dimension, the set of active slices does not change,
+// and the slab must be covered by the projections of the active slices
+// onto the remaining dimensions (checked recursively, again sweeping).
+// In the last dimension, slices sorted by start are scanned for gaps and
+// overlaps. This results in O(n log n) for 1d. For 2d/3d, each sweep step
+// recurses on active slices only, which for typical partitionings (blocks,
+// grids, halos) stays close to O(n log n).
+
+typedef struct _CoverCheck {
+    Laik_TaskSlice_Gen* ts;
+    int dims;
+    bool covered;
+    bool checkOverlap;
+    int overlap1, overlap2; // first overlap found, or -1
+} CoverCheck;
+
+typedef struct _CoverEvent {
+    int64_t pos, end; // <end> only used in last dimension
+    int isStart;
+    unsigned int no; // position in slice list of sweep step
+} CoverEvent;
+
+static int coverEvent_cmp(const void *p1, const void *p2)
 {
-    const Laik_TaskSlice_Gen* ts1 = (const Laik_TaskSlice_Gen*) p1;
-    const Laik_TaskSlice_Gen* ts2 = (const Laik_TaskSlice_Gen*) p2;
-    if (ts1->s.from.i[0] > ts2->s.from.i[0]) return 1;
-    if (ts1->s.from.i[0] == ts2->s.from.i[0]) return 0;
-    return -1;
+    const CoverEvent* e1 = (const CoverEvent*) p1;
+    const CoverEvent* e2 = (const CoverEvent*) p2;
+    if (e1->pos != e2->pos) return (e1->pos > e2->pos) ? 1 : -1;
+    // ends before starts: touching slices do not overlap
+    return e1->isStart - e2->isStart;
 }
 
-// do the slices of this partitioning cover the full space?
-// (currently works for 1d/2d/3d spaces)
-//
-// we maintain a list of slices not yet covered,
-// starting with the one slice equal to full space, and then
-// subtract the slices from the partitioning step-by-step
-// from each of the not-yet-covered slices, creating a
-// new list of not-yet-covered slices.
-//
-// Note: subtraction of a slice from another one may result in
-// multiple smaller slices which are appended to the not-yet-covered
-// list (eg. in 3d, 6 smaller slices may be created).
-bool laik_slicearray_coversSpace(Laik_SliceArray* sa)
+// check coverage of <range> in dimensions [d;dims[ by the slices with
+// offsets <ids> (all of them overlapping with <range> in dimensions < d)
+static void sweepCoverage(CoverCheck* c, int d, const Laik_Slice* range,
+                          unsigned int* ids, unsigned int n)
 {
-    int dims = sa->space->dims;
-    notcovered_count = 0;
+    // stop if no more information can be gained
+    if (!c->covered && (!c->checkOverlap || (c->overlap1 >= 0))) return;
 
-    // start with full space not-yet-covered
-    appendToNotcovered(&(sa->space->s));
+    if (n == 0) {
+        if (range->from.i[d] < range->to.i[d]) c->covered = false;
+        return;
+    }
 
-    // use a copy of slice list which is just sorted by slice start
-    Laik_TaskSlice_Gen* list;
-    list = malloc(sa->count * sizeof(Laik_TaskSlice_Gen));
-    if (!list) {
-        laik_panic("Out of memory allocating memory for coversSpace");
+    // events for start/end of slices clipped to <range> in dimension d
+    bool lastDim = (d == c->dims - 1);
+    CoverEvent* ev = malloc(2 * n * sizeof(CoverEvent));
+    if (!ev) {
+        laik_panic("Out of memory allocating memory for coverage check");
         exit(1); // not actually needed, laik_panic never returns
     }
-
-    memcpy(list, sa->tslice, sa->count * sizeof(Laik_TaskSlice_Gen));
-    qsort(list, sa->count, sizeof(Laik_TaskSlice_Gen), tsgen_cmpfrom);
-
-    // remove each slice in partitioning
-    for(unsigned int i = 0; i < sa->count; i++) {
-        Laik_Slice* toRemove = &(list[i].s);
-
-#ifdef DEBUG_COVERSPACE
-        if (laik_log_begin(1)) {
-            laik_log_append("coversSpace - ");
-            log_Notcovered(dims, toRemove);
-            laik_log_flush(0);
+    unsigned int evCount = 0;
+    for(unsigned int i = 0; i < n; i++) {
+        const Laik_Slice* s = &(c->ts[ids[i]].s);
+        int64_t from = s->from.i[d], to = s->to.i[d];
+        if (from < range->from.i[d]) from = range->from.i[d];
+        if (to > range->to.i[d]) to = range->to.i[d];
+        if (from >= to) continue;
+        ev[evCount].pos = from;
+        ev[evCount].end = to;
+        ev[evCount].isStart = 1;
+        ev[evCount].no = i;
+        evCount++;
+        if (lastDim) continue;
+        ev[evCount].pos = to;
+        ev[evCount].isStart = 0;
+        ev[evCount].no = i;
+        evCount++;
+    }
+    qsort(ev, evCount, sizeof(CoverEvent), coverEvent_cmp);
+
+    if (lastDim) {
+        // scan slices sorted by start for gaps and overlaps
+        int64_t end = range->from.i[d];
+        unsigned int endNo = 0; // slice reaching to <end>
+        for(unsigned int e = 0; e < evCount; e++) {
+            if (ev[e].pos > end) c->covered = false;
+            if ((ev[e].pos < end) && c->checkOverlap && (c->overlap1 < 0)) {
+                c->overlap1 = (int) ids[endNo];
+                c->overlap2 = (int) ids[ev[e].no];
+            }
+            if (ev[e].end > end) {
+                end = ev[e].end;
+                endNo = ev[e].no;
+            }
         }
-#endif
-
-        int count = notcovered_count; // number of slices to visit
-        for(int j = 0; j < count; j++) {
-            Laik_Slice* orig = &(notcovered[j]);
+        if (end < range->to.i[d]) c->covered = false;
+        free(ev);
+        return;
+    }
 
-            if (laik_slice_intersect(orig, toRemove) == 0) {
-                // slice to remove does not overlap with orig: keep original
-                appendToNotcovered(orig);
-                continue;
+    // sweep over dimension d, keeping list of active slices
+    unsigned int* active = malloc(2 * n * sizeof(unsigned int));
+    if (!active) {
+        laik_panic("Out of memory allocating memory for coverage check");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    unsigned int* pos = active + n; // position of slice in active list
+    unsigned int* sub = malloc(n * sizeof(unsigned int));
+    if (!sub) {
+        laik_panic("Out of memory allocating memory for coverage check");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    unsigned int activeCount = 0;
+    Laik_Slice slab = *range;
+    int64_t last = range->from.i[d];
+    unsigned int e = 0;
+    while(e < evCount) {
+        int64_t p = ev[e].pos;
+        if (p > last) {
+            // slab [last;p[ with current active slices
+            slab.from.i[d] = last;
+            slab.to.i[d] = p;
+            for(unsigned int i = 0; i < activeCount; i++)
+                sub[i] = ids[active[i]];
+            sweepCoverage(c, d + 1, &slab, sub, activeCount);
+        }
+        last = p;
+        for(; (e < evCount) && (ev[e].pos == p); e++) {
+            unsigned int no = ev[e].no;
+            if (ev[e].isStart) {
+                pos[no] = activeCount;
+                active[activeCount++] = no;
             }
-
-            // subtract toRemove from orig
-
-            // check for space not covered in orig, loop through valid dims
-            for(int d = 0; d < dims; d++) {
-                // space in dim <d> before <toRemove> ?
-                if (orig->from.i[d] < toRemove->from.i[d]) {
-                    // yes, add to not-covered
-                    Laik_Slice s = *orig;
-                    s.to.i[d] = toRemove->from.i[d];
-                    appendToNotcovered(&s);
-                    // remove appended part from <orig>
-                    orig->from.i[d] = toRemove->from.i[d];
-                }
-                // space in dim <d> after <toRemove> ?
-                if (orig->to.i[d] > toRemove->to.i[d]) {
-                    Laik_Slice s = *orig;
-                    s.from.i[d] = toRemove->to.i[d];
-                    appendToNotcovered(&s);
-                    // remove appended part from <orig>
-                    orig->to.i[d] = toRemove->to.i[d];
-                }
+            else {
+                unsigned int moved = active[--activeCount];
+                active[pos[no]] = moved;
+                pos[moved] = pos[no];
             }
         }
-        if (notcovered_count == count) {
-            // nothing appended, ie. nothing left?
-            notcovered_count = 0;
-            break;
-        }
-        // move appended slices to start
-        for(int j = 0; j < notcovered_count - count; j++)
-            notcovered[j] = notcovered[count + j];
-        notcovered_count = notcovered_count - count;
     }
+    if (last < range->to.i[d]) c->covered = false;
 
-#ifdef DEBUG_COVERSPACE
-    if (laik_log_begin(1)) {
-        laik_log_append("coversSpace - remaining ");
-        log_Notcovered(dims, 0);
-        laik_log_flush(0);
+    free(sub);
+    free(active);
+    free(ev);
+}
+
+// do the slices cover the full space? If <overlap> is not 0, also check
+// for overlapping slices: overlap[0] and overlap[1] are set to offsets
+// of two overlapping slices, or -1 if no slices overlap.
+// (works for 1d/2d/3d spaces, reentrant)
+bool laik_slicearray_checkCoverage(Laik_SliceArray* sa, int* overlap)
+{
+    CoverCheck c;
+    c.ts = sa->tslice;
+    c.dims = sa->space->dims;
+    c.covered = true;
+    c.checkOverlap = (overlap != 0);
+    c.overlap1 = -1;
+    c.overlap2 = -1;
+
+    unsigned int* ids = malloc((sa->count + 1) * sizeof(unsigned int));
+    if (!ids) {
+        laik_panic("Out of memory allocating memory for coverage check");
+        exit(1); // not actually needed, laik_panic never returns
     }
-#endif
+    for(unsigned int i = 0; i < sa->count; i++)
+        ids[i] = i;
 
-    free(list);
+    sweepCoverage(&c, 0, &(sa->space->s), ids, sa->count);
+    free(ids);
+
+    if (overlap) {
+        overlap[0] = c.overlap1;
+        overlap[1] = c.overlap2;
+    }
+    return c.covered;
+}
 
-    // only if no slices are left, we did cover full space
-    return (notcovered_count == 0);
+// do the slices of this partitioning cover the full space?
+bool laik_slicearray_coversSpace(Laik_SliceArray* sa)
+{
+    return laik_slicearray_checkCoverage(sa, 0);
 }
 
 
@@ -340,6 +391,19 @@ void laik_slicearray_append_single1d(Laik_SliceArray* sa, int tid, int64_t idx)
 {
     // not allowed to add slices with different APIs
     assert(sa->tslice == 0);
+    assert((tid >= 0) && (tid < (int) sa->tid_count));
+    assert((idx >= sa->space->s.from.i[0]) && (idx < sa->space->s.to.i[0]));
+
+    // indexes often get appended in sequence: extend run of last index
+    if (sa->count > 0) {
+        Laik_TaskSlice_Single1d* last = &(sa->tss1d[sa->count - 1]);
+        if ((last->task == tid) && (idx >= last->idx) &&
+            (idx <= last->idx + last->len) && (last->len < UINT_MAX)) {
+            if (idx == last->idx + last->len)
+                last->len++;
+            return;
+        }
+    }
 
     if (sa->count == sa->capacity) {
         assert(sa->tslice == 0);
@@ -352,13 +416,12 @@ void laik_slicearray_append_single1d(Laik_SliceArray* sa, int tid, int64_t idx)
         }
     }
     assert(sa->tss1d);
-    assert((tid >= 0) && (tid < (int) sa->tid_count));
-    assert((idx >= sa->space->s.from.i[0]) && (idx < sa->space->s.to.i[0]));
 
     Laik_TaskSlice_Single1d* ts = &(sa->tss1d[sa->count]);
     sa->count++;
 
     ts->task = tid;
+    ts->len = 1;
     ts->idx = idx;
 }
 
@@ -382,19 +445,6 @@ static int tsgen_cmp(const void *p1, const void *p2)
     return ts1->task - ts2->task;
 }
 
-static int tss1d_cmp(const void *p1, const void *p2)
-{
-    const Laik_TaskSlice_Single1d* ts1 = (const Laik_TaskSlice_Single1d*) p1;
-    const Laik_TaskSlice_Single1d* ts2 = (const Laik_TaskSlice_Single1d*) p2;
-    if (ts1->task == ts2->task) {
-        // sort slices for same task by index
-        if (ts1->idx > ts2->idx) return 1;
-        if (ts1->idx == ts2->idx) return 0;
-        return -1;
-    }
-    return ts1->task - ts2->task;
-}
-
 static void sortSlices(Laik_SliceArray* sa)
 {
     // nothing to sort?
@@ -473,36 +523,84 @@ static void updateOffsets(Laik_SliceArray* sa)
     assert(off == sa->count);
 }
 
+// sort single index runs by task ID, then start index.
+// Instead of comparison-based sorting, we do a LSD radix sort on the
+// start index (8 bits per pass, skipping passes which would not change
+// the order), followed by a stable counting sort on task IDs
+static void sortSingle1d(Laik_SliceArray* sa)
+{
+    unsigned int n = sa->count;
+    Laik_TaskSlice_Single1d* src = sa->tss1d;
+    Laik_TaskSlice_Single1d* dst;
+    dst = malloc(sizeof(Laik_TaskSlice_Single1d) * n);
+    unsigned int* cnt = malloc(sizeof(unsigned int) * (sa->tid_count + 1));
+    if (!dst || !cnt) {
+        laik_panic("Out of memory sorting single index slices");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    int64_t from = sa->space->s.from.i[0];
+    uint64_t maxKey = (uint64_t) (sa->space->s.to.i[0] - from - 1);
+    unsigned int bcnt[256];
+    for(int shift = 0; (shift < 64) && ((maxKey >> shift) > 0); shift += 8) {
+        memset(bcnt, 0, sizeof(bcnt));
+        for(unsigned int i = 0; i < n; i++)
+            bcnt[((uint64_t) (src[i].idx - from) >> shift) & 255]++;
+        if (bcnt[((uint64_t) (src[0].idx - from) >> shift) & 255] == n)
+            continue; // all with same digit
+
+        unsigned int off = 0;
+        for(int b = 0; b < 256; b++) {
+            unsigned int c = bcnt[b];
+            bcnt[b] = off;
+            off += c;
+        }
+        for(unsigned int i = 0; i < n; i++)
+            dst[bcnt[((uint64_t) (src[i].idx - from) >> shift) & 255]++] = src[i];
+
+        Laik_TaskSlice_Single1d* tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    memset(cnt, 0, sizeof(unsigned int) * (sa->tid_count + 1));
+    for(unsigned int i = 0; i < n; i++)
+        cnt[src[i].task + 1]++;
+    for(unsigned int t = 0; t < sa->tid_count; t++)
+        cnt[t + 1] += cnt[t];
+    for(unsigned int i = 0; i < n; i++)
+        dst[cnt[src[i].task]++] = src[i];
+
+    sa->tss1d = dst;
+    free(src);
+    free(cnt);
+}
+
 // update offset array from slices, single index format
-// also, convert to generic format
+// also, convert to generic format, merging overlapping/adjacent runs
 static void updateOffsetsSI(Laik_SliceArray* sa)
 {
     assert(sa->tss1d);
     assert(sa->count > 0);
 
-    // make sure slices are sorted according by task IDs
-    qsort(&(sa->tss1d[0]), sa->count,
-          sizeof(Laik_TaskSlice_Single1d), tss1d_cmp);
+    sortSingle1d(sa);
 
-    // count slices
-    int64_t idx, idx0;
-    int task;
+    // count merged slices
+    Laik_TaskSlice_Single1d* tss = sa->tss1d;
     unsigned int count = 1;
-    task = sa->tss1d[0].task;
-    idx = sa->tss1d[0].idx;
+    int task = tss[0].task;
+    int64_t end = tss[0].idx + tss[0].len;
     for(unsigned int i = 1; i < sa->count; i++) {
-        if (sa->tss1d[i].task == task) {
-            if (sa->tss1d[i].idx == idx) continue;
-            if (sa->tss1d[i].idx == idx + 1) {
-                idx++;
-                continue;
-            }
+        if ((tss[i].task == task) && (tss[i].idx <= end)) {
+            if (tss[i].idx + tss[i].len > end)
+                end = tss[i].idx + tss[i].len;
+            continue;
         }
-        task = sa->tss1d[i].task;
-        idx = sa->tss1d[i].idx;
+        task = tss[i].task;
+        end = tss[i].idx + tss[i].len;
         count++;
     }
-    laik_log(1, "Merging single indexes: %d original, %d merged",
+    laik_log(1, "Merging single indexes: %d runs, %d merged",
              sa->count, count);
 
     sa->tslice = malloc(sizeof(Laik_TaskSlice_Gen) * count);
@@ -512,20 +610,18 @@ static void updateOffsetsSI(Laik_SliceArray* sa)
     }
 
     // convert into generic slices (already sorted)
-    unsigned int off = 0, j = 0;
-    task = sa->tss1d[0].task;
-    idx0 = idx = sa->tss1d[0].idx;
-    for(unsigned int i = 1; i <= sa->count; i++) {
-        if ((i < sa->count) && (sa->tss1d[i].task == task)) {
-            if (sa->tss1d[i].idx == idx) continue;
-            if (sa->tss1d[i].idx == idx + 1) {
-                idx++;
-                continue;
-            }
+    unsigned int off = 0;
+    for(unsigned int i = 0; i < sa->count; ) {
+        task = tss[i].task;
+        int64_t idx0 = tss[i].idx;
+        end = tss[i].idx + tss[i].len;
+        for(i++; i < sa->count; i++) {
+            if ((tss[i].task != task) || (tss[i].idx > end)) break;
+            if (tss[i].idx + tss[i].len > end)
+                end = tss[i].idx + tss[i].len;
         }
-        laik_log(1, "  adding slice for offsets %d - %d: task %d, [%lld;%lld[",
-                 j, i-1, task,
-                 (long long) idx0, (long long) (idx + 1) );
+        laik_log(1, "  adding slice %d: task %d, [%lld;%lld[",
+                 off, task, (long long) idx0, (long long) end);
 
         Laik_TaskSlice_Gen* ts = &(sa->tslice[off]);
         ts->task = task;
@@ -534,13 +630,8 @@ static void updateOffsetsSI(Laik_SliceArray* sa)
         ts->data = 0;
         ts->s.space = sa->space;
         ts->s.from.i[0] = idx0;
-        ts->s.to.i[0] = idx + 1;
+        ts->s.to.i[0] = end;
         off++;
-        if (i == sa->count) break;
-
-        task = sa->tss1d[i].task;
-        idx0 = idx = sa->tss1d[i].idx;
-        j = i;
     }
     assert(count == off);
     sa->count = count;
@@ -708,4 +799,415 @@ void laik_slicearray_migrate(Laik_SliceArray* sa, int* idmap, unsigned int new_c
     sa->tid_count = new_count;
     sortSlices(sa);
     updateOffsets(sa);
+
+    // offsets of slices and task ids changed
+    freeIndex(sa);
+    free(sa->map_off);
+    sa->map_off = 0;
+    sa->map_tid = -1;
+    sa->map_count = 0;
+}
+
+
+//
+// Sharing of frozen slice arrays among partitionings
+//
+// Partitionings often are structurally identical (same partitioner on same
+// space, re-created after group changes or for different containers).
+// Slice arrays from full partitioner runs are looked up in a hash table of
+// the instance and shared with reference counting. Shared slice arrays are
+// immutable: migration works on a copy (see laik_slicearray_unshare).
+
+// hash over task ids and slice borders, as compared by isEqual (FNV-1a)
+static uint64_t hashSlices(Laik_SliceArray* sa)
+{
+    int dims = sa->space->dims;
+    uint64_t h = 14695981039346656037ULL;
+#define HASH(v) h = (h ^ (uint64_t)(v)) * 1099511628211ULL
+    HASH(sa->tid_count);
+    HASH(sa->count);
+    for(unsigned int i = 0; i < sa->count; i++) {
+        Laik_TaskSlice_Gen* ts = &(sa->tslice[i]);
+        HASH(ts->task);
+        for(int d = 0; d < dims; d++) {
+            HASH(ts->s.from.i[d]);
+            HASH(ts->s.to.i[d]);
+        }
+    }
+#undef HASH
+    return h;
+}
+
+// are <sa1> and <sa2> identical in every aspect stored?
+static bool isIdentical(Laik_SliceArray* sa1, Laik_SliceArray* sa2)
+{
+    if (sa1->hash != sa2->hash) return false;
+    if (sa1->shareTid != sa2->shareTid) return false;
+    if (!laik_slicearray_isEqual(sa1, sa2)) return false;
+    for(unsigned int i = 0; i < sa1->count; i++) {
+        Laik_TaskSlice_Gen* ts1 = &(sa1->tslice[i]);
+        Laik_TaskSlice_Gen* ts2 = &(sa2->tslice[i]);
+        if ((ts1->tag != ts2->tag) || (ts1->mapNo != ts2->mapNo) ||
+            (ts1->data != ts2->data))
+            return false;
+    }
+    return true;
+}
+
+static void insertShared(Laik_Instance* inst, Laik_SliceArray* sa)
+{
+    unsigned int b = (unsigned int) (sa->hash % inst->saTableSize);
+    sa->nextShared = inst->saTable[b];
+    inst->saTable[b] = sa;
+}
+
+static void removeShared(Laik_Instance* inst, Laik_SliceArray* sa)
+{
+    // table may be gone already after laik_finalize
+    if (inst->saTableSize == 0) return;
+
+    Laik_SliceArray** p = &(inst->saTable[sa->hash % inst->saTableSize]);
+    while(*p) {
+        if (*p == sa) {
+            *p = sa->nextShared;
+            sa->nextShared = 0;
+            inst->saTableCount--;
+            return;
+        }
+        p = &((*p)->nextShared);
+    }
+}
+
+Laik_SliceArray* laik_slicearray_intern(Laik_SliceArray* sa, int tid)
+{
+    assert(sa->off != 0);
+    assert(sa->refcount == 0);
+    Laik_Instance* inst = sa->space->inst;
+
+    // slices with attached data belong to one partitioning
+    for(unsigned int i = 0; i < sa->count; i++)
+        if (sa->tslice[i].data) return sa;
+
+    sa->shareTid = tid;
+    sa->hash = hashSlices(sa);
+    if (inst->saTableSize > 0) {
+        Laik_SliceArray* s = inst->saTable[sa->hash % inst->saTableSize];
+        for(; s; s = s->nextShared) {
+            if (!isIdentical(s, sa)) continue;
+
+            s->refcount++;
+            laik_log(1, "sharing slice array (%d slices, space '%s'): %d users",
+                     s->count, s->space->name, s->refcount);
+            laik_slicearray_free(sa);
+            free(sa);
+            return s;
+        }
+    }
+
+    // enlarge hash table if needed, keeping load factor below 1
+    if (inst->saTableCount >= inst->saTableSize) {
+        Laik_SliceArray** old = inst->saTable;
+        unsigned int oldSize = inst->saTableSize;
+        inst->saTableSize = oldSize ? 2 * oldSize : 64;
+        inst->saTable = calloc(inst->saTableSize, sizeof(Laik_SliceArray*));
+        if (!inst->saTable) {
+            laik_panic("Out of memory allocating table for shared slice arrays");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        for(unsigned int i = 0; i < oldSize; i++) {
+            Laik_SliceArray* s = old[i];
+            while(s) {
+                Laik_SliceArray* next = s->nextShared;
+                insertShared(inst, s);
+                s = next;
+            }
+        }
+        free(old);
+    }
+    insertShared(inst, sa);
+    inst->saTableCount++;
+    sa->refcount = 1;
+
+    return sa;
+}
+
+void laik_slicearray_release(Laik_SliceArray* sa)
+{
+    if (sa->refcount > 0) {
+        sa->refcount--;
+        if (sa->refcount > 0) return;
+        removeShared(sa->space->inst, sa);
+    }
+    laik_slicearray_free(sa);
+    free(sa);
+}
+
+Laik_SliceArray* laik_slicearray_unshare(Laik_SliceArray* sa)
+{
+    if (sa->refcount == 0) return sa;
+    if (sa->refcount == 1) {
+        // only user: just remove from table
+        removeShared(sa->space->inst, sa);
+        sa->refcount = 0;
+        sa->shareTid = -1;
+        return sa;
+    }
+
+    // copy without lazily calculated data
+    assert(sa->tss1d == 0);
+    Laik_SliceArray* copy = laik_slicearray_new(sa->space, sa->tid_count);
+    copy->capacity = sa->count;
+    copy->count = sa->count;
+    copy->tslice = malloc(sizeof(Laik_TaskSlice_Gen) * (sa->count + 1));
+    copy->off = malloc(sizeof(int) * (sa->tid_count + 1));
+    if ((copy->tslice == 0) || (copy->off == 0)) {
+        laik_panic("Out of memory copying Laik_SliceArray object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    memcpy(copy->tslice, sa->tslice, sizeof(Laik_TaskSlice_Gen) * sa->count);
+    memcpy(copy->off, sa->off, sizeof(int) * (sa->tid_count + 1));
+
+    sa->refcount--;
+    return copy;
+}
+
+
+//
+// Spatial index for intersection queries
+//
+// A bounding volume hierarchy over the slices of a frozen slice array.
+// Each node splits its slices at the median of slice centers along the
+// dimension where its bounding box is largest. With this, finding the
+// slices intersecting a given one only visits nodes overlapping with it,
+// instead of checking all slices of all tasks.
+//
+
+// below this number of slices, queries just check all slices
+#define SLICEINDEX_MINCOUNT 32
+// maximum number of slices in a leaf
+#define SLICEINDEX_LEAFSIZE 4
+
+static
+void freeIndex(Laik_SliceArray* sa)
+{
+    if (!sa->index) return;
+
+    free(sa->index->node);
+    free(sa->index->order);
+    free(sa->index);
+    sa->index = 0;
+}
+
+// center of slice <o> in dimension <d>, doubled to stay integer
+static inline
+int64_t sliceCenter2(Laik_SliceArray* sa, unsigned int o, int d)
+{
+    return sa->tslice[o].s.from.i[d] + sa->tslice[o].s.to.i[d];
+}
+
+// reorder <order>[0;count[ such that the slice with k-th smallest center in
+// dimension <d> is at position k, with smaller ones before and larger after
+static
+void selectByCenter(Laik_SliceArray* sa, unsigned int* order,
+                    unsigned int count, int64_t k, int d)
+{
+    int64_t lo = 0, hi = count - 1;
+    while(lo < hi) {
+        int64_t pivot = sliceCenter2(sa, order[(lo + hi) / 2], d);
+        int64_t i = lo, j = hi;
+        while(i <= j) {
+            while(sliceCenter2(sa, order[i], d) < pivot) i++;
+            while(sliceCenter2(sa, order[j], d) > pivot) j--;
+            if (i <= j) {
+                unsigned int tmp = order[i];
+                order[i] = order[j];
+                order[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+        // now [lo;j] <= pivot, [i;hi] >= pivot, in-between == pivot
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+}
+
+static
+void buildIndexNode(Laik_SliceArray* sa, Laik_SliceIndex* idx, unsigned int n)
+{
+    int dims = sa->space->dims;
+    Laik_SliceIndexNode* node = &(idx->node[n]);
+    unsigned int* order = idx->order + node->first;
+
+    // bounding box
+    node->from = sa->tslice[order[0]].s.from;
+    node->to = sa->tslice[order[0]].s.to;
+    for(unsigned int i = 1; i < node->count; i++) {
+        Laik_Slice* s = &(sa->tslice[order[i]].s);
+        for(int d = 0; d < dims; d++) {
+            if (s->from.i[d] < node->from.i[d]) node->from.i[d] = s->from.i[d];
+            if (s->to.i[d] > node->to.i[d]) node->to.i[d] = s->to.i[d];
+        }
+    }
+
+    node->child = 0;
+    if (node->count <= SLICEINDEX_LEAFSIZE) return;
+
+    int splitDim = 0;
+    for(int d = 1; d < dims; d++)
+        if (node->to.i[d] - node->from.i[d] >
+            node->to.i[splitDim] - node->from.i[splitDim]) splitDim = d;
+
+    unsigned int half = node->count / 2;
+    selectByCenter(sa, order, node->count, half, splitDim);
+
+    unsigned int c = idx->nodeCount;
+    idx->nodeCount += 2;
+    node->child = c;
+    idx->node[c].first = node->first;
+    idx->node[c].count = half;
+    idx->node[c + 1].first = node->first + half;
+    idx->node[c + 1].count = node->count - half;
+
+    buildIndexNode(sa, idx, c);
+    buildIndexNode(sa, idx, c + 1);
+}
+
+static
+Laik_SliceIndex* buildIndex(Laik_SliceArray* sa)
+{
+    assert(sa->off != 0);
+
+    Laik_SliceIndex* idx = malloc(sizeof(Laik_SliceIndex));
+    unsigned int* order = malloc(sa->count * sizeof(unsigned int));
+    // a binary tree with <count> leaves has less than 2 * <count> nodes
+    Laik_SliceIndexNode* node = malloc(2 * sa->count * sizeof(Laik_SliceIndexNode));
+    if (!idx || !order || !node) {
+        laik_panic("Out of memory allocating index for Laik_SliceArray");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    // empty slices are indexed, too: same result as laik_slice_intersect
+    unsigned int count = sa->count;
+    for(unsigned int o = 0; o < count; o++)
+        order[o] = o;
+
+    idx->order = order;
+    idx->node = node;
+    idx->nodeCount = 1;
+    node[0].first = 0;
+    node[0].count = count;
+
+    if (count > 0)
+        buildIndexNode(sa, idx, 0);
+
+    laik_log(1, "slice array index: %u nodes for %u slices",
+             idx->nodeCount, count);
+    return idx;
+}
+
+// slice arrays may be queried concurrently (e.g. when calculating
+// transitions for multiple containers in parallel): build index only once
+static pthread_mutex_t indexLock = PTHREAD_MUTEX_INITIALIZER;
+
+static
+Laik_SliceIndex* getIndex(Laik_SliceArray* sa)
+{
+    Laik_SliceIndex* idx = __atomic_load_n(&(sa->index), __ATOMIC_ACQUIRE);
+    if (idx) return idx;
+
+    pthread_mutex_lock(&indexLock);
+    idx = sa->index;
+    if (!idx) {
+        idx = buildIndex(sa);
+        __atomic_store_n(&(sa->index), idx, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&indexLock);
+    return idx;
+}
+
+static
+bool overlaps(int dims, const Laik_Index* from1, const Laik_Index* to1,
+              const Laik_Index* from2, const Laik_Index* to2)
+{
+    for(int d = 0; d < dims; d++) {
+        if (from1->i[d] >= to2->i[d]) return false;
+        if (from2->i[d] >= to1->i[d]) return false;
+    }
+    return true;
+}
+
+static
+void appendResult(unsigned int o, unsigned int count,
+                  unsigned int** res, unsigned int* resSize)
+{
+    if (count == *resSize) {
+        *resSize = (*resSize + 20) * 2;
+        *res = realloc(*res, *resSize * sizeof(unsigned int));
+        if (!*res) {
+            laik_panic("Out of memory allocating slice query results");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+    }
+    (*res)[count] = o;
+}
+
+static
+int cmpOffset(const void* p1, const void* p2)
+{
+    unsigned int o1 = *(const unsigned int*) p1;
+    unsigned int o2 = *(const unsigned int*) p2;
+    return (o1 > o2) - (o1 < o2);
+}
+
+// get offsets of slices in frozen <sa> intersecting with <s>, ascending.
+// offsets are written into <*res>, enlarged if needed; returns count
+unsigned int laik_slicearray_intersecting(Laik_SliceArray* sa,
+                                          const Laik_Slice* s,
+                                          unsigned int** res,
+                                          unsigned int* resSize)
+{
+    assert(sa->off != 0);
+    assert(sa->tss1d == 0);
+
+    int dims = sa->space->dims;
+    unsigned int count = 0;
+
+    if (sa->count < SLICEINDEX_MINCOUNT) {
+        for(unsigned int o = 0; o < sa->count; o++) {
+            if (!laik_slice_intersect(&(sa->tslice[o].s), s)) continue;
+            appendResult(o, count++, res, resSize);
+        }
+        return count;
+    }
+
+    Laik_SliceIndex* idx = getIndex(sa);
+    if (idx->node[0].count == 0) return 0;
+
+    // median split: depth is bounded by log2 of slice count
+    unsigned int stack[64];
+    int sp = 0;
+    stack[sp++] = 0;
+    while(sp > 0) {
+        Laik_SliceIndexNode* node = &(idx->node[stack[--sp]]);
+        if (!overlaps(dims, &(node->from), &(node->to), &(s->from), &(s->to)))
+            continue;
+
+        if (node->child > 0) {
+            assert(sp + 2 <= 64);
+            stack[sp++] = node->child + 1;
+            stack[sp++] = node->child;
+            continue;
+        }
+        for(unsigned int i = node->first; i < node->first + node->count; i++) {
+            Laik_Slice* s2 = &(sa->tslice[idx->order[i]].s);
+            if (!overlaps(dims, &(s2->from), &(s2->to), &(s->from), &(s->to)))
+                continue;
+            appendResult(idx->order[i], count++, res, resSize);
+        }
+    }
+
+    qsort(*res, count, sizeof(unsigned int), cmpOffset);
+    return count;
 }
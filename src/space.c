@@ -175,9 +175,10 @@ bool intersectRange(int64_t from1, int64_t to1, int64_t from2, int64_t to2,
 }
 
 // get the intersection of 2 slices; return 0 if intersection is empty
+// the result is valid until the next call from the same thread
 Laik_Slice* laik_slice_intersect(const Laik_Slice* s1, const Laik_Slice* s2)
 {
-    static Laik_Slice s;
+    static __thread Laik_Slice s;
 
     // intersection with invalid slice gives invalid slice
     if ((s1->space == 0) || (s2->space == 0)) {
@@ -594,8 +595,8 @@ const Laik_Slice* laik_taskslice_get_slice(Laik_TaskSlice* ts)
 
     if (ts->sa->tss1d) {
         static Laik_Slice slc;
-        int64_t idx = ts->sa->tss1d[ts->no].idx;
-        laik_slice_init_1d(&slc, ts->sa->space, idx, idx + 1);
+        Laik_TaskSlice_Single1d* tss = &(ts->sa->tss1d[ts->no]);
+        laik_slice_init_1d(&slc, ts->sa->space, tss->idx, tss->idx + tss->len);
         return &slc;
     }
     return 0;
@@ -653,6 +654,8 @@ void laik_taskslice_set_data(Laik_TaskSlice* ts, void* data)
     assert(ts && ts->sa);
     // does the partitioning store slices as single indexes? No data to set!
     assert(ts->sa->tss1d == 0);
+    // shared slice arrays are immutable
+    assert(ts->sa->refcount == 0);
 
     Laik_TaskSlice_Gen* tsg = &(ts->sa->tslice[ts->no]);
     tsg->data = data;
@@ -690,34 +693,122 @@ bool laik_index_global2local(Laik_Partitioning* p,
 #define DEBUG_REDUCTIONSLICES 1
 
 
-static TaskGroup* groupList = 0;
-static int groupListSize = 0, groupListCount = 0;
+// only for 1d
+typedef struct _SliceBorder {
+    int64_t b;
+    int task;
+    int sliceNo, mapNo;
+    unsigned int isStart :1;
+    unsigned int isInput :1;
+} SliceBorder;
+
+// send/recv candidates found by slice array queries, sorted before
+// appending to get same order as iterating over tasks
+struct transPair {
+    int task;
+    unsigned int o1, o2;
+};
+
+// temporary buffers used when calculating a transition.
+// Each calculation uses its own context, thus transitions can be
+// calculated concurrently (e.g. for different containers by different
+// threads, see laik_calc_transitions)
+typedef struct _TransCalc {
+    struct localTOp *localBuf;
+    struct initTOp  *initBuf;
+    struct sendTOp  *sendBuf;
+    struct recvTOp  *recvBuf;
+    struct redTOp   *redBuf;
+    int localBufSize, localBufCount;
+    int initBufSize, initBufCount;
+    int sendBufSize, sendBufCount;
+    int recvBufSize, recvBufCount;
+    int redBufSize, redBufCount;
+
+    // sub-groups referenced by reduction operations
+    TaskGroup* groupList;
+    int groupListSize, groupListCount;
+
+    // slice borders, see calcAddReductions
+    SliceBorder* borderList;
+    int borderListSize, borderListCount;
+
+    struct transPair *pairBuf;
+    int pairBufSize, pairBufCount;
+
+    // results of slice array queries
+    unsigned int *queryBuf;
+    unsigned int queryBufSize;
+
+    // offsets of dependencies, see collectDeps
+    unsigned int *depBuf;
+    int depBufSize, depBufCount;
+
+    // changed tasks, see laik_calc_transition_update
+    int *changedBuf;
+    int changedBufSize, changedBufCount;
+} TransCalc;
 
 static
-void cleanGroupList()
+void initTransCalc(TransCalc* tc)
 {
-    for(int i = 0; i < groupListCount; i++)
-        free(groupList[i].task);
-    groupListCount = 0;
+    memset(tc, 0, sizeof(TransCalc));
+}
 
-    // we keep the groupList array
+static
+void cleanTOpBufs(TransCalc* tc)
+{
+    tc->localBufCount = 0;
+    tc->initBufCount = 0;
+    tc->sendBufCount = 0;
+    tc->recvBufCount = 0;
+    tc->redBufCount = 0;
+    tc->pairBufCount = 0;
 }
 
 static
-TaskGroup* newTaskGroup(int* group)
+void cleanGroupList(TransCalc* tc)
 {
-    if (groupListCount == groupListSize) {
+    for(int i = 0; i < tc->groupListCount; i++)
+        free(tc->groupList[i].task);
+    tc->groupListCount = 0;
+
+    // we keep the group list array
+}
+
+static
+void freeTransCalc(TransCalc* tc)
+{
+    cleanGroupList(tc);
+    free(tc->groupList);
+    free(tc->borderList);
+    free(tc->localBuf);
+    free(tc->initBuf);
+    free(tc->sendBuf);
+    free(tc->recvBuf);
+    free(tc->redBuf);
+    free(tc->pairBuf);
+    free(tc->queryBuf);
+    free(tc->depBuf);
+    free(tc->changedBuf);
+    initTransCalc(tc);
+}
+
+static
+TaskGroup* newTaskGroup(TransCalc* tc, int* group)
+{
+    if (tc->groupListCount == tc->groupListSize) {
         // enlarge group list
-        groupListSize = (groupListSize + 10) * 2;
-        groupList = realloc(groupList, groupListSize * sizeof(TaskGroup));
-        if (!groupList) {
+        tc->groupListSize = (tc->groupListSize + 10) * 2;
+        tc->groupList = realloc(tc->groupList, tc->groupListSize * sizeof(TaskGroup));
+        if (!tc->groupList) {
             laik_panic("Out of memory allocating memory for Laik_Transition");
             exit(1); // not actually needed, laik_panic never returns
         }
     }
-    TaskGroup* g = &(groupList[groupListCount]);
-    if (group) *group = groupListCount;
-    groupListCount++;
+    TaskGroup* g = &(tc->groupList[tc->groupListCount]);
+    if (group) *group = tc->groupListCount;
+    tc->groupListCount++;
 
     g->count = 0; // invalid
     g->task = 0;
@@ -725,15 +816,15 @@ TaskGroup* newTaskGroup(int* group)
     return g;
 }
 
-static int getTaskGroupSingle(int task)
+static int getTaskGroupSingle(TransCalc* tc, int task)
 {
     // already existing?
-    for(int i = 0; i < groupListCount; i++)
-        if ((groupList[i].count == 1) && (groupList[i].task[0] == task))
+    for(int i = 0; i < tc->groupListCount; i++)
+        if ((tc->groupList[i].count == 1) && (tc->groupList[i].task[0] == task))
             return i;
 
     int group;
-    TaskGroup* g = newTaskGroup(&group);
+    TaskGroup* g = newTaskGroup(tc, &group);
 
     g->count = 1;
     g->task = malloc(sizeof(int));
@@ -743,21 +834,21 @@ static int getTaskGroupSingle(int task)
     return group;
 }
 
-// append given task group if not already in groupList, return index
-static int getTaskGroup(TaskGroup* tg)
+// append given task group if not already in group list, return index
+static int getTaskGroup(TransCalc* tc, TaskGroup* tg)
 {
     // already existing?
     int i, j;
-    for(i = 0; i < groupListCount; i++) {
-        if (tg->count != groupList[i].count) continue;
+    for(i = 0; i < tc->groupListCount; i++) {
+        if (tg->count != tc->groupList[i].count) continue;
         for(j = 0; j < tg->count; j++)
-            if (tg->task[j] != groupList[i].task[j]) break;
+            if (tg->task[j] != tc->groupList[i].task[j]) break;
         if (j == tg->count)
             return i; // found
     }
 
     int group;
-    TaskGroup* g = newTaskGroup(&group);
+    TaskGroup* g = newTaskGroup(tc, &group);
 
     g->count = tg->count;
     int tsize = tg->count * sizeof(int);
@@ -769,48 +860,36 @@ static int getTaskGroup(TaskGroup* tg)
 }
 
 
-// only for 1d
-typedef struct _SliceBorder {
-    int64_t b;
-    int task;
-    int sliceNo, mapNo;
-    unsigned int isStart :1;
-    unsigned int isInput :1;
-} SliceBorder;
-
-static SliceBorder* borderList = 0;
-int borderListSize = 0, borderListCount = 0;
-
 static
-void cleanBorderList()
+void cleanBorderList(TransCalc* tc)
 {
-    borderListCount = 0;
+    tc->borderListCount = 0;
 }
 
 static
-void freeBorderList()
+void freeBorderList(TransCalc* tc)
 {
-    free(borderList);
-    borderList = 0;
-    borderListCount = 0;
-    borderListSize = 0;
+    free(tc->borderList);
+    tc->borderList = 0;
+    tc->borderListCount = 0;
+    tc->borderListSize = 0;
 }
 
 static
-void appendBorder(int64_t b, int task, int sliceNo, int mapNo,
+void appendBorder(TransCalc* tc, int64_t b, int task, int sliceNo, int mapNo,
                   bool isStart, bool isInput)
 {
-    if (borderListCount == borderListSize) {
+    if (tc->borderListCount == tc->borderListSize) {
         // enlarge list
-        borderListSize = (borderListSize + 10) * 2;
-        borderList = realloc(borderList, borderListSize * sizeof(SliceBorder));
-        if (!borderList) {
+        tc->borderListSize = (tc->borderListSize + 10) * 2;
+        tc->borderList = realloc(tc->borderList, tc->borderListSize * sizeof(SliceBorder));
+        if (!tc->borderList) {
             laik_panic("Out of memory allocating memory for Laik_Transition");
             exit(1); // not actually needed, laik_panic never returns
         }
     }
-    SliceBorder *sb = &(borderList[borderListCount]);
-    borderListCount++;
+    SliceBorder *sb = &(tc->borderList[tc->borderListCount]);
+    tc->borderListCount++;
 
     sb->b = b;
     sb->task = task;
@@ -884,51 +963,60 @@ static bool isInTaskGroup(TaskGroup* g, int task)
 }
 
 
-// temporary buffers used when calculating a transition
-static struct localTOp *localBuf = 0;
-static struct initTOp  *initBuf = 0;
-static struct sendTOp  *sendBuf = 0;
-static struct recvTOp  *recvBuf = 0;
-static struct redTOp   *redBuf = 0;
-static int localBufSize = 0, localBufCount = 0;
-static int initBufSize = 0, initBufCount = 0;
-static int sendBufSize = 0, sendBufCount = 0;
-static int recvBufSize = 0, recvBufCount = 0;
-static int redBufSize = 0, redBufCount = 0;
-
 static
-void cleanTOpBufs(bool doFree)
+void appendPair(TransCalc* tc, int task, unsigned int o1, unsigned int o2)
 {
-    localBufCount = 0;
-    initBufCount = 0;
-    sendBufCount = 0;
-    recvBufCount = 0;
-    redBufCount = 0;
-    if (doFree) {
-        free(localBuf); localBufSize = 0;
-        free(initBuf); initBufSize = 0;
-        free(sendBuf); sendBufSize = 0;
-        free(recvBuf); recvBufSize = 0;
-        free(redBuf); redBufSize = 0;
+    if (tc->pairBufCount == tc->pairBufSize) {
+        // enlarge temp buffer
+        tc->pairBufSize = (tc->pairBufSize + 20) * 2;
+        tc->pairBuf = realloc(tc->pairBuf, tc->pairBufSize * sizeof(struct transPair));
+        if (!tc->pairBuf) {
+            laik_panic("Out of memory allocating memory for Laik_Transition");
+            exit(1); // not actually needed, laik_panic never returns
+        }
     }
+    struct transPair* p = &(tc->pairBuf[tc->pairBufCount]);
+    tc->pairBufCount++;
+
+    p->task = task;
+    p->o1 = o1;
+    p->o2 = o2;
+}
+
+// does <task> have a slice equal to <slc> in <sa>?
+static bool hasEqualSlice(Laik_SliceArray* sa, int task, Laik_Slice* slc)
+{
+    for(unsigned int o = sa->off[task]; o < sa->off[task+1]; o++)
+        if (laik_slice_isEqual(slc, &(sa->tslice[o].s))) return true;
+    return false;
+}
+
+static int pair_cmp(const void *p1, const void *p2)
+{
+    const struct transPair* tp1 = (const struct transPair*) p1;
+    const struct transPair* tp2 = (const struct transPair*) p2;
+    if (tp1->task != tp2->task) return tp1->task - tp2->task;
+    if (tp1->o1 != tp2->o1) return (tp1->o1 < tp2->o1) ? -1 : 1;
+    if (tp1->o2 != tp2->o2) return (tp1->o2 < tp2->o2) ? -1 : 1;
+    return 0;
 }
 
 static
-struct localTOp* appendLocalTOp(Laik_Slice* slc,
+struct localTOp* appendLocalTOp(TransCalc* tc, Laik_Slice* slc,
                                 int fromSliceNo, int toSliceNo,
                                 int fromMapNo, int toMapNo)
 {
-    if (localBufCount == localBufSize) {
+    if (tc->localBufCount == tc->localBufSize) {
         // enlarge temp buffer
-        localBufSize = (localBufSize + 20) * 2;
-        localBuf = realloc(localBuf, localBufSize * sizeof(struct localTOp));
-        if (!localBuf) {
+        tc->localBufSize = (tc->localBufSize + 20) * 2;
+        tc->localBuf = realloc(tc->localBuf, tc->localBufSize * sizeof(struct localTOp));
+        if (!tc->localBuf) {
             laik_panic("Out of memory allocating memory for Laik_Transition");
             exit(1); // not actually needed, laik_panic never returns
         }
     }
-    struct localTOp* op = &(localBuf[localBufCount]);
-    localBufCount++;
+    struct localTOp* op = &(tc->localBuf[tc->localBufCount]);
+    tc->localBufCount++;
 
     op->slc = *slc;
     op->fromSliceNo = fromSliceNo;
@@ -940,21 +1028,21 @@ struct localTOp* appendLocalTOp(Laik_Slice* slc,
 }
 
 static
-struct initTOp* appendInitTOp(Laik_Slice* slc,
+struct initTOp* appendInitTOp(TransCalc* tc, Laik_Slice* slc,
                               int sliceNo, int mapNo,
                               Laik_ReductionOperation redOp)
 {
-    if (initBufCount == initBufSize) {
+    if (tc->initBufCount == tc->initBufSize) {
         // enlarge temp buffer
-        initBufSize = (initBufSize + 20) * 2;
-        initBuf = realloc(initBuf, initBufSize * sizeof(struct initTOp));
-        if (!initBuf) {
+        tc->initBufSize = (tc->initBufSize + 20) * 2;
+        tc->initBuf = realloc(tc->initBuf, tc->initBufSize * sizeof(struct initTOp));
+        if (!tc->initBuf) {
             laik_panic("Out of memory allocating memory for Laik_Transition");
             exit(1); // not actually needed, laik_panic never returns
         }
     }
-    struct initTOp* op = &(initBuf[initBufCount]);
-    initBufCount++;
+    struct initTOp* op = &(tc->initBuf[tc->initBufCount]);
+    tc->initBufCount++;
 
     op->slc = *slc;
     op->sliceNo = sliceNo;
@@ -965,20 +1053,20 @@ struct initTOp* appendInitTOp(Laik_Slice* slc,
 }
 
 static
-struct sendTOp* appendSendTOp(Laik_Slice* slc,
+struct sendTOp* appendSendTOp(TransCalc* tc, Laik_Slice* slc,
                               int sliceNo, int mapNo, int toTask)
 {
-    if (sendBufCount == sendBufSize) {
+    if (tc->sendBufCount == tc->sendBufSize) {
         // enlarge temp buffer
-        sendBufSize = (sendBufSize + 20) * 2;
-        sendBuf = realloc(sendBuf, sendBufSize * sizeof(struct sendTOp));
-        if (!sendBuf) {
+        tc->sendBufSize = (tc->sendBufSize + 20) * 2;
+        tc->sendBuf = realloc(tc->sendBuf, tc->sendBufSize * sizeof(struct sendTOp));
+        if (!tc->sendBuf) {
             laik_panic("Out of memory allocating memory for Laik_Transition");
             exit(1); // not actually needed, laik_panic never returns
         }
     }
-    struct sendTOp* op = &(sendBuf[sendBufCount]);
-    sendBufCount++;
+    struct sendTOp* op = &(tc->sendBuf[tc->sendBufCount]);
+    tc->sendBufCount++;
 
     op->slc = *slc;
     op->sliceNo = sliceNo;
@@ -989,20 +1077,20 @@ struct sendTOp* appendSendTOp(Laik_Slice* slc,
 }
 
 static
-struct recvTOp* appendRecvTOp(Laik_Slice* slc,
+struct recvTOp* appendRecvTOp(TransCalc* tc, Laik_Slice* slc,
                               int sliceNo, int mapNo, int fromTask)
 {
-    if (recvBufCount == recvBufSize) {
+    if (tc->recvBufCount == tc->recvBufSize) {
         // enlarge temp buffer
-        recvBufSize = (recvBufSize + 20) * 2;
-        recvBuf = realloc(recvBuf, recvBufSize * sizeof(struct recvTOp));
-        if (!recvBuf) {
+        tc->recvBufSize = (tc->recvBufSize + 20) * 2;
+        tc->recvBuf = realloc(tc->recvBuf, tc->recvBufSize * sizeof(struct recvTOp));
+        if (!tc->recvBuf) {
             laik_panic("Out of memory allocating memory for Laik_Transition");
             exit(1); // not actually needed, laik_panic never returns
         }
     }
-    struct recvTOp* op = &(recvBuf[recvBufCount]);
-    recvBufCount++;
+    struct recvTOp* op = &(tc->recvBuf[tc->recvBufCount]);
+    tc->recvBufCount++;
 
     op->slc = *slc;
     op->sliceNo = sliceNo;
@@ -1013,23 +1101,23 @@ struct recvTOp* appendRecvTOp(Laik_Slice* slc,
 }
 
 static
-struct redTOp* appendRedTOp(Laik_Slice* slc,
+struct redTOp* appendRedTOp(TransCalc* tc, Laik_Slice* slc,
                             Laik_ReductionOperation redOp,
                             int inputGroup, int outputGroup,
                             int myInputSliceNo, int myOutputSliceNo,
                             int myInputMapNo, int myOutputMapNo)
 {
-    if (redBufCount == redBufSize) {
+    if (tc->redBufCount == tc->redBufSize) {
         // enlarge temp buffer
-        redBufSize = (redBufSize + 20) * 2;
-        redBuf = realloc(redBuf, redBufSize * sizeof(struct redTOp));
-        if (!redBuf) {
+        tc->redBufSize = (tc->redBufSize + 20) * 2;
+        tc->redBuf = realloc(tc->redBuf, tc->redBufSize * sizeof(struct redTOp));
+        if (!tc->redBuf) {
             laik_panic("Out of memory allocating memory for Laik_Transition");
             exit(1); // not actually needed, laik_panic never returns
         }
     }
-    struct redTOp* op = &(redBuf[redBufCount]);
-    redBufCount++;
+    struct redTOp* op = &(tc->redBuf[tc->redBufCount]);
+    tc->redBufCount++;
 
     op->slc = *slc;
     op->redOp = redOp;
@@ -1059,7 +1147,7 @@ bool oneInputIsCopy(Laik_ReductionOperation redOp)
 // TODO: we only support one mapping in each task for reductions
 //       better: support multiple mappings for same index in same task
 static
-void calcAddReductions(int tflags,
+void calcAddReductions(TransCalc* tc, int tflags,
                        Laik_Group* group,
                        Laik_ReductionOperation redOp,
                        Laik_Partitioning* fromP, Laik_Partitioning* toP)
@@ -1086,7 +1174,7 @@ void calcAddReductions(int tflags,
     }
 
     // add slice borders of all tasks
-    cleanBorderList();
+    cleanBorderList(tc);
     int sliceNo, lastTask, lastMapNo;
     sliceNo = 0;
     lastTask = -1;
@@ -1108,8 +1196,8 @@ void calcAddReductions(int tflags,
 #endif
             continue;
         }
-        appendBorder(ts->s.from.i[0], ts->task, sliceNo, ts->mapNo, true, true);
-        appendBorder(ts->s.to.i[0], ts->task, sliceNo, ts->mapNo, false, true);
+        appendBorder(tc, ts->s.from.i[0], ts->task, sliceNo, ts->mapNo, true, true);
+        appendBorder(tc, ts->s.to.i[0], ts->task, sliceNo, ts->mapNo, false, true);
         sliceNo++;
     }
     lastTask = -1;
@@ -1131,15 +1219,15 @@ void calcAddReductions(int tflags,
 #endif
             continue;
         }
-        appendBorder(ts->s.from.i[0], ts->task, sliceNo, ts->mapNo, true, false);
-        appendBorder(ts->s.to.i[0], ts->task, sliceNo, ts->mapNo, false, false);
+        appendBorder(tc, ts->s.from.i[0], ts->task, sliceNo, ts->mapNo, true, false);
+        appendBorder(tc, ts->s.to.i[0], ts->task, sliceNo, ts->mapNo, false, false);
         sliceNo++;
     }
 
-    if (borderListCount == 0) return;
+    if (tc->borderListCount == 0) return;
 
     // order by border to travers in border order
-    qsort(borderList, borderListCount, sizeof(SliceBorder), sb_cmp);
+    qsort(tc->borderList, tc->borderListCount, sizeof(SliceBorder), sb_cmp);
 
 #define MAX_TASKS 65536
     int inputTask[MAX_TASKS], outputTask[MAX_TASKS];
@@ -1161,8 +1249,8 @@ void calcAddReductions(int tflags,
     // all slices are from same space
     slc.space = fromP->space;
 
-    for(int i = 0; i < borderListCount; i++) {
-        SliceBorder* sb = &(borderList[i]);
+    for(int i = 0; i < tc->borderListCount; i++) {
+        SliceBorder* sb = &(tc->borderList[i]);
 
 #ifdef DEBUG_REDUCTIONSLICES
         laik_log(1, "at border %lld, task %d (slice %d, map %d): %s for %s",
@@ -1203,9 +1291,9 @@ void calcAddReductions(int tflags,
         }
         assert(isOk);
 
-        if ((i < borderListCount - 1) && (borderList[i + 1].b > sb->b)) {
+        if ((i < tc->borderListCount - 1) && (tc->borderList[i + 1].b > sb->b)) {
             // about to leave a range with given input/output tasks
-            int64_t nextBorder = borderList[i + 1].b;
+            int64_t nextBorder = tc->borderList[i + 1].b;
 
 #ifdef DEBUG_REDUCTIONSLICES
             char* act[] = {"(none)", "input", "output", "in & out"};
@@ -1233,7 +1321,7 @@ void calcAddReductions(int tflags,
                             (outputGroup.task[0] == myid)) {
 
                             // local (copy) operation
-                            appendLocalTOp(&slc,
+                            appendLocalTOp(tc, &slc,
                                            myInputSliceNo, myOutputSliceNo,
                                            myInputMapNo, myOutputMapNo);
 #ifdef DEBUG_REDUCTIONSLICES
@@ -1252,7 +1340,7 @@ void calcAddReductions(int tflags,
                             for(int out = 0; out < outputGroup.count; out++) {
                                 if (outputGroup.task[out] == myid) {
                                     // local (copy) operation
-                                    appendLocalTOp(&slc,
+                                    appendLocalTOp(tc, &slc,
                                                    myInputSliceNo, myOutputSliceNo,
                                                    myInputMapNo, myOutputMapNo);
 #ifdef DEBUG_REDUCTIONSLICES
@@ -1267,7 +1355,7 @@ void calcAddReductions(int tflags,
                                 }
 
                                 // send operation
-                                appendSendTOp(&slc,
+                                appendSendTOp(tc, &slc,
                                               myInputSliceNo, myInputMapNo,
                                               outputGroup.task[out]);
 #ifdef DEBUG_REDUCTIONSLICES
@@ -1289,7 +1377,7 @@ void calcAddReductions(int tflags,
                                 if (outputGroup.task[out] != myid) continue;
 
                                 // receive operation
-                                appendRecvTOp(&slc,
+                                appendRecvTOp(tc, &slc,
                                               myOutputSliceNo, myOutputMapNo,
                                               inputGroup.task[0]);
 
@@ -1310,21 +1398,21 @@ void calcAddReductions(int tflags,
                 } // one input
 
                 // add reduction operation
-                int in = getTaskGroup(&inputGroup);
-                int out = getTaskGroup(&outputGroup);
+                int in = getTaskGroup(tc, &inputGroup);
+                int out = getTaskGroup(tc, &outputGroup);
 
 #ifdef DEBUG_REDUCTIONSLICES
                 laik_log_begin(1);
                 laik_log_append("  adding reduction (%lu - %lu), in %d:(",
                                 slc.from.i[0], slc.to.i[0], in);
-                for(int i = 0; i < groupList[in].count; i++) {
+                for(int i = 0; i < tc->groupList[in].count; i++) {
                     if (i > 0) laik_log_append(",");
-                    laik_log_append("T%d", groupList[in].task[i]);
+                    laik_log_append("T%d", tc->groupList[in].task[i]);
                 }
                 laik_log_append("), out %d:(", out);
-                for(int i = 0; i < groupList[out].count; i++) {
+                for(int i = 0; i < tc->groupList[out].count; i++) {
                     if (i > 0) laik_log_append(",");
-                    laik_log_append("T%d", groupList[out].task[i]);
+                    laik_log_append("T%d", tc->groupList[out].task[i]);
                 }
                 laik_log_flush("), in %d/%d out %d/%d (slc/map)",
                                myInputSliceNo, myInputMapNo,
@@ -1332,11 +1420,11 @@ void calcAddReductions(int tflags,
 #endif
 
                 // convert to all-group if possible
-                if (groupList[in].count == group->size) in = -1;
-                if (groupList[out].count == group->size) out = -1;
+                if (tc->groupList[in].count == group->size) in = -1;
+                if (tc->groupList[out].count == group->size) out = -1;
 
                 assert(redOp != LAIK_RO_None); // must be a real reduction
-                appendRedTOp(&slc, redOp, in, out,
+                appendRedTOp(tc, &slc, redOp, in, out,
                              myInputSliceNo, myOutputSliceNo,
                              myInputMapNo, myOutputMapNo);
             }
@@ -1345,24 +1433,229 @@ void calcAddReductions(int tflags,
     // all tasks should be removed from input/output groups
     assert(inputGroup.count == 0);
     assert(outputGroup.count == 0);
-    freeBorderList();
+    freeBorderList(tc);
 }
 
 static int trans_id = 0;
 
-// Calculate communication required for transitioning between partitionings
-Laik_Transition*
-do_calc_transition(Laik_Space* space,
-                   Laik_Partitioning* fromP, Laik_Partitioning* toP,
-                   Laik_DataFlow flow, Laik_ReductionOperation redOp)
+// allocate a transition object with space for the given number of
+// operations, copying the sub-groups. Everything is allocated in one
+// memory block, to be freed with laik_free_transition.
+// The caller has to fill in the operations and identifying data.
+Laik_Transition* laik_transition_new(int localCount, int initCount,
+                                     int sendCount, int recvCount,
+                                     int redCount,
+                                     int subgroupCount, TaskGroup* subgroup)
+{
+    int localSize = localCount * sizeof(struct localTOp);
+    int initSize  = initCount  * sizeof(struct initTOp);
+    int sendSize  = sendCount  * sizeof(struct sendTOp);
+    int recvSize  = recvCount  * sizeof(struct recvTOp);
+    int redSize   = redCount   * sizeof(struct redTOp);
+    // we copy group list into transition object
+    int gListSize = subgroupCount * sizeof(TaskGroup);
+    int tListSize = 0;
+    for (int i = 0; i < subgroupCount; i++)
+        tListSize += subgroup[i].count * sizeof(int);
+
+    int tsize = sizeof(Laik_Transition) + gListSize + tListSize +
+                localSize + initSize + sendSize + recvSize + redSize;
+    int localOff = sizeof(Laik_Transition);
+    int initOff  = localOff + localSize;
+    int sendOff  = initOff  + initSize;
+    int recvOff  = sendOff  + sendSize;
+    int redOff   = recvOff  + recvSize;
+    int gListOff = redOff   + redSize;
+    int tListOff = gListOff + gListSize;
+    assert(tListOff + tListSize == tsize);
+
+    Laik_Transition* t = malloc(tsize);
+    if (!t) {
+        laik_log(LAIK_LL_Panic,
+                 "Out of memory allocating Laik_Transition object, size %d",
+                 tsize);
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    // transitions may be calculated concurrently
+    t->id = __atomic_fetch_add(&trans_id, 1, __ATOMIC_RELAXED);
+    t->name = strdup("trans-0     ");
+    sprintf(t->name, "trans-%d", t->id);
+
+    t->flags = 0;
+    t->space = 0;
+    t->group = 0;
+    t->fromPartitioning = 0;
+    t->toPartitioning = 0;
+    t->flow = LAIK_DF_None;
+    t->redOp = LAIK_RO_None;
+    t->dims = 0;
+
+    t->actionCount = localCount + initCount +
+                     sendCount + recvCount + redCount;
+    t->local = (struct localTOp*) (((char*)t) + localOff);
+    t->init  = (struct initTOp*)  (((char*)t) + initOff);
+    t->send  = (struct sendTOp*)  (((char*)t) + sendOff);
+    t->recv  = (struct recvTOp*)  (((char*)t) + recvOff);
+    t->red   = (struct redTOp*)   (((char*)t) + redOff);
+    t->subgroup = (TaskGroup*)       (((char*)t) + gListOff);
+    t->localCount = localCount;
+    t->initCount  = initCount;
+    t->sendCount  = sendCount;
+    t->recvCount  = recvCount;
+    t->redCount   = redCount;
+    t->subgroupCount = subgroupCount;
+
+    t->fromDepCount = 0;
+    t->toDepCount = 0;
+    t->fromDep = 0;
+    t->toDep = 0;
+
+    // copy group list and task list of each group into transition object
+    char* tList = ((char*)t) + tListOff;
+    for (int i = 0; i < subgroupCount; i++) {
+        t->subgroup[i].count = subgroup[i].count;
+        t->subgroup[i].task = (int*) tList;
+        tListSize = subgroup[i].count * sizeof(int);
+        memcpy(tList, subgroup[i].task, tListSize);
+        tList += tListSize;
+    }
+    assert(tList == ((char*)t) + tsize);
+
+    return t;
+}
+
+// create transition from operations collected in temporary buffers
+static
+Laik_Transition* newTransitionFromBufs(TransCalc* tc, int tflags,
+                                       Laik_Space* space, Laik_Group* group,
+                                       Laik_Partitioning* fromP,
+                                       Laik_Partitioning* toP,
+                                       Laik_DataFlow flow,
+                                       Laik_ReductionOperation redOp)
+{
+    Laik_Transition* t = laik_transition_new(tc->localBufCount, tc->initBufCount,
+                                             tc->sendBufCount, tc->recvBufCount,
+                                             tc->redBufCount,
+                                             tc->groupListCount, tc->groupList);
+    t->flags = tflags;
+    t->space = space;
+    t->group = group;
+    t->fromPartitioning = fromP;
+    t->toPartitioning = toP;
+    t->flow = flow;
+    t->redOp = redOp;
+    t->dims = space->dims;
+
+    memcpy(t->local, tc->localBuf, tc->localBufCount * sizeof(struct localTOp));
+    memcpy(t->init,  tc->initBuf,  tc->initBufCount  * sizeof(struct initTOp));
+    memcpy(t->send,  tc->sendBuf,  tc->sendBufCount  * sizeof(struct sendTOp));
+    memcpy(t->recv,  tc->recvBuf,  tc->recvBufCount  * sizeof(struct recvTOp));
+    memcpy(t->red,   tc->redBuf,   tc->redBufCount   * sizeof(struct redTOp));
+
+    return t;
+}
+
+// can a transition be calculated incrementally from another one?
+// only supported for preserving data without reduction
+static
+bool isUpdatable(Laik_Partitioning* fromP, Laik_Partitioning* toP,
+                 Laik_DataFlow flow, Laik_ReductionOperation redOp)
+{
+    if ((fromP == 0) || (toP == 0)) return false;
+    if (flow != LAIK_DF_Preserve) return false;
+    return !laik_is_reduction(redOp);
+}
+
+// slice arrays used for calculating transition between <fromP>/<toP>
+static
+void getTransitionSlices(Laik_Partitioning* fromP, Laik_Partitioning* toP,
+                         Laik_SliceArray** fromSA, Laik_SliceArray** toSA)
+{
+    // all slices, if known (see prepareTransitionSlices)
+    *fromSA = laik_partitioning_interslices(fromP, toP);
+    *toSA = laik_partitioning_interslices(toP, fromP);
+    assert(*fromSA && *toSA);
+}
+
+static
+void appendDep(TransCalc* tc, unsigned int o)
+{
+    if (tc->depBufCount == tc->depBufSize) {
+        // enlarge temp buffer
+        tc->depBufSize = (tc->depBufSize + 20) * 2;
+        tc->depBuf = realloc(tc->depBuf, tc->depBufSize * sizeof(unsigned int));
+        if (!tc->depBuf) {
+            laik_panic("Out of memory allocating memory for Laik_Transition");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+    }
+    tc->depBuf[tc->depBufCount++] = o;
+}
+
+static int uint_cmp(const void *p1, const void *p2)
+{
+    unsigned int o1 = *(const unsigned int*) p1;
+    unsigned int o2 = *(const unsigned int*) p2;
+    return (o1 > o2) - (o1 < o2);
+}
+
+// return copy of slices in <sa> operations of task <myid> depend on:
+// own slices, and slices intersecting with own slices in <sa>/<otherSA>.
+// Sorted by task as in <sa>, number written to <count>
+static
+Laik_TaskSlice_Gen* collectDeps(TransCalc* tc,
+                                Laik_SliceArray* sa, Laik_SliceArray* otherSA,
+                                int myid, int* count)
+{
+    unsigned int o, n, i;
+    tc->depBufCount = 0;
+    for(o = sa->off[myid]; o < sa->off[myid+1]; o++) {
+        appendDep(tc, o);
+        n = laik_slicearray_intersecting(sa, &(sa->tslice[o].s),
+                                         &tc->queryBuf, &tc->queryBufSize);
+        for(i = 0; i < n; i++)
+            appendDep(tc, tc->queryBuf[i]);
+    }
+    for(o = otherSA->off[myid]; o < otherSA->off[myid+1]; o++) {
+        n = laik_slicearray_intersecting(sa, &(otherSA->tslice[o].s),
+                                         &tc->queryBuf, &tc->queryBufSize);
+        for(i = 0; i < n; i++)
+            appendDep(tc, tc->queryBuf[i]);
+    }
+    qsort(tc->depBuf, tc->depBufCount, sizeof(unsigned int), uint_cmp);
+
+    Laik_TaskSlice_Gen* deps;
+    deps = malloc((tc->depBufCount + 1) * sizeof(Laik_TaskSlice_Gen));
+    if (!deps) {
+        laik_panic("Out of memory allocating memory for Laik_Transition");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    int c = 0;
+    for(int j = 0; j < tc->depBufCount; j++) {
+        if ((j > 0) && (tc->depBuf[j] == tc->depBuf[j - 1])) continue;
+        deps[c++] = sa->tslice[tc->depBuf[j]];
+    }
+    *count = c;
+    return deps;
+}
+
+// Calculate communication required for transitioning between partitionings,
+// using temporary buffers from <tc>
+static
+Laik_Transition* calcTransition(TransCalc* tc, Laik_Space* space,
+                                Laik_Partitioning* fromP,
+                                Laik_Partitioning* toP,
+                                Laik_DataFlow flow,
+                                Laik_ReductionOperation redOp)
 {
     Laik_Slice* slc;
 
     // flags for transition
     int tflags = 0; //LAIK_TF_KEEP_REDUCTIONS; // no_sendrev_actions
 
-    cleanTOpBufs(false);
-    cleanGroupList();
+    cleanTOpBufs(tc);
+    cleanGroupList(tc);
 
     // make sure requested operation is consistent
     Laik_Group* group = 0;
@@ -1415,7 +1708,7 @@ do_calc_transition(Laik_Space* space,
             if (laik_slice_isEmpty(&(toSA->tslice[o].s))) continue;
 
             assert(redOp != LAIK_RO_None);
-            appendInitTOp( &(toSA->tslice[o].s),
+            appendInitTOp(tc,  &(toSA->tslice[o].s),
                            o - toSA->off[myid],
                            toSA->tslice[o].mapNo,
                            redOp);
@@ -1429,12 +1722,13 @@ do_calc_transition(Laik_Space* space,
 
             // just check for reduction action
             // TODO: Do this always, remove other cases
-            calcAddReductions(tflags, group, redOp, fromP, toP);
+            calcAddReductions(tc, tflags, group, redOp, fromP, toP);
         }
         else {
             // we need intersection of own slices in fromP/toP
-            Laik_SliceArray* fromSA = laik_partitioning_allslices(fromP);
-            Laik_SliceArray* toSA = laik_partitioning_allslices(toP);
+            // (all slices if known, see prepareTransitionSlices)
+            Laik_SliceArray* fromSA = laik_partitioning_interslices(fromP, toP);
+            Laik_SliceArray* toSA = laik_partitioning_interslices(toP, fromP);
             if ((fromSA == 0) || (toSA == 0)) {
                 laik_panic("Slices not known for transition calculation");
                 exit(1); // not actually needed, laik_panic never returns
@@ -1449,7 +1743,7 @@ do_calc_transition(Laik_Space* space,
                                                &(toSA->tslice[o2].s));
                     if (slc == 0) continue;
 
-                    appendLocalTOp(slc,
+                    appendLocalTOp(tc, slc,
                                    o1 - fromSA->off[myid],
                                    o2 - toSA->off[myid],
                                    fromSA->tslice[o1].mapNo,
@@ -1463,6 +1757,12 @@ do_calc_transition(Laik_Space* space,
                 //               result to one or all?
                 bool fromAllto1OrAll = false;
                 int outputGroup = -2;
+                if ((laik_partitioning_allslices(fromP) == 0) ||
+                    (laik_partitioning_allslices(toP) == 0)) {
+                    laik_panic("Reductions in multi-dimensional spaces "
+                               "not supported for distributed partitionings");
+                    exit(1); // not actually needed, laik_panic never returns
+                }
                 if (laik_partitioning_isAll(fromP)) {
                     // reduction result either goes to all or master
                     int task = laik_partitioning_isSingle(toP);
@@ -1475,7 +1775,7 @@ do_calc_transition(Laik_Space* space,
                         }
                     }
                     else {
-                        outputGroup = getTaskGroupSingle(task);
+                        outputGroup = getTaskGroupSingle(tc, task);
                         if (taskCount == 1) {
                             // the process group only consists of 1 process:
                             // one output process is equivalent to all
@@ -1489,59 +1789,27 @@ do_calc_transition(Laik_Space* space,
                 if (fromAllto1OrAll) {
                     assert(outputGroup > -2);
                     // complete space, always sliceNo 0 and mapNo 0
-                    appendRedTOp( &(space->s), redOp,
+                    appendRedTOp(tc,  &(space->s), redOp,
                                   -1, outputGroup, 0, 0, 0, 0);
                 }
                 else {
                     assert(dims == 1);
-                    calcAddReductions(tflags, group, redOp, fromP, toP);
+                    calcAddReductions(tc, tflags, group, redOp, fromP, toP);
                 }
             }
             else { // no reduction
 
                 // something to receive not coming from a reduction?
-                for(int task = 0; task < taskCount; task++) {
-                    if (task == myid) continue;
-                    for(o1 = toSA->off[myid]; o1 < toSA->off[myid+1]; o1++) {
-
-                        // everything we have local will not have been sent
-                        // TODO: we only check for exact match to catch All
-                        // FIXME: should print out a Warning/Error as the App
-                        //        was requesting for overwriting of values!
-                        slc = &(toSA->tslice[o1].s);
-                        for(o2 = fromSA->off[myid]; o2 < fromSA->off[myid+1]; o2++) {
-                            if (laik_slice_isEqual(slc,
-                                                   &(fromSA->tslice[o2].s))) {
-                                slc = 0;
-                                break;
-                            }
-                        }
-                        if (slc == 0) continue;
-
-                        for(o2 = fromSA->off[task]; o2 < fromSA->off[task+1]; o2++) {
-
-                            slc = laik_slice_intersect(&(fromSA->tslice[o2].s),
-                                                       &(toSA->tslice[o1].s));
-                            if (slc == 0) continue;
+                // only visit slices of other tasks intersecting with ours
+                // (via index of slice array), sorted afterwards by task
+                for(o1 = toSA->off[myid]; o1 < toSA->off[myid+1]; o1++) {
 
-                            appendRecvTOp(slc, o1 - toSA->off[myid],
-                                          toSA->tslice[o1].mapNo, task);
-                        }
-                    }
-                }
-            }
-
-            // something to send?
-            for(int task = 0; task < taskCount; task++) {
-                if (task == myid) continue;
-                for(o1 = fromSA->off[myid]; o1 < fromSA->off[myid+1]; o1++) {
-
-                    // everything the receiver has local, no need to send
+                    // everything we have local will not have been sent
                     // TODO: we only check for exact match to catch All
                     // FIXME: should print out a Warning/Error as the App
-                    //        requests overwriting of values!
-                    slc = &(fromSA->tslice[o1].s);
-                    for(o2 = fromSA->off[task]; o2 < fromSA->off[task+1]; o2++) {
+                    //        was requesting for overwriting of values!
+                    slc = &(toSA->tslice[o1].s);
+                    for(o2 = fromSA->off[myid]; o2 < fromSA->off[myid+1]; o2++) {
                         if (laik_slice_isEqual(slc,
                                                &(fromSA->tslice[o2].s))) {
                             slc = 0;
@@ -1550,98 +1818,348 @@ do_calc_transition(Laik_Space* space,
                     }
                     if (slc == 0) continue;
 
-                    // we may send multiple messages to same task
-                    for(o2 = toSA->off[task]; o2 < toSA->off[task+1]; o2++) {
+                    unsigned int n;
+                    n = laik_slicearray_intersecting(fromSA, slc,
+                                                     &tc->queryBuf, &tc->queryBufSize);
+                    for(unsigned int i = 0; i < n; i++) {
+                        o2 = tc->queryBuf[i];
+                        int task = fromSA->tslice[o2].task;
+                        if (task == myid) continue;
+                        appendPair(tc, task, o1, o2);
+                    }
+                }
+                qsort(tc->pairBuf, tc->pairBufCount, sizeof(struct transPair), pair_cmp);
+                for(int i = 0; i < tc->pairBufCount; i++) {
+                    o1 = tc->pairBuf[i].o1;
+                    o2 = tc->pairBuf[i].o2;
+                    slc = laik_slice_intersect(&(fromSA->tslice[o2].s),
+                                               &(toSA->tslice[o1].s));
+                    assert(slc != 0);
+                    appendRecvTOp(tc, slc, o1 - toSA->off[myid],
+                                  toSA->tslice[o1].mapNo, tc->pairBuf[i].task);
+                }
+                tc->pairBufCount = 0;
+            }
+
+            // something to send?
+            for(o1 = fromSA->off[myid]; o1 < fromSA->off[myid+1]; o1++) {
 
-                        slc = laik_slice_intersect(&(fromSA->tslice[o1].s),
-                                                   &(toSA->tslice[o2].s));
-                        if (slc == 0) continue;
+                // everything the receiver has local, no need to send
+                // TODO: we only check for exact match to catch All
+                // FIXME: should print out a Warning/Error as the App
+                //        requests overwriting of values!
+                slc = &(fromSA->tslice[o1].s);
+
+                // we may send multiple messages to same task
+                unsigned int n;
+                n = laik_slicearray_intersecting(toSA, slc,
+                                                 &tc->queryBuf, &tc->queryBufSize);
+                for(unsigned int i = 0; i < n; i++) {
+                    o2 = tc->queryBuf[i];
+                    int task = toSA->tslice[o2].task;
+                    if (task == myid) continue;
 
-                        appendSendTOp(slc, o1 - fromSA->off[myid],
-                                      fromSA->tslice[o1].mapNo, task);
-                    }
+                    if (hasEqualSlice(fromSA, task, slc)) continue;
+
+                    appendPair(tc, task, o1, o2);
                 }
             }
+            qsort(tc->pairBuf, tc->pairBufCount, sizeof(struct transPair), pair_cmp);
+            for(int i = 0; i < tc->pairBufCount; i++) {
+                o1 = tc->pairBuf[i].o1;
+                o2 = tc->pairBuf[i].o2;
+                slc = laik_slice_intersect(&(fromSA->tslice[o1].s),
+                                           &(toSA->tslice[o2].s));
+                assert(slc != 0);
+                appendSendTOp(tc, slc, o1 - fromSA->off[myid],
+                              fromSA->tslice[o1].mapNo, tc->pairBuf[i].task);
+            }
+            tc->pairBufCount = 0;
         }
     }
 
-    // allocate space as needed
-    int localSize = localBufCount * sizeof(struct localTOp);
-    int initSize  = initBufCount  * sizeof(struct initTOp);
-    int sendSize  = sendBufCount  * sizeof(struct sendTOp);
-    int recvSize  = recvBufCount  * sizeof(struct recvTOp);
-    int redSize   = redBufCount   * sizeof(struct redTOp);
-    // we copy group list into transition object
-    int gListSize = groupListCount * sizeof(TaskGroup);
-    int tListSize = 0;
-    for (int i = 0; i < groupListCount; i++)
-        tListSize += groupList[i].count * sizeof(int);
+    Laik_Transition* t = newTransitionFromBufs(tc, tflags, space, group,
+                                               fromP, toP, flow, redOp);
 
-    int tsize = sizeof(Laik_Transition) + gListSize + tListSize +
-                localSize + initSize + sendSize + recvSize + redSize;
-    int localOff = sizeof(Laik_Transition);
-    int initOff  = localOff + localSize;
-    int sendOff  = initOff  + initSize;
-    int recvOff  = sendOff  + sendSize;
-    int redOff   = recvOff  + recvSize;
-    int gListOff = redOff   + redSize;
-    int tListOff = gListOff + gListSize;
-    assert(tListOff + tListSize == tsize);
+    if (isUpdatable(fromP, toP, flow, redOp)) {
+        Laik_SliceArray *fromSA, *toSA;
+        getTransitionSlices(fromP, toP, &fromSA, &toSA);
+        t->fromDep = collectDeps(tc, fromSA, toSA, myid, &(t->fromDepCount));
+        t->toDep = collectDeps(tc, toSA, fromSA, myid, &(t->toDepCount));
+    }
 
-    Laik_Transition* t = malloc(tsize);
-    if (!t) {
-        laik_log(LAIK_LL_Panic,
-                 "Out of memory allocating Laik_Transition object, size %d",
-                 tsize);
-        exit(1); // not actually needed, laik_panic never returns
+    if (laik_log_begin(1)) {
+        laik_log_append("calculated transition ");
+        laik_log_Transition(t, true);
+        laik_log_flush(0);
     }
 
-    t->id = trans_id++;
-    t->name = strdup("trans-0     ");
-    sprintf(t->name, "trans-%d", t->id);
+    return t;
+}
 
-    t->flags = tflags;
-    t->space = space;
-    t->group = group;
-    t->fromPartitioning = fromP;
-    t->toPartitioning = toP;
-    t->flow = flow;
-    t->redOp = redOp;
+// Make sure slices needed for transition between <fromP>/<toP> are known.
+// For partitionings without all slices (see laik_new_distributed_partitioning),
+// partitioners are run to get slices intersecting with own slices.
+// Modifies partitionings, thus must not be called concurrently
+static
+void prepareTransitionSlices(Laik_Partitioning* fromP, Laik_Partitioning* toP,
+                             Laik_DataFlow flow)
+{
+    // slices of other tasks only needed when preserving data
+    if ((fromP == 0) || (toP == 0) || (flow != LAIK_DF_Preserve)) return;
+    if (fromP->group->myid < 0) return;
 
-    t->dims = dims;
-    t->actionCount = localBufCount + initBufCount +
-                     sendBufCount + recvBufCount + redBufCount;
-    t->local = (struct localTOp*) (((char*)t) + localOff);
-    t->init  = (struct initTOp*)  (((char*)t) + initOff);
-    t->send  = (struct sendTOp*)  (((char*)t) + sendOff);
-    t->recv  = (struct recvTOp*)  (((char*)t) + recvOff);
-    t->red   = (struct redTOp*)   (((char*)t) + redOff);
-    t->subgroup = (TaskGroup*)       (((char*)t) + gListOff);
-    t->localCount = localBufCount;
-    t->initCount  = initBufCount;
-    t->sendCount  = sendBufCount;
-    t->recvCount  = recvBufCount;
-    t->redCount   = redBufCount;
-    t->subgroupCount = groupListCount;
-    memcpy(t->local, localBuf, localSize);
-    memcpy(t->init, initBuf,  initSize);
-    memcpy(t->send, sendBuf,  sendSize);
-    memcpy(t->recv, recvBuf,  recvSize);
-    memcpy(t->red,  redBuf,   redSize);
+    if (laik_partitioning_interslices(fromP, toP) == 0)
+        laik_partitioning_store_intersectslices(fromP, toP);
+    if (laik_partitioning_interslices(toP, fromP) == 0)
+        laik_partitioning_store_intersectslices(toP, fromP);
+}
 
-    // copy group list and task list of each group into transition object
-    char* tList = ((char*)t) + tListOff;
-    for (int i = 0; i < groupListCount; i++) {
-        t->subgroup[i].count = groupList[i].count;
-        t->subgroup[i].task = (int*) tList;
-        tListSize = groupList[i].count * sizeof(int);
-        memcpy(tList, groupList[i].task, tListSize);
-        tList += tListSize;
+// Calculate communication required for transitioning between partitionings
+Laik_Transition*
+do_calc_transition(Laik_Space* space,
+                   Laik_Partitioning* fromP, Laik_Partitioning* toP,
+                   Laik_DataFlow flow, Laik_ReductionOperation redOp)
+{
+    prepareTransitionSlices(fromP, toP, flow);
+
+    TransCalc tc;
+    initTransCalc(&tc);
+    Laik_Transition* t = calcTransition(&tc, space, fromP, toP, flow, redOp);
+    freeTransCalc(&tc);
+    return t;
+}
+
+
+//
+// Incremental transition recalculation
+//
+// If partitionings change only slightly (e.g. by moving a few borders for
+// load balancing), most operations of a transition calculated before stay
+// the same. The operations of a process only depend on its own slices and
+// the slices of other tasks intersecting with them. These are recorded in
+// the transition. For a new transition, operations with tasks where these
+// did not change are taken from the old transition.
+//
+
+static
+void appendChanged(TransCalc* tc, int task)
+{
+    if (tc->changedBufCount == tc->changedBufSize) {
+        // enlarge temp buffer
+        tc->changedBufSize = (tc->changedBufSize + 20) * 2;
+        tc->changedBuf = realloc(tc->changedBuf, tc->changedBufSize * sizeof(int));
+        if (!tc->changedBuf) {
+            laik_panic("Out of memory allocating memory for Laik_Transition");
+            exit(1); // not actually needed, laik_panic never returns
+        }
     }
-    assert(tList == ((char*)t) + tsize);
+    tc->changedBuf[tc->changedBufCount++] = task;
+}
+
+static int int_cmp(const void *p1, const void *p2)
+{
+    return *(const int*) p1 - *(const int*) p2;
+}
+
+static
+bool isChanged(TransCalc* tc, int task)
+{
+    return bsearch(&task, tc->changedBuf, tc->changedBufCount,
+                   sizeof(int), int_cmp) != 0;
+}
+
+// is the same dependency? for own slices, mapping must be same, too
+static
+bool isSameDep(Laik_TaskSlice_Gen* d1, Laik_TaskSlice_Gen* d2, int myid)
+{
+    if (d1->task != d2->task) return false;
+    if ((d1->task == myid) && (d1->mapNo != d2->mapNo)) return false;
+    return laik_slice_isEqual(&(d1->s), &(d2->s));
+}
+
+// add tasks with different slices in dependency lists <d1>/<d2> (sorted by
+// task) to changed tasks. Returns false if own slices are different
+static
+bool diffDeps(TransCalc* tc, int myid, int n1, Laik_TaskSlice_Gen* d1,
+              int n2, Laik_TaskSlice_Gen* d2)
+{
+    int i1 = 0, i2 = 0;
+    while((i1 < n1) || (i2 < n2)) {
+        int task;
+        if (i1 == n1) task = d2[i2].task;
+        else if (i2 == n2) task = d1[i1].task;
+        else task = (d1[i1].task < d2[i2].task) ? d1[i1].task : d2[i2].task;
+
+        int e1 = i1, e2 = i2;
+        while((e1 < n1) && (d1[e1].task == task)) e1++;
+        while((e2 < n2) && (d2[e2].task == task)) e2++;
+
+        bool same = (e1 - i1 == e2 - i2);
+        for(int k = 0; same && (k < e1 - i1); k++)
+            same = isSameDep(&(d1[i1 + k]), &(d2[i2 + k]), myid);
+        if (!same) {
+            if (task == myid) return false;
+            appendChanged(tc, task);
+        }
+        i1 = e1;
+        i2 = e2;
+    }
+    return true;
+}
+
+// Calculate transition from <fromP> to <toP>, reusing operations of
+// transition <base> calculated before for other partitionings on same
+// space and process group. Falls back to full calculation if <base>
+// cannot be used.
+// If dependencies (own slices and intersecting ones of other tasks) are
+// equal, all operations are taken from <base>. For 2d/3d, if only slices
+// of some other tasks changed, only send/recv operations with these tasks
+// are recalculated.
+static
+Laik_Transition* updateTransition(TransCalc* tc, Laik_Transition* base,
+                                  Laik_Space* space,
+                                  Laik_Partitioning* fromP,
+                                  Laik_Partitioning* toP,
+                                  Laik_DataFlow flow,
+                                  Laik_ReductionOperation redOp)
+{
+    if (!base || !base->fromDep || !isUpdatable(fromP, toP, flow, redOp) ||
+        (base->space != space) || (base->flow != flow) ||
+        (base->redOp != redOp) || (base->subgroupCount > 0) ||
+        (base->initCount > 0) || (base->redCount > 0) ||
+        (fromP->group != toP->group) ||
+        (base->group && (base->group != fromP->group)))
+        return calcTransition(tc, space, fromP, toP, flow, redOp);
+
+    Laik_Group* group = fromP->group;
+    int myid = group->myid;
+    if (myid == -1) return 0;
+
+    Laik_SliceArray *fromSA, *toSA;
+    getTransitionSlices(fromP, toP, &fromSA, &toSA);
+
+    int fromDepCount, toDepCount;
+    Laik_TaskSlice_Gen *fromDep, *toDep;
+    fromDep = collectDeps(tc, fromSA, toSA, myid, &fromDepCount);
+    toDep = collectDeps(tc, toSA, fromSA, myid, &toDepCount);
+
+    tc->changedBufCount = 0;
+    bool ownSame = diffDeps(tc, myid, base->fromDepCount, base->fromDep,
+                            fromDepCount, fromDep) &&
+                   diffDeps(tc, myid, base->toDepCount, base->toDep,
+                            toDepCount, toDep);
+    if (!ownSame || ((tc->changedBufCount > 0) && (space->dims == 1))) {
+        // for 1d, ranges of operations depend on borders of other tasks
+        laik_log(1, "update transition '%s': %s, full recalculation",
+                 base->name, ownSame ? "1d with changed tasks" : "own slices changed");
+        free(fromDep);
+        free(toDep);
+        return calcTransition(tc, space, fromP, toP, flow, redOp);
+    }
+
+    qsort(tc->changedBuf, tc->changedBufCount, sizeof(int), int_cmp);
+    int n = 0;
+    for(int i = 0; i < tc->changedBufCount; i++)
+        if ((n == 0) || (tc->changedBuf[n - 1] != tc->changedBuf[i]))
+            tc->changedBuf[n++] = tc->changedBuf[i];
+    tc->changedBufCount = n;
+
+    cleanTOpBufs(tc);
+    cleanGroupList(tc);
+
+    // local operations only depend on own slices
+    for(int i = 0; i < base->localCount; i++) {
+        struct localTOp* op = &(base->local[i]);
+        appendLocalTOp(tc, &(op->slc), op->fromSliceNo, op->toSliceNo,
+                       op->fromMapNo, op->toMapNo);
+    }
+
+    // receive: operations with changed tasks are recalculated
+    Laik_Slice* slc;
+    unsigned int o1, o2;
+    for(o1 = toSA->off[myid]; o1 < toSA->off[myid+1]; o1++) {
+        // everything we have local will not have been sent (see above)
+        slc = &(toSA->tslice[o1].s);
+        for(o2 = fromSA->off[myid]; o2 < fromSA->off[myid+1]; o2++) {
+            if (laik_slice_isEqual(slc, &(fromSA->tslice[o2].s))) {
+                slc = 0;
+                break;
+            }
+        }
+        if (slc == 0) continue;
+
+        for(int i = 0; i < tc->changedBufCount; i++) {
+            int task = tc->changedBuf[i];
+            for(o2 = fromSA->off[task]; o2 < fromSA->off[task+1]; o2++)
+                if (laik_slice_intersect(&(fromSA->tslice[o2].s), slc))
+                    appendPair(tc, task, o1, o2);
+        }
+    }
+    qsort(tc->pairBuf, tc->pairBufCount, sizeof(struct transPair), pair_cmp);
+    int p = 0;
+    for(int i = 0; i <= base->recvCount; i++) {
+        // keep order by task: first add new operations of lower tasks
+        int task = (i < base->recvCount) ? base->recv[i].fromTask : group->size;
+        while((p < tc->pairBufCount) && (tc->pairBuf[p].task < task)) {
+            o1 = tc->pairBuf[p].o1;
+            o2 = tc->pairBuf[p].o2;
+            slc = laik_slice_intersect(&(fromSA->tslice[o2].s),
+                                       &(toSA->tslice[o1].s));
+            appendRecvTOp(tc, slc, o1 - toSA->off[myid],
+                          toSA->tslice[o1].mapNo, tc->pairBuf[p].task);
+            p++;
+        }
+        if ((i == base->recvCount) || isChanged(tc, task)) continue;
+
+        struct recvTOp* op = &(base->recv[i]);
+        appendRecvTOp(tc, &(op->slc), op->sliceNo, op->mapNo, op->fromTask);
+    }
+    tc->pairBufCount = 0;
+
+    // send: operations with changed tasks are recalculated
+    for(o1 = fromSA->off[myid]; o1 < fromSA->off[myid+1]; o1++) {
+        slc = &(fromSA->tslice[o1].s);
+        for(int i = 0; i < tc->changedBufCount; i++) {
+            int task = tc->changedBuf[i];
+            // everything the receiver has local, no need to send
+            if (hasEqualSlice(fromSA, task, slc)) continue;
+
+            for(o2 = toSA->off[task]; o2 < toSA->off[task+1]; o2++)
+                if (laik_slice_intersect(slc, &(toSA->tslice[o2].s)))
+                    appendPair(tc, task, o1, o2);
+        }
+    }
+    qsort(tc->pairBuf, tc->pairBufCount, sizeof(struct transPair), pair_cmp);
+    p = 0;
+    for(int i = 0; i <= base->sendCount; i++) {
+        int task = (i < base->sendCount) ? base->send[i].toTask : group->size;
+        while((p < tc->pairBufCount) && (tc->pairBuf[p].task < task)) {
+            o1 = tc->pairBuf[p].o1;
+            o2 = tc->pairBuf[p].o2;
+            slc = laik_slice_intersect(&(fromSA->tslice[o1].s),
+                                       &(toSA->tslice[o2].s));
+            appendSendTOp(tc, slc, o1 - fromSA->off[myid],
+                          fromSA->tslice[o1].mapNo, tc->pairBuf[p].task);
+            p++;
+        }
+        if ((i == base->sendCount) || isChanged(tc, task)) continue;
+
+        struct sendTOp* op = &(base->send[i]);
+        appendSendTOp(tc, &(op->slc), op->sliceNo, op->mapNo, op->toTask);
+    }
+    tc->pairBufCount = 0;
+
+    Laik_Transition* t = newTransitionFromBufs(tc, base->flags, space, group,
+                                               fromP, toP, flow, redOp);
+    t->fromDep = fromDep;
+    t->fromDepCount = fromDepCount;
+    t->toDep = toDep;
+    t->toDepCount = toDepCount;
 
     if (laik_log_begin(1)) {
-        laik_log_append("calculated transition ");
+        laik_log_append("updated transition '%s' (%d tasks changed) to ",
+                        base->name, tc->changedBufCount);
         laik_log_Transition(t, true);
         laik_log_flush(0);
     }
@@ -1649,6 +2167,21 @@ do_calc_transition(Laik_Space* space,
     return t;
 }
 
+Laik_Transition*
+laik_calc_transition_update(Laik_Transition* base, Laik_Space* space,
+                            Laik_Partitioning* fromP, Laik_Partitioning* toP,
+                            Laik_DataFlow flow, Laik_ReductionOperation redOp)
+{
+    prepareTransitionSlices(fromP, toP, flow);
+
+    TransCalc tc;
+    initTransCalc(&tc);
+    Laik_Transition* t = updateTransition(&tc, base, space,
+                                          fromP, toP, flow, redOp);
+    freeTransCalc(&tc);
+    return t;
+}
+
 
 // Calculate communication required for transitioning between partitionings
 Laik_Transition*
@@ -1679,11 +2212,72 @@ laik_calc_transition(Laik_Space* space,
     return t;
 }
 
+// arguments for calculating multiple transitions, see laik_calc_transitions
+struct calcJob {
+    Laik_Space** space;
+    Laik_Partitioning **fromP, **toP;
+    Laik_DataFlow* flow;
+    Laik_ReductionOperation* redOp;
+    Laik_Transition** t;
+};
+
+static
+void calcTransitionJob(void* ctx, int i)
+{
+    struct calcJob* job = (struct calcJob*) ctx;
+
+    TransCalc tc;
+    initTransCalc(&tc);
+    job->t[i] = calcTransition(&tc, job->space[i],
+                               job->fromP[i], job->toP[i],
+                               job->flow[i], job->redOp[i]);
+    freeTransCalc(&tc);
+}
+
+// Calculate <n> transitions at once, e.g. for multiple containers.
+// Transition i goes from <fromP>[i] to <toP>[i] with <flow>[i]/<redOp>[i],
+// the result is written to <t>[i]. Calculation is done in parallel by the
+// threads of the instance (see laik_set_threads)
+void laik_calc_transitions(int n, Laik_Space** space,
+                           Laik_Partitioning** fromP, Laik_Partitioning** toP,
+                           Laik_DataFlow* flow, Laik_ReductionOperation* redOp,
+                           Laik_Transition** t)
+{
+    if (n == 0) return;
+
+    for(int i = 0; i < n; i++) {
+        if (fromP[i] && toP[i]) {
+            // a transition always needs to be between the same process group
+            assert(fromP[i]->group == toP[i]->group);
+        }
+        // done before starting threads, as slices get stored
+        prepareTransitionSlices(fromP[i], toP[i], flow[i]);
+    }
+
+    struct calcJob job;
+    job.space = space;
+    job.fromP = fromP;
+    job.toP = toP;
+    job.flow = flow;
+    job.redOp = redOp;
+    job.t = t;
+
+    // logging is not thread-safe
+    Laik_Instance* inst = space[0]->inst;
+    laik_threadpool_run(laik_log_shown(1) ? 0 : inst->threadPool,
+                        n, calcTransitionJob, &job);
+
+    laik_log(2, "calculated %d transitions (%d threads)",
+             n, laik_threadpool_size(inst->threadPool));
+}
+
 void laik_free_transition(Laik_Transition* t)
 {
     if (!t) return;
 
     laik_log(1, "free transition '%s'", t->name);
+    free(t->fromDep);
+    free(t->toDep);
     free(t);
 }
 
@@ -0,0 +1,203 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2018 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <laik-internal.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+//
+// Thread pool for local data movement (pack/unpack/copy)
+//
+// Worker threads only do memory copies or transition calculations given
+// to laik_threadpool_run. Communication (backend calls) always stays in
+// the calling thread.
+//
+
+struct _Laik_ThreadPool {
+    int threads;      // including the calling thread
+    pthread_t* worker;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wakeup;  // new job or shutdown
+    pthread_cond_t done;    // all workers finished current job
+
+    // current job: call func(ctx, i) for i in [0;items[
+    void (*func)(void* ctx, int item);
+    void* ctx;
+    int items, nextItem;
+    int busyWorkers;        // workers not yet finished with current job
+    unsigned int job;       // incremented for each new job
+    bool shutdown;
+};
+
+// grab next item of current job, or -1 if none left
+static
+int nextItem(Laik_ThreadPool* p)
+{
+    pthread_mutex_lock(&(p->lock));
+    int i = (p->nextItem < p->items) ? p->nextItem++ : -1;
+    pthread_mutex_unlock(&(p->lock));
+    return i;
+}
+
+static
+void* workerMain(void* arg)
+{
+    Laik_ThreadPool* p = arg;
+    unsigned int seenJob = 0;
+
+    while(1) {
+        pthread_mutex_lock(&(p->lock));
+        while(!p->shutdown && (p->job == seenJob))
+            pthread_cond_wait(&(p->wakeup), &(p->lock));
+        if (p->shutdown) {
+            pthread_mutex_unlock(&(p->lock));
+            break;
+        }
+        seenJob = p->job;
+        pthread_mutex_unlock(&(p->lock));
+
+        int i;
+        while((i = nextItem(p)) >= 0)
+            (p->func)(p->ctx, i);
+
+        pthread_mutex_lock(&(p->lock));
+        p->busyWorkers--;
+        if (p->busyWorkers == 0)
+            pthread_cond_signal(&(p->done));
+        pthread_mutex_unlock(&(p->lock));
+    }
+    return 0;
+}
+
+// create pool using <threads> threads (including the calling thread).
+// returns 0 for less than 2 threads
+Laik_ThreadPool* laik_threadpool_new(int threads)
+{
+    if (threads < 2) return 0;
+
+    Laik_ThreadPool* p = malloc(sizeof(Laik_ThreadPool));
+    pthread_t* worker = malloc((threads - 1) * sizeof(pthread_t));
+    if (!p || !worker) {
+        laik_panic("Out of memory allocating Laik_ThreadPool object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    p->worker = worker;
+    pthread_mutex_init(&(p->lock), 0);
+    pthread_cond_init(&(p->wakeup), 0);
+    pthread_cond_init(&(p->done), 0);
+    p->func = 0;
+    p->ctx = 0;
+    p->items = 0;
+    p->nextItem = 0;
+    p->busyWorkers = 0;
+    p->job = 0;
+    p->shutdown = false;
+
+    p->threads = 1;
+    for(int t = 0; t < threads - 1; t++) {
+        if (pthread_create(&(p->worker[t]), 0, workerMain, p) != 0) {
+            laik_log(LAIK_LL_Warning,
+                     "thread pool: could only start %d of %d threads",
+                     p->threads, threads);
+            break;
+        }
+        p->threads++;
+    }
+    return p;
+}
+
+// stop worker threads and free pool
+void laik_threadpool_free(Laik_ThreadPool* p)
+{
+    if (!p) return;
+
+    pthread_mutex_lock(&(p->lock));
+    p->shutdown = true;
+    pthread_cond_broadcast(&(p->wakeup));
+    pthread_mutex_unlock(&(p->lock));
+
+    for(int t = 0; t < p->threads - 1; t++)
+        pthread_join(p->worker[t], 0);
+
+    pthread_cond_destroy(&(p->done));
+    pthread_cond_destroy(&(p->wakeup));
+    pthread_mutex_destroy(&(p->lock));
+    free(p->worker);
+    free(p);
+}
+
+// number of threads used by pool <p> (1 if no pool)
+int laik_threadpool_size(Laik_ThreadPool* p)
+{
+    return p ? p->threads : 1;
+}
+
+// call <func>(<ctx>, i) for all i in [0;<items>[, distributed among the
+// threads of pool <p> and the calling thread. Returns when all are done.
+// Without pool, all items are processed by the calling thread
+void laik_threadpool_run(Laik_ThreadPool* p, int items,
+                         void (*func)(void* ctx, int item), void* ctx)
+{
+    if (!p || (p->threads < 2) || (items < 2)) {
+        for(int i = 0; i < items; i++)
+            func(ctx, i);
+        return;
+    }
+
+    pthread_mutex_lock(&(p->lock));
+    assert(p->busyWorkers == 0);
+    p->func = func;
+    p->ctx = ctx;
+    p->items = items;
+    p->nextItem = 0;
+    p->busyWorkers = p->threads - 1;
+    p->job++;
+    pthread_cond_broadcast(&(p->wakeup));
+    pthread_mutex_unlock(&(p->lock));
+
+    int i;
+    while((i = nextItem(p)) >= 0)
+        func(ctx, i);
+
+    // workers may still work on their last item
+    pthread_mutex_lock(&(p->lock));
+    while(p->busyWorkers > 0)
+        pthread_cond_wait(&(p->done), &(p->lock));
+    pthread_mutex_unlock(&(p->lock));
+}
+
+// set number of threads used by instance <inst> for local data movement
+void laik_set_threads(Laik_Instance* inst, int threads)
+{
+    if (laik_threadpool_size(inst->threadPool) == threads) return;
+
+    laik_threadpool_free(inst->threadPool);
+    inst->threadPool = laik_threadpool_new(threads);
+
+    laik_log(1, "thread pool: using %d threads for local data movement",
+             laik_threadpool_size(inst->threadPool));
+}
+
+// return number of threads used by instance <inst> for local data movement
+int laik_get_threads(Laik_Instance* inst)
+{
+    return laik_threadpool_size(inst->threadPool);
+}
@@ -0,0 +1,10 @@
+#!/bin/sh
+# forward messages via node leaders, emulating 2 nodes with 2 tasks each.
+# only done for cached sequences (reservation) and pre-calculated ones
+export LAIK_BACKEND=mpi LAIK_MPI_AGGREGATE=2
+${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -r -s 100 > test-aggregate-mpi-4.out
+cmp test-aggregate-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected" || exit 1
+${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -m -s 100 > test-aggregate-mpi-4.out
+cmp test-aggregate-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected" || exit 1
+LAIK_MPI_ASYNC=0 ${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -r -o -s 100 > test-aggregate-mpi-4.out
+cmp test-aggregate-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected"
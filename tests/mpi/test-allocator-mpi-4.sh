@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/allocatortest > test-allocator-mpi-4.out
+cmp test-allocator-mpi-4.out "$(dirname -- "${0}")/test-allocator-mpi-4.expected"
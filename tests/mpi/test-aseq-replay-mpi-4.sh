@@ -0,0 +1,11 @@
+#!/bin/sh
+# record action sequences of markov2, replay largest one with different passes
+rm -f aseq-replay-*.aseq
+LAIK_BACKEND=mpi LAIK_ASEQ_SAVE=aseq-replay ${MPIEXEC-mpiexec} -n 4 ../../examples/markov2 -f 500 5 > test-aseq-replay-mpi-4.out || exit 1
+cmp test-aseq-replay-mpi-4.out "$(dirname -- "${0}")/../test-markov2-f-500-5.expected" || exit 1
+seq=$(ls -S aseq-replay-*-0.aseq | head -n 1 | sed 's/-0.aseq$//')
+test -n "$seq" || exit 1
+LAIK_BACKEND=mpi LAIK_MPI_SORT=2phases ${MPIEXEC-mpiexec} -n 4 ../../examples/aseq-replay -n 3 $seq || exit 1
+LAIK_BACKEND=mpi LAIK_MPI_SORT=rankdigits ${MPIEXEC-mpiexec} -n 4 ../../examples/aseq-replay -n 3 $seq || exit 1
+LAIK_BACKEND=mpi LAIK_MPI_COMBINE=0 ${MPIEXEC-mpiexec} -n 4 ../../examples/aseq-replay -n 3 $seq || exit 1
+rm -f aseq-replay-*.aseq
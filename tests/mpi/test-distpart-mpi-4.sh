@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/distparttest > test-distpart-mpi-4.out
+cmp test-distpart-mpi-4.out "$(dirname -- "${0}")/test-distpart-mpi-4.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s 1000 50 5 > test-jac2d-1000-repart-mpi-4.out
+cmp test-jac2d-1000-repart-mpi-4.out "$(dirname -- "${0}")/test-jac2d-1000-repart.expected"
@@ -0,0 +1,4 @@
+#!/bin/sh
+# test with surface-minimizing weighted bisection
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s -b 1000 > test-jac2d-1000-wb-mpi-4.out
+cmp test-jac2d-1000-wb-mpi-4.out "$(dirname -- "${0}")/test-jac2d-1000.expected"
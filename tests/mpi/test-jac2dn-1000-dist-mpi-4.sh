@@ -0,0 +1,4 @@
+#!/bin/sh
+# test with no-corners halo partitioner and distributed partitionings
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s -n -d 1000 > test-jac2dn-1000-dist-mpi-4.out
+cmp test-jac2dn-1000-dist-mpi-4.out "$(dirname -- "${0}")/test-jac2dn-1000.expected"
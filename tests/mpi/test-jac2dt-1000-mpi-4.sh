@@ -0,0 +1,4 @@
+#!/bin/sh
+# test with no-corners stencil partitioner, same results as with '-n'
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s -t 1000 > test-jac2dt-1000-mpi-4.out
+cmp test-jac2dt-1000-mpi-4.out "$(dirname -- "${0}")/test-jac2dn-1000.expected"
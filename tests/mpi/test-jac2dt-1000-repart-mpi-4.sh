@@ -0,0 +1,4 @@
+#!/bin/sh
+# no-corners stencil partitioner also works with repartitioning
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s -t 1000 50 5 > test-jac2dt-1000-repart-mpi-4.out
+cmp test-jac2dt-1000-repart-mpi-4.out "$(dirname -- "${0}")/test-jac2dt-1000-repart.expected"
@@ -0,0 +1,4 @@
+#!/bin/sh
+# test with built-in allocator: huge pages, first touch, NUMA interleaving
+LAIK_BACKEND=mpi LAIK_THREADS=2 ${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -s -H -N 100 > test-jac3d-100-hn-mpi-4.out
+cmp test-jac3d-100-hn-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected"
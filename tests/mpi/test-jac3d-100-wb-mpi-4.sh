@@ -0,0 +1,4 @@
+#!/bin/sh
+# test with surface-minimizing weighted bisection
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -s -b 100 > test-jac3d-100-wb-mpi-4.out
+cmp test-jac3d-100-wb-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected"
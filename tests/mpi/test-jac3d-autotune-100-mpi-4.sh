@@ -0,0 +1,12 @@
+#!/bin/sh
+export LAIK_BACKEND=mpi LAIK_MPI_AUTOTUNE=1
+${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -r -s 100 > test-jac3d-autotune-100-mpi-4.out
+cmp test-jac3d-autotune-100-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected" || exit 1
+LAIK_MPI_REDUCE=0 LAIK_MPI_PERSISTENT=0 ${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -a -s 100 > test-jac3d-autotune-100-mpi-4.out
+cmp test-jac3d-autotune-100-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected" || exit 1
+# split-phase switches overlapping halo exchange
+${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -r -o -s 100 > test-jac3d-autotune-100-mpi-4.out
+cmp test-jac3d-autotune-100-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected" || exit 1
+# tasks choose on their own: must work with tasks not autotuning
+${MPIEXEC-mpiexec} -n 2 env LAIK_MPI_AUTOTUNE=0 ../../examples/jac3d -r -s 100 : -n 2 ../../examples/jac3d -r -s 100 > test-jac3d-autotune-100-mpi-4.out
+cmp test-jac3d-autotune-100-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected"
@@ -0,0 +1,4 @@
+#!/bin/sh
+# test with no-corners stencil partitioner, same results as with '-n'
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -s -t 100 > test-jac3dt-100-mpi-4.out
+cmp test-jac3dt-100-mpi-4.out "$(dirname -- "${0}")/test-jac3dn-100.expected"
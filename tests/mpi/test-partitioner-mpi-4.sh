@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/partitionertest > test-partitioner-mpi-4.out
+cmp test-partitioner-mpi-4.out "$(dirname -- "${0}")/test-partitioner.expected"
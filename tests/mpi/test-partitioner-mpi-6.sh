@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 6 ../src/partitionertest > test-partitioner-mpi-6.out
+cmp test-partitioner-mpi-6.out "$(dirname -- "${0}")/test-partitioner.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/slicearraytest > test-slicearray-mpi-4.out
+cmp test-slicearray-mpi-4.out "$(dirname -- "${0}")/test-slicearray-mpi-4.expected"
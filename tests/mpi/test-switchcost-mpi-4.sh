@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/switchcosttest > test-switchcost-mpi-4.out
+cmp test-switchcost-mpi-4.out "$(dirname -- "${0}")/test-switchcost-mpi-4.expected"
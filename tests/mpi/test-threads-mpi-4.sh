@@ -0,0 +1,12 @@
+#!/bin/sh
+# pack/unpack and local copies executed by 4 threads per process
+export LAIK_BACKEND=mpi LAIK_THREADS=4
+${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -s 100 > test-threads-mpi-4.out
+cmp test-threads-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected" || exit 1
+# transitions calculated in parallel, also on repartitioning
+${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -a -r -i 10 -s 100 > test-threads-mpi-4.out
+cmp test-threads-mpi-4.out "$(dirname -- "${0}")/test-jac3di-100.expected" || exit 1
+${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s 1000 > test-threads-mpi-4.out
+cmp test-threads-mpi-4.out "$(dirname -- "${0}")/test-jac2d-1000.expected" || exit 1
+${MPIEXEC-mpiexec} -n 4 ../../examples/markov2 40 4 > test-threads-mpi-4.out
+cmp test-threads-mpi-4.out "$(dirname -- "${0}")/test-markov2-40-4.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/transcachetest > test-transcache-mpi-4.out
+cmp test-transcache-mpi-4.out "$(dirname -- "${0}")/test-transcache-mpi-4.expected"
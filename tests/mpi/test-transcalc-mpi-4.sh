@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/transcalctest > test-transcalc-mpi-4.out
+cmp test-transcalc-mpi-4.out "$(dirname -- "${0}")/test-transcalc-mpi-4.expected"
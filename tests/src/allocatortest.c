@@ -0,0 +1,286 @@
+// Test for allocators of containers
+//
+// Prints one summary line per part:
+// - mapping pool (policy LAIK_MP_UsePool): switches a container between
+//   two partitionings with disjoint own slices of slightly different size.
+//   Memory of freed mappings must be reused from the pool, the limit for
+//   cached memory must be respected, and pooled memory must be usable.
+//   Also changes the allocator while mappings from the pool are active
+// - built-in allocators with huge page, NUMA and first touch options:
+//   switches containers of different sizes between a block and an empty
+//   partitioning. Mappings must be usable, large mappings with huge pages
+//   must be aligned to huge page boundaries, a first touch callback must
+//   be called for large mappings (otherwise, LAIK threads do the first
+//   touch), and presets must work with the mapping pool
+
+#include "laik-internal.h"
+#include "testutil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+//----------------------------------------------------------------------
+// mapping pool
+
+static const int64_t n = 1000; // mapping size in pool tests
+
+// task t gets [(2t+phase)*n, (2t+phase+1)*n + phase[
+void runShifted(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
+{
+    int phase = *((int*) p->partitioner->data);
+    Laik_Slice slc;
+    for(int t = 0; t < p->group->size; t++) {
+        int64_t from = (2 * t + phase) * n;
+        laik_slice_init_1d(&slc, p->space, from, from + n + phase);
+        laik_append_slice(r, t, &slc, 1, 0);
+    }
+}
+
+static
+void checkPool(Laik_Instance* inst, Laik_Allocator* a, int switches,
+               int expHits, int expMisses)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_Space* space = laik_new_space_1d(inst, 2 * n * world->size + 1);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    if (a) laik_set_allocator(d, a);
+    checks++;
+
+    static int phase[2] = { 0, 1 };
+    Laik_Partitioning* p[2];
+    for(int i = 0; i < 2; i++) {
+        Laik_Partitioner* pr = laik_new_partitioner("shifted", runShifted,
+                                                    &(phase[i]),
+                                                    LAIK_PF_NoFullCoverage);
+        p[i] = laik_new_partitioning(pr, world, space, 0);
+    }
+
+    bool ok = true;
+    for(int i = 0; i < switches; i++) {
+        laik_switchto_partitioning(d, p[i % 2], LAIK_DF_None, LAIK_RO_None);
+        double* base;
+        uint64_t count;
+        laik_get_map_1d(d, 0, (void**) &base, &count);
+        if (count != (uint64_t) (n + i % 2)) ok = false;
+        for(uint64_t j = 0; j < count; j++)
+            base[j] = (double) j;
+        for(uint64_t j = 0; j < count; j++)
+            if (base[j] != (double) j) ok = false;
+    }
+    if (!ok) {
+        printf("Error: wrong mapping\n");
+        errors++;
+    }
+
+    Laik_SwitchStat* ss = d->stat;
+    if ((ss->poolHits != expHits) || (ss->poolMisses != expMisses)) {
+        printf("Error: %d pool hits, %d misses, expected %d/%d\n",
+               ss->poolHits, ss->poolMisses, expHits, expMisses);
+        errors++;
+    }
+    // memory taken from the pool is not counted as new allocation
+    if (a && (a->policy == LAIK_MP_UsePool) &&
+        (ss->mallocCount != ss->poolMisses)) {
+        printf("Error: %d mallocs for %d pool misses\n",
+               ss->mallocCount, ss->poolMisses);
+        errors++;
+    }
+    if (a && a->poolMaxBytes && d->pool &&
+        (d->pool->cachedBytes > a->poolMaxBytes)) {
+        printf("Error: %llu bytes cached, limit %llu\n",
+               (unsigned long long) d->pool->cachedBytes,
+               (unsigned long long) a->poolMaxBytes);
+        errors++;
+    }
+
+    laik_free(d);
+    laik_free_partitioning(p[0]);
+    laik_free_partitioning(p[1]);
+}
+
+// change allocator while a mapping from the pool is active: the mapping
+// must be freed via the allocator it was allocated with
+static
+void checkPoolChange(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_Space* space = laik_new_space_1d(inst, 2 * n * world->size + 1);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    Laik_Allocator* a = laik_new_allocator_preset(LAIK_AF_None, 0);
+    a->policy = LAIK_MP_UsePool;
+    laik_set_allocator(d, a);
+    checks++;
+
+    static int phase[2] = { 0, 1 };
+    Laik_Partitioning* p[2];
+    for(int i = 0; i < 2; i++) {
+        Laik_Partitioner* pr = laik_new_partitioner("shifted", runShifted,
+                                                    &(phase[i]),
+                                                    LAIK_PF_NoFullCoverage);
+        p[i] = laik_new_partitioning(pr, world, space, 0);
+    }
+
+    laik_switchto_partitioning(d, p[0], LAIK_DF_None, LAIK_RO_None);
+    laik_switchto_partitioning(d, p[1], LAIK_DF_None, LAIK_RO_None);
+    laik_set_allocator(d, laik_new_pool_allocator(0));
+    for(int i = 0; i < 4; i++)
+        laik_switchto_partitioning(d, p[i % 2], LAIK_DF_None, LAIK_RO_None);
+
+    // 2 mallocs with each allocator; memory of first allocator freed on
+    // change (cached) and on next switch (active), then 2 pool hits
+    Laik_SwitchStat* ss = d->stat;
+    if ((ss->mallocCount != 4) || (ss->freeCount != 2) || (ss->poolHits != 2)) {
+        printf("Error: %d mallocs, %d frees, %d pool hits after allocator "
+               "change\n", ss->mallocCount, ss->freeCount, ss->poolHits);
+        errors++;
+    }
+
+    laik_free(d);
+    laik_free_partitioning(p[0]);
+    laik_free_partitioning(p[1]);
+}
+
+static
+void testPool(Laik_Instance* inst)
+{
+    // without pool
+    checkPool(inst, 0, 10, 0, 0);
+    checkPool(inst, laik_new_allocator(), 10, 0, 0);
+
+    // sizes of both mappings are in same class: all but first 2 are hits
+    checkPool(inst, laik_new_pool_allocator(0), 10, 8, 2);
+    checkPool(inst, laik_new_pool_allocator(1 << 20), 10, 8, 2);
+
+    // limit below class size: nothing cached
+    checkPool(inst, laik_new_pool_allocator(4096), 10, 0, 10);
+
+    checkPoolChange(inst);
+
+    testReport(laik_world(inst), "containers with mapping pool");
+}
+
+//----------------------------------------------------------------------
+// built-in allocators
+
+static uint64_t touched = 0;
+
+void touch(Laik_Data* d, void* ptr, size_t size)
+{
+    (void) d;
+    memset(ptr, 0, size);
+    touched += size;
+}
+
+// no slices: switching to it frees all mappings
+void runEmpty(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
+{
+    (void) r;
+    (void) p;
+}
+
+static
+void checkPreset(Laik_Instance* inst, int flags, int64_t size,
+                 bool useTouch, bool usePool)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_Space* space = laik_new_space_1d(inst, size);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    Laik_Allocator* a = laik_new_allocator_preset(flags, 0);
+    if (useTouch) a->touch = touch;
+    if (usePool) a->policy = LAIK_MP_UsePool;
+    laik_set_allocator(d, a);
+    checks++;
+    touched = 0;
+
+    Laik_Partitioning* p[2];
+    p[0] = laik_new_partitioning(laik_new_block_partitioner1(), world, space, 0);
+    p[1] = laik_new_partitioning(laik_new_partitioner("empty", runEmpty, 0,
+                                                      LAIK_PF_NoFullCoverage),
+                                 world, space, 0);
+
+    bool ok = true, aligned = true;
+    for(int i = 0; i < 4; i++) {
+        laik_switchto_partitioning(d, p[i % 2], LAIK_DF_None, LAIK_RO_None);
+        double* base;
+        uint64_t count;
+        if (laik_my_slicecount(p[i % 2]) == 0) continue;
+        laik_get_map_1d(d, 0, (void**) &base, &count);
+        for(uint64_t j = 0; j < count; j++)
+            base[j] = (double) j;
+        for(uint64_t j = 0; j < count; j++)
+            if (base[j] != (double) j) ok = false;
+        // memory of large mappings follows a 64 byte header
+        if ((count * sizeof(double) >= 4 * 1024 * 1024) &&
+            ((((uintptr_t) base - 64) % (2 * 1024 * 1024)) != 0))
+            aligned = false;
+    }
+
+    if (!ok) {
+        printf("Error: wrong mapping (flags %d, size %lld)\n",
+               flags, (long long) size);
+        errors++;
+    }
+    if ((flags == LAIK_AF_HugePages) && !aligned) {
+        printf("Error: mapping not aligned to huge pages (size %lld)\n",
+               (long long) size);
+        errors++;
+    }
+    // first touch only for large mappings
+    bool large = (size * sizeof(double) >= 1024 * 1024);
+    if (useTouch && (flags & LAIK_AF_FirstTouch) && large && (touched == 0)) {
+        printf("Error: no first touch (flags %d, size %lld)\n",
+               flags, (long long) size);
+        errors++;
+    }
+    if (((flags & LAIK_AF_FirstTouch) == 0) && (touched > 0)) {
+        printf("Error: first touch not requested (flags %d)\n", flags);
+        errors++;
+    }
+    if (usePool && (d->stat->poolHits == 0)) {
+        printf("Error: no pool hits with preset allocator\n");
+        errors++;
+    }
+
+    laik_free(d);
+    laik_free_partitioning(p[0]);
+    laik_free_partitioning(p[1]);
+}
+
+static
+void testPresets(Laik_Instance* inst)
+{
+    int flags[] = {
+        LAIK_AF_None,
+        LAIK_AF_HugePages,
+        LAIK_AF_HugePages | LAIK_AF_FirstTouch,
+        LAIK_AF_HugeTLB2M | LAIK_AF_FirstTouch,
+        LAIK_AF_NumaInterleave,
+        LAIK_AF_NumaBind | LAIK_AF_FirstTouch,
+        LAIK_AF_HugePages | LAIK_AF_NumaInterleave | LAIK_AF_FirstTouch
+    };
+    int64_t sizes[] = { 100, 20000, 3000000 };
+
+    for(unsigned int f = 0; f < sizeof(flags) / sizeof(int); f++)
+        for(unsigned int s = 0; s < sizeof(sizes) / sizeof(int64_t); s++)
+            checkPreset(inst, flags[f], sizes[s], true, false);
+
+    // first touch by LAIK threads, and with mapping pool
+    checkPreset(inst, LAIK_AF_HugePages | LAIK_AF_FirstTouch, 3000000, false, false);
+    checkPreset(inst, LAIK_AF_HugePages | LAIK_AF_FirstTouch, 3000000, true, true);
+
+    testReport(laik_world(inst), "containers with built-in allocators");
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+
+    testPool(inst);
+    testPresets(inst);
+
+    laik_finalize(inst);
+    return testExitCode();
+}
@@ -0,0 +1,103 @@
+// Test for distributed partitionings
+//
+// Calculates transitions between partitionings storing all slices, and
+// between distributed partitionings from same partitioners (storing only
+// own slices and slices calculated on demand). Both must result in the
+// same operations.
+
+#include "laik-internal.h"
+#include "testutil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// compare transitions <p1> => <p2> and <d1> => <d2>, both ways
+static
+void check(Laik_Partitioning* p1, Laik_Partitioning* p2,
+           Laik_Partitioning* d1, Laik_Partitioning* d2,
+           Laik_ReductionOperation redOp, bool bothWays)
+{
+    Laik_Transition *t1, *t2;
+    Laik_Space* space = p1->space;
+
+    for(int i = 0; i < (bothWays ? 2 : 1); i++) {
+        t1 = laik_calc_transition(space, p1, p2, LAIK_DF_Preserve, redOp);
+        t2 = laik_calc_transition(space, d1, d2, LAIK_DF_Preserve, redOp);
+        if (!sameTransition(t1, t2)) {
+            printf("Task %d: transition %d differs\n",
+                   laik_myid(p1->group), checks);
+            errors++;
+        }
+        checks++;
+        laik_free_transition(t1);
+        laik_free_transition(t2);
+
+        Laik_Partitioning* p = p1; p1 = p2; p2 = p;
+        p = d1; d1 = d2; d2 = p;
+    }
+}
+
+// partitioning with all slices and distributed version
+static
+void newPartitionings(Laik_Partitioner* pr, Laik_Group* g, Laik_Space* s,
+                      Laik_Partitioning* p0, Laik_Partitioning* d0,
+                      Laik_Partitioning** p, Laik_Partitioning** d)
+{
+    *p = laik_new_partitioning(pr, g, s, p0);
+    *d = laik_new_distributed_partitioning(pr, g, s, d0);
+
+    // own slices must be the same
+    Laik_SliceArray* sa = laik_partitioning_allslices(*d);
+    assert(sa == 0);
+    assert(laik_my_slicecount(*p) == laik_my_slicecount(*d));
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+    Laik_Partitioning *p1a, *p1b, *p1all, *p1m, *d1a, *d1b, *d1all, *d1m;
+    Laik_Partitioning *p2, *p2h, *p2c, *p2b, *d2, *d2h, *d2c, *d2b;
+    Laik_Partitioning *p3, *p3c, *p3b, *d3, *d3c, *d3b;
+
+    // 1d: block partitionings with different weights, reductions
+    Laik_Space* s1 = laik_new_space_1d(inst, 100000);
+    newPartitionings(laik_new_block_partitioner1(), world, s1, 0, 0, &p1a, &d1a);
+    newPartitionings(laik_new_block_partitioner(0, 3, 0, 0, 0), world, s1,
+                     0, 0, &p1b, &d1b);
+    newPartitionings(laik_All, world, s1, 0, 0, &p1all, &d1all);
+    newPartitionings(laik_Master, world, s1, 0, 0, &p1m, &d1m);
+    check(p1a, p1b, d1a, d1b, LAIK_RO_None, true);
+    check(p1a, p1all, d1a, d1all, LAIK_RO_None, false);
+    check(p1all, p1m, d1all, d1m, LAIK_RO_Sum, false);
+    check(p1all, p1all, d1all, d1all, LAIK_RO_Max, false);
+
+    // 2d/3d: halo partitionings, derived from distributed base
+    Laik_Space* s2 = laik_new_space_2d(inst, 1000, 1000);
+    newPartitionings(laik_new_bisection_partitioner(), world, s2, 0, 0, &p2, &d2);
+    newPartitionings(laik_new_halo_partitioner(1), world, s2, p2, d2, &p2h, &d2h);
+    newPartitionings(laik_new_cornerhalo_partitioner(2), world, s2, p2, d2, &p2c, &d2c);
+    newPartitionings(laik_new_block_partitioner(0, 50, 0, 0, 0), world, s2,
+                     0, 0, &p2b, &d2b);
+    check(p2, p2h, d2, d2h, LAIK_RO_None, true);
+    check(p2, p2c, d2, d2c, LAIK_RO_None, true);
+    check(p2h, p2b, d2h, d2b, LAIK_RO_None, true);
+    check(p2c, p2b, d2c, d2b, LAIK_RO_None, true);
+    // mixed: only one distributed
+    check(p2c, p2b, p2c, d2b, LAIK_RO_None, true);
+
+    Laik_Space* s3 = laik_new_space_3d(inst, 100, 100, 100);
+    newPartitionings(laik_new_bisection_partitioner(), world, s3, 0, 0, &p3, &d3);
+    newPartitionings(laik_new_cornerhalo_partitioner(1), world, s3, p3, d3, &p3c, &d3c);
+    newPartitionings(laik_new_block_partitioner(2, 20, 0, 0, 0), world, s3,
+                     0, 0, &p3b, &d3b);
+    check(p3, p3c, d3, d3c, LAIK_RO_None, true);
+    check(p3c, p3b, d3c, d3b, LAIK_RO_None, true);
+
+    testReport(world, "transitions with distributed partitionings");
+
+    laik_finalize(inst);
+    return testExitCode();
+}
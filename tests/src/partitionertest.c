@@ -0,0 +1,711 @@
+// Test for partitioners
+//
+// Runs partitioners on 1d/2d/3d spaces and checks the resulting
+// partitionings, printing one summary line per partitioner:
+// - space-filling-curve partitioner: Morton and Hilbert curves, with and
+//   without index weights. Checks that the space is covered without
+//   overlap, that weights are balanced, and that distributed partitionings
+//   result in the same own slices
+// - weighted bisection partitioner: index and task weights are balanced;
+//   without weights, the total cut surface must not be larger than with
+//   the bisection partitioner
+// - graph partitioner: a 2d grid graph with scrambled vertex numbering is
+//   balanced with an edge cut much lower than with block partitioning.
+//   Also checks the graph halo partitioner
+// - stencil partitioner: face-only, asymmetric and full-box halos around
+//   base partitionings. Each task must get its own slices plus the halo
+//   cells, halos must go into the mapping of the slice they extend (also
+//   with tag 0 and tagged slices mixed in a task), and switching only
+//   communicates with neighbors touched by the stencil
+// - block partitioner: bulk index weights result in the same
+//   partitionings as per-index weights and are cached for runs with
+//   changed task weights
+
+#include "laik-internal.h"
+#include "testutil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// task weights: task i gets (i+1) parts
+double getTW(int rank, const void* userData)
+{
+    (void) userData;
+    return (double) (rank + 1);
+}
+
+// sum up index weights per task of slices in <sa> (1.0 without <f>)
+static
+double weightPerTask(Laik_SliceArray* sa, Laik_GetIdxWeight_t f, double* tw)
+{
+    int dims = sa->space->dims;
+    double totalW = 0.0;
+    for(unsigned int i = 0; i < sa->count; i++) {
+        Laik_Slice* s = &(sa->tslice[i].s);
+        Laik_Index idx = s->from;
+        while(1) {
+            double w = f ? f(&idx, 0) : 1.0;
+            tw[sa->tslice[i].task] += w;
+            totalW += w;
+            int d = 0;
+            while(d < dims) {
+                idx.i[d]++;
+                if (idx.i[d] < s->to.i[d]) break;
+                idx.i[d] = s->from.i[d];
+                d++;
+            }
+            if (d == dims) break;
+        }
+    }
+    return totalW;
+}
+
+// do slices of <p> cover its space exactly once?
+static
+bool isPartitioned(Laik_Partitioning* p)
+{
+    Laik_SliceArray* sa = laik_partitioning_allslices(p);
+    uint64_t size = 0;
+    for(unsigned int i = 0; i < sa->count; i++)
+        size += laik_slice_size(&(sa->tslice[i].s));
+    return laik_partitioning_coversSpace(p) &&
+           (size == laik_slice_size(&(p->space->s)));
+}
+
+//----------------------------------------------------------------------
+// space-filling-curve partitioner
+
+// weight increasing with distance from origin, heavy corner
+double sfcIW(Laik_Index* idx, const void* userData)
+{
+    (void) userData;
+    double w = 1.0 + (double) (idx->i[0] % 7);
+    if ((idx->i[0] < 10) && (idx->i[1] < 10) && (idx->i[2] < 10)) w += 20.0;
+    return w;
+}
+
+static
+void checkSFC(Laik_Group* world, Laik_Space* space,
+              Laik_SFCType type, Laik_GetIdxWeight_t f)
+{
+    int tasks = world->size;
+    int myid = world->myid;
+    Laik_Partitioner* pr = laik_new_sfc_partitioner(type, f, 0);
+    Laik_Partitioning* p = laik_new_partitioning(pr, world, space, 0);
+    Laik_SliceArray* sa = laik_partitioning_allslices(p);
+    checks++;
+
+    if (!isPartitioned(p)) {
+        printf("Task %d: %s: space not partitioned\n", myid, pr->name);
+        errors++;
+    }
+
+    // weight per task at most off by a maximal index weight
+    double* tw = calloc(tasks, sizeof(double));
+    double totalW = weightPerTask(sa, f, tw);
+    double maxW = f ? 28.0 : 1.0;
+    for(int t = 0; t < tasks; t++) {
+        if ((tw[t] < totalW / tasks - maxW) || (tw[t] > totalW / tasks + maxW)) {
+            printf("Task %d: %s: task %d has weight %.1f, expected %.1f\n",
+                   myid, pr->name, t, tw[t], totalW / tasks);
+            errors++;
+        }
+    }
+    free(tw);
+
+    // distributed partitioning must result in same own slices
+    Laik_Partitioning* dp = laik_new_distributed_partitioning(pr, world, space, 0);
+    int n = laik_my_slicecount(p);
+    if (laik_my_slicecount(dp) != n) {
+        printf("Task %d: %s: distributed partitioning differs\n", myid, pr->name);
+        errors++;
+    }
+    else {
+        for(int i = 0; i < n; i++) {
+            Laik_Slice s1 = *laik_taskslice_get_slice(laik_my_slice(p, i));
+            Laik_Slice s2 = *laik_taskslice_get_slice(laik_my_slice(dp, i));
+            if (!laik_slice_isEqual(&s1, &s2)) {
+                printf("Task %d: %s: distributed partitioning differs\n",
+                       myid, pr->name);
+                errors++;
+                break;
+            }
+        }
+    }
+
+    laik_free_partitioning(dp);
+    laik_free_partitioning(p);
+}
+
+static
+void testSFC(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_Space* spaces[4];
+    spaces[0] = laik_new_space_1d(inst, 1000);
+    spaces[1] = laik_new_space_2d(inst, 300, 200);
+    spaces[2] = laik_new_space_2d(inst, 1, 77);
+    spaces[3] = laik_new_space_3d(inst, 40, 30, 50);
+
+    for(int i = 0; i < 4; i++) {
+        checkSFC(world, spaces[i], LAIK_SFC_Morton, 0);
+        checkSFC(world, spaces[i], LAIK_SFC_Hilbert, 0);
+        checkSFC(world, spaces[i], LAIK_SFC_Morton, sfcIW);
+        checkSFC(world, spaces[i], LAIK_SFC_Hilbert, sfcIW);
+    }
+    testReport(world, "SFC partitionings");
+}
+
+//----------------------------------------------------------------------
+// weighted bisection partitioner
+
+// heavy region near origin
+double heavyIW(Laik_Index* idx, const void* userData)
+{
+    (void) userData;
+    if ((idx->i[0] < 20) && (idx->i[1] < 20) && (idx->i[2] < 20)) return 10.0;
+    return 1.0;
+}
+
+// total size of borders between slices
+static
+double cutSurface(Laik_SliceArray* sa, Laik_Space* space)
+{
+    double surface = 0.0;
+    for(unsigned int i = 0; i < sa->count; i++) {
+        Laik_Slice* s = &(sa->tslice[i].s);
+        for(int d = 0; d < space->dims; d++) {
+            double area = 1.0;
+            for(int dd = 0; dd < space->dims; dd++)
+                if (dd != d) area *= (double) (s->to.i[dd] - s->from.i[dd]);
+            if (s->from.i[d] > space->s.from.i[d]) surface += area;
+            if (s->to.i[d] < space->s.to.i[d]) surface += area;
+        }
+    }
+    return surface / 2;
+}
+
+static
+void checkWBisection(Laik_Group* world, Laik_Space* space,
+                     Laik_GetIdxWeight_t ifunc, Laik_GetTaskWeight_t tfunc)
+{
+    int tasks = world->size;
+    int myid = world->myid;
+    Laik_Partitioner* pr = laik_new_weighted_bisection_partitioner(ifunc, tfunc, 0);
+    Laik_Partitioning* p = laik_new_partitioning(pr, world, space, 0);
+    Laik_SliceArray* sa = laik_partitioning_allslices(p);
+    checks++;
+
+    if (!isPartitioned(p)) {
+        printf("Task %d: %dd: space not partitioned\n", myid, space->dims);
+        errors++;
+    }
+
+    // weights per task proportional to task weights (within 10%)
+    double* tw = calloc(tasks, sizeof(double));
+    double totalW = weightPerTask(sa, ifunc, tw);
+    double totalTW = 0.0;
+    for(int t = 0; t < tasks; t++)
+        totalTW += tfunc ? tfunc(t, 0) : 1.0;
+    for(int t = 0; t < tasks; t++) {
+        double expected = totalW * (tfunc ? tfunc(t, 0) : 1.0) / totalTW;
+        if ((tw[t] < 0.9 * expected) || (tw[t] > 1.1 * expected)) {
+            printf("Task %d: %dd: task %d has weight %.1f, expected %.1f\n",
+                   myid, space->dims, t, tw[t], expected);
+            errors++;
+        }
+    }
+    free(tw);
+
+    // without weights, cut surface must not be worse than with bisection
+    if (!ifunc && !tfunc) {
+        Laik_Partitioning* pb;
+        pb = laik_new_partitioning(laik_new_bisection_partitioner(),
+                                   world, space, 0);
+        double s1 = cutSurface(sa, space);
+        double s2 = cutSurface(laik_partitioning_allslices(pb), space);
+        if (s1 > s2) {
+            printf("Task %d: %dd: cut surface %.0f, bisection %.0f\n",
+                   myid, space->dims, s1, s2);
+            errors++;
+        }
+        laik_free_partitioning(pb);
+    }
+
+    // distributed partitioning must result in same own slices
+    Laik_Partitioning* dp = laik_new_distributed_partitioning(pr, world, space, 0);
+    int n = laik_my_slicecount(p);
+    if (laik_my_slicecount(dp) != n) {
+        printf("Task %d: %dd: distributed partitioning differs\n",
+               myid, space->dims);
+        errors++;
+    }
+    laik_free_partitioning(dp);
+    laik_free_partitioning(p);
+}
+
+static
+void testWBisection(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_Space* spaces[3];
+    spaces[0] = laik_new_space_1d(inst, 10000);
+    spaces[1] = laik_new_space_2d(inst, 600, 400);
+    spaces[2] = laik_new_space_3d(inst, 60, 50, 40);
+
+    for(int i = 0; i < 3; i++) {
+        checkWBisection(world, spaces[i], 0, 0);
+        checkWBisection(world, spaces[i], heavyIW, 0);
+        checkWBisection(world, spaces[i], 0, getTW);
+        checkWBisection(world, spaces[i], heavyIW, getTW);
+    }
+    testReport(world, "weighted bisection partitionings");
+}
+
+//----------------------------------------------------------------------
+// graph partitioner
+
+#define XSIZE 120
+#define YSIZE 100
+#define SCRAMBLE 7919
+
+static int n, xadj[XSIZE * YSIZE + 1], adjncy[4 * XSIZE * YSIZE];
+
+// vertex number of grid cell (x,y)
+static int vertex(int x, int y)
+{
+    return (int) (((int64_t) (y * XSIZE + x) * SCRAMBLE) % n);
+}
+
+// 5-point stencil grid graph, CSR sorted by vertex number
+static void buildGraph(void)
+{
+    n = XSIZE * YSIZE;
+    int* cell = malloc(n * sizeof(int));
+    for(int c = 0; c < n; c++)
+        cell[vertex(c % XSIZE, c / XSIZE)] = c;
+
+    int e = 0;
+    for(int v = 0; v < n; v++) {
+        int x = cell[v] % XSIZE, y = cell[v] / XSIZE;
+        xadj[v] = e;
+        if (x > 0) adjncy[e++] = vertex(x - 1, y);
+        if (x < XSIZE - 1) adjncy[e++] = vertex(x + 1, y);
+        if (y > 0) adjncy[e++] = vertex(x, y - 1);
+        if (y < YSIZE - 1) adjncy[e++] = vertex(x, y + 1);
+    }
+    xadj[n] = e;
+    free(cell);
+}
+
+// number of edges between different tasks
+static int edgeCut(Laik_Partitioning* p)
+{
+    int* owner = malloc(n * sizeof(int));
+    Laik_SliceArray* sa = laik_partitioning_allslices(p);
+    for(unsigned int i = 0; i < sa->count; i++)
+        for(int64_t v = sa->tslice[i].s.from.i[0]; v < sa->tslice[i].s.to.i[0]; v++)
+            owner[v] = sa->tslice[i].task;
+    int cut = 0;
+    for(int v = 0; v < n; v++)
+        for(int o = xadj[v]; o < xadj[v+1]; o++)
+            if (owner[adjncy[o]] != owner[v]) cut++;
+    free(owner);
+    return cut / 2;
+}
+
+static
+void testGraph(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+    int tasks = laik_size(world);
+    int myid = laik_myid(world);
+
+    buildGraph();
+    Laik_Space* space = laik_new_space_1d(inst, n);
+    Laik_Partitioner* pr = laik_new_graph_partitioner(n, xadj, adjncy, 0);
+    Laik_Partitioning* p = laik_new_partitioning(pr, world, space, 0);
+    Laik_SliceArray* sa = laik_partitioning_allslices(p);
+    checks++;
+
+    // every vertex assigned exactly once, balanced
+    int* count = calloc(tasks, sizeof(int));
+    for(unsigned int i = 0; i < sa->count; i++)
+        count[sa->tslice[i].task] += (int) laik_slice_size(&(sa->tslice[i].s));
+    if (!isPartitioned(p)) {
+        printf("Task %d: vertices not partitioned\n", myid);
+        errors++;
+    }
+    for(int t = 0; t < tasks; t++) {
+        if ((count[t] == 0) || (count[t] > 1.03 * n / tasks + 1)) {
+            printf("Task %d: task %d has %d vertices\n", myid, t, count[t]);
+            errors++;
+        }
+    }
+    free(count);
+
+    // much better than block partitioning on scrambled numbering, and
+    // not far from cutting the grid into stripes
+    Laik_Partitioning* pb = laik_new_partitioning(laik_new_block_partitioner1(),
+                                                  world, space, 0);
+    int cut = edgeCut(p);
+    int blockCut = edgeCut(pb);
+    if ((tasks > 1) && ((4 * cut > blockCut) || (cut > 2 * XSIZE * (tasks - 1)))) {
+        printf("Task %d: edge cut %d (block partitioning: %d)\n",
+               myid, cut, blockCut);
+        errors++;
+    }
+    laik_free_partitioning(pb);
+
+    // halo: own vertices plus neighbors
+    Laik_Partitioner* prh = laik_new_graph_halo_partitioner(n, xadj, adjncy);
+    Laik_Partitioning* ph = laik_new_partitioning(prh, world, space, p);
+    checks++;
+    char* mine = calloc(n, 1);
+    int expected = 0;
+    for(int sNo = 0; sNo < laik_my_slicecount(p); sNo++) {
+        const Laik_Slice* s = laik_taskslice_get_slice(laik_my_slice(p, sNo));
+        for(int64_t v = s->from.i[0]; v < s->to.i[0]; v++) {
+            if (!mine[v]) { mine[v] = 1; expected++; }
+            for(int o = xadj[v]; o < xadj[v+1]; o++)
+                if (!mine[adjncy[o]]) { mine[adjncy[o]] = 1; expected++; }
+        }
+    }
+    int got = 0, wrong = 0;
+    for(int sNo = 0; sNo < laik_my_slicecount(ph); sNo++) {
+        const Laik_Slice* s = laik_taskslice_get_slice(laik_my_slice(ph, sNo));
+        for(int64_t v = s->from.i[0]; v < s->to.i[0]; v++) {
+            if (!mine[v]) wrong++;
+            got++;
+        }
+    }
+    if ((got != expected) || (wrong > 0)) {
+        printf("Task %d: halo has %d vertices (%d wrong), expected %d\n",
+               myid, got, wrong, expected);
+        errors++;
+    }
+    free(mine);
+
+    // distributed partitionings result in same own slices
+    Laik_Partitioning* dp = laik_new_distributed_partitioning(pr, world, space, 0);
+    Laik_Partitioning* dph = laik_new_distributed_partitioning(prh, world, space, dp);
+    if ((laik_my_slicecount(dp) != laik_my_slicecount(p)) ||
+        (laik_my_slicecount(dph) != laik_my_slicecount(ph))) {
+        printf("Task %d: distributed partitioning differs\n", myid);
+        errors++;
+    }
+    laik_free_partitioning(dph);
+    laik_free_partitioning(dp);
+    laik_free_partitioning(ph);
+    laik_free_partitioning(p);
+
+    testReport(world, "graph partitionings");
+}
+
+//----------------------------------------------------------------------
+// stencil partitioner
+
+// is <idx> within the stencil-extended slice <s>?
+static
+bool inStencil(int dims, const Laik_Slice* s, Laik_Index* idx,
+               const int* lo, const int* hi, bool corners)
+{
+    int outside = 0;
+    for(int d = 0; d < dims; d++) {
+        if (idx->i[d] < s->from.i[d] - lo[d]) return false;
+        if (idx->i[d] >= s->to.i[d] + hi[d]) return false;
+        if ((idx->i[d] < s->from.i[d]) || (idx->i[d] >= s->to.i[d]))
+            outside++;
+    }
+    return corners || (outside <= 1);
+}
+
+// is <idx> within slice <s>?
+static
+bool inSlice(int dims, const Laik_Slice* s, Laik_Index* idx)
+{
+    for(int d = 0; d < dims; d++)
+        if ((idx->i[d] < s->from.i[d]) || (idx->i[d] >= s->to.i[d]))
+            return false;
+    return true;
+}
+
+// is <idx> within slices of <task> in slice array <sa>?
+// returns number of slices containing <idx>, stencil-extended if <lo> set
+static
+int taskSlices(Laik_SliceArray* sa, int task, Laik_Index* idx,
+               const int* lo, const int* hi, bool corners)
+{
+    int dims = sa->space->dims;
+    int found = 0;
+    for(unsigned int i = sa->off[task]; i < sa->off[task+1]; i++) {
+        Laik_Slice* s = &(sa->tslice[i].s);
+        if (lo) {
+            if (inStencil(dims, s, idx, lo, hi, corners)) found++;
+        }
+        else if (inSlice(dims, s, idx)) found++;
+    }
+    return found;
+}
+
+static
+void checkStencil(Laik_Group* world, Laik_Space* space, Laik_Partitioner* base,
+                  const int* lo, const int* hi, bool corners)
+{
+    int tasks = world->size;
+    int myid = world->myid;
+    int dims = space->dims;
+
+    Laik_Partitioner* pr = laik_new_stencil_partitioner(dims, lo, hi, corners);
+    Laik_Partitioning* pBase = laik_new_partitioning(base, world, space, 0);
+    Laik_Partitioning* pHalo = laik_new_partitioning(pr, world, space, pBase);
+    Laik_SliceArray* saBase = laik_partitioning_allslices(pBase);
+    Laik_SliceArray* saHalo = laik_partitioning_allslices(pHalo);
+    const char* name = base->name;
+    checks++;
+
+    // each task must get own indexes plus stencil halos, without overlap.
+    // as well, remember neighbors of this task touched by its halo
+    bool* isNeighbor = calloc(tasks, sizeof(bool));
+    for(int t = 0; t < tasks; t++) {
+        bool ok = true;
+        Laik_Index idx = space->s.from;
+        while(1) {
+            bool expected = taskSlices(saBase, t, &idx, lo, hi, corners) > 0;
+            int got = taskSlices(saHalo, t, &idx, 0, 0, false);
+            if (got != (expected ? 1 : 0)) ok = false;
+            if (expected && (t == myid)) {
+                for(int u = 0; u < tasks; u++)
+                    if ((u != t) && (taskSlices(saBase, u, &idx, 0, 0, false) > 0))
+                        isNeighbor[u] = true;
+            }
+            int d = 0;
+            while(d < dims) {
+                idx.i[d]++;
+                if (idx.i[d] < space->s.to.i[d]) break;
+                idx.i[d] = space->s.from.i[d];
+                d++;
+            }
+            if (d == dims) break;
+        }
+        if (!ok) {
+            printf("Task %d: %s/%dd: wrong halo slices for task %d\n",
+                   myid, name, dims, t);
+            errors++;
+        }
+
+        // halos must go into same mapping as the base slice
+        int maps = 0, haloMaps = 0;
+        for(unsigned int i = saBase->off[t]; i < saBase->off[t+1]; i++)
+            if (saBase->tslice[i].mapNo + 1 > maps)
+                maps = saBase->tslice[i].mapNo + 1;
+        for(unsigned int i = saHalo->off[t]; i < saHalo->off[t+1]; i++)
+            if (saHalo->tslice[i].mapNo + 1 > haloMaps)
+                haloMaps = saHalo->tslice[i].mapNo + 1;
+        if (haloMaps != maps) {
+            printf("Task %d: %s/%dd: task %d has %d mappings instead of %d\n",
+                   myid, name, dims, t, haloMaps, maps);
+            errors++;
+        }
+    }
+
+    // switch to halo partitioning must only receive from stencil neighbors
+    Laik_Data* data = laik_new_data(space, laik_Double);
+    laik_switchto_partitioning(data, pBase, LAIK_DF_None, LAIK_RO_None);
+    Laik_SwitchCost* c = laik_data_predict_switch(data, pHalo,
+                                                  LAIK_DF_Preserve,
+                                                  LAIK_RO_None);
+    assert(c != 0);
+    for(int u = 0; u < tasks; u++) {
+        if ((c->peerMsgRecv[u] > 0) != isNeighbor[u]) {
+            printf("Task %d: %s/%dd: %s from task %d\n", myid, name, dims,
+                   isNeighbor[u] ? "no message" : "needless message", u);
+            errors++;
+        }
+    }
+    laik_free_switchcost(c);
+    laik_free(data);
+    free(isNeighbor);
+
+    laik_free_partitioning(pHalo);
+    laik_free_partitioning(pBase);
+}
+
+// task t gets chunk t with tag 0 and chunk tasks+t with tag 1 of 2 * tasks
+// chunks, the last one up to the end of the space
+void runMixedTags(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
+{
+    int tasks = p->group->size;
+    int64_t size = p->space->s.to.i[0];
+    int64_t chunk = size / (2 * tasks);
+    Laik_Slice slc;
+    for(int t = 0; t < tasks; t++) {
+        laik_slice_init_1d(&slc, p->space, t * chunk, (t + 1) * chunk);
+        laik_append_slice(r, t, &slc, 0, 0);
+        int64_t to = (t == tasks - 1) ? size : (tasks + t + 1) * chunk;
+        laik_slice_init_1d(&slc, p->space, (tasks + t) * chunk, to);
+        laik_append_slice(r, t, &slc, 1, 0);
+    }
+}
+
+static
+void testStencil(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_Space* spaces[3];
+    spaces[0] = laik_new_space_1d(inst, 100);
+    spaces[1] = laik_new_space_2d(inst, 40, 30);
+    spaces[2] = laik_new_space_3d(inst, 12, 10, 8);
+
+    int one[3] = { 1, 1, 1 };
+    int lo[3] = { 2, 0, 1 };
+    int hi[3] = { 0, 3, 1 };
+
+    // block partitioner with 2 cycles: 2 slices per task with tag 0
+    // (with 1 task, its slices would be adjacent and halos overlap)
+    int cycles = (world->size > 1) ? 2 : 1;
+    Laik_Partitioner* block = laik_new_block_partitioner(0, cycles, 0, 0, 0);
+    checkStencil(world, spaces[0], block, one, one, false);
+    checkStencil(world, spaces[0], block, lo, hi, false);
+
+    // slices with tag 0 and 1 per task must stay in separate mappings
+    // (with 1 task, its slices are adjacent: check mappings without halos)
+    int zero[3] = { 0, 0, 0 };
+    int* depth = (world->size > 1) ? one : zero;
+    Laik_Partitioner* mixed = laik_new_partitioner("mixed", runMixedTags, 0, 0);
+    checkStencil(world, spaces[0], mixed, depth, depth, false);
+
+    // bisection: one slice per task with tag 1
+    Laik_Partitioner* bisection = laik_new_bisection_partitioner();
+    for(int i = 0; i < 3; i++) {
+        checkStencil(world, spaces[i], bisection, one, one, false);
+        checkStencil(world, spaces[i], bisection, lo, hi, false);
+        checkStencil(world, spaces[i], bisection, one, one, true);
+    }
+    testReport(world, "stencil partitionings");
+}
+
+//----------------------------------------------------------------------
+// index weights of block partitioner
+
+static int64_t requested = 0; // number of weights requested in bulk
+
+double blockIW(Laik_Index* idx, const void* userData)
+{
+    (void) userData;
+    return (double) ((idx->i[0] * 7919) % 13);
+}
+
+void blockIWs(int64_t from, int64_t to, double* w, const void* userData)
+{
+    (void) userData;
+    for(int64_t i = from; i < to; i++)
+        w[i - from] = (double) ((i * 7919) % 13);
+    requested += to - from;
+}
+
+// compare partitionings from <pr1> and <pr2>, check balance
+static
+void checkBlock(Laik_Group* g, Laik_Space* space,
+                Laik_Partitioner* pr1, Laik_Partitioner* pr2,
+                int cycles, bool useTW)
+{
+    Laik_Partitioning* p1 = laik_new_partitioning(pr1, g, space, 0);
+    Laik_Partitioning* p2 = laik_new_partitioning(pr2, g, space, 0);
+    Laik_SliceArray* sa1 = laik_partitioning_allslices(p1);
+    Laik_SliceArray* sa2 = laik_partitioning_allslices(p2);
+    int myid = g->myid;
+    checks++;
+
+    bool same = (sa1->count == sa2->count);
+    for(unsigned int i = 0; same && (i < sa1->count); i++) {
+        if ((sa1->tslice[i].task != sa2->tslice[i].task) ||
+            !laik_slice_isEqual(&(sa1->tslice[i].s), &(sa2->tslice[i].s)))
+            same = false;
+    }
+    if (!same) {
+        printf("Task %d: bulk weights give different partitioning\n", myid);
+        errors++;
+    }
+
+    // weight per task at most off by a maximal index weight per part
+    double* tw = calloc(g->size, sizeof(double));
+    double totalW = weightPerTask(sa2, blockIW, tw);
+    double totalTW = 0.0;
+    for(int t = 0; t < g->size; t++)
+        totalTW += useTW ? getTW(t, 0) : 1.0;
+    for(int t = 0; t < g->size; t++) {
+        double expected = totalW * (useTW ? getTW(t, 0) : 1.0) / totalTW;
+        double maxW = 12.0 * cycles;
+        if ((tw[t] < expected - maxW) || (tw[t] > expected + maxW)) {
+            printf("Task %d: task %d has weight %.1f, expected %.1f\n",
+                   myid, t, tw[t], expected);
+            errors++;
+        }
+    }
+    free(tw);
+
+    laik_free_partitioning(p1);
+    laik_free_partitioning(p2);
+}
+
+static
+void testBlock(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+    int myid = laik_myid(world);
+
+    int64_t size = 100000;
+    Laik_Space* space = laik_new_space_1d(inst, size);
+
+    for(int cycles = 1; cycles <= 3; cycles++) {
+        Laik_Partitioner* pr1 = laik_new_block_partitioner(0, cycles,
+                                                           blockIW, 0, 0);
+        Laik_Partitioner* pr2 = laik_new_block_partitioner(0, cycles,
+                                                           0, 0, 0);
+        laik_set_index_weights(pr2, blockIWs, 0);
+        requested = 0;
+        checkBlock(world, space, pr1, pr2, cycles, false);
+        if (requested < size) {
+            printf("Task %d: only %lld weights requested\n",
+                   myid, (long long) requested);
+            errors++;
+        }
+
+        // only task weights changed: weights only requested for cuts
+        laik_set_task_weight(pr1, getTW, 0);
+        laik_set_task_weight(pr2, getTW, 0);
+        requested = 0;
+        checkBlock(world, space, pr1, pr2, cycles, true);
+        if (requested >= size) {
+            printf("Task %d: weights not cached\n", myid);
+            errors++;
+        }
+
+        // setting index weights again drops cached weights
+        laik_set_index_weights(pr2, blockIWs, 0);
+        requested = 0;
+        checkBlock(world, space, pr1, pr2, cycles, true);
+        if (requested < size) {
+            printf("Task %d: cached weights used after reset\n", myid);
+            errors++;
+        }
+    }
+    testReport(world, "block partitionings");
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+
+    testSFC(inst);
+    testWBisection(inst);
+    testGraph(inst);
+    testStencil(inst);
+    testBlock(inst);
+
+    laik_finalize(inst);
+    return testExitCode();
+}
@@ -0,0 +1,346 @@
+// Test for slice arrays
+//
+// Prints one summary line per part:
+// - single index slices: appends 1d indexes in random order, in ascending
+//   and descending runs and with duplicates, for up to 300 synthetic
+//   tasks. Freezing must result in sorted, fully merged slices covering
+//   exactly the appended indexes of each task
+// - coverage: compares laik_slicearray_checkCoverage() with counting per
+//   index for random slice arrays in 1d/2d/3d, and checks large
+//   partitionings (many 1d blocks, 2d grid with halos)
+// - sharing: partitionings created by the same partitioner on the same
+//   space share their slice array. Freeing one of them keeps the others
+//   valid, and migration to a new group does not change partitionings
+//   sharing the slice array with the migrated one
+
+#include "laik-internal.h"
+#include "testutil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+//----------------------------------------------------------------------
+// single index slices
+
+static
+void checkSingle1d(Laik_Instance* inst, int64_t size, int tasks, int appends)
+{
+    Laik_Space* space = laik_new_space_1d(inst, size);
+    Laik_SliceArray* sa = laik_slicearray_new(space, (unsigned) tasks);
+    char* set = calloc(size * tasks, 1);
+    assert(set);
+    checks++;
+
+    for(int i = 0; i < appends; ) {
+        int task = rand() % tasks;
+        int64_t idx = ((int64_t) rand() * RAND_MAX + rand()) % size;
+        int len = 1 + rand() % 20;
+        int dir = (rand() % 3 == 0) ? -1 : 1;
+        for(int j = 0; j < len; j++, i++) {
+            if ((idx < 0) || (idx >= size)) break;
+            laik_slicearray_append_single1d(sa, task, idx);
+            set[task * size + idx] = 1;
+            // sometimes append same index twice
+            if (rand() % 10 == 0) {
+                laik_slicearray_append_single1d(sa, task, idx);
+                i++;
+            }
+            idx += dir;
+        }
+    }
+    laik_slicearray_freeze(sa, false);
+
+    bool ok = (sa->off[0] == 0) && (sa->off[tasks] == sa->count);
+    for(int t = 0; ok && (t < tasks); t++) {
+        int64_t last = -2;
+        for(unsigned int o = sa->off[t]; ok && (o < sa->off[t+1]); o++) {
+            Laik_TaskSlice_Gen* ts = &(sa->tslice[o]);
+            // sorted, merged, and covering only appended indexes
+            if ((ts->task != t) || (ts->s.from.i[0] <= last) ||
+                (ts->s.from.i[0] >= ts->s.to.i[0])) ok = false;
+            for(int64_t idx = ts->s.from.i[0]; ok && (idx < ts->s.to.i[0]); idx++) {
+                if (set[t * size + idx] != 1) ok = false;
+                set[t * size + idx] = 2;
+            }
+            last = ts->s.to.i[0];
+        }
+    }
+    // all appended indexes covered
+    for(int64_t i = 0; ok && (i < size * tasks); i++)
+        if (set[i] == 1) ok = false;
+
+    if (!ok) {
+        printf("Error for %d tasks, size %lld\n", tasks, (long long) size);
+        errors++;
+    }
+
+    free(set);
+    laik_slicearray_free(sa);
+    free(sa);
+}
+
+static
+void testSingle1d(Laik_Instance* inst)
+{
+    checkSingle1d(inst, 1, 1, 5);
+    checkSingle1d(inst, 1000, 3, 5000);
+    checkSingle1d(inst, 5000, 300, 20000);
+    checkSingle1d(inst, 70000, 20, 100000);
+    checkSingle1d(inst, 3000000, 2, 200000);
+    testReport(laik_world(inst), "single index slice arrays");
+}
+
+//----------------------------------------------------------------------
+// coverage and overlap checks
+
+static
+void randomSlice(Laik_Slice* s, Laik_Space* space, int64_t size)
+{
+    laik_slice_init_copy(s, &(space->s));
+    for(int d = 0; d < space->dims; d++) {
+        int64_t from = rand() % size;
+        int64_t to = from + 1 + rand() % size;
+        if (to > size) to = size;
+        s->from.i[d] = from;
+        s->to.i[d] = to;
+    }
+}
+
+// compare with counting slices per index
+static
+void checkRandomCoverage(Laik_Instance* inst, int dims, int slices)
+{
+    int64_t size = 8;
+    Laik_Space* space;
+    if (dims == 1) space = laik_new_space_1d(inst, size);
+    else if (dims == 2) space = laik_new_space_2d(inst, size, size);
+    else space = laik_new_space_3d(inst, size, size, size);
+
+    Laik_SliceArray* sa = laik_slicearray_new(space, 1);
+    Laik_Slice s;
+    for(int i = 0; i < slices; i++) {
+        randomSlice(&s, space, size);
+        laik_slicearray_append(sa, 0, &s, 0, 0);
+    }
+    laik_slicearray_freeze(sa, false);
+    checks++;
+
+    bool covered = true, overlapping = false;
+    Laik_Index idx;
+    laik_index_init(&idx, 0, 0, 0);
+    while(1) {
+        int n = 0;
+        for(unsigned int o = 0; o < sa->count; o++) {
+            Laik_Slice* ts = &(sa->tslice[o].s);
+            bool in = true;
+            for(int d = 0; d < dims; d++)
+                if ((idx.i[d] < ts->from.i[d]) || (idx.i[d] >= ts->to.i[d]))
+                    in = false;
+            if (in) n++;
+        }
+        if (n == 0) covered = false;
+        if (n > 1) overlapping = true;
+
+        int d = 0;
+        while(d < dims) {
+            idx.i[d]++;
+            if (idx.i[d] < size) break;
+            idx.i[d] = 0;
+            d++;
+        }
+        if (d == dims) break;
+    }
+
+    int overlap[2];
+    bool res = laik_slicearray_checkCoverage(sa, overlap);
+    if ((res != covered) || (laik_slicearray_coversSpace(sa) != covered)) {
+        printf("Error in %dd with %d slices: coverage %d, expected %d\n",
+               dims, slices, res, covered);
+        errors++;
+    }
+    if ((overlap[0] >= 0) != overlapping) {
+        printf("Error in %dd with %d slices: overlap %s\n",
+               dims, slices, overlapping ? "not found" : "reported");
+        errors++;
+    }
+    else if (overlapping &&
+             ((overlap[0] == overlap[1]) ||
+              !laik_slice_intersect(&(sa->tslice[overlap[0]].s),
+                                    &(sa->tslice[overlap[1]].s)))) {
+        printf("Error in %dd with %d slices: wrong overlap %d/%d\n",
+               dims, slices, overlap[0], overlap[1]);
+        errors++;
+    }
+
+    laik_slicearray_free(sa);
+    free(sa);
+}
+
+static
+void testCoverage(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+    int overlap[2];
+
+    srand(7);
+    for(int dims = 1; dims <= 3; dims++)
+        for(int slices = 0; slices < 40; slices++)
+            for(int r = 0; r < 20; r++)
+                checkRandomCoverage(inst, dims, slices);
+
+    // 1d: many blocks, then with a gap
+    Laik_Space* s1 = laik_new_space_1d(inst, 2000000);
+    Laik_Partitioner* pr = laik_new_block_partitioner(0, 100, 0, 0, 0);
+    Laik_PartitionerParams params = { s1, world, pr, 0 };
+    Laik_SliceArray* sa = laik_run_partitioner(&params, 0);
+    checks++;
+    if (!laik_slicearray_checkCoverage(sa, overlap) || (overlap[0] >= 0)) {
+        printf("Error: 1d blocks not exclusive\n");
+        errors++;
+    }
+    sa->tslice[sa->count / 2].s.to.i[0]--;
+    checks++;
+    if (laik_slicearray_coversSpace(sa)) {
+        printf("Error: gap in 1d blocks not found\n");
+        errors++;
+    }
+    laik_slicearray_free(sa);
+    free(sa);
+
+    // 2d: 300x300 grid of blocks, exclusive, then extended by halos
+    int64_t n = 300, bs = 4;
+    Laik_Space* s2 = laik_new_space_2d(inst, n * bs, n * bs);
+    Laik_SliceArray* sa2 = laik_slicearray_new(s2, 1);
+    Laik_SliceArray* sa3 = laik_slicearray_new(s2, 1);
+    for(int64_t y = 0; y < n; y++)
+        for(int64_t x = 0; x < n; x++) {
+            Laik_Slice slc;
+            laik_slice_init_2d(&slc, s2, x * bs, (x + 1) * bs,
+                               y * bs, (y + 1) * bs);
+            laik_slicearray_append(sa2, 0, &slc, 0, 0);
+            if (x > 0) slc.from.i[0]--;
+            if (y < n - 1) slc.to.i[1]++;
+            laik_slicearray_append(sa3, 0, &slc, 0, 0);
+        }
+    laik_slicearray_freeze(sa2, false);
+    laik_slicearray_freeze(sa3, false);
+    checks += 2;
+    if (!laik_slicearray_checkCoverage(sa2, overlap) || (overlap[0] >= 0)) {
+        printf("Error: 2d grid not exclusive\n");
+        errors++;
+    }
+    if (!laik_slicearray_checkCoverage(sa3, overlap) || (overlap[0] < 0)) {
+        printf("Error: overlap of 2d halos not found\n");
+        errors++;
+    }
+    laik_slicearray_free(sa2);
+    laik_slicearray_free(sa3);
+    free(sa2);
+    free(sa3);
+
+    testReport(world, "slice arrays for coverage");
+}
+
+//----------------------------------------------------------------------
+// sharing of identical slice arrays among partitionings
+
+static
+void expect(bool ok, const char* msg)
+{
+    checks++;
+    if (!ok) {
+        printf("Error: %s\n", msg);
+        errors++;
+    }
+}
+
+// task 0 gets no indexes, to allow removing it from the group
+double noIndexesForTask0(int rank, const void* userData)
+{
+    (void) userData;
+    return (rank == 0) ? 0.0 : 1.0;
+}
+
+static
+void testSharing(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+
+    Laik_Space* space = laik_new_space_2d(inst, 100, 50);
+    Laik_Space* space2 = laik_new_space_2d(inst, 100, 50);
+    Laik_Partitioner* block = laik_new_block_partitioner1();
+    Laik_Partitioner* bisection = laik_new_bisection_partitioner();
+
+    Laik_Partitioning* p1 = laik_new_partitioning(block, world, space, 0);
+    Laik_Partitioning* p2 = laik_new_partitioning(block, world, space, 0);
+    Laik_Partitioning* p3 = laik_new_partitioning(block, world, space2, 0);
+    Laik_Partitioning* p4 = laik_new_partitioning(bisection, world, space, 0);
+    Laik_SliceArray* sa1 = laik_partitioning_allslices(p1);
+    Laik_SliceArray* sa2 = laik_partitioning_allslices(p2);
+    Laik_SliceArray* sa3 = laik_partitioning_allslices(p3);
+    Laik_SliceArray* sa4 = laik_partitioning_allslices(p4);
+
+    expect((sa1 == sa2) && (sa1->refcount == 2),
+           "identical partitionings not sharing slices");
+    expect(sa1 != sa3, "slices shared among different spaces");
+    expect(laik_partitioning_isEqual(p1, p2), "shared slices not equal");
+    expect(laik_slicearray_isEqual(sa1, sa4) ==
+           laik_slicearray_isEqual(sa4, sa1), "equality not symmetric");
+
+    // freeing one user keeps slices valid for the other
+    laik_free_partitioning(p1);
+    expect((sa2->refcount == 1) && laik_slicearray_coversSpace(sa2),
+           "slices of remaining user invalid");
+    Laik_Partitioning* p5 = laik_new_partitioning(block, world, space, 0);
+    expect(laik_partitioning_allslices(p5) == sa2,
+           "slices not shared after freeing a user");
+    laik_free_partitioning(p2);
+    laik_free_partitioning(p5);
+    laik_free_partitioning(p3);
+    laik_free_partitioning(p4);
+
+    // migration works on a copy of shared slices
+    if (world->size > 1) {
+        Laik_Partitioner* pr = laik_new_block_partitioner1();
+        laik_set_task_weight(pr, noIndexesForTask0, 0);
+        Laik_Partitioning* q1 = laik_new_partitioning(pr, world, space, 0);
+        Laik_Partitioning* q2 = laik_new_partitioning(pr, world, space, 0);
+        Laik_SliceArray* sa = laik_partitioning_allslices(q1);
+        expect(laik_partitioning_allslices(q2) == sa, "slices not shared");
+        unsigned int count = sa->count;
+
+        int removeList[1] = { 0 };
+        Laik_Group* g = laik_new_shrinked_group(world, 1, removeList);
+        laik_partitioning_migrate(q1, g);
+        Laik_SliceArray* saM = laik_partitioning_allslices(q1);
+        expect((saM != sa) && (saM->tid_count == (unsigned) g->size) &&
+               (sa->tid_count == (unsigned) world->size) &&
+               (sa->refcount == 1) && (saM->count == count),
+               "migration modified shared slices");
+
+        // migrating the other user shares the migrated slices again
+        laik_partitioning_migrate(q2, g);
+        expect((laik_partitioning_allslices(q2) == saM) &&
+               (saM->refcount == 2), "migrated slices not shared");
+        expect(laik_partitioning_isEqual(q1, q2), "migrated slices differ");
+
+        laik_free_partitioning(q1);
+        laik_free_partitioning(q2);
+    }
+
+    testReport(world, "shared slice arrays");
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+
+    testSingle1d(inst);
+    testCoverage(inst);
+    testSharing(inst);
+
+    laik_finalize(inst);
+    return testExitCode();
+}
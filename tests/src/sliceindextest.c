@@ -0,0 +1,160 @@
+// Test for intersection queries on slice arrays (using a spatial index)
+//
+// Checks results against checking all slices for random slice arrays.
+// With "-b", additionally runs a benchmark with up to 100k synthetic tasks,
+// each owning one block of a 2d/3d space, querying the neighbors of a task
+// as done in transition calculation.
+
+#include "laik-internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static unsigned int *res = 0;
+static unsigned int resSize = 0;
+
+static
+void randomSlice(Laik_Slice* s, Laik_Space* space, int64_t size)
+{
+    int dims = space->dims;
+    laik_slice_init_copy(s, &(space->s));
+    for(int d = 0; d < dims; d++) {
+        int64_t from = rand() % size;
+        int64_t to = from + rand() % (size / 4 + 1);
+        if (to > size) to = size;
+        s->from.i[d] = from;
+        s->to.i[d] = to;
+    }
+}
+
+// compare query results with checking all slices
+static
+void checkQueries(Laik_Instance* inst, int dims, int tasks, int slices)
+{
+    int64_t size = 1000;
+    Laik_Space* space;
+    if (dims == 1) space = laik_new_space_1d(inst, size);
+    else if (dims == 2) space = laik_new_space_2d(inst, size, size);
+    else space = laik_new_space_3d(inst, size, size, size);
+
+    Laik_SliceArray* sa = laik_slicearray_new(space, (unsigned) tasks);
+    Laik_Slice s;
+    for(int i = 0; i < slices; i++) {
+        randomSlice(&s, space, size);
+        laik_slicearray_append(sa, rand() % tasks, &s, 0, 0);
+    }
+    laik_slicearray_freeze(sa, false);
+
+    for(int q = 0; q < 200; q++) {
+        randomSlice(&s, space, size);
+        unsigned int n = laik_slicearray_intersecting(sa, &s, &res, &resSize);
+
+        unsigned int k = 0;
+        for(unsigned int o = 0; o < sa->count; o++) {
+            if (!laik_slice_intersect(&(sa->tslice[o].s), &s)) continue;
+            assert(k < n);
+            assert(res[k] == o);
+            k++;
+        }
+        assert(k == n);
+    }
+
+    laik_slicearray_free(sa);
+    free(sa);
+    laik_free_space(space);
+}
+
+// block decomposition of a 2d/3d space among <tasks>, one slice per task
+static
+void benchQueries(Laik_Instance* inst, int dims, int tasks)
+{
+    // blocks per dimension
+    int b = 1;
+    while(b * (dims == 2 ? b : b * b) < tasks) b++;
+    int bcount = (dims == 2) ? b * b : b * b * b;
+    int64_t bsize = 10;
+    int64_t size = b * bsize;
+
+    Laik_Space* space;
+    if (dims == 2) space = laik_new_space_2d(inst, size, size);
+    else space = laik_new_space_3d(inst, size, size, size);
+
+    Laik_SliceArray* sa = laik_slicearray_new(space, (unsigned) bcount);
+    Laik_Slice s;
+    laik_slice_init_copy(&s, &(space->s));
+    for(int t = 0; t < bcount; t++) {
+        int bi = t;
+        for(int d = 0; d < dims; d++) {
+            s.from.i[d] = (bi % b) * bsize;
+            s.to.i[d] = s.from.i[d] + bsize;
+            bi = bi / b;
+        }
+        laik_slicearray_append(sa, t, &s, 0, 0);
+    }
+    laik_slicearray_freeze(sa, false);
+
+    // first query builds index
+    double t0 = laik_wtime();
+    laik_slicearray_intersecting(sa, &s, &res, &resSize);
+
+    // query own block with halo of 1 for some tasks
+    int queries = 1000;
+    double t1 = laik_wtime();
+    unsigned int found = 0;
+    for(int q = 0; q < queries; q++) {
+        int t = (int) ((int64_t) q * bcount / queries);
+        s = sa->tslice[sa->off[t]].s;
+        for(int d = 0; d < dims; d++) {
+            s.from.i[d]--;
+            s.to.i[d]++;
+        }
+        found += laik_slicearray_intersecting(sa, &s, &res, &resSize);
+    }
+    double t2 = laik_wtime();
+    for(int q = 0; q < queries; q++) {
+        int t = (int) ((int64_t) q * bcount / queries);
+        s = sa->tslice[sa->off[t]].s;
+        for(int d = 0; d < dims; d++) {
+            s.from.i[d]--;
+            s.to.i[d]++;
+        }
+        for(unsigned int o = 0; o < sa->count; o++)
+            if (laik_slice_intersect(&(sa->tslice[o].s), &s)) found--;
+    }
+    double t3 = laik_wtime();
+    assert(found == 0);
+
+    printf("%dd, %6d tasks: index build %7.3f ms, query %6.3f us"
+           " (checking all slices: %8.3f us)\n",
+           dims, bcount, (t1 - t0) * 1e3,
+           (t2 - t1) * 1e6 / queries, (t3 - t2) * 1e6 / queries);
+
+    laik_slicearray_free(sa);
+    free(sa);
+    laik_free_space(space);
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    bool doBench = (argc > 1) && (strcmp(argv[1], "-b") == 0);
+
+    srand(1);
+    for(int dims = 1; dims <= 3; dims++) {
+        checkQueries(inst, dims, 4, 10);
+        checkQueries(inst, dims, 100, 1000);
+        checkQueries(inst, dims, 10000, 10000);
+    }
+    printf("Slice array queries OK\n");
+
+    if (doBench) {
+        for(int dims = 2; dims <= 3; dims++)
+            for(int tasks = 1000; tasks <= 100000; tasks *= 10)
+                benchQueries(inst, dims, tasks);
+    }
+
+    laik_finalize(inst);
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Test for predicting the cost of switching a container
+//
+// Predicts switches between block partitionings with different task
+// weights and for a reduction, executes them and compares the prediction
+// with the statistics of the executed switch.
+
+#include "laik-internal.h"
+#include "testutil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// task weights: task i gets (i+1) parts
+double getTW(int rank, const void* userData)
+{
+    (void) userData;
+    return (double) (rank + 1);
+}
+
+// predict switch of <d> to <toP>, execute it and compare
+static
+void check(const char* name, Laik_Data* d, Laik_Partitioning* toP,
+           Laik_DataFlow flow, Laik_ReductionOperation redOp)
+{
+    int myid = laik_myid(toP->group);
+
+    Laik_SwitchCost* c = laik_data_predict_switch(d, toP, flow, redOp);
+    assert(c != 0);
+    checks++;
+
+    // per-peer values must sum up to totals
+    uint64_t sendBytes = 0, recvBytes = 0;
+    unsigned int sendMsgs = 0, recvMsgs = 0;
+    for(int i = 0; i < c->peers; i++) {
+        sendBytes += c->peerByteSend[i];
+        recvBytes += c->peerByteRecv[i];
+        sendMsgs += c->peerMsgSend[i];
+        recvMsgs += c->peerMsgRecv[i];
+    }
+    if ((sendBytes != c->byteSendCount) || (recvBytes != c->byteRecvCount) ||
+        (sendMsgs != c->msgSendCount) || (recvMsgs != c->msgRecvCount)) {
+        printf("Task %d: %s: per-peer counts do not match totals\n",
+               myid, name);
+        errors++;
+    }
+
+    // compare with statistics of executed switch
+    Laik_SwitchStat before = *(d->stat);
+    laik_switchto_partitioning(d, toP, flow, redOp);
+    Laik_SwitchStat* after = d->stat;
+    if ((c->byteSendCount != after->byteSendCount - before.byteSendCount) ||
+        (c->byteRecvCount != after->byteRecvCount - before.byteRecvCount) ||
+        (c->byteReduceCount != after->byteReduceCount - before.byteReduceCount)) {
+        printf("Task %d: %s: predicted %llu/%llu/%llu bytes send/recv/reduce,"
+               " got %llu/%llu/%llu\n", myid, name,
+               (unsigned long long) c->byteSendCount,
+               (unsigned long long) c->byteRecvCount,
+               (unsigned long long) c->byteReduceCount,
+               (unsigned long long) (after->byteSendCount - before.byteSendCount),
+               (unsigned long long) (after->byteRecvCount - before.byteRecvCount),
+               (unsigned long long) (after->byteReduceCount - before.byteReduceCount));
+        errors++;
+    }
+
+    laik_free_switchcost(c);
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+    int size = laik_size(world);
+
+    Laik_Space* space = laik_new_space_1d(inst, 100000);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    Laik_Partitioning* p1 = laik_new_partitioning(laik_new_block_partitioner1(),
+                                                  world, space, 0);
+    Laik_Partitioning* p2;
+    p2 = laik_new_partitioning(laik_new_block_partitioner_tw1(getTW, 0),
+                               world, space, 0);
+    Laik_Partitioning* pAll = laik_new_partitioning(laik_All, world, space, 0);
+
+    laik_switchto_partitioning(d, p1, LAIK_DF_None, LAIK_RO_None);
+    laik_fill_double(d, 1.0);
+
+    check("same", d, p1, LAIK_DF_Preserve, LAIK_RO_None);
+    check("weighted", d, p2, LAIK_DF_Preserve, LAIK_RO_None);
+    check("back", d, p1, LAIK_DF_Preserve, LAIK_RO_None);
+
+    // no communication needed if partitioning does not change
+    Laik_SwitchCost* c = laik_data_predict_switch(d, p1, LAIK_DF_Preserve,
+                                                  LAIK_RO_None);
+    checks++;
+    if ((c->msgSendCount > 0) || (c->msgRecvCount > 0) ||
+        (c->byteCopyCount == 0)) {
+        printf("Task %d: unexpected cost for same partitioning\n",
+               laik_myid(world));
+        errors++;
+    }
+    laik_free_switchcost(c);
+
+    // with multiple tasks, weighted partitioning requires communication
+    c = laik_data_predict_switch(d, p2, LAIK_DF_Preserve, LAIK_RO_None);
+    checks++;
+    if ((c->peers != size) || ((size > 1) && (c->byteSendCount +
+                                              c->byteRecvCount == 0))) {
+        printf("Task %d: unexpected cost for weighted partitioning\n",
+               laik_myid(world));
+        errors++;
+    }
+    laik_free_switchcost(c);
+
+    check("all", d, pAll, LAIK_DF_Preserve, LAIK_RO_None);
+    check("sum", d, pAll, LAIK_DF_Preserve, LAIK_RO_Sum);
+    check("sum-block", d, p2, LAIK_DF_Preserve, LAIK_RO_Sum);
+
+    testReport(world, "switch cost predictions");
+
+    laik_finalize(inst);
+    return testExitCode();
+}
@@ -0,0 +1,103 @@
+// Helpers shared by the unit tests in this directory
+//
+// Tests count checks and errors found in <checks> and <errors>, printing
+// a message for each error. testReport() prints a summary line from
+// task 0, which test scripts compare with an .expected file.
+
+#ifndef LAIK_TESTUTIL_H
+#define LAIK_TESTUTIL_H
+
+#include "laik-internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int checks = 0, errors = 0;
+static int failedReports = 0;
+
+// print summary of checks done since last report, and reset counters
+static inline
+void testReport(Laik_Group* g, const char* what)
+{
+    if (laik_myid(g) == 0)
+        printf("Checked %d %s: %s\n", checks, what, errors ? "Errors" : "OK");
+    if (errors > 0) failedReports++;
+    checks = 0;
+    errors = 0;
+}
+
+// exit code for test: 1 if any report had errors
+static inline
+int testExitCode(void)
+{
+    return (failedReports > 0) ? 1 : 0;
+}
+
+// same tasks in sub-group <g1> of <t1> and <g2> of <t2>?
+// (negative IDs denote special groups, see laik_trans_groupCount)
+static inline
+bool sameSubgroup(Laik_Transition* t1, int g1, Laik_Transition* t2, int g2)
+{
+    if ((g1 < 0) || (g2 < 0)) return g1 == g2;
+
+    TaskGroup* tg1 = &(t1->subgroup[g1]);
+    TaskGroup* tg2 = &(t2->subgroup[g2]);
+    if (tg1->count != tg2->count) return false;
+    return memcmp(tg1->task, tg2->task, tg1->count * sizeof(int)) == 0;
+}
+
+// compare transitions field-wise: unused dimensions of slices may be
+// arbitrary, and sub-groups are compared by their tasks
+static inline
+bool sameTransition(Laik_Transition* t1, Laik_Transition* t2)
+{
+    if ((t1 == 0) || (t2 == 0)) return t1 == t2;
+
+    if ((t1->localCount != t2->localCount) ||
+        (t1->initCount  != t2->initCount) ||
+        (t1->sendCount  != t2->sendCount) ||
+        (t1->recvCount  != t2->recvCount) ||
+        (t1->redCount   != t2->redCount) ||
+        (t1->subgroupCount != t2->subgroupCount)) return false;
+
+    for(int i = 0; i < t1->localCount; i++) {
+        struct localTOp *op1 = &(t1->local[i]), *op2 = &(t2->local[i]);
+        if (!laik_slice_isEqual(&(op1->slc), &(op2->slc)) ||
+            (op1->fromSliceNo != op2->fromSliceNo) ||
+            (op1->toSliceNo != op2->toSliceNo) ||
+            (op1->fromMapNo != op2->fromMapNo) ||
+            (op1->toMapNo != op2->toMapNo)) return false;
+    }
+    for(int i = 0; i < t1->initCount; i++) {
+        struct initTOp *op1 = &(t1->init[i]), *op2 = &(t2->init[i]);
+        if (!laik_slice_isEqual(&(op1->slc), &(op2->slc)) ||
+            (op1->sliceNo != op2->sliceNo) || (op1->mapNo != op2->mapNo) ||
+            (op1->redOp != op2->redOp)) return false;
+    }
+    for(int i = 0; i < t1->sendCount; i++) {
+        struct sendTOp *op1 = &(t1->send[i]), *op2 = &(t2->send[i]);
+        if (!laik_slice_isEqual(&(op1->slc), &(op2->slc)) ||
+            (op1->sliceNo != op2->sliceNo) || (op1->mapNo != op2->mapNo) ||
+            (op1->toTask != op2->toTask)) return false;
+    }
+    for(int i = 0; i < t1->recvCount; i++) {
+        struct recvTOp *op1 = &(t1->recv[i]), *op2 = &(t2->recv[i]);
+        if (!laik_slice_isEqual(&(op1->slc), &(op2->slc)) ||
+            (op1->sliceNo != op2->sliceNo) || (op1->mapNo != op2->mapNo) ||
+            (op1->fromTask != op2->fromTask)) return false;
+    }
+    for(int i = 0; i < t1->redCount; i++) {
+        struct redTOp *op1 = &(t1->red[i]), *op2 = &(t2->red[i]);
+        if (!laik_slice_isEqual(&(op1->slc), &(op2->slc)) ||
+            (op1->redOp != op2->redOp) ||
+            !sameSubgroup(t1, op1->inputGroup, t2, op2->inputGroup) ||
+            !sameSubgroup(t1, op1->outputGroup, t2, op2->outputGroup) ||
+            (op1->myInputSliceNo != op2->myInputSliceNo) ||
+            (op1->myOutputSliceNo != op2->myOutputSliceNo) ||
+            (op1->myInputMapNo != op2->myInputMapNo) ||
+            (op1->myOutputMapNo != op2->myOutputMapNo)) return false;
+    }
+    return true;
+}
+
+#endif // LAIK_TESTUTIL_H
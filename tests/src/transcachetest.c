@@ -0,0 +1,289 @@
+// Test for the transition cache of containers
+//
+// Prints one summary line per part:
+// - pending switches: starts split-phase switches of a container between
+//   a block and a weighted block partitioning and invalidates cached
+//   transitions before the switch is completed, as done when a
+//   partitioning is freed or migrated. The pending switch must be
+//   completed first, and values must be preserved. This is checked both
+//   with cached action sequences (using a reservation) and with sequences
+//   created on the fly
+// - retired transitions: frees a partitioning with cached transitions,
+//   which are kept as base for incremental calculation. They must not
+//   refer to the partitionings or their group any longer. Switches to new
+//   partitionings from the same partitioners, also on a shrinked group,
+//   must preserve values
+// - moved buffers: cached sequences only borrow their buffers from the
+//   pool while executing. Holding pool buffers between switches makes
+//   the next executions get buffers at other addresses, which must not
+//   break the sequences (including persistent MPI requests)
+
+#include "laik-internal.h"
+#include "testutil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static const int64_t size = 100000;
+
+// task weights: task i gets (i+1) parts
+double getTW(int rank, const void* userData)
+{
+    (void) userData;
+    return (double) (rank + 1);
+}
+
+// set each element to its global index
+static
+void fillIndex(Laik_Data* d)
+{
+    Laik_Partitioning* p = d->activePartitioning;
+    for(int n = 0; n < laik_my_slicecount(p); n++) {
+        int64_t from, to;
+        double* base;
+        laik_my_slice_1d(p, n, &from, &to);
+        int mapNo = laik_taskslice_get_mapNo(laik_my_slice(p, n));
+        Laik_Mapping* m = laik_get_map_1d(d, mapNo, (void**) &base, 0);
+        int64_t off = m->requiredSlice.from.i[0];
+        for(int64_t i = from; i < to; i++)
+            base[i - off] = (double) i;
+    }
+}
+
+// check that each element is set to its global index
+static
+void checkIndex(const char* name, Laik_Data* d)
+{
+    checks++;
+    if (d->pendingASeq) {
+        printf("Task %d: %s: switch still pending\n",
+               laik_myid(d->activePartitioning->group), name);
+        errors++;
+        return;
+    }
+    Laik_Partitioning* p = d->activePartitioning;
+    for(int n = 0; n < laik_my_slicecount(p); n++) {
+        int64_t from, to;
+        double* base;
+        laik_my_slice_1d(p, n, &from, &to);
+        int mapNo = laik_taskslice_get_mapNo(laik_my_slice(p, n));
+        Laik_Mapping* m = laik_get_map_1d(d, mapNo, (void**) &base, 0);
+        int64_t off = m->requiredSlice.from.i[0];
+        for(int64_t i = from; i < to; i++) {
+            if (base[i - off] == (double) i) continue;
+            printf("Task %d: %s: value at %lld is %f\n",
+                   laik_myid(p->group), name, (long long) i, base[i - off]);
+            errors++;
+            return;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// invalidation of cached transitions during pending switches
+
+static
+void testPending(Laik_Instance* inst, bool useReservation)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_Space* space = laik_new_space_1d(inst, size);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    Laik_Partitioning* p1 = laik_new_partitioning(laik_new_block_partitioner1(),
+                                                  world, space, 0);
+    Laik_Partitioning* p2;
+    p2 = laik_new_partitioning(laik_new_block_partitioner_tw1(getTW, 0),
+                               world, space, 0);
+
+    if (useReservation) {
+        // with stable mappings, action sequences are kept in the cache
+        Laik_Reservation* r = laik_reservation_new(d);
+        laik_reservation_add(r, p1);
+        laik_reservation_add(r, p2);
+        laik_reservation_alloc(r);
+        laik_data_use_reservation(d, r);
+    }
+
+    laik_switchto_partitioning(d, p1, LAIK_DF_None, LAIK_RO_None);
+    fillIndex(d);
+
+    // fill the cache with transitions in both directions
+    laik_switchto_partitioning(d, p2, LAIK_DF_Preserve, LAIK_RO_None);
+    laik_switchto_partitioning(d, p1, LAIK_DF_Preserve, LAIK_RO_None);
+    checkIndex("cached", d);
+
+    // cached transitions to <p2> get invalid while switching to it
+    laik_switchto_partitioning_start(d, p2, LAIK_DF_Preserve, LAIK_RO_None);
+    laik_data_transcache_invalidate(inst, p2);
+    checkIndex("invalidate target", d);
+    laik_switchto_wait(d);
+
+    // same, with source of switch
+    laik_switchto_partitioning_start(d, p1, LAIK_DF_Preserve, LAIK_RO_None);
+    laik_data_transcache_invalidate(inst, p2);
+    checkIndex("invalidate source", d);
+    laik_switchto_wait(d);
+
+    if (!useReservation) {
+        // free source partitioning of pending switch
+        laik_switchto_partitioning_start(d, p2, LAIK_DF_Preserve, LAIK_RO_None);
+        laik_free_partitioning(p1);
+        checkIndex("free source", d);
+        laik_switchto_wait(d);
+    }
+}
+
+//----------------------------------------------------------------------
+// retired transitions as base for incremental calculation
+
+static
+void testRetired(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_Space* space = laik_new_space_1d(inst, size);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    Laik_Partitioner* pr1 = laik_new_block_partitioner1();
+    Laik_Partitioner* pr2 = laik_new_block_partitioner_tw1(getTW, 0);
+    Laik_Partitioning* p1 = laik_new_partitioning(pr1, world, space, 0);
+    Laik_Partitioning* p2 = laik_new_partitioning(pr2, world, space, 0);
+
+    laik_switchto_partitioning(d, p1, LAIK_DF_None, LAIK_RO_None);
+    fillIndex(d);
+    laik_switchto_partitioning(d, p2, LAIK_DF_Preserve, LAIK_RO_None);
+    laik_switchto_partitioning(d, p1, LAIK_DF_Preserve, LAIK_RO_None);
+
+    laik_free_partitioning(p2);
+    for(int i = 0; i < d->transCacheCount; i++) {
+        Laik_TransCacheEntry* e = &(d->transCache[i]);
+        if (!e->retired) continue;
+        checks++;
+        if (e->fromP || e->toP || e->t->fromPartitioning ||
+            e->t->toPartitioning || e->t->group || (e->gid != world->gid)) {
+            printf("Task %d: retired transition '%s' not cleared\n",
+                   laik_myid(world), e->t->name);
+            errors++;
+        }
+    }
+
+    // new partitioning from same partitioner: retired entry may be used
+    Laik_Partitioning* p3 = laik_new_partitioning(pr2, world, space, 0);
+    laik_switchto_partitioning(d, p3, LAIK_DF_Preserve, LAIK_RO_None);
+    checkIndex("same group", d);
+    laik_switchto_partitioning(d, p1, LAIK_DF_Preserve, LAIK_RO_None);
+    checkIndex("same group back", d);
+
+    // same partitioners on shrinked group: retired entries do not match
+    if (world->size == 1) return;
+    int removeList[1] = {0};
+    Laik_Group* g = laik_new_shrinked_group(world, 1, removeList);
+    Laik_Partitioning* p4 = laik_new_partitioning(pr1, g, space, 0);
+    Laik_Partitioning* p5 = laik_new_partitioning(pr2, g, space, 0);
+    laik_switchto_partitioning(d, p4, LAIK_DF_Preserve, LAIK_RO_None);
+    checkIndex("shrinked group", d);
+    laik_switchto_partitioning(d, p5, LAIK_DF_Preserve, LAIK_RO_None);
+    checkIndex("shrinked group weighted", d);
+}
+
+//----------------------------------------------------------------------
+// buffers of cached sequences moving between executions
+
+// chunk i of 4 * tasks chunks goes to task (i + shift) % tasks, with tag
+// 1 + i / tasks: each task gets 4 mappings
+void runInterleaved(Laik_SliceReceiver* r, Laik_PartitionerParams* p)
+{
+    int shift = *((int*) p->partitioner->data);
+    int tasks = p->group->size;
+    int64_t chunk = size / (4 * tasks);
+    Laik_Slice slc;
+    for(int i = 0; i < 4 * tasks; i++) {
+        int64_t to = (i == 4 * tasks - 1) ? size : (i + 1) * chunk;
+        laik_slice_init_1d(&slc, p->space, i * chunk, to);
+        laik_append_slice(r, (i + shift) % tasks, &slc, 1 + i / tasks, 0);
+    }
+}
+
+static
+void testBuffers(Laik_Instance* inst)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_BufPool* pool = inst->bufPool;
+    Laik_Space* space = laik_new_space_1d(inst, size);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    // multiple messages to the same task are combined via buffers
+    static int shift[2] = {0, 1};
+    Laik_Partitioner* pr1 = laik_new_partitioner("interleaved", runInterleaved,
+                                                 &shift[0], 0);
+    Laik_Partitioner* pr2 = laik_new_partitioner("interleaved", runInterleaved,
+                                                 &shift[1], 0);
+    Laik_Partitioning* p1 = laik_new_partitioning(pr1, world, space, 0);
+    Laik_Partitioning* p2 = laik_new_partitioning(pr2, world, space, 0);
+
+    Laik_Reservation* r = laik_reservation_new(d);
+    laik_reservation_add(r, p1);
+    laik_reservation_add(r, p2);
+    laik_reservation_alloc(r);
+    laik_data_use_reservation(d, r);
+
+    laik_switchto_partitioning(d, p1, LAIK_DF_None, LAIK_RO_None);
+    fillIndex(d);
+    laik_switchto_partitioning(d, p2, LAIK_DF_Preserve, LAIK_RO_None);
+    laik_switchto_partitioning(d, p1, LAIK_DF_Preserve, LAIK_RO_None);
+
+    // buffers are only borrowed from the pool during execution
+    checks++;
+    if (pool->enabled && (pool->usedBytes > 0)) {
+        printf("Task %d: %llu bytes of buffers in use between switches\n",
+               laik_myid(world), (unsigned long long) pool->usedBytes);
+        errors++;
+    }
+
+    // take buffers of cached sequences from the pool: next executions
+    // get buffers at other addresses
+    for(int iter = 0; iter < 2; iter++) {
+        char* held[TRANSCACHE_SIZE][4];
+        int heldCount = 0;
+        for(int i = 0; i < d->transCacheCount; i++) {
+            Laik_ActionSeq* as = d->transCache[i].as;
+            if (!as) continue;
+            for(int b = 0; (b < as->bufferCount) && (b < 4); b++)
+                held[heldCount][b] = laik_bufpool_get(inst, as->bufSize[b]);
+            for(int b = as->bufferCount; b < 4; b++)
+                held[heldCount][b] = 0;
+            heldCount++;
+        }
+
+        laik_switchto_partitioning(d, p2, LAIK_DF_Preserve, LAIK_RO_None);
+        checkIndex("moved buffers", d);
+        laik_switchto_partitioning(d, p1, LAIK_DF_Preserve, LAIK_RO_None);
+        checkIndex("moved buffers back", d);
+
+        int h = 0;
+        for(int i = 0; i < d->transCacheCount; i++) {
+            Laik_ActionSeq* as = d->transCache[i].as;
+            if (!as) continue;
+            for(int b = 0; (b < as->bufferCount) && (b < 4); b++)
+                laik_bufpool_put(inst, held[h][b], as->bufSize[b]);
+            h++;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+
+    testPending(inst, false);
+    testPending(inst, true);
+    testReport(world, "pending switches with invalidated transitions");
+
+    testRetired(inst);
+    testReport(world, "retired transitions");
+
+    testBuffers(inst);
+    testReport(world, "cached sequences with moved buffers");
+
+    laik_finalize(inst);
+    return testExitCode();
+}
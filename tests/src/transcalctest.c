@@ -0,0 +1,120 @@
+// Test for calculating multiple transitions in parallel
+//
+// Calculates transitions between various partitionings one by one, and
+// then all at once using multiple threads (laik_calc_transitions).
+// Both must result in the same operations.
+
+#include "laik-internal.h"
+#include "testutil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define MAXTRANS 64
+
+static Laik_Space* tSpace[MAXTRANS];
+static Laik_Partitioning *tFrom[MAXTRANS], *tTo[MAXTRANS];
+static Laik_DataFlow tFlow[MAXTRANS];
+static Laik_ReductionOperation tRedOp[MAXTRANS];
+static int tCount = 0;
+
+static
+void addTrans(Laik_Partitioning* fromP, Laik_Partitioning* toP,
+              Laik_DataFlow flow, Laik_ReductionOperation redOp)
+{
+    assert(tCount < MAXTRANS);
+    tSpace[tCount] = toP->space;
+    tFrom[tCount] = fromP;
+    tTo[tCount] = toP;
+    tFlow[tCount] = flow;
+    tRedOp[tCount] = redOp;
+    tCount++;
+}
+
+// both ways between <p1> and <p2>
+static
+void addTransPair(Laik_Partitioning* p1, Laik_Partitioning* p2)
+{
+    addTrans(p1, p2, LAIK_DF_Preserve, LAIK_RO_None);
+    addTrans(p2, p1, LAIK_DF_Preserve, LAIK_RO_None);
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+
+    // 1d: block partitionings with different weights, reductions
+    Laik_Space* s1 = laik_new_space_1d(inst, 100000);
+    Laik_Partitioning* p1a = laik_new_partitioning(laik_new_block_partitioner1(),
+                                                   world, s1, 0);
+    Laik_Partitioning* p1b = laik_new_partitioning(laik_new_block_partitioner(0, 3, 0, 0, 0),
+                                                   world, s1, 0);
+    Laik_Partitioning* p1all = laik_new_partitioning(laik_All, world, s1, 0);
+    Laik_Partitioning* p1m = laik_new_partitioning(laik_Master, world, s1, 0);
+    addTransPair(p1a, p1b);
+    addTrans(p1a, p1all, LAIK_DF_Preserve, LAIK_RO_None);
+    addTrans(p1all, p1m, LAIK_DF_Preserve, LAIK_RO_Sum);
+    addTrans(p1all, p1all, LAIK_DF_Preserve, LAIK_RO_Max);
+    addTrans(0, p1a, LAIK_DF_None, LAIK_RO_None);
+    addTrans(0, p1all, LAIK_DF_Init, LAIK_RO_Sum);
+
+    // 2d/3d: halo partitionings, with a large number of slices
+    Laik_Space* s2 = laik_new_space_2d(inst, 1000, 1000);
+    Laik_Partitioning* p2 = laik_new_partitioning(laik_new_bisection_partitioner(),
+                                                  world, s2, 0);
+    Laik_Partitioning* p2h = laik_new_partitioning(laik_new_halo_partitioner(1),
+                                                   world, s2, p2);
+    Laik_Partitioning* p2c = laik_new_partitioning(laik_new_cornerhalo_partitioner(2),
+                                                   world, s2, p2);
+    Laik_Partitioning* p2b = laik_new_partitioning(laik_new_block_partitioner(0, 50, 0, 0, 0),
+                                                   world, s2, 0);
+    addTransPair(p2, p2h);
+    addTransPair(p2, p2c);
+    addTransPair(p2h, p2b);
+    addTransPair(p2c, p2b);
+
+    Laik_Space* s3 = laik_new_space_3d(inst, 100, 100, 100);
+    Laik_Partitioning* p3 = laik_new_partitioning(laik_new_bisection_partitioner(),
+                                                  world, s3, 0);
+    Laik_Partitioning* p3c = laik_new_partitioning(laik_new_cornerhalo_partitioner(1),
+                                                   world, s3, p3);
+    Laik_Partitioning* p3b = laik_new_partitioning(laik_new_block_partitioner(2, 20, 0, 0, 0),
+                                                   world, s3, 0);
+    addTransPair(p3, p3c);
+    addTransPair(p3c, p3b);
+
+    // add everything a second time to have more transitions than threads
+    int n = tCount;
+    for(int i = 0; i < n; i++)
+        addTrans(tFrom[i], tTo[i], tFlow[i], tRedOp[i]);
+
+    Laik_Transition* tSeq[MAXTRANS];
+    Laik_Transition* tPar[MAXTRANS];
+    for(int i = 0; i < tCount; i++)
+        tSeq[i] = laik_calc_transition(tSpace[i], tFrom[i], tTo[i],
+                                       tFlow[i], tRedOp[i]);
+
+    laik_set_threads(inst, 4);
+    for(int iter = 0; iter < 10; iter++) {
+        laik_calc_transitions(tCount, tSpace, tFrom, tTo, tFlow, tRedOp, tPar);
+        for(int i = 0; i < tCount; i++) {
+            checks++;
+            if (!sameTransition(tSeq[i], tPar[i])) {
+                printf("Task %d: transition %d differs\n", laik_myid(world), i);
+                errors++;
+            }
+            laik_free_transition(tPar[i]);
+        }
+    }
+
+    for(int i = 0; i < tCount; i++)
+        laik_free_transition(tSeq[i]);
+
+    testReport(world, "transitions calculated in parallel");
+
+    laik_finalize(inst);
+    return testExitCode();
+}
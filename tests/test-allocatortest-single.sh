@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/allocatortest > test-allocatortest-single.out
+cmp test-allocatortest-single.out "$(dirname -- "${0}")/test-allocatortest.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/distparttest > test-distparttest-single.out
+cmp test-distparttest-single.out "$(dirname -- "${0}")/test-distparttest.expected"
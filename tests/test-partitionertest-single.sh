@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/partitionertest > test-partitionertest-single.out
+cmp test-partitionertest-single.out "$(dirname -- "${0}")/test-partitionertest.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/slicearraytest > test-slicearraytest-single.out
+cmp test-slicearraytest-single.out "$(dirname -- "${0}")/test-slicearraytest.expected"
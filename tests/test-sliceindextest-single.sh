@@ -0,0 +1,2 @@
+#!/bin/sh
+LAIK_BACKEND=single src/sliceindextest > test-sliceindextest-single.out
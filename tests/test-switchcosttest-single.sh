@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/switchcosttest > test-switchcosttest-single.out
+cmp test-switchcosttest-single.out "$(dirname -- "${0}")/test-switchcosttest.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/transcachetest > test-transcachetest-single.out
+cmp test-transcachetest-single.out "$(dirname -- "${0}")/test-transcachetest.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/transcalctest > test-transcalctest-single.out
+cmp test-transcalctest-single.out "$(dirname -- "${0}")/test-transcalctest.expected"